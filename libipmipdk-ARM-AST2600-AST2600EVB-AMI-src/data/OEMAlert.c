@@ -0,0 +1,348 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMAlert.c
+*** Description: Asynchronous alert dispatch. PDK_Alert only queues the
+*** alert; a worker thread delivers it, batched per destination, with
+*** exponential backoff while a destination is unreachable.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "Types.h"
+#include "Debug.h"
+#include "PDKAlert.h"
+#include "smtpclient.h"
+#include "OEMAlert.h"
+
+typedef struct
+{
+    INT8U   Record [OEM_ALERT_RECORD_SIZE];
+    INT8U   SetSelector;
+    INT8U   EthIndex;
+    INT8U   Attempts;
+    int     BMCInst;
+    INT64U  EnqueueMs;
+} OEMAlertEntry_T;
+
+/* A destination is an alert destination (set selector) on a LAN channel */
+typedef struct
+{
+    INT8U   Used;
+    INT8U   SetSelector;
+    INT8U   EthIndex;
+    int     BMCInst;
+    INT32U  BackoffSec;
+    INT64U  NextAttemptMs;
+} OEMAlertDest_T;
+
+static OEMAlertEntry_T  m_AlertQueue [OEM_ALERT_QUEUE_MAX];
+static int              m_AlertQueueCount = 0;
+static OEMAlertDest_T   m_AlertDest [OEM_ALERT_DEST_MAX];
+static OEMAlertStats_T  m_AlertStats;
+static pthread_mutex_t  m_AlertLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   m_AlertCond;
+static pthread_once_t   m_AlertOnce = PTHREAD_ONCE_INIT;
+static int              m_AlertWorkerRunning = 0;
+
+static INT64U OEMAlertNowMs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (INT64U)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * @fn OEMAlertGetDest
+ * @brief Finds or allocates the backoff state of a destination. Must be
+ *        called with the lock held.
+ * @return Destination, NULL if the table is full.
+ */
+static OEMAlertDest_T *OEMAlertGetDest(INT8U SetSelector, INT8U EthIndex, int BMCInst)
+{
+    OEMAlertDest_T *pFree = NULL;
+    int i;
+
+    for (i = 0; i < OEM_ALERT_DEST_MAX; i++)
+    {
+        if (!m_AlertDest[i].Used)
+        {
+            if (pFree == NULL)
+                pFree = &m_AlertDest[i];
+            continue;
+        }
+        if ((m_AlertDest[i].SetSelector == SetSelector) && (m_AlertDest[i].EthIndex == EthIndex) &&
+            (m_AlertDest[i].BMCInst == BMCInst))
+            return &m_AlertDest[i];
+    }
+
+    if (pFree != NULL)
+    {
+        memset(pFree, 0, sizeof(OEMAlertDest_T));
+        pFree->Used        = 1;
+        pFree->SetSelector = SetSelector;
+        pFree->EthIndex    = EthIndex;
+        pFree->BMCInst     = BMCInst;
+    }
+    return pFree;
+}
+
+/**
+ * @fn OEMAlertTakeBatch
+ * @brief Removes up to OEM_ALERT_BATCH_MAX queued alerts of the first
+ *        destination that is not backing off. Must be called with the lock
+ *        held.
+ * @param[out] pBatch Alerts taken off the queue, oldest first.
+ * @param[out] ppDest Their destination.
+ * @param[out] pWakeMs Earliest retry time if nothing is ready, else 0.
+ * @return Number of alerts in the batch.
+ */
+static int OEMAlertTakeBatch(OEMAlertEntry_T *pBatch, OEMAlertDest_T **ppDest, INT64U *pWakeMs)
+{
+    OEMAlertDest_T *pDest = NULL, *pCand;
+    INT64U now = OEMAlertNowMs();
+    int i, count = 0;
+
+    *pWakeMs = 0;
+    for (i = 0; i < m_AlertQueueCount; i++)
+    {
+        pCand = OEMAlertGetDest(m_AlertQueue[i].SetSelector, m_AlertQueue[i].EthIndex, m_AlertQueue[i].BMCInst);
+        if (pCand == NULL)
+            continue;
+        if (pCand->NextAttemptMs <= now)
+        {
+            pDest = pCand;
+            break;
+        }
+        if ((*pWakeMs == 0) || (pCand->NextAttemptMs < *pWakeMs))
+            *pWakeMs = pCand->NextAttemptMs;
+    }
+    if (pDest == NULL)
+        return 0;
+
+    for (i = 0; (i < m_AlertQueueCount) && (count < OEM_ALERT_BATCH_MAX); )
+    {
+        if ((m_AlertQueue[i].SetSelector == pDest->SetSelector) && (m_AlertQueue[i].EthIndex == pDest->EthIndex) &&
+            (m_AlertQueue[i].BMCInst == pDest->BMCInst))
+        {
+            pBatch[count++] = m_AlertQueue[i];
+            memmove(&m_AlertQueue[i], &m_AlertQueue[i + 1], (m_AlertQueueCount - i - 1) * sizeof(OEMAlertEntry_T));
+            m_AlertQueueCount--;
+            continue;
+        }
+        i++;
+    }
+    *pWakeMs = 0;
+    *ppDest = pDest;
+    return count;
+}
+
+/**
+ * @fn OEMAlertRequeue
+ * @brief Puts undelivered alerts back at the head of the queue in their
+ *        original order. Alerts out of attempts, or without room, are
+ *        counted as failed. Must be called with the lock held.
+ */
+static void OEMAlertRequeue(OEMAlertEntry_T *pBatch, int Count)
+{
+    int i, keep = 0;
+
+    for (i = 0; i < Count; i++)
+    {
+        if (pBatch[i].Attempts >= OEM_ALERT_RETRY_MAX)
+        {
+            m_AlertStats.Failed++;
+            continue;
+        }
+        pBatch[keep++] = pBatch[i];
+    }
+
+    if ((m_AlertQueueCount + keep) > OEM_ALERT_QUEUE_MAX)
+    {
+        m_AlertStats.Failed += (m_AlertQueueCount + keep) - OEM_ALERT_QUEUE_MAX;
+        keep = OEM_ALERT_QUEUE_MAX - m_AlertQueueCount;
+    }
+
+    memmove(&m_AlertQueue[keep], &m_AlertQueue[0], m_AlertQueueCount * sizeof(OEMAlertEntry_T));
+    memcpy(&m_AlertQueue[0], pBatch, keep * sizeof(OEMAlertEntry_T));
+    m_AlertQueueCount += keep;
+    m_AlertStats.Retries += keep;
+}
+
+/**
+ * @fn OEMAlertWorker
+ * @brief Delivers queued alerts one destination batch at a time. When the
+ *        mail server cannot be reached the rest of the batch is not tried;
+ *        the destination backs off (doubling up to OEM_ALERT_BACKOFF_MAX_SEC)
+ *        and the alerts go back to the queue.
+ */
+static void *OEMAlertWorker(void *pArg)
+{
+    OEMAlertEntry_T batch [OEM_ALERT_BATCH_MAX];
+    OEMAlertDest_T *pDest = NULL;
+    struct timespec deadline;
+    INT64U wake_ms, latency;
+    int count, i, status;
+
+    (void)pArg;
+
+    pthread_mutex_lock(&m_AlertLock);
+    for (;;)
+    {
+        count = OEMAlertTakeBatch(batch, &pDest, &wake_ms);
+        if (count == 0)
+        {
+            if (wake_ms == 0)
+            {
+                pthread_cond_wait(&m_AlertCond, &m_AlertLock);
+            }
+            else
+            {
+                deadline.tv_sec  = wake_ms / 1000;
+                deadline.tv_nsec = (wake_ms % 1000) * 1000000;
+                pthread_cond_timedwait(&m_AlertCond, &m_AlertLock, &deadline);
+            }
+            continue;
+        }
+        m_AlertStats.QueueDepth = m_AlertQueueCount;
+        pthread_mutex_unlock(&m_AlertLock);
+
+        for (i = 0; i < count; i++)
+        {
+            batch[i].Attempts++;
+            status = PDK_FrameAndSendMail(batch[i].Record, batch[i].SetSelector, batch[i].EthIndex, batch[i].BMCInst);
+            if (status == EMAIL_NO_CONNECT)
+                break;
+
+            pthread_mutex_lock(&m_AlertLock);
+            if (status == 0)
+            {
+                latency = OEMAlertNowMs() - batch[i].EnqueueMs;
+                m_AlertStats.Sent++;
+                m_AlertStats.LastLatencyMs = (INT32U)latency;
+                if (latency > m_AlertStats.MaxLatencyMs)
+                    m_AlertStats.MaxLatencyMs = (INT32U)latency;
+            }
+            else
+            {
+                /* Not a network problem (no such user, no address, ...), retrying will not help */
+                m_AlertStats.Failed++;
+            }
+            pthread_mutex_unlock(&m_AlertLock);
+        }
+
+        pthread_mutex_lock(&m_AlertLock);
+        if (i < count)
+        {
+            pDest->BackoffSec = (pDest->BackoffSec == 0) ? OEM_ALERT_BACKOFF_MIN_SEC : (pDest->BackoffSec * 2);
+            if (pDest->BackoffSec > OEM_ALERT_BACKOFF_MAX_SEC)
+                pDest->BackoffSec = OEM_ALERT_BACKOFF_MAX_SEC;
+            pDest->NextAttemptMs = OEMAlertNowMs() + (INT64U)pDest->BackoffSec * 1000;
+            TDBG("OEMAlert: destination %d unreachable, retry in %lu sec\n", pDest->SetSelector, (unsigned long)pDest->BackoffSec);
+            OEMAlertRequeue(&batch[i], count - i);
+        }
+        else
+        {
+            pDest->BackoffSec = 0;
+            pDest->NextAttemptMs = 0;
+        }
+    }
+
+    pthread_mutex_unlock(&m_AlertLock);
+    return NULL;
+}
+
+static void OEMAlertInitOnce(void)
+{
+    pthread_condattr_t attr;
+    pthread_t thread_id;
+
+    /* Backoff deadlines are CLOCK_MONOTONIC, the condvar has to match */
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_AlertCond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    if (pthread_create(&thread_id, NULL, OEMAlertWorker, NULL) != 0)
+    {
+        TCRIT("OEMAlert: failed to start alert worker\n");
+        return;
+    }
+    pthread_detach(thread_id);
+    m_AlertWorkerRunning = 1;
+}
+
+/**
+ * @fn OEM_AlertEnqueue
+ * @brief Queues an alert for the worker thread and returns right away, so
+ *        PEF never waits on the network.
+ * @param[in] pEventRecord SEL event record that triggered the alert.
+ * @param[in] SetSelector Alert destination.
+ * @param[in] EthIndex LAN channel index.
+ * @param[in] BMCInst BMC instance.
+ * @return 0 on success, -1 if the alert was dropped.
+ */
+int OEM_AlertEnqueue(void *pEventRecord, INT8U SetSelector, INT8U EthIndex, int BMCInst)
+{
+    OEMAlertEntry_T *pEntry;
+
+    if (pEventRecord == NULL)
+        return -1;
+
+    pthread_once(&m_AlertOnce, OEMAlertInitOnce);
+
+    pthread_mutex_lock(&m_AlertLock);
+    if (!m_AlertWorkerRunning || (m_AlertQueueCount >= OEM_ALERT_QUEUE_MAX) ||
+        (OEMAlertGetDest(SetSelector, EthIndex, BMCInst) == NULL))
+    {
+        m_AlertStats.Dropped++;
+        pthread_mutex_unlock(&m_AlertLock);
+        IPMI_WARNING("OEMAlert: alert for destination %d dropped\n", SetSelector);
+        return -1;
+    }
+
+    pEntry = &m_AlertQueue[m_AlertQueueCount++];
+    memcpy(pEntry->Record, pEventRecord, OEM_ALERT_RECORD_SIZE);
+    pEntry->SetSelector = SetSelector;
+    pEntry->EthIndex    = EthIndex;
+    pEntry->Attempts    = 0;
+    pEntry->BMCInst     = BMCInst;
+    pEntry->EnqueueMs   = OEMAlertNowMs();
+
+    m_AlertStats.Enqueued++;
+    m_AlertStats.QueueDepth = m_AlertQueueCount;
+    if (m_AlertQueueCount > (int)m_AlertStats.MaxQueueDepth)
+        m_AlertStats.MaxQueueDepth = m_AlertQueueCount;
+
+    pthread_cond_signal(&m_AlertCond);
+    pthread_mutex_unlock(&m_AlertLock);
+    return 0;
+}
+
+/**
+ * @fn OEM_AlertGetStats
+ * @brief Copies the alert delivery counters.
+ * @param[out] pStats Alert statistics.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_AlertGetStats(OEMAlertStats_T *pStats)
+{
+    if (pStats == NULL)
+        return -1;
+
+    pthread_mutex_lock(&m_AlertLock);
+    memcpy(pStats, &m_AlertStats, sizeof(OEMAlertStats_T));
+    pthread_mutex_unlock(&m_AlertLock);
+    return 0;
+}
@@ -0,0 +1,44 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMAlert.h
+*** Description: Asynchronous alert dispatch queue.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#ifndef OEM_ALERT_H
+#define OEM_ALERT_H
+
+#include "Types.h"
+
+#define OEM_ALERT_QUEUE_MAX         64      /* alerts waiting for delivery */
+#define OEM_ALERT_BATCH_MAX         8       /* alerts sent per destination in one go */
+#define OEM_ALERT_DEST_MAX          16      /* destinations with backoff state */
+#define OEM_ALERT_RETRY_MAX         5       /* delivery attempts per alert */
+#define OEM_ALERT_BACKOFF_MIN_SEC   2
+#define OEM_ALERT_BACKOFF_MAX_SEC   300
+#define OEM_ALERT_RECORD_SIZE       16      /* SEL event record */
+
+typedef struct
+{
+    INT32U  Enqueued;
+    INT32U  Dropped;        /* queue full, or destination table full */
+    INT32U  Sent;
+    INT32U  Failed;         /* rejected, or retries exhausted */
+    INT32U  Retries;
+    INT32U  QueueDepth;
+    INT32U  MaxQueueDepth;
+    INT32U  LastLatencyMs;  /* enqueue to delivery */
+    INT32U  MaxLatencyMs;
+} OEMAlertStats_T;
+
+extern int  OEM_AlertEnqueue(void *pEventRecord, INT8U SetSelector, INT8U EthIndex, int BMCInst);
+extern int  OEM_AlertGetStats(OEMAlertStats_T *pStats);
+
+#endif /* OEM_ALERT_H */
@@ -0,0 +1,386 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMChassis.c
+*** Description: Chassis power on/off/cycle/reset as a state machine driven
+*** by a timerfd. The caller only presses the button; holding it, releasing
+*** it and waiting for PS_PWROK happen on the chassis thread, so the IPMI
+*** task never sleeps through a power sequence.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/timerfd.h>
+
+#include "Types.h"
+#include "Debug.h"
+#include "hal_hw.h"
+#include "gpioifc.h"
+#include "OEMChassis.h"
+
+#define OEM_CHASSIS_PRESS_MS            1000    /* power on / reset button press */
+#define OEM_CHASSIS_SOFT_OFF_PRESS_MS   5000
+#define OEM_CHASSIS_OFF_PRESS_SEC       5       /* first power off press, grows after retries */
+#define OEM_CHASSIS_OFF_PRESS_MAX_SEC   9
+#define OEM_CHASSIS_OFF_SHORT_RETRIES   3       /* presses before the press gets longer */
+#define OEM_CHASSIS_OFF_SETTLE_MS       2000
+#define OEM_CHASSIS_CYCLE_POLL_MAX      50
+
+/* A finished step, reported once the lock is dropped */
+typedef struct
+{
+    INT8U   Action;
+    INT8U   Result;
+} OEMChassisNotify_T;
+
+typedef struct
+{
+    const OEMChassisPlatform_T  *pPlatform;
+    INT8U                       Action;     /* requested action */
+    INT8U                       Step;       /* action being executed, differs from Action during a cycle */
+    INT8U                       State;      /* OEMChassisState_E */
+    INT8U                       Retry;
+    INT8U                       PressSec;
+    INT32U                      Polls;
+    INT32U                      CycleIntervalSec;
+    int                         BMCInst;
+    OEMChassisNotify_T          Notify [2];
+    int                         NotifyCount;
+} OEMChassisCtx_T;
+
+/* Internal state before the first step runs, see OEM_ChassisStart */
+#define OEM_CHASSIS_ST_STARTING     0xFF
+
+static OEMChassisCtx_T  m_Chassis;
+static int              m_ChassisTimerFd = -1;
+static pthread_mutex_t  m_ChassisLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t   m_ChassisOnce = PTHREAD_ONCE_INIT;
+
+static void OEMChassisArm(INT32U Ms)
+{
+    struct itimerspec spec;
+
+    /* A zero it_value would disarm the timer */
+    if (Ms == 0)
+        Ms = 1;
+
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec  = Ms / 1000;
+    spec.it_value.tv_nsec = (Ms % 1000) * 1000000;
+    if (timerfd_settime(m_ChassisTimerFd, 0, &spec, NULL) == -1)
+    {
+        TCRIT("OEMChassis: timerfd_settime failed(%d)\n", errno);
+    }
+}
+
+static void OEMChassisButton(INT8U Pin, INT8U Pressed)
+{
+    u8 val;
+    hal_t hal;
+
+    hal.pwrite_buf = &val;
+    hal.gpio.pin = Pin;
+    if (Pressed)
+    {
+        hal.func = HAL_SET_GPIO_DIR;
+        val = 1;    /* output */
+        gpio_write(&hal);
+    }
+
+    /* Buttons are active low */
+    hal.func = HAL_DEVICE_WRITE;
+    val = Pressed ? 0 : 1;
+    gpio_write(&hal);
+}
+
+static INT8U OEMChassisStepPin(void)
+{
+    if (m_Chassis.Step == OEM_CHASSIS_ACT_RESET)
+        return m_Chassis.pPlatform->ResetButtonPin;
+    return m_Chassis.pPlatform->PowerButtonPin;
+}
+
+static int OEMChassisPSGood(void)
+{
+    return m_Chassis.pPlatform->GetPSGood(m_Chassis.BMCInst);
+}
+
+static void OEMChassisPress(INT32U Ms)
+{
+    OEMChassisButton(OEMChassisStepPin(), 1);
+    m_Chassis.State = OEM_CHASSIS_ST_BUTTON_PRESSED;
+    OEMChassisArm(Ms);
+}
+
+static void OEMChassisBeginStep(INT8U Step);
+
+static void OEMChassisNotify(INT8U Action, INT8U Result)
+{
+    m_Chassis.Notify[m_Chassis.NotifyCount].Action = Action;
+    m_Chassis.Notify[m_Chassis.NotifyCount].Result = Result;
+    m_Chassis.NotifyCount++;
+}
+
+/**
+ * @fn OEMChassisCycleWaitOff
+ * @brief Power cycle: waits for PS_PWROK to drop, polling every
+ *        CycleIntervalSec, then powers the host back on.
+ */
+static void OEMChassisCycleWaitOff(void)
+{
+    if (OEMChassisPSGood() && (m_Chassis.Polls < OEM_CHASSIS_CYCLE_POLL_MAX))
+    {
+        m_Chassis.Polls++;
+        m_Chassis.State = OEM_CHASSIS_ST_CYCLE_WAIT_OFF;
+        OEMChassisArm(m_Chassis.CycleIntervalSec * 1000);
+        return;
+    }
+    OEMChassisBeginStep(OEM_CHASSIS_ACT_POWER_ON);
+}
+
+static void OEMChassisStepDone(INT8U Result)
+{
+    OEMChassisNotify(m_Chassis.Step, Result);
+
+    if (m_Chassis.Action == OEM_CHASSIS_ACT_POWER_CYCLE)
+    {
+        if (m_Chassis.Step == OEM_CHASSIS_ACT_POWER_OFF)
+        {
+            /* Power on whether or not the power off worked, the host may be stuck */
+            m_Chassis.Polls = 0;
+            OEMChassisCycleWaitOff();
+            return;
+        }
+        OEMChassisNotify(OEM_CHASSIS_ACT_POWER_CYCLE, Result);
+    }
+    m_Chassis.State = OEM_CHASSIS_ST_IDLE;
+}
+
+static void OEMChassisBeginStep(INT8U Step)
+{
+    m_Chassis.Step = Step;
+
+    switch (Step)
+    {
+        case OEM_CHASSIS_ACT_POWER_OFF:
+            m_Chassis.Retry = 0;
+            m_Chassis.PressSec = OEM_CHASSIS_OFF_PRESS_SEC;
+            if (!OEMChassisPSGood())
+            {
+                OEMChassisStepDone(OEM_CHASSIS_RESULT_PASS);
+                break;
+            }
+            OEMChassisPress(m_Chassis.PressSec * 1000);
+            break;
+
+        case OEM_CHASSIS_ACT_SOFT_OFF:
+            OEMChassisPress(OEM_CHASSIS_SOFT_OFF_PRESS_MS);
+            break;
+
+        case OEM_CHASSIS_ACT_POWER_ON:
+        case OEM_CHASSIS_ACT_RESET:
+        default:
+            OEMChassisPress(OEM_CHASSIS_PRESS_MS);
+            break;
+    }
+}
+
+/**
+ * @fn OEMChassisOffSettled
+ * @brief Power off: the button was released a while ago. Presses again if
+ *        the host is still up, holding longer once the short presses are
+ *        used up, and gives up after the longest press.
+ */
+static void OEMChassisOffSettled(void)
+{
+    if (!OEMChassisPSGood())
+    {
+        OEMChassisStepDone(OEM_CHASSIS_RESULT_PASS);
+        return;
+    }
+
+    m_Chassis.Retry++;
+    if (m_Chassis.Retry >= OEM_CHASSIS_OFF_SHORT_RETRIES)
+    {
+        if (m_Chassis.PressSec >= OEM_CHASSIS_OFF_PRESS_MAX_SEC)
+        {
+            OEMChassisStepDone(OEM_CHASSIS_RESULT_FAIL);
+            return;
+        }
+        m_Chassis.PressSec++;
+    }
+    OEMChassisPress(m_Chassis.PressSec * 1000);
+}
+
+/**
+ * @fn OEMChassisTimerExpired
+ * @brief Advances the state machine on a timer deadline. Must be called with
+ *        the lock held.
+ */
+static void OEMChassisTimerExpired(void)
+{
+    switch (m_Chassis.State)
+    {
+        case OEM_CHASSIS_ST_STARTING:
+            OEMChassisBeginStep((m_Chassis.Action == OEM_CHASSIS_ACT_POWER_CYCLE) ?
+                                OEM_CHASSIS_ACT_POWER_OFF : m_Chassis.Action);
+            break;
+
+        case OEM_CHASSIS_ST_BUTTON_PRESSED:
+            OEMChassisButton(OEMChassisStepPin(), 0);
+            switch (m_Chassis.Step)
+            {
+                case OEM_CHASSIS_ACT_POWER_OFF:
+                    m_Chassis.State = OEM_CHASSIS_ST_OFF_SETTLE;
+                    OEMChassisArm(OEM_CHASSIS_OFF_SETTLE_MS);
+                    break;
+                case OEM_CHASSIS_ACT_POWER_ON:
+                    OEMChassisStepDone(OEMChassisPSGood() ? OEM_CHASSIS_RESULT_PASS : OEM_CHASSIS_RESULT_FAIL);
+                    break;
+                case OEM_CHASSIS_ACT_SOFT_OFF:
+                    OEMChassisStepDone(OEMChassisPSGood() ? OEM_CHASSIS_RESULT_FAIL : OEM_CHASSIS_RESULT_PASS);
+                    break;
+                default:
+                    OEMChassisStepDone(OEM_CHASSIS_RESULT_PASS);
+                    break;
+            }
+            break;
+
+        case OEM_CHASSIS_ST_OFF_SETTLE:
+            OEMChassisOffSettled();
+            break;
+
+        case OEM_CHASSIS_ST_CYCLE_WAIT_OFF:
+            OEMChassisCycleWaitOff();
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void *OEMChassisTask(void *pArg)
+{
+    OEMChassisNotify_T notify [2];
+    const OEMChassisPlatform_T *pPlatform;
+    INT64U expirations;
+    int count, bmc_inst, i;
+
+    (void)pArg;
+
+    for (;;)
+    {
+        if (read(m_ChassisTimerFd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        {
+            if (errno != EINTR)
+            {
+                TCRIT("OEMChassis: timerfd read failed(%d)\n", errno);
+                sleep(1);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&m_ChassisLock);
+        m_Chassis.NotifyCount = 0;
+        OEMChassisTimerExpired();
+        count = m_Chassis.NotifyCount;
+        memcpy(notify, m_Chassis.Notify, sizeof(notify));
+        pPlatform = m_Chassis.pPlatform;
+        bmc_inst = m_Chassis.BMCInst;
+        pthread_mutex_unlock(&m_ChassisLock);
+
+        for (i = 0; i < count; i++)
+        {
+            if ((pPlatform != NULL) && (pPlatform->Done != NULL))
+                pPlatform->Done(notify[i].Action, notify[i].Result, bmc_inst);
+        }
+    }
+    return NULL;
+}
+
+static void OEMChassisInitOnce(void)
+{
+    pthread_t thread_id;
+
+    m_ChassisTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (m_ChassisTimerFd == -1)
+    {
+        TCRIT("OEMChassis: timerfd_create failed(%d)\n", errno);
+        return;
+    }
+
+    if (pthread_create(&thread_id, NULL, OEMChassisTask, NULL) != 0)
+    {
+        TCRIT("OEMChassis: failed to start chassis thread\n");
+        close(m_ChassisTimerFd);
+        m_ChassisTimerFd = -1;
+        return;
+    }
+    pthread_detach(thread_id);
+}
+
+/**
+ * @fn OEM_ChassisStart
+ * @brief Starts a chassis action and returns without waiting for it. The
+ *        platform's Done callback reports the result.
+ * @param[in] pPlatform Button pins, PS_PWROK reader and completion callback.
+ * @param[in] Action OEMChassisAction_E.
+ * @param[in] CycleIntervalSec Power cycle: PS_PWROK poll interval.
+ * @param[in] BMCInst BMC instance.
+ * @return 0 on success, -1 if another action is in progress or on failure.
+ */
+int OEM_ChassisStart(const OEMChassisPlatform_T *pPlatform, INT8U Action, INT32U CycleIntervalSec, int BMCInst)
+{
+    if ((pPlatform == NULL) || (pPlatform->GetPSGood == NULL) || (Action > OEM_CHASSIS_ACT_POWER_CYCLE))
+        return -1;
+
+    pthread_once(&m_ChassisOnce, OEMChassisInitOnce);
+    if (m_ChassisTimerFd == -1)
+        return -1;
+
+    pthread_mutex_lock(&m_ChassisLock);
+    if (m_Chassis.State != OEM_CHASSIS_ST_IDLE)
+    {
+        pthread_mutex_unlock(&m_ChassisLock);
+        IPMI_WARNING("OEMChassis: action %d rejected, action %d in progress\n", Action, m_Chassis.Action);
+        return -1;
+    }
+
+    memset(&m_Chassis, 0, sizeof(m_Chassis));
+    m_Chassis.pPlatform        = pPlatform;
+    m_Chassis.Action           = Action;
+    m_Chassis.CycleIntervalSec = CycleIntervalSec;
+    m_Chassis.BMCInst          = BMCInst;
+
+    /* The first step runs on the chassis thread too, callbacks never run on the caller */
+    m_Chassis.State = OEM_CHASSIS_ST_STARTING;
+    OEMChassisArm(1);
+    pthread_mutex_unlock(&m_ChassisLock);
+    return 0;
+}
+
+/**
+ * @fn OEM_ChassisGetState
+ * @brief Returns the state of the power sequencer.
+ * @return OEMChassisState_E.
+ */
+int OEM_ChassisGetState(void)
+{
+    int state;
+
+    pthread_mutex_lock(&m_ChassisLock);
+    state = m_Chassis.State;
+    pthread_mutex_unlock(&m_ChassisLock);
+
+    /* Starting is an implementation detail, a button press is imminent */
+    return (state == OEM_CHASSIS_ST_STARTING) ? OEM_CHASSIS_ST_BUTTON_PRESSED : state;
+}
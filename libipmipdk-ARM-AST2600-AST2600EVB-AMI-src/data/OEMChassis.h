@@ -0,0 +1,59 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMChassis.h
+*** Description: Timer driven chassis power sequencing.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#ifndef OEM_CHASSIS_H
+#define OEM_CHASSIS_H
+
+#include "Types.h"
+
+/* Chassis actions, also reported as the steps of a power cycle */
+typedef enum
+{
+    OEM_CHASSIS_ACT_POWER_ON = 0,
+    OEM_CHASSIS_ACT_POWER_OFF,
+    OEM_CHASSIS_ACT_SOFT_OFF,
+    OEM_CHASSIS_ACT_RESET,
+    OEM_CHASSIS_ACT_POWER_CYCLE,
+} OEMChassisAction_E;
+
+typedef enum
+{
+    OEM_CHASSIS_ST_IDLE = 0,
+    OEM_CHASSIS_ST_BUTTON_PRESSED,  /* button held, waiting for the release deadline */
+    OEM_CHASSIS_ST_OFF_SETTLE,      /* button released, waiting for PS_PWROK to drop */
+    OEM_CHASSIS_ST_CYCLE_WAIT_OFF,  /* power cycle, polling until the host is off */
+} OEMChassisState_E;
+
+#define OEM_CHASSIS_RESULT_FAIL     0
+#define OEM_CHASSIS_RESULT_PASS     1
+
+/**
+ * @brief Completion callback. Called on the chassis thread once per finished
+ *        action; a power cycle reports its POWER_OFF and POWER_ON steps before
+ *        the POWER_CYCLE itself.
+ */
+typedef void (*OEMChassisDone_T)(INT8U Action, INT8U Result, int BMCInst);
+
+typedef struct
+{
+    INT8U               PowerButtonPin;
+    INT8U               ResetButtonPin;
+    int                 (*GetPSGood)(int BMCInst);
+    OEMChassisDone_T    Done;
+} OEMChassisPlatform_T;
+
+extern int  OEM_ChassisStart(const OEMChassisPlatform_T *pPlatform, INT8U Action, INT32U CycleIntervalSec, int BMCInst);
+extern int  OEM_ChassisGetState(void);
+
+#endif /* OEM_CHASSIS_H */
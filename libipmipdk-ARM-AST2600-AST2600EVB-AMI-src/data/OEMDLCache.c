@@ -0,0 +1,182 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMDLCache.c
+*** Description: Resolves the helper entry points the PDK calls through
+*** dlopen/dlsym once and keeps the libraries loaded, instead of paying for
+*** a dlopen/dlsym/dlclose round trip on every chassis command.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#include <string.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "Types.h"
+#include "Debug.h"
+#include "PDKInt.h"
+#include "gpioifc.h"
+#include "OEMDLCache.h"
+
+#define OEM_DL_IPMISTACK_LIB    "/usr/local/lib/libipmistack.so"
+#define OEM_DL_TELCOHELPER_LIB  "/usr/local/lib/libtelcohelper.so"
+#define OEM_DL_MSGHNDLR_LIB     "/usr/local/lib/libipmimsghndlr.so"
+#define OEM_DL_THERMALMGR_LIB   "/usr/local/lib/libthermalmgr_dell.so"
+
+typedef struct
+{
+    const char  *pLibPath;
+    int         Flags;
+    void        *pHandle;
+} OEMDLLib_T;
+
+typedef struct
+{
+    int         Lib;            /* index in m_DLLib */
+    const char  *pSymName;
+    void        *pFunc;         /* read without the lock, see OEM_DLCacheGet */
+    time_t      LastFailure;    /* CLOCK_MONOTONIC seconds of the last failed lookup */
+} OEMDLSym_T;
+
+enum
+{
+    OEM_DL_LIB_IPMISTACK = 0,
+    OEM_DL_LIB_TELCOHELPER,
+    OEM_DL_LIB_GPIO,
+    OEM_DL_LIB_MSGHNDLR,
+    OEM_DL_LIB_THERMALMGR,
+    OEM_DL_LIB_MAX,
+};
+
+/* Libraries are never dlclose'd, the cached pointers must stay valid */
+static OEMDLLib_T m_DLLib [OEM_DL_LIB_MAX] =
+{
+    { OEM_DL_IPMISTACK_LIB,     RTLD_LAZY,                              NULL },
+    { OEM_DL_TELCOHELPER_LIB,   RTLD_NOW | RTLD_NODELETE | RTLD_GLOBAL, NULL },
+    { GPIO_LIB,                 RTLD_NOW,                               NULL },
+    { OEM_DL_MSGHNDLR_LIB,      RTLD_NOW,                               NULL },
+    { OEM_DL_THERMALMGR_LIB,    RTLD_NOW,                               NULL },
+};
+
+static OEMDLSym_T m_DLSym [OEM_DL_SYM_MAX] =
+{
+    [OEM_DL_SYM_GLOW_LED]               = { OEM_DL_LIB_IPMISTACK,   "GlowLED",                      NULL, 0 },
+    [OEM_DL_SYM_TELCO_CHASSIS_HELPER]   = { OEM_DL_LIB_TELCOHELPER, "TelcoChassisHelper",           NULL, 0 },
+    [OEM_DL_SYM_REGISTER_SENSOR_INT]    = { OEM_DL_LIB_GPIO,        "register_sensor_interrupts",   NULL, 0 },
+    [OEM_DL_SYM_UNREGISTER_SENSOR_INT]  = { OEM_DL_LIB_GPIO,        "unregister_sensor_interrupts", NULL, 0 },
+    [OEM_DL_SYM_SMTP_PRIMARY]           = { OEM_DL_LIB_MSGHNDLR,    "GetSMTP_PrimaryServer",        NULL, 0 },
+    [OEM_DL_SYM_SMTP_SECONDARY]         = { OEM_DL_LIB_MSGHNDLR,    "GetSMTP_SecondaryServer",      NULL, 0 },
+    [OEM_DL_SYM_FSC_START]              = { OEM_DL_LIB_THERMALMGR,  "FSCStart",                     NULL, 0 },
+    [OEM_DL_SYM_FSC_STOP]               = { OEM_DL_LIB_THERMALMGR,  "FSCStop",                      NULL, 0 },
+};
+
+static pthread_mutex_t m_DLLock = PTHREAD_MUTEX_INITIALIZER;
+
+static time_t OEMDLNowSec(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec;
+}
+
+/**
+ * @fn OEMDLResolve
+ * @brief Looks a symbol up, loading its library first if needed. A failed
+ *        lookup is not repeated for OEM_DL_RETRY_SEC so a missing library
+ *        does not cost a search of the library path on every call. Must be
+ *        called with the lock held.
+ * @param[in] Sym Symbol to resolve.
+ * @param[in] Force Ignore the retry interval.
+ * @return Function pointer, NULL if it cannot be resolved.
+ */
+static void *OEMDLResolve(OEMDLSym_E Sym, int Force)
+{
+    OEMDLSym_T *pSym = &m_DLSym[Sym];
+    OEMDLLib_T *pLib = &m_DLLib[pSym->Lib];
+    void *pFunc;
+    time_t now;
+
+    if (pSym->pFunc != NULL)
+        return pSym->pFunc;
+
+    now = OEMDLNowSec();
+    if (!Force && (pSym->LastFailure != 0) && ((now - pSym->LastFailure) < OEM_DL_RETRY_SEC))
+        return NULL;
+
+    if (pLib->pHandle == NULL)
+    {
+        pLib->pHandle = dlopen(pLib->pLibPath, pLib->Flags);
+        if (pLib->pHandle == NULL)
+        {
+            IPMI_ERROR("Error in loading library %s\n", dlerror());
+            pSym->LastFailure = now;
+            return NULL;
+        }
+    }
+
+    pFunc = dlsym(pLib->pHandle, pSym->pSymName);
+    if (pFunc == NULL)
+    {
+        IPMI_ERROR("Error in getting symbol %s\n", dlerror());
+        pSym->LastFailure = now;
+        return NULL;
+    }
+
+    pSym->LastFailure = 0;
+    __atomic_store_n(&pSym->pFunc, pFunc, __ATOMIC_RELEASE);
+    return pFunc;
+}
+
+/**
+ * @fn OEM_DLCacheInit
+ * @brief Resolves every cached entry point. Called once from PDK_PostInit;
+ *        entries that fail here are retried on first use.
+ * @return 0 if everything was resolved, -1 otherwise.
+ */
+int OEM_DLCacheInit(void)
+{
+    int i, ret = 0;
+
+    pthread_mutex_lock(&m_DLLock);
+    for (i = 0; i < OEM_DL_SYM_MAX; i++)
+    {
+        if (OEMDLResolve((OEMDLSym_E)i, 1) == NULL)
+        {
+            ret = -1;
+        }
+    }
+    pthread_mutex_unlock(&m_DLLock);
+    return ret;
+}
+
+/**
+ * @fn OEM_DLCacheGet
+ * @brief Returns the cached address of an entry point. Once resolved this
+ *        is a single load, no lock is taken.
+ * @param[in] Sym Entry point.
+ * @return Function pointer, NULL if it cannot be resolved.
+ */
+void *OEM_DLCacheGet(OEMDLSym_E Sym)
+{
+    void *pFunc;
+
+    if ((unsigned int)Sym >= OEM_DL_SYM_MAX)
+        return NULL;
+
+    pFunc = __atomic_load_n(&m_DLSym[Sym].pFunc, __ATOMIC_ACQUIRE);
+    if (pFunc != NULL)
+        return pFunc;
+
+    pthread_mutex_lock(&m_DLLock);
+    pFunc = OEMDLResolve(Sym, 0);
+    pthread_mutex_unlock(&m_DLLock);
+    return pFunc;
+}
@@ -0,0 +1,39 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMDLCache.h
+*** Description: Cached dlopen/dlsym resolution of the helper entry points
+*** the PDK calls in other libraries.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#ifndef OEM_DL_CACHE_H
+#define OEM_DL_CACHE_H
+
+#include "Types.h"
+
+#define OEM_DL_RETRY_SEC    5   /* minimum time between lookups of a missing symbol */
+
+typedef enum
+{
+    OEM_DL_SYM_GLOW_LED = 0,            /* libipmistack GlowLED */
+    OEM_DL_SYM_TELCO_CHASSIS_HELPER,    /* libtelcohelper TelcoChassisHelper */
+    OEM_DL_SYM_REGISTER_SENSOR_INT,     /* GPIO_LIB register_sensor_interrupts */
+    OEM_DL_SYM_UNREGISTER_SENSOR_INT,   /* GPIO_LIB unregister_sensor_interrupts */
+    OEM_DL_SYM_SMTP_PRIMARY,            /* libipmimsghndlr GetSMTP_PrimaryServer */
+    OEM_DL_SYM_SMTP_SECONDARY,          /* libipmimsghndlr GetSMTP_SecondaryServer */
+    OEM_DL_SYM_FSC_START,               /* libthermalmgr_dell FSCStart */
+    OEM_DL_SYM_FSC_STOP,                /* libthermalmgr_dell FSCStop */
+    OEM_DL_SYM_MAX,
+} OEMDLSym_E;
+
+extern int   OEM_DLCacheInit(void);
+extern void *OEM_DLCacheGet(OEMDLSym_E Sym);
+
+#endif /* OEM_DL_CACHE_H */
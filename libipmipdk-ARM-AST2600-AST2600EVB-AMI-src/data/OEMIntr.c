@@ -0,0 +1,421 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMIntr.c
+*** Description: Timestamped interrupt event ring. The interrupt task is
+*** the only producer, a dispatch thread is the only consumer and hands
+*** the events to the subscribed modules.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+#include "Types.h"
+#include "Debug.h"
+#include "OEMIntr.h"
+
+#define OEM_INTR_RING_MASK      (OEM_INTR_RING_SIZE - 1)
+#define NS_PER_MS               1000000ULL
+#define NS_PER_SEC              1000000000ULL
+
+typedef struct
+{
+    OEMIntrCallback_T   Callback;
+    void                *pCtx;
+    INT16U              Line;
+} OEMIntrSubscriber_T;
+
+/* Coalescing/rate state, written by the producer. The consumer reads it and
+ * takes Pending to deliver what is left when the window expires. */
+typedef struct
+{
+    INT64U  LastPostNs;
+    INT64U  RateStartNs;
+    INT32U  RateCount;
+    INT32U  Pending;        /* coalesced since the last event, swapped atomically */
+    INT64U  PendingNs;      /* last coalesced interrupt */
+    INT8U   PendingSource;
+    INT8U   PendingLevel;
+    INT16U  WindowMs;
+} OEMIntrLineState_T;
+
+static OEMIntrEvent_T       m_IntrRing [OEM_INTR_RING_SIZE];
+static INT32U               m_IntrHead = 0;     /* written by the producer only */
+static INT32U               m_IntrTail = 0;     /* written by the consumer only */
+static int                  m_IntrEventFd = -1;
+
+static OEMIntrLineState_T   m_IntrLineState [OEM_INTR_LINE_MAX];
+static OEMIntrLineStats_T   m_IntrLineStats [OEM_INTR_LINE_MAX];
+static INT32U               m_IntrDroppedNoLine = 0;
+
+static OEMIntrSubscriber_T  m_IntrSubscriber [OEM_INTR_SUBSCRIBER_MAX];
+static int                  m_IntrSubscriberCount = 0;
+static pthread_mutex_t      m_IntrSubscriberLock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_once_t       m_IntrOnce = PTHREAD_ONCE_INIT;
+static int                  m_IntrInitStatus = -1;
+
+
+static INT64U OEMIntrNowNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (INT64U)now.tv_sec * NS_PER_SEC + (INT64U)now.tv_nsec;
+}
+
+/**
+ * @fn OEMIntrPop
+ * @brief Takes the oldest event off the ring. Consumer side only.
+ * @param[out] pEvent Event copied out of the ring.
+ * @return 1 if an event was returned, 0 if the ring is empty.
+ */
+static int OEMIntrPop(OEMIntrEvent_T *pEvent)
+{
+    INT32U tail = m_IntrTail;
+
+    if (__atomic_load_n(&m_IntrHead, __ATOMIC_SEQ_CST) == tail)
+        return 0;
+
+    *pEvent = m_IntrRing[tail & OEM_INTR_RING_MASK];
+    __atomic_store_n(&m_IntrTail, tail + 1, __ATOMIC_SEQ_CST);
+    return 1;
+}
+
+/**
+ * @fn OEMIntrDispatch
+ * @brief Updates latency statistics and calls every matching subscriber.
+ * @param[in] pEvent Event taken off the ring.
+ */
+static void OEMIntrDispatch(const OEMIntrEvent_T *pEvent)
+{
+    OEMIntrLineStats_T *pStats;
+    INT32U latency_us;
+    int count, i;
+
+    latency_us = (INT32U)((OEMIntrNowNs() - pEvent->TimeStampNs) / 1000);
+    if (pEvent->Line < OEM_INTR_LINE_MAX)
+    {
+        pStats = &m_IntrLineStats[pEvent->Line];
+        if ((pStats->LatencyMaxUs == 0) || (latency_us < pStats->LatencyMinUs))
+            pStats->LatencyMinUs = latency_us;
+        if (latency_us > pStats->LatencyMaxUs)
+            pStats->LatencyMaxUs = latency_us;
+        /* 1/8 EWMA, good enough to spot a dispatch thread falling behind */
+        pStats->LatencyAvgUs = pStats->LatencyAvgUs - (pStats->LatencyAvgUs >> 3) + (latency_us >> 3);
+    }
+
+    count = __atomic_load_n(&m_IntrSubscriberCount, __ATOMIC_ACQUIRE);
+    for (i = 0; i < count; i++)
+    {
+        if ((m_IntrSubscriber[i].Line == OEM_INTR_LINE_ANY) || (m_IntrSubscriber[i].Line == pEvent->Line))
+        {
+            m_IntrSubscriber[i].Callback(pEvent, m_IntrSubscriber[i].pCtx);
+        }
+    }
+}
+
+/**
+ * @fn OEMIntrFlushPending
+ * @brief Delivers the interrupts still coalesced on lines whose window has
+ *        expired, as one event carrying the last level and the count, so
+ *        the last edge of a burst is not held until the next interrupt.
+ *        Consumer side only.
+ * @return ms until the next window expires, -1 if nothing is pending.
+ */
+static int OEMIntrFlushPending(void)
+{
+    OEMIntrLineState_T *pState;
+    OEMIntrEvent_T event;
+    INT64U now = OEMIntrNowNs();
+    INT64U deadline, wait_ns = 0;
+    INT32U pending;
+    int line;
+
+    for (line = 0; line < OEM_INTR_LINE_MAX; line++)
+    {
+        pState = &m_IntrLineState[line];
+        if (__atomic_load_n(&pState->Pending, __ATOMIC_ACQUIRE) == 0)
+            continue;
+
+        deadline = __atomic_load_n(&pState->LastPostNs, __ATOMIC_RELAXED) + pState->WindowMs * NS_PER_MS;
+        if (now < deadline)
+        {
+            if ((wait_ns == 0) || ((deadline - now) < wait_ns))
+                wait_ns = deadline - now;
+            continue;
+        }
+
+        /* The producer may post, and take the count, at the same time */
+        pending = __atomic_exchange_n(&pState->Pending, 0, __ATOMIC_ACQ_REL);
+        if (pending == 0)
+            continue;
+
+        event.TimeStampNs = pState->PendingNs;
+        event.Line        = (INT16U)line;
+        event.Source      = pState->PendingSource;
+        event.Level       = pState->PendingLevel;
+        event.Coalesced   = pending - 1;
+        OEMIntrDispatch(&event);
+    }
+
+    if (wait_ns == 0)
+        return -1;
+    return (int)((wait_ns + NS_PER_MS - 1) / NS_PER_MS);
+}
+
+/**
+ * @fn OEMIntrDispatchTask
+ * @brief Drains the ring, then sleeps on the eventfd until the next event
+ *        or until a coalescing window with interrupts pending expires.
+ */
+static void *OEMIntrDispatchTask(void *pArg)
+{
+    OEMIntrEvent_T event;
+    struct pollfd pfd;
+    eventfd_t value;
+    int timeout_ms;
+
+    (void)pArg;
+
+    pfd.fd     = m_IntrEventFd;
+    pfd.events = POLLIN;
+
+    for (;;)
+    {
+        while (OEMIntrPop(&event))
+        {
+            OEMIntrDispatch(&event);
+        }
+        timeout_ms = OEMIntrFlushPending();
+
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+        {
+            if ((timeout_ms < 0) && (errno != EINTR))
+            {
+                TCRIT("OEMIntr: eventfd poll failed(%d)\n", errno);
+                sleep(1);
+            }
+            continue;
+        }
+
+        if ((eventfd_read(m_IntrEventFd, &value) == -1) && (errno != EINTR))
+        {
+            TCRIT("OEMIntr: eventfd read failed(%d)\n", errno);
+            sleep(1);
+        }
+    }
+    return NULL;
+}
+
+static void OEMIntrInitOnce(void)
+{
+    pthread_t thread_id;
+    int i;
+
+    for (i = 0; i < OEM_INTR_LINE_MAX; i++)
+    {
+        m_IntrLineState[i].WindowMs = OEM_INTR_COALESCE_DEFAULT_MS;
+    }
+
+    m_IntrEventFd = eventfd(0, EFD_CLOEXEC);
+    if (m_IntrEventFd == -1)
+    {
+        TCRIT("OEMIntr: eventfd failed(%d)\n", errno);
+        return;
+    }
+
+    if (pthread_create(&thread_id, NULL, OEMIntrDispatchTask, NULL) != 0)
+    {
+        TCRIT("OEMIntr: failed to start dispatch thread\n");
+        close(m_IntrEventFd);
+        m_IntrEventFd = -1;
+        return;
+    }
+    pthread_detach(thread_id);
+    m_IntrInitStatus = 0;
+}
+
+/**
+ * @fn OEM_IntrInit
+ * @brief Starts the dispatch thread. Safe to call more than once.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_IntrInit(void)
+{
+    pthread_once(&m_IntrOnce, OEMIntrInitOnce);
+    return m_IntrInitStatus;
+}
+
+/**
+ * @fn OEM_IntrRecord
+ * @brief Records one interrupt. Called from the interrupt handlers, which
+ *        all run on the interrupt task, the single producer of the ring.
+ *        Never blocks: duplicates inside the line's coalescing window are
+ *        only counted, and delivered with the next event or by the
+ *        dispatcher when the window expires. Events are dropped (and
+ *        counted) if the ring is full.
+ * @param[in] Line Interrupt number.
+ * @param[in] Source OEMIntrSource_E.
+ * @param[in] Level Pin level read by the handler or OEM_INTR_LEVEL_UNKNOWN.
+ */
+void OEM_IntrRecord(INT16U Line, INT8U Source, INT8U Level)
+{
+    OEMIntrLineState_T *pState = NULL;
+    OEMIntrLineStats_T *pStats = NULL;
+    OEMIntrEvent_T *pEvent;
+    INT64U now = OEMIntrNowNs();
+    INT32U head = m_IntrHead;
+
+    if (Line < OEM_INTR_LINE_MAX)
+    {
+        pState = &m_IntrLineState[Line];
+        pStats = &m_IntrLineStats[Line];
+
+        pStats->Count++;
+        pStats->LastTimeStampNs = now;
+
+        pState->RateCount++;
+        if ((now - pState->RateStartNs) >= NS_PER_SEC)
+        {
+            pStats->RatePerSec = pState->RateCount;
+            pState->RateStartNs = now;
+            pState->RateCount = 0;
+        }
+
+        if ((pState->WindowMs != 0) && (pState->LastPostNs != 0) &&
+            ((now - pState->LastPostNs) < (pState->WindowMs * NS_PER_MS)))
+        {
+            pState->PendingNs     = now;
+            pState->PendingSource = Source;
+            pState->PendingLevel  = Level;
+            pStats->Coalesced++;
+            /* The dispatcher has to be woken to flush it once the window is over */
+            if ((__atomic_fetch_add(&pState->Pending, 1, __ATOMIC_RELEASE) == 0) && (m_IntrEventFd != -1))
+            {
+                eventfd_write(m_IntrEventFd, 1);
+            }
+            return;
+        }
+    }
+
+    if ((head - __atomic_load_n(&m_IntrTail, __ATOMIC_ACQUIRE)) >= OEM_INTR_RING_SIZE)
+    {
+        if (pStats != NULL)
+            pStats->Dropped++;
+        else
+            m_IntrDroppedNoLine++;
+        return;
+    }
+
+    pEvent = &m_IntrRing[head & OEM_INTR_RING_MASK];
+    pEvent->TimeStampNs = now;
+    pEvent->Line        = Line;
+    pEvent->Source      = Source;
+    pEvent->Level       = Level;
+    pEvent->Coalesced   = 0;
+    if (pState != NULL)
+    {
+        pEvent->Coalesced = __atomic_exchange_n(&pState->Pending, 0, __ATOMIC_ACQ_REL);
+        __atomic_store_n(&pState->LastPostNs, now, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&m_IntrHead, head + 1, __ATOMIC_SEQ_CST);
+
+    /* Only wake the dispatcher if it may have seen the ring empty */
+    if ((__atomic_load_n(&m_IntrTail, __ATOMIC_SEQ_CST) == head) && (m_IntrEventFd != -1))
+    {
+        eventfd_write(m_IntrEventFd, 1);
+    }
+}
+
+/**
+ * @fn OEM_IntrSubscribe
+ * @brief Registers a callback for one interrupt line or OEM_INTR_LINE_ANY.
+ *        Subscriptions cannot be removed.
+ * @param[in] Line Interrupt number or OEM_INTR_LINE_ANY.
+ * @param[in] Callback Called on the dispatch thread for each event.
+ * @param[in] pCtx Passed back to the callback.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_IntrSubscribe(INT16U Line, OEMIntrCallback_T Callback, void *pCtx)
+{
+    int ret = -1;
+
+    if (Callback == NULL)
+        return -1;
+
+    pthread_mutex_lock(&m_IntrSubscriberLock);
+    if (m_IntrSubscriberCount < OEM_INTR_SUBSCRIBER_MAX)
+    {
+        m_IntrSubscriber[m_IntrSubscriberCount].Callback = Callback;
+        m_IntrSubscriber[m_IntrSubscriberCount].pCtx     = pCtx;
+        m_IntrSubscriber[m_IntrSubscriberCount].Line     = Line;
+        __atomic_store_n(&m_IntrSubscriberCount, m_IntrSubscriberCount + 1, __ATOMIC_RELEASE);
+        ret = 0;
+    }
+    pthread_mutex_unlock(&m_IntrSubscriberLock);
+
+    if (ret != 0)
+    {
+        TCRIT("OEMIntr: no room for another subscriber\n");
+    }
+    return ret;
+}
+
+/**
+ * @fn OEM_IntrSetCoalesceWindow
+ * @brief Sets the window inside which repeated interrupts on a line are
+ *        folded into one event. 0 delivers every interrupt.
+ * @param[in] Line Interrupt number or OEM_INTR_LINE_ANY for all lines.
+ * @param[in] WindowMs Coalescing window in milliseconds.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_IntrSetCoalesceWindow(INT16U Line, INT16U WindowMs)
+{
+    int i;
+
+    if (Line == OEM_INTR_LINE_ANY)
+    {
+        for (i = 0; i < OEM_INTR_LINE_MAX; i++)
+        {
+            m_IntrLineState[i].WindowMs = WindowMs;
+        }
+        return 0;
+    }
+
+    if (Line >= OEM_INTR_LINE_MAX)
+        return -1;
+
+    m_IntrLineState[Line].WindowMs = WindowMs;
+    return 0;
+}
+
+/**
+ * @fn OEM_IntrGetLineStats
+ * @brief Copies the statistics of one interrupt line. The counters are
+ *        updated without locking, so a snapshot may be slightly torn.
+ * @param[in] Line Interrupt number.
+ * @param[out] pStats Statistics of the line.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_IntrGetLineStats(INT16U Line, OEMIntrLineStats_T *pStats)
+{
+    if ((Line >= OEM_INTR_LINE_MAX) || (pStats == NULL))
+        return -1;
+
+    memcpy(pStats, &m_IntrLineStats[Line], sizeof(OEMIntrLineStats_T));
+    return 0;
+}
@@ -0,0 +1,67 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMIntr.h
+*** Description: Interrupt event ring shared by the GPIO/CPLD interrupt
+*** handlers and the modules that consume their events.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#ifndef OEM_INTR_H
+#define OEM_INTR_H
+
+#include "Types.h"
+
+#define OEM_INTR_RING_SIZE              256     /* must be a power of two */
+#define OEM_INTR_LINE_MAX               512     /* lines are interrupt/GPIO numbers */
+#define OEM_INTR_LINE_ANY               0xFFFF
+#define OEM_INTR_SUBSCRIBER_MAX         8
+#define OEM_INTR_COALESCE_DEFAULT_MS    10
+#define OEM_INTR_LEVEL_UNKNOWN          0xFF
+
+typedef enum
+{
+    OEM_INTR_SRC_GPIO = 0,
+    OEM_INTR_SRC_CPLD,
+} OEMIntrSource_E;
+
+typedef struct
+{
+    INT64U  TimeStampNs;    /* CLOCK_MONOTONIC when the handler ran */
+    INT16U  Line;           /* interrupt number as in m_IntInfo */
+    INT8U   Source;         /* OEMIntrSource_E */
+    INT8U   Level;          /* pin level seen by the handler or OEM_INTR_LEVEL_UNKNOWN */
+    INT32U  Coalesced;      /* duplicates folded into this event */
+} OEMIntrEvent_T;
+
+typedef struct
+{
+    INT32U  Count;          /* interrupts recorded */
+    INT32U  Coalesced;      /* folded into another event */
+    INT32U  Dropped;        /* lost because the ring was full */
+    INT32U  RatePerSec;     /* interrupts seen during the last full second */
+    INT32U  LatencyMinUs;   /* record to dispatch */
+    INT32U  LatencyMaxUs;
+    INT32U  LatencyAvgUs;
+    INT64U  LastTimeStampNs;
+} OEMIntrLineStats_T;
+
+/**
+ * @brief Subscriber callback. Runs on the dispatch thread, never on the
+ *        interrupt task, so it may block for a short while.
+ */
+typedef void (*OEMIntrCallback_T)(const OEMIntrEvent_T *pEvent, void *pCtx);
+
+extern int  OEM_IntrInit(void);
+extern void OEM_IntrRecord(INT16U Line, INT8U Source, INT8U Level);
+extern int  OEM_IntrSubscribe(INT16U Line, OEMIntrCallback_T Callback, void *pCtx);
+extern int  OEM_IntrSetCoalesceWindow(INT16U Line, INT16U WindowMs);
+extern int  OEM_IntrGetLineStats(INT16U Line, OEMIntrLineStats_T *pStats);
+
+#endif /* OEM_INTR_H */
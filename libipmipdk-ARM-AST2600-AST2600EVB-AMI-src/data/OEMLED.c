@@ -19,6 +19,7 @@
 #include "OEMLED.h"
 #include "OEMDBG.h"
 #include "OEMPLD.h"
+#include "OEMLEDEngine.h"
 
 /**
  * @brief Global flag indicating the current LED control mode (Auto or Manual).
@@ -33,6 +34,24 @@ INT8U g_LEDTestMode = 0;
  * Function Implementations (Base Board CPLD)
  *-------------------------------------------------------------------------*/
 
+/**
+ * @fn LEDPatternName
+ * @brief Returns a printable name of an LED pattern for the debug output.
+ */
+static const char *LEDPatternName(INT8U pattern)
+{
+    switch(pattern)
+    {
+        case LED_OFF:               return "Off";
+        case LED_SOLID_GREEN:       return "Solid Green";
+        case LED_SOLID_AMBER:       return "Solid Amber";
+        case LED_SOLID_BLUE:        return "Solid Blue";
+        case LED_FLASHING_AMBER:    return "Flashing Amber";
+        case LED_FLASHING_BLUE:     return "Flashing Blue";
+        default:                    return "Unsupported";
+    }
+}
+
 /**
  * @fn GetSIDLedOnFrontPanel
  * @brief Reads the CPLD register to get the current state of the front panel SID LED.
@@ -81,46 +100,32 @@ static int GetSIDLedOnFrontPanel(INT8U *pattern)
 }
 
 /**
- * @fn SetSIDLedOnFrontPanel
- * @brief Writes to the CPLD register to set the state of the front panel SID LED.
+ * @fn SIDLedPatternToReg
+ * @brief Maps an LED pattern to the CPLD value of the front panel SID LED.
  *
- * @param pattern The desired LED pattern (mapped to CPLD value).
- * @return 0 on success, -1 on failure.
+ * @param pattern The desired LED pattern.
+ * @param[out] led_reg_val CPLD register value.
+ * @return 0 on success, -1 if the pattern is not supported by this LED.
  */
-static int SetSIDLedOnFrontPanel(INT8U pattern)
+static int SIDLedPatternToReg(INT8U pattern, INT8U *led_reg_val)
 {
-    INT8U led_reg_val = 0;
-
-    // Debug print the requested LED pattern
-    if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
-        printf("  > Front Panel SID LED pattern: ");
-
-    // Map the standard LED pattern to the raw CPLD register value
     switch(pattern)
     {
         case LED_OFF:
-            led_reg_val = CPLD_SID_LED_OFF;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
-                printf("Off\n");
+            *led_reg_val = CPLD_SID_LED_OFF;
         break;
 
         case LED_SOLID_BLUE:
-            led_reg_val = CPLD_SID_LED_BLUE_ON;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
-                printf("Solid Blue\n");
+            *led_reg_val = CPLD_SID_LED_BLUE_ON;
         break;
 
         // Flashing blue is typically used for the System ID / Beacon function
         case LED_FLASHING_BLUE:
-            led_reg_val = CPLD_SID_LED_BLUE_FLASHING;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
-                printf("Flashing Blue\n");
+            *led_reg_val = CPLD_SID_LED_BLUE_FLASHING;
         break;
 
         case LED_FLASHING_AMBER:
-            led_reg_val = CPLD_SID_LED_AMBER_FLASHING;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
-                printf("Flashing Amber\n");
+            *led_reg_val = CPLD_SID_LED_AMBER_FLASHING;
         break;
 
         default:
@@ -128,6 +133,27 @@ static int SetSIDLedOnFrontPanel(INT8U pattern)
             return -1;
     }
 
+    return 0;
+}
+
+/**
+ * @fn SetSIDLedOnFrontPanel
+ * @brief Writes to the CPLD register to set the state of the front panel SID LED.
+ *
+ * @param pattern The desired LED pattern (mapped to CPLD value).
+ * @return 0 on success, -1 on failure.
+ */
+static int SetSIDLedOnFrontPanel(INT8U pattern)
+{
+    INT8U led_reg_val = 0;
+
+    // Debug print the requested LED pattern
+    if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
+        printf("  > Front Panel SID LED pattern: %s\n", LEDPatternName(pattern));
+
+    if (SIDLedPatternToReg(pattern, &led_reg_val) != 0)
+        return -1;
+
     // Write the calculated register value to the Base Board CPLD
     return OEM_ReadWritePLD(PLD_ID_BaseBoard, CPLD_B_SID_LED_CTRL, led_reg_val, NULL, PLD_WriteRegister);
 }
@@ -183,41 +209,31 @@ static int GetPowerLedOnFrontPanel(INT8U *pattern)
 }
 
 /**
- * @fn SetPowerLedOnFrontPanel
- * @brief Writes to the CPLD register to set the state of the front panel Power/PSU LED.
+ * @fn PowerLedPatternToReg
+ * @brief Maps an LED pattern to the CPLD value of the front panel Power/PSU LED.
  *
  * @param pattern The desired LED pattern.
- * @return 0 on success, -1 on failure.
+ * @param[out] led_reg_val CPLD register value.
+ * @return 0 on success, -1 if the pattern is not supported by this LED.
  */
-static int SetPowerLedOnFrontPanel(INT8U pattern)
+static int PowerLedPatternToReg(INT8U pattern, INT8U *led_reg_val)
 {
-    INT8U led_reg_val = 0;
-
-    // Debug print the requested LED pattern
-    if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
-        printf("  >> Front Panel Power LED pattern: ");
-
-    // Map the standard LED pattern to the raw CPLD register value
     switch(pattern)
     {
         case LED_OFF:
-            led_reg_val = CPLD_PSU_LED_OFF;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Off\n");
+            *led_reg_val = CPLD_PSU_LED_OFF;
         break;
 
         case LED_SOLID_GREEN:
-            led_reg_val = CPLD_PSU_LED_GREEN_ON;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Solid Green\n");
+            *led_reg_val = CPLD_PSU_LED_GREEN_ON;
         break;
 
         case LED_FLASHING_AMBER:
-            led_reg_val = CPLD_PSU_LED_AMBER_FLASHING;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Flashing Amber\n");
+            *led_reg_val = CPLD_PSU_LED_AMBER_FLASHING;
         break;
 
         case LED_SOLID_AMBER:
-            led_reg_val = CPLD_PSU_LED_AMBER_ON;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Solid Amber\n");
+            *led_reg_val = CPLD_PSU_LED_AMBER_ON;
         break;
 
         default:
@@ -225,6 +241,27 @@ static int SetPowerLedOnFrontPanel(INT8U pattern)
             return -1;
     }
 
+    return 0;
+}
+
+/**
+ * @fn SetPowerLedOnFrontPanel
+ * @brief Writes to the CPLD register to set the state of the front panel Power/PSU LED.
+ *
+ * @param pattern The desired LED pattern.
+ * @return 0 on success, -1 on failure.
+ */
+static int SetPowerLedOnFrontPanel(INT8U pattern)
+{
+    INT8U led_reg_val = 0;
+
+    // Debug print the requested LED pattern
+    if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
+        printf("  >> Front Panel Power LED pattern: %s\n", LEDPatternName(pattern));
+
+    if (PowerLedPatternToReg(pattern, &led_reg_val) != 0)
+        return -1;
+
     // Write the calculated register value to the Base Board CPLD
     return OEM_ReadWritePLD(PLD_ID_BaseBoard, CPLD_B_PSU_LED_CTRL, led_reg_val, NULL, PLD_WriteRegister);
 }
@@ -280,41 +317,31 @@ static int GetFanLedOnFrontPanel(INT8U *pattern)
 }
 
 /**
- * @fn SetFanLedOnFrontPanel
- * @brief Writes to the CPLD register to set the state of the front panel Fan LED.
+ * @fn FanLedPatternToReg
+ * @brief Maps an LED pattern to the CPLD value of the front panel Fan LED.
  *
  * @param pattern The desired LED pattern.
- * @return 0 on success, -1 on failure.
+ * @param[out] led_reg_val CPLD register value.
+ * @return 0 on success, -1 if the pattern is not supported by this LED.
  */
-static int SetFanLedOnFrontPanel(INT8U pattern)
+static int FanLedPatternToReg(INT8U pattern, INT8U *led_reg_val)
 {
-    INT8U led_reg_val = 0;
-
-    // Debug print the requested LED pattern
-    if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
-        printf("  >> Front Panel FAN LED pattern: ");
-
-    // Map the standard LED pattern to the raw CPLD register value
     switch(pattern)
     {
         case LED_OFF:
-            led_reg_val = CPLD_FAN_LED_OFF;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Off\n");
+            *led_reg_val = CPLD_FAN_LED_OFF;
         break;
 
         case LED_SOLID_GREEN:
-            led_reg_val = CPLD_FAN_LED_GREEN_ON;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Solid Green\n");
+            *led_reg_val = CPLD_FAN_LED_GREEN_ON;
         break;
 
         case LED_FLASHING_AMBER:
-            led_reg_val = CPLD_FAN_LED_AMBER_FLASHING;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Flashing Amber\n");
+            *led_reg_val = CPLD_FAN_LED_AMBER_FLASHING;
         break;
 
         case LED_SOLID_AMBER:
-            led_reg_val = CPLD_FAN_LED_AMBER_ON;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Solid Amber\n");
+            *led_reg_val = CPLD_FAN_LED_AMBER_ON;
         break;
 
         default:
@@ -322,6 +349,27 @@ static int SetFanLedOnFrontPanel(INT8U pattern)
             return -1;
     }
 
+    return 0;
+}
+
+/**
+ * @fn SetFanLedOnFrontPanel
+ * @brief Writes to the CPLD register to set the state of the front panel Fan LED.
+ *
+ * @param pattern The desired LED pattern.
+ * @return 0 on success, -1 on failure.
+ */
+static int SetFanLedOnFrontPanel(INT8U pattern)
+{
+    INT8U led_reg_val = 0;
+
+    // Debug print the requested LED pattern
+    if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
+        printf("  >> Front Panel FAN LED pattern: %s\n", LEDPatternName(pattern));
+
+    if (FanLedPatternToReg(pattern, &led_reg_val) != 0)
+        return -1;
+
     // Write the calculated register value to the Base Board CPLD
     OEM_ReadWritePLD(PLD_ID_BaseBoard, CPLD_B_FAN_LED_CTRL, led_reg_val, NULL, PLD_WriteRegister);
 
@@ -412,73 +460,76 @@ static int GetFanLedOnFanCage(INT8U led, INT8U *pattern)
 }
 
 /**
- * @fn SetFanLedOnFanCage
- * @brief Writes to the CPLD register to set the state of a specific fan tray LED.
- *
- * The CPLD register value is constructed by ORing the software control bit and the pattern value.
+ * @fn FanCageLedReg
+ * @brief Returns the Fan Board CPLD register of a fan tray LED.
  *
  * @param led The LED number corresponding to a fan tray (FAN1_LED to FAN5_LED).
- * @param pattern The desired LED pattern.
+ * @param[out] led_reg CPLD register address.
+ * @param[out] fan_id Fan number, 1 based.
  * @return 0 on success, -1 on failure.
  */
-static int SetFanLedOnFanCage(INT8U led, INT8U pattern)
+static int FanCageLedReg(INT8U led, INT8U *led_reg, INT8U *fan_id)
 {
-    INT8U led_reg;
-    INT8U fan_id;
-    INT8U led_reg_val = CPLD_FAN_TRAY_LED_SOFT_CTRL;
-
-    // Determine the CPLD register address and fan ID based on the LED number
     switch(led)
     {
         case FAN1_LED:
-            led_reg = CPLD_F_FAN1_LED_CTRL;
-            fan_id = 1;
+            *led_reg = CPLD_F_FAN1_LED_CTRL;
+            *fan_id = 1;
         break;
 
         case FAN2_LED:
-            led_reg = CPLD_F_FAN2_LED_CTRL;
-            fan_id = 2;
+            *led_reg = CPLD_F_FAN2_LED_CTRL;
+            *fan_id = 2;
         break;
 
         case FAN3_LED:
-            led_reg = CPLD_F_FAN3_LED_CTRL;
-            fan_id = 3;
+            *led_reg = CPLD_F_FAN3_LED_CTRL;
+            *fan_id = 3;
         break;
 
         case FAN4_LED:
-            led_reg = CPLD_F_FAN4_LED_CTRL;
-            fan_id = 4;
+            *led_reg = CPLD_F_FAN4_LED_CTRL;
+            *fan_id = 4;
         break;
 
         case FAN5_LED:
-            led_reg = CPLD_F_FAN5_LED_CTRL;
-            fan_id = 5;
+            *led_reg = CPLD_F_FAN5_LED_CTRL;
+            *fan_id = 5;
         break;
 
         default:
             return -1;
     }
 
-    // Debug print the requested LED pattern
-    if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
-        printf("  >> Fan tray Fan%d LED pattern: ", fan_id);
+    return 0;
+}
+
+/**
+ * @fn FanCageLedPatternToReg
+ * @brief Maps an LED pattern to the CPLD value of a fan tray LED.
+ *
+ * The CPLD register value is constructed by ORing the software control bit and the pattern value.
+ *
+ * @param pattern The desired LED pattern.
+ * @param[out] led_reg_val CPLD register value.
+ * @return 0 on success, -1 if the pattern is not supported by this LED.
+ */
+static int FanCageLedPatternToReg(INT8U pattern, INT8U *led_reg_val)
+{
+    *led_reg_val = CPLD_FAN_TRAY_LED_SOFT_CTRL;
 
-    // Map the standard LED pattern to the raw CPLD value and OR it with the control bits
     switch(pattern)
     {
         case LED_OFF:
-            led_reg_val |= CPLD_FAN_TRAY_LED_OFF;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Off\n");
+            *led_reg_val |= CPLD_FAN_TRAY_LED_OFF;
         break;
 
         case LED_SOLID_GREEN:
-            led_reg_val |= CPLD_FAN_TRAY_LED_GREEN_ON;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Solid Green\n");
+            *led_reg_val |= CPLD_FAN_TRAY_LED_GREEN_ON;
         break;
 
         case LED_FLASHING_AMBER:
-            led_reg_val |= CPLD_FAN_TRAY_LED_AMBER_FLASHING;
-            if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0) printf("Flashing Amber\n");
+            *led_reg_val |= CPLD_FAN_TRAY_LED_AMBER_FLASHING;
         break;
 
         default:
@@ -486,6 +537,34 @@ static int SetFanLedOnFanCage(INT8U led, INT8U pattern)
             return -1;
     }
 
+    return 0;
+}
+
+/**
+ * @fn SetFanLedOnFanCage
+ * @brief Writes to the CPLD register to set the state of a specific fan tray LED.
+ *
+ * @param led The LED number corresponding to a fan tray (FAN1_LED to FAN5_LED).
+ * @param pattern The desired LED pattern.
+ * @return 0 on success, -1 on failure.
+ */
+static int SetFanLedOnFanCage(INT8U led, INT8U pattern)
+{
+    INT8U led_reg;
+    INT8U fan_id;
+    INT8U led_reg_val = 0;
+
+    // Determine the CPLD register address and fan ID based on the LED number
+    if (FanCageLedReg(led, &led_reg, &fan_id) != 0)
+        return -1;
+
+    // Debug print the requested LED pattern
+    if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
+        printf("  >> Fan tray Fan%d LED pattern: %s\n", fan_id, LEDPatternName(pattern));
+
+    if (FanCageLedPatternToReg(pattern, &led_reg_val) != 0)
+        return -1;
+
     // Write the calculated register value to the Fan Board CPLD
     return OEM_ReadWritePLD(PLD_ID_FanBoard, led_reg, led_reg_val, NULL, PLD_WriteRegister);
 }
@@ -603,3 +682,51 @@ int SetLEDPatterns(INT8U LEDNum, INT8U Pattern)
     return ret;
 }
 
+/**
+ * @fn OEM_LEDPatternToReg
+ * @brief Returns the CPLD register and value that display a pattern on an
+ * LED, without writing it. Used by the LED engine to diff against what it
+ * last wrote.
+ *
+ * @param LEDNum The identifier for the LED.
+ * @param Pattern The desired pattern.
+ * @param[out] pPldId PLD holding the LED register.
+ * @param[out] pReg CPLD register address.
+ * @param[out] pVal CPLD register value.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_LEDPatternToReg(INT8U LEDNum, INT8U Pattern, INT8U *pPldId, INT8U *pReg, INT8U *pVal)
+{
+    INT8U fan_id;
+
+    switch(LEDNum)
+    {
+        case FrontPanel_POWER_LED:
+            *pPldId = PLD_ID_BaseBoard;
+            *pReg = CPLD_B_PSU_LED_CTRL;
+            return PowerLedPatternToReg(Pattern, pVal);
+
+        case FrontPanel_FAN_LED:
+            *pPldId = PLD_ID_BaseBoard;
+            *pReg = CPLD_B_FAN_LED_CTRL;
+            return FanLedPatternToReg(Pattern, pVal);
+
+        case FrontPanel_SID_LED:
+            *pPldId = PLD_ID_BaseBoard;
+            *pReg = CPLD_B_SID_LED_CTRL;
+            return SIDLedPatternToReg(Pattern, pVal);
+
+        case FAN1_LED:
+        case FAN2_LED:
+        case FAN3_LED:
+        case FAN4_LED:
+        case FAN5_LED:
+            *pPldId = PLD_ID_FanBoard;
+            if (FanCageLedReg(LEDNum, pReg, &fan_id) != 0)
+                return -1;
+            return FanCageLedPatternToReg(Pattern, pVal);
+
+        default:
+            return -1;
+    }
+}
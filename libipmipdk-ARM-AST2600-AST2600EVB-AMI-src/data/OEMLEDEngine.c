@@ -0,0 +1,271 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMLEDEngine.c
+*** Description: Drives the front panel and fan tray LEDs from fan and
+*** power health while g_LEDTestMode is LED_Auto. All LEDs are computed in
+*** one pass and only registers that differ from what was last written are
+*** sent to the CPLDs, adjacent ones in a single block write.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#include <stdio.h>
+
+#include "Types.h"
+#include "OEMLED.h"
+#include "OEMDBG.h"
+#include "OEMPLD.h"
+#include "OEMFAN.h"
+#include "OEMSysState.h"
+#include "OEMLEDEngine.h"
+
+#define OEM_LED_PATTERN_KEEP    0xFF    /* health unknown, leave the LED alone */
+
+#define OEM_LED_ROTOR_UNKNOWN   0
+#define OEM_LED_ROTOR_OK        1
+#define OEM_LED_ROTOR_FAILED    2
+
+typedef struct
+{
+    INT8U   FanId;
+    INT8U   LEDNum;
+} OEMLEDEngineFan_T;
+
+static const OEMLEDEngineFan_T m_EngineFan [] =
+{
+    { SYS_FAN1, FAN1_LED },
+    { SYS_FAN2, FAN2_LED },
+    { SYS_FAN3, FAN3_LED },
+    { SYS_FAN4, FAN4_LED },
+    { SYS_FAN5, FAN5_LED },
+};
+
+#define OEM_LED_ENGINE_FAN_COUNT    (sizeof(m_EngineFan) / sizeof(m_EngineFan[0]))
+#define OEM_LED_ENGINE_LED_COUNT    (OEM_LED_ENGINE_FAN_COUNT + 2)
+
+/* Register last written for each LED the engine drives */
+typedef struct
+{
+    INT8U   PldId;
+    INT8U   Reg;
+    INT8U   Val;
+    INT8U   Valid;
+} OEMLEDShadow_T;
+
+/* A register the current pass wants, sorted by PLD and address */
+typedef struct
+{
+    INT8U   PldId;
+    INT8U   Reg;
+    INT8U   Val;
+    INT8U   Changed;
+    INT8U   Slot;
+} OEMLEDPending_T;
+
+/* Rotor health reported by the fan sensor scan, see OEM_LEDEngineFanReading */
+static INT8U            m_RotorState [OEM_LED_ENGINE_FAN_COUNT][2];
+static OEMLEDShadow_T   m_LEDShadow [OEM_LED_ENGINE_LED_COUNT];
+
+/**
+ * @fn OEM_LEDEngineFanReading
+ * @brief Records the result of a fan RPM read done by the sensor scan, so
+ *        the engine does not read the RPM registers a second time.
+ * @param fan_id The fan tray ID (SYS_FAN1, SYS_FAN2, etc.).
+ * @param fan_rotor FAN_ROTOR_FRONT or FAN_ROTOR_REAR.
+ * @param ret Return value of OEM_GetFanTrayRPM.
+ * @param rpm RPM read, valid if ret is 0.
+ */
+void OEM_LEDEngineFanReading(INT8U fan_id, INT8U fan_rotor, int ret, INT16U rpm)
+{
+    unsigned int i;
+
+    for (i = 0; i < OEM_LED_ENGINE_FAN_COUNT; i++)
+    {
+        if (m_EngineFan[i].FanId == fan_id)
+        {
+            __atomic_store_n(&m_RotorState[i][(FAN_ROTOR_FRONT == fan_rotor) ? 0 : 1],
+                             ((ret == 0) && (rpm >= OEM_LED_FAN_RPM_MIN)) ? OEM_LED_ROTOR_OK : OEM_LED_ROTOR_FAILED,
+                             __ATOMIC_RELAXED);
+            return;
+        }
+    }
+}
+
+/**
+ * @fn OEMLEDEngineDesired
+ * @brief Computes the pattern of every LED the engine drives.
+ * @param[out] pPattern LED pattern per slot: power, front panel fan, fan
+ *             trays. OEM_LED_PATTERN_KEEP if it cannot be decided.
+ * @param[out] pLEDNum LED number per slot.
+ */
+static void OEMLEDEngineDesired(INT8U *pPattern, INT8U *pLEDNum)
+{
+    unsigned int i, fault = 0, missing = 0;
+    INT8U front, rear;
+    int present;
+
+    for (i = 0; i < OEM_LED_ENGINE_FAN_COUNT; i++)
+    {
+        pLEDNum[2 + i] = m_EngineFan[i].LEDNum;
+        present = OEM_GetFanTrayPresent(m_EngineFan[i].FanId);
+        if (present == FAN_ABSENT)
+        {
+            /* A tray plugged in later starts over */
+            __atomic_store_n(&m_RotorState[i][0], OEM_LED_ROTOR_UNKNOWN, __ATOMIC_RELAXED);
+            __atomic_store_n(&m_RotorState[i][1], OEM_LED_ROTOR_UNKNOWN, __ATOMIC_RELAXED);
+            pPattern[2 + i] = LED_OFF;
+            missing++;
+            continue;
+        }
+        if (present != FAN_PRESENT)
+        {
+            pPattern[2 + i] = OEM_LED_PATTERN_KEEP;
+            continue;
+        }
+
+        front = __atomic_load_n(&m_RotorState[i][0], __ATOMIC_RELAXED);
+        rear  = __atomic_load_n(&m_RotorState[i][1], __ATOMIC_RELAXED);
+        if ((front == OEM_LED_ROTOR_FAILED) || (rear == OEM_LED_ROTOR_FAILED))
+        {
+            pPattern[2 + i] = LED_FLASHING_AMBER;
+            fault++;
+        }
+        else
+        {
+            pPattern[2 + i] = LED_SOLID_GREEN;
+        }
+    }
+
+    pLEDNum[1] = FrontPanel_FAN_LED;
+    if (fault > 0)
+        pPattern[1] = LED_FLASHING_AMBER;
+    else if (missing > 0)
+        pPattern[1] = LED_SOLID_AMBER;
+    else
+        pPattern[1] = LED_SOLID_GREEN;
+
+    /* PS_PWRGD is the only power supply state available to the BMC */
+    pLEDNum[0] = FrontPanel_POWER_LED;
+    if (!OEM_SysStateIsValid())
+        pPattern[0] = OEM_LED_PATTERN_KEEP;
+    else if (OEM_SysStateGet() & OEM_SYS_STATE_PS_PWRGD)
+        pPattern[0] = LED_SOLID_GREEN;
+    else
+        pPattern[0] = LED_OFF;
+}
+
+/**
+ * @fn OEMLEDEngineWrite
+ * @brief Writes pPending[0..count-1], consecutive registers of one PLD,
+ *        and updates the shadow.
+ */
+static void OEMLEDEngineWrite(OEMLEDPending_T *pPending, int count)
+{
+    INT8U vals [PLD_BLOCK_WRITE_MAX];
+    int i, ret;
+
+    for (i = 0; i < count; i++)
+    {
+        vals[i] = pPending[i].Val;
+    }
+
+    if (count == 1)
+        ret = OEM_ReadWritePLD(pPending[0].PldId, pPending[0].Reg, vals[0], NULL, PLD_WriteRegister);
+    else
+        ret = OEM_WritePLDBlock(pPending[0].PldId, pPending[0].Reg, vals, (INT8U)count);
+
+    if(g_OEMDebugArray[OEM_DEBUG_Item_LED] > 0)
+        printf("  >> LED engine: PLD %d reg 0x%02X x%d %s\n", pPending[0].PldId, pPending[0].Reg, count, (ret == 0) ? "written" : "failed");
+
+    for (i = 0; i < count; i++)
+    {
+        m_LEDShadow[pPending[i].Slot].PldId = pPending[i].PldId;
+        m_LEDShadow[pPending[i].Slot].Reg   = pPending[i].Reg;
+        m_LEDShadow[pPending[i].Slot].Val   = pPending[i].Val;
+        /* Unknown CPLD contents after a failed write, rewrite next pass */
+        m_LEDShadow[pPending[i].Slot].Valid = (ret == 0) ? 1 : 0;
+    }
+}
+
+/**
+ * @fn OEM_LEDEngineRun
+ * @brief One pass of the LED engine, called from the timer task. Does
+ *        nothing unless g_LEDTestMode is LED_Auto; the shadow is dropped in
+ *        manual mode so every LED is rewritten when auto mode comes back.
+ */
+void OEM_LEDEngineRun(void)
+{
+    OEMLEDPending_T pending [OEM_LED_ENGINE_LED_COUNT], tmp;
+    INT8U pattern [OEM_LED_ENGINE_LED_COUNT];
+    INT8U led_num [OEM_LED_ENGINE_LED_COUNT];
+    OEMLEDShadow_T *pShadow;
+    int count = 0, i, j, end;
+
+    if (g_LEDTestMode != LED_Auto)
+    {
+        for (i = 0; i < (int)OEM_LED_ENGINE_LED_COUNT; i++)
+        {
+            m_LEDShadow[i].Valid = 0;
+        }
+        return;
+    }
+
+    OEMLEDEngineDesired(pattern, led_num);
+
+    for (i = 0; i < (int)OEM_LED_ENGINE_LED_COUNT; i++)
+    {
+        if (pattern[i] == OEM_LED_PATTERN_KEEP)
+            continue;
+        if (OEM_LEDPatternToReg(led_num[i], pattern[i], &pending[count].PldId, &pending[count].Reg, &pending[count].Val) != 0)
+            continue;
+
+        pShadow = &m_LEDShadow[i];
+        pending[count].Slot = (INT8U)i;
+        pending[count].Changed = !(pShadow->Valid && (pShadow->PldId == pending[count].PldId) &&
+                                   (pShadow->Reg == pending[count].Reg) && (pShadow->Val == pending[count].Val));
+        count++;
+    }
+
+    /* Sort by PLD and register so adjacent registers end up next to each other */
+    for (i = 1; i < count; i++)
+    {
+        tmp = pending[i];
+        for (j = i; (j > 0) && ((pending[j - 1].PldId > tmp.PldId) ||
+                                ((pending[j - 1].PldId == tmp.PldId) && (pending[j - 1].Reg > tmp.Reg))); j--)
+        {
+            pending[j] = pending[j - 1];
+        }
+        pending[j] = tmp;
+    }
+
+    /* Each run starts at a changed register and takes the consecutive
+     * registers after it; unchanged ones at its tail are dropped, unchanged
+     * ones inside it are simply written again. */
+    for (i = 0; i < count; i = end)
+    {
+        if (!pending[i].Changed)
+        {
+            end = i + 1;
+            continue;
+        }
+
+        end = i + 1;
+        while ((end < count) && ((end - i) < PLD_BLOCK_WRITE_MAX) &&
+               (pending[end].PldId == pending[i].PldId) && (pending[end].Reg == pending[end - 1].Reg + 1))
+        {
+            end++;
+        }
+        while (!pending[end - 1].Changed)
+        {
+            end--;
+        }
+
+        OEMLEDEngineWrite(&pending[i], end - i);
+    }
+}
@@ -0,0 +1,34 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMLEDEngine.h
+*** Description: Health driven LED engine for LED_Auto mode, and the
+*** OEMLED/OEMPLD helpers it is built on.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#ifndef OEM_LED_ENGINE_H
+#define OEM_LED_ENGINE_H
+
+#include "Types.h"
+
+#define PLD_BLOCK_WRITE_MAX         8       /* registers per OEM_WritePLDBlock transfer */
+#define OEM_LED_FAN_RPM_MIN         1000    /* below this a running rotor is failed */
+
+/* OEMPLD.c */
+extern int  OEM_WritePLDBlock(INT8U pld_id, INT8U reg, const INT8U *data_in, INT8U len);
+
+/* OEMLED.c */
+extern int  OEM_LEDPatternToReg(INT8U LEDNum, INT8U Pattern, INT8U *pPldId, INT8U *pReg, INT8U *pVal);
+
+/* OEMLEDEngine.c */
+extern void OEM_LEDEngineFanReading(INT8U fan_id, INT8U fan_rotor, int ret, INT16U rpm);
+extern void OEM_LEDEngineRun(void);
+
+#endif /* OEM_LED_ENGINE_H */
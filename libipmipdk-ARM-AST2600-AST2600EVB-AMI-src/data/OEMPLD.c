@@ -13,10 +13,56 @@
 ***************************************************************************
 **************************************************************************/
 
+#include <string.h>
+
 #include "PDKDefs.h"
 #include "hal_hw.h"
 
 #include "OEMPLD.h"
+#include "OEMLEDEngine.h"
+
+/**
+ * @fn PLDGetBus
+ * @brief Returns the I2C bus device and slave address of a PLD.
+ * @param pld_id   - PLD number
+ * @param busName  - Buffer for the bus device name, 64 bytes
+ * @param slaveAddr - Slave address of the PLD
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int PLDGetBus(INT8U pld_id, char *busName, INT8U *slaveAddr)
+{
+    INT8U i2cBusId = 0xff;
+
+    switch( pld_id )
+    {
+        case PLD_ID_FPGA:
+            i2cBusId   = I2C_BUS_FPGA;
+            *slaveAddr = I2C_ADDR_FPGA;
+            break;
+
+        case PLD_ID_BaseBoard:
+            i2cBusId   = I2C_BUS_BASE_CPLD;
+            *slaveAddr = I2C_ADDR_BASE_CPLD;
+            break;
+
+        case PLD_ID_FanBoard:
+            i2cBusId   = I2C_BUS_FAN_CPLD;
+            *slaveAddr = I2C_ADDR_FAN_CPLD;
+            break;
+
+        case PLD_ID_COMe:
+            i2cBusId   = I2C_BUS_COME_CPLD;
+            *slaveAddr = I2C_ADDR_COME_CPLD;
+            break;
+
+        default:
+            return -1;
+    }
+
+    sprintf(busName,"/dev/i2c-%d",i2cBusId);
+    return 0;
+}
 
 /**
  * @fn OEM_ReadWritePLD
@@ -39,7 +85,6 @@ int OEM_ReadWritePLD(INT8U pld_id, INT8U reg, INT8U data_in, INT8U *data_out, IN
     _NEAR_ INT8U* outBuffer;
     _NEAR_ INT8U* inBuffer;
     INT8U temp[2] = {0};
-    INT8U i2cBusId = 0xff;
     INT8U slaveAddr = 0xff;
     char busName[64] = {0};
     int retval = -1;
@@ -47,33 +92,8 @@ int OEM_ReadWritePLD(INT8U pld_id, INT8U reg, INT8U data_in, INT8U *data_out, IN
     inBuffer = temp;
     outBuffer = temp;
 
-    switch( pld_id )
-    {
-        case PLD_ID_FPGA:
-            i2cBusId  = I2C_BUS_FPGA;
-            slaveAddr = I2C_ADDR_FPGA;
-            break;
-
-        case PLD_ID_BaseBoard:
-            i2cBusId  = I2C_BUS_BASE_CPLD;
-            slaveAddr = I2C_ADDR_BASE_CPLD;
-            break;
-
-        case PLD_ID_FanBoard:
-            i2cBusId  = I2C_BUS_FAN_CPLD;
-            slaveAddr = I2C_ADDR_FAN_CPLD;
-            break;
-
-        case PLD_ID_COMe:
-            i2cBusId  = I2C_BUS_COME_CPLD;
-            slaveAddr = I2C_ADDR_COME_CPLD;
-            break;
-
-        default:
-            return -1;
-    }
-
-    sprintf(busName,"/dev/i2c-%d",i2cBusId);
+    if (PLDGetBus(pld_id, busName, &slaveAddr) != 0)
+        return -1;
 
     if(mode == PLD_ReadRegister)
     {
@@ -113,3 +133,43 @@ int OEM_ReadWritePLD(INT8U pld_id, INT8U reg, INT8U data_in, INT8U *data_out, IN
 
     return 0;
 }
+
+/**
+ * @fn OEM_WritePLDBlock
+ * @brief Write consecutive PLD registers in one I2C transfer. The PLD
+ *        auto-increments the register address after each data byte.
+ * @param pld_id   - PLD number, see OEM_ReadWritePLD
+ * @param reg      - First PLD register
+ * @param data_in  - Values of reg, reg + 1, ...
+ * @param len      - Number of registers, 1 to PLD_BLOCK_WRITE_MAX
+ *
+ * @return 0 on success, -1 on error.
+ */
+int OEM_WritePLDBlock(INT8U pld_id, INT8U reg, const INT8U *data_in, INT8U len)
+{
+    INT8U outBuffer[PLD_BLOCK_WRITE_MAX + 1];
+    INT8U slaveAddr = 0xff;
+    char busName[64] = {0};
+    int retval = -1;
+
+    if ((data_in == NULL) || (len == 0) || (len > PLD_BLOCK_WRITE_MAX))
+        return -1;
+
+    if (PLDGetBus(pld_id, busName, &slaveAddr) != 0)
+        return -1;
+
+    outBuffer[0] = reg;
+    memcpy(&outBuffer[1], data_in, len);
+
+    /* Without the HAL nothing was written, the caller must not shadow it */
+    if( g_HALI2CHandle[HAL_I2C_MW] == NULL )
+        return -1;
+
+    retval = ( ( int( * )( char *, u8, u8 *, size_t ) )g_HALI2CHandle[HAL_I2C_MW] )( busName, slaveAddr, outBuffer, len + 1);
+    if ( retval < 0 )
+    {
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,212 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMPostCode.c
+*** Description: Continuous BIOS POST code capture. The snoop buffer is
+*** drained every timer tick into a ring that survives host resets.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "Types.h"
+#include "Debug.h"
+#include "hal_hw.h"
+#include "OEMPostCode.h"
+
+#define OEM_POSTCODE_RING_MASK      (OEM_POSTCODE_RING_SIZE - 1)
+#define MAX_SNOOP_SIZE              1024
+
+static OEMPostCode_T    m_PostCodeRing [OEM_POSTCODE_RING_SIZE];
+static INT32U           m_PostCodeTotal = 0;    /* codes ever captured, ring head */
+static INT32U           m_SnoopSeenLen = 0;     /* bytes of the current boot already captured */
+static INT8U            m_SnoopLast [MAX_SNOOP_SIZE];   /* driver buffer at the last capture */
+static INT16U           m_BootCount = 0;
+static INT32U           m_PostCodeDumped = 0;   /* m_PostCodeTotal at the last dump */
+static pthread_mutex_t  m_PostCodeLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @fn OEMPostCodeSnoopNew
+ * @brief Finds where the codes not captured yet start in the driver buffer.
+ *        Once the buffer holds MAX_SNOOP_SIZE codes the driver drops the
+ *        oldest for every new one, so the length stops growing: the shift
+ *        is found by matching the start of the new buffer against the tail
+ *        of the last one. Codes that repeat the whole buffer, e.g. one
+ *        code sent over and over, are not told apart from no new codes.
+ *        Must be called with the lock held.
+ * @return Offset of the first new code in pBuf.
+ */
+static INT32U OEMPostCodeSnoopNew(const INT8U *pBuf, INT32U Len)
+{
+    INT32U shift;
+
+    if (Len < MAX_SNOOP_SIZE)
+        return m_SnoopSeenLen;
+
+    for (shift = 0; shift < m_SnoopSeenLen; shift++)
+    {
+        if (memcmp(&m_SnoopLast[shift], pBuf, m_SnoopSeenLen - shift) == 0)
+            break;
+    }
+    return m_SnoopSeenLen - shift;
+}
+
+/**
+ * @fn OEM_PostCodeCapture
+ * @brief Appends the POST codes the snoop driver collected since the last
+ *        call. Called from PDK_TimerTask once a second, so codes read in the
+ *        same tick share a timestamp.
+ */
+void OEM_PostCodeCapture(void)
+{
+    INT8U PostCodeBuf[MAX_SNOOP_SIZE];
+    OEMPostCode_T *pEntry;
+    struct timespec now;
+    hal_t phal;
+    int rd_len;
+    INT32U i;
+
+    phal.read_len = sizeof(PostCodeBuf);
+    phal.pread_buf = PostCodeBuf;
+    rd_len = snoop_read_current_bios_code(&phal);
+    if (rd_len <= 0)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&m_PostCodeLock);
+
+    /* The driver buffer shrank without an LPC reset hook, treat it as a new boot */
+    if ((INT32U)rd_len < m_SnoopSeenLen)
+    {
+        m_SnoopSeenLen = 0;
+        m_BootCount++;
+    }
+
+    for (i = OEMPostCodeSnoopNew(PostCodeBuf, rd_len); i < (INT32U)rd_len; i++)
+    {
+        pEntry = &m_PostCodeRing[m_PostCodeTotal & OEM_POSTCODE_RING_MASK];
+        pEntry->TimeStampMs = (INT64U)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+        pEntry->BootCount   = m_BootCount;
+        pEntry->Code        = PostCodeBuf[i];
+        pEntry->Reserved    = 0;
+        m_PostCodeTotal++;
+    }
+    m_SnoopSeenLen = rd_len;
+    memcpy(m_SnoopLast, PostCodeBuf, rd_len);
+
+    pthread_mutex_unlock(&m_PostCodeLock);
+}
+
+/**
+ * @fn OEM_PostCodeHostReset
+ * @brief Marks the start of a new host boot. The snoop driver starts a new
+ *        current-boot buffer on LPC reset; the ring keeps the old codes.
+ */
+void OEM_PostCodeHostReset(void)
+{
+    pthread_mutex_lock(&m_PostCodeLock);
+    m_SnoopSeenLen = 0;
+    m_BootCount++;
+    pthread_mutex_unlock(&m_PostCodeLock);
+}
+
+/**
+ * @fn OEM_GetLastPostCodes
+ * @brief Copies the most recent POST codes, oldest first. Locating them is
+ *        O(1), the copy is O(Count).
+ * @param[out] pCodes Buffer for at least Count entries.
+ * @param[in] Count Number of codes wanted.
+ * @return Number of codes copied, -1 on failure.
+ */
+int OEM_GetLastPostCodes(OEMPostCode_T *pCodes, int Count)
+{
+    INT32U avail, start, i;
+
+    if ((pCodes == NULL) || (Count < 0))
+        return -1;
+
+    pthread_mutex_lock(&m_PostCodeLock);
+
+    avail = (m_PostCodeTotal < OEM_POSTCODE_RING_SIZE) ? m_PostCodeTotal : OEM_POSTCODE_RING_SIZE;
+    if ((INT32U)Count > avail)
+        Count = avail;
+
+    start = m_PostCodeTotal - Count;
+    for (i = 0; i < (INT32U)Count; i++)
+    {
+        pCodes[i] = m_PostCodeRing[(start + i) & OEM_POSTCODE_RING_MASK];
+    }
+
+    pthread_mutex_unlock(&m_PostCodeLock);
+    return Count;
+}
+
+/**
+ * @fn OEM_GetPostCodeTotal
+ * @brief Returns the number of POST codes captured since the BMC started,
+ *        including the ones already overwritten in the ring.
+ */
+INT32U OEM_GetPostCodeTotal(void)
+{
+    return m_PostCodeTotal;
+}
+
+/**
+ * @fn OEM_PostCodeDump
+ * @brief Writes the last OEM_POSTCODE_DUMP_COUNT POST codes to a text
+ *        file, oldest first, one "<boot> <ms> <code>" line each, so a
+ *        hung boot can be read from the BMC shell. Called from
+ *        PDK_TimerTask after the capture; the file is only rewritten when
+ *        new codes came in, and is replaced with a rename so a reader
+ *        never sees half of it.
+ * @param[in] pFileName Dump file, normally OEM_POSTCODE_DUMP_FILE.
+ * @return 1 if the file was written, 0 if there was nothing new, -1 on
+ *         failure.
+ */
+int OEM_PostCodeDump(const char *pFileName)
+{
+    OEMPostCode_T codes[OEM_POSTCODE_DUMP_COUNT];
+    char tmp_name[128];
+    INT32U total;
+    FILE *fp;
+    int count, i;
+
+    total = OEM_GetPostCodeTotal();
+    if (total == m_PostCodeDumped)
+        return 0;
+
+    count = OEM_GetLastPostCodes(codes, OEM_POSTCODE_DUMP_COUNT);
+    if (count < 0)
+        return -1;
+
+    snprintf(tmp_name, sizeof(tmp_name), "%s.tmp", pFileName);
+    fp = fopen(tmp_name, "w");
+    if (fp == NULL)
+        return -1;
+
+    fprintf(fp, "# boot ms code, %lu codes captured\n", (unsigned long)total);
+    for (i = 0; i < count; i++)
+    {
+        fprintf(fp, "%u %llu 0x%02X\n", codes[i].BootCount,
+                (unsigned long long)codes[i].TimeStampMs, codes[i].Code);
+    }
+    if ((fclose(fp) != 0) || (rename(tmp_name, pFileName) != 0))
+    {
+        TCRIT("OEMPostCode: failed to write %s\n", pFileName);
+        remove(tmp_name);
+        return -1;
+    }
+
+    m_PostCodeDumped = total;
+    return 1;
+}
@@ -0,0 +1,38 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMPostCode.h
+*** Description: BIOS POST code capture ring.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#ifndef OEM_POSTCODE_H
+#define OEM_POSTCODE_H
+
+#include "Types.h"
+
+#define OEM_POSTCODE_RING_SIZE      2048    /* must be a power of two */
+#define OEM_POSTCODE_DUMP_FILE      "/var/bios_postcodes"   /* tmpfs, for boot hang triage */
+#define OEM_POSTCODE_DUMP_COUNT     256     /* most recent codes written to the dump */
+
+typedef struct
+{
+    INT64U  TimeStampMs;    /* CLOCK_MONOTONIC of the tick that captured it */
+    INT16U  BootCount;      /* host boots seen since the BMC started */
+    INT8U   Code;
+    INT8U   Reserved;
+} OEMPostCode_T;
+
+extern void OEM_PostCodeCapture(void);
+extern void OEM_PostCodeHostReset(void);
+extern int  OEM_GetLastPostCodes(OEMPostCode_T *pCodes, int Count);
+extern INT32U OEM_GetPostCodeTotal(void);
+extern int  OEM_PostCodeDump(const char *pFileName);
+
+#endif /* OEM_POSTCODE_H */
@@ -0,0 +1,267 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMSDR.c
+*** Description: Sensor number indexed view of the SDR repository with
+*** the reading conversion factors precomputed per sensor.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#include <string.h>
+#include <pthread.h>
+
+#include "Types.h"
+#include "Debug.h"
+#include "OSPort.h"
+#include "IPMIConf.h"
+#include "IPMI_SDRRecord.h"
+#include "SDRFunc.h"
+#include "OEMSDR.h"
+
+static OEMSDRSensor_T   m_SDRSensor [OEM_SDR_LUN_MAX][OEM_SDR_SENSOR_MAX];
+static volatile int     m_SDRIndexValid = 0;
+static pthread_rwlock_t m_SDRIndexLock = PTHREAD_RWLOCK_INITIALIZER;
+
+/* 10 bit two's complement M/B from the LSB byte and bits 7:6 of the next */
+static int OEMSDRSigned10(INT8U Lsb, INT8U Msb)
+{
+    int value = Lsb | ((Msb & 0xC0) << 2);
+
+    return (value & 0x200) ? (value - 0x400) : value;
+}
+
+static float OEMSDRPow10(int Exp)
+{
+    float value = 1.0f;
+
+    for (; Exp > 0; Exp--)
+        value *= 10.0f;
+    for (; Exp < 0; Exp++)
+        value /= 10.0f;
+    return value;
+}
+
+static int OEMSDRSigned4(INT8U Nibble)
+{
+    return (Nibble & 0x08) ? ((int)Nibble - 0x10) : (int)Nibble;
+}
+
+/**
+ * @fn OEMSDRAddFull
+ * @brief Fills the index entry of a full sensor record and precomputes
+ *        y = (M * x + B * 10^Bexp) * 10^Rexp as Scale * x + BOffset.
+ */
+static void OEMSDRAddFull(FullSensorRec_T *pRec, INT32U RecOffset)
+{
+    OEMSDRSensor_T *pSensor = &m_SDRSensor[pRec->OwnerLUN & 0x03][pRec->SensorNum];
+    int m = OEMSDRSigned10(pRec->M, pRec->M_Tolerance);
+    int b = OEMSDRSigned10(pRec->B, pRec->B_Accuracy);
+    int r_exp = OEMSDRSigned4(pRec->R_B_Exp >> 4);
+    int b_exp = OEMSDRSigned4(pRec->R_B_Exp & 0x0F);
+
+    pSensor->RecOffset     = RecOffset;
+    pSensor->RecID         = pRec->hdr.ID;
+    pSensor->RecType       = FULL_SDR_REC;
+    pSensor->SensorType    = pRec->SensorType;
+    pSensor->EventTypeCode = pRec->EventTypeCode;
+    pSensor->AnalogFormat  = (pRec->Units1 >> 6) & 0x03;
+    pSensor->Linear        = ((pRec->Linearization & 0x7F) == 0) ? 1 : 0;
+    pSensor->Scale         = m * OEMSDRPow10(r_exp);
+    pSensor->BOffset       = b * OEMSDRPow10(b_exp + r_exp);
+    pSensor->Valid         = 1;
+}
+
+static void OEMSDRAddCompact(CompactSensorRec_T *pRec, INT32U RecOffset)
+{
+    OEMSDRSensor_T *pSensor = &m_SDRSensor[pRec->OwnerLUN & 0x03][pRec->SensorNum];
+
+    pSensor->RecOffset     = RecOffset;
+    pSensor->RecID         = pRec->hdr.ID;
+    pSensor->RecType       = COMPACT_SDR_REC;
+    pSensor->SensorType    = pRec->SensorType;
+    pSensor->EventTypeCode = pRec->EventTypeCode;
+    pSensor->AnalogFormat  = OEM_SDR_FORMAT_NON_ANALOG;
+    pSensor->Linear        = 0;
+    pSensor->Scale         = 0;
+    pSensor->BOffset       = 0;
+    pSensor->Valid         = 1;
+}
+
+/**
+ * @fn OEM_SDRBuildIndex
+ * @brief Walks the core's SDR RAM copy once and indexes every full and
+ *        compact sensor record by owner LUN and sensor number. Called from
+ *        PDK_AfterSDRInit, before anything else can write the SDR; later
+ *        rebuilds go through OEM_SDRIndexTick. Records are kept as offsets,
+ *        the RAM copy may move when the SDR is rewritten.
+ * @param[in] BMCInst BMC instance.
+ * @return Number of sensor records indexed, -1 on failure.
+ */
+int OEM_SDRBuildIndex(int BMCInst)
+{
+    _FAR_ BMCInfo_t *pBMCInfo = &g_BMCInfo[BMCInst];
+    _FAR_ SDRRecHdr_T *pSDRRecord;
+    INT32U offset;
+    int i, count = 0;
+
+    if (pBMCInfo->SDRConfig.SDRRAM == NULL)
+        return -1;
+
+    pthread_rwlock_wrlock(&m_SDRIndexLock);
+
+    memset(m_SDRSensor, 0, sizeof(m_SDRSensor));
+
+    pSDRRecord = SDR_GetFirstSDRRec(BMCInst);
+    for (i = 0; (i < pBMCInfo->SDRConfig.SDRRAM->NumRecords) && (pSDRRecord != NULL); i++)
+    {
+        offset = (INT32U)((_FAR_ INT8U *)pSDRRecord - (_FAR_ INT8U *)pBMCInfo->SDRConfig.SDRRAM);
+        switch (pSDRRecord->Type)
+        {
+            case FULL_SDR_REC:
+                OEMSDRAddFull((FullSensorRec_T *)pSDRRecord, offset);
+                count++;
+                break;
+            case COMPACT_SDR_REC:
+                OEMSDRAddCompact((CompactSensorRec_T *)pSDRRecord, offset);
+                count++;
+                break;
+            default:
+                break;
+        }
+        pSDRRecord = SDR_GetNextSDRRec(pSDRRecord, BMCInst);
+    }
+    m_SDRIndexValid = 1;
+
+    pthread_rwlock_unlock(&m_SDRIndexLock);
+
+    TDBG("OEMSDR: indexed %d sensor records\n", count);
+    return count;
+}
+
+/**
+ * @fn OEM_SDRInvalidateIndex
+ * @brief Marks the index stale after the SDR repository was written.
+ *        Lookups fail until OEM_SDRIndexTick has rebuilt it.
+ */
+void OEM_SDRInvalidateIndex(void)
+{
+    m_SDRIndexValid = 0;
+}
+
+/**
+ * @fn OEM_SDRIndexTick
+ * @brief Rebuilds a stale index. Called from PDK_TimerTask, outside the
+ *        SDR write path. The core SDR lock keeps the repository from being
+ *        rewritten, or its RAM copy moved, during the walk.
+ * @param[in] BMCInst BMC instance.
+ * @return Number of sensor records indexed, 0 if nothing was done.
+ */
+int OEM_SDRIndexTick(int BMCInst)
+{
+    _FAR_ BMCInfo_t *pBMCInfo = &g_BMCInfo[BMCInst];
+    int count;
+
+    if (m_SDRIndexValid)
+        return 0;
+
+    OS_THREAD_MUTEX_ACQUIRE(&pBMCInfo->SDRConfig.SDRMutex, WAIT_INFINITE);
+    count = OEM_SDRBuildIndex(BMCInst);
+    OS_THREAD_MUTEX_RELEASE(&pBMCInfo->SDRConfig.SDRMutex);
+    return count;
+}
+
+/**
+ * @fn OEM_SDRGetSensor
+ * @brief O(1) lookup of a sensor's SDR information.
+ * @param[in] SensorNum Sensor number.
+ * @param[in] OwnerLUN Sensor owner LUN.
+ * @param[out] pSensor Copy of the index entry.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_SDRGetSensor(INT8U SensorNum, INT8U OwnerLUN, OEMSDRSensor_T *pSensor)
+{
+    int ret = -1;
+
+    if (pSensor == NULL)
+        return -1;
+
+    pthread_rwlock_rdlock(&m_SDRIndexLock);
+    if (m_SDRIndexValid && m_SDRSensor[OwnerLUN & 0x03][SensorNum].Valid)
+    {
+        *pSensor = m_SDRSensor[OwnerLUN & 0x03][SensorNum];
+        ret = 0;
+    }
+    pthread_rwlock_unlock(&m_SDRIndexLock);
+    return ret;
+}
+
+/**
+ * @fn OEM_SDRGetSensorType
+ * @brief O(1) lookup of a sensor's type.
+ * @return Sensor type on success, -1 on failure.
+ */
+int OEM_SDRGetSensorType(INT8U SensorNum, INT8U OwnerLUN)
+{
+    int ret = -1;
+
+    pthread_rwlock_rdlock(&m_SDRIndexLock);
+    if (m_SDRIndexValid && m_SDRSensor[OwnerLUN & 0x03][SensorNum].Valid)
+    {
+        ret = m_SDRSensor[OwnerLUN & 0x03][SensorNum].SensorType;
+    }
+    pthread_rwlock_unlock(&m_SDRIndexLock);
+    return ret;
+}
+
+/**
+ * @fn OEM_SDRConvertReading
+ * @brief Converts a raw reading of a linear full record sensor with the
+ *        precomputed factors.
+ * @param[in] SensorNum Sensor number.
+ * @param[in] OwnerLUN Sensor owner LUN.
+ * @param[in] Raw Raw reading.
+ * @param[out] pValue Reading in the sensor's units.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_SDRConvertReading(INT8U SensorNum, INT8U OwnerLUN, INT8U Raw, float *pValue)
+{
+    OEMSDRSensor_T *pSensor;
+    int x, ret = -1;
+
+    if (pValue == NULL)
+        return -1;
+
+    pthread_rwlock_rdlock(&m_SDRIndexLock);
+    pSensor = &m_SDRSensor[OwnerLUN & 0x03][SensorNum];
+    if (m_SDRIndexValid && pSensor->Valid && pSensor->Linear)
+    {
+        switch (pSensor->AnalogFormat)
+        {
+            case OEM_SDR_FORMAT_UNSIGNED:
+                x = Raw;
+                break;
+            case OEM_SDR_FORMAT_1S_COMP:
+                x = (Raw & 0x80) ? -(INT8U)(~Raw) : Raw;
+                break;
+            case OEM_SDR_FORMAT_2S_COMP:
+                x = (INT8S)Raw;
+                break;
+            default:
+                x = 0;
+                break;
+        }
+        if (pSensor->AnalogFormat != OEM_SDR_FORMAT_NON_ANALOG)
+        {
+            *pValue = pSensor->Scale * x + pSensor->BOffset;
+            ret = 0;
+        }
+    }
+    pthread_rwlock_unlock(&m_SDRIndexLock);
+    return ret;
+}
@@ -0,0 +1,49 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMSDR.h
+*** Description: Sensor number indexed view of the SDR repository.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#ifndef OEM_SDR_H
+#define OEM_SDR_H
+
+#include "Types.h"
+
+#define OEM_SDR_LUN_MAX         4
+#define OEM_SDR_SENSOR_MAX      256
+
+#define OEM_SDR_FORMAT_UNSIGNED     0
+#define OEM_SDR_FORMAT_1S_COMP      1
+#define OEM_SDR_FORMAT_2S_COMP      2
+#define OEM_SDR_FORMAT_NON_ANALOG   3
+
+typedef struct
+{
+    INT32U  RecOffset;      /* of the record in the core's SDR RAM copy, read it under the core SDR lock */
+    INT16U  RecID;
+    INT8U   Valid;
+    INT8U   RecType;        /* FULL_SDR_REC or COMPACT_SDR_REC */
+    INT8U   SensorType;
+    INT8U   EventTypeCode;
+    INT8U   AnalogFormat;   /* OEM_SDR_FORMAT_xxx, Units1 bits 7:6 */
+    INT8U   Linear;         /* 1 if Scale/BOffset apply (full record, linearization 0) */
+    float   Scale;          /* M * 10^Rexp */
+    float   BOffset;        /* B * 10^(Bexp + Rexp) */
+} OEMSDRSensor_T;
+
+extern int  OEM_SDRBuildIndex(int BMCInst);
+extern void OEM_SDRInvalidateIndex(void);
+extern int  OEM_SDRIndexTick(int BMCInst);
+extern int  OEM_SDRGetSensor(INT8U SensorNum, INT8U OwnerLUN, OEMSDRSensor_T *pSensor);
+extern int  OEM_SDRGetSensorType(INT8U SensorNum, INT8U OwnerLUN);
+extern int  OEM_SDRConvertReading(INT8U SensorNum, INT8U OwnerLUN, INT8U Raw, float *pValue);
+
+#endif /* OEM_SDR_H */
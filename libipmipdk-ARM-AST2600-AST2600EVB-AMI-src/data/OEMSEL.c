@@ -0,0 +1,1082 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMSEL.c
+*** Description: OEM SEL helpers. PDKWriteSEL goes through a RAM journal
+*** that is flushed to the SEL NVR file in batches, and an in-memory index
+*** answers filtered SEL queries without walking the log. Repeated events
+*** are coalesced before they reach the SEL.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "Types.h"
+#include "Debug.h"
+#include "API.h"
+#include "IPMIDefs.h"
+#include "NVRAPI.h"
+#include "IPMI_SEL.h"
+#include "SEL.h"
+#include "PDKSEL.h"
+#include "OEMSEL.h"
+
+typedef struct
+{
+    INT32U  Offset;         /* offset in the SEL file */
+    INT32U  Size;
+    INT32U  DataOffset;     /* offset in m_SELJournal.Data */
+} OEMSELExtent_T;
+
+typedef struct
+{
+    int             BMCInst;
+    int             ExtentCount;
+    INT32U          Used;
+    time_t          FirstPendingSec;
+    OEMSELExtent_T  Extent [OEM_SEL_JOURNAL_EXTENT_MAX];
+    INT8U           Data [OEM_SEL_JOURNAL_SIZE];
+} OEMSELJournal_T;
+
+#define OEM_SEL_OEM_RECORD_TYPE     0xC0    /* record types from here on carry no sensor fields */
+#define OEM_SEL_SENSOR_NUM_MAX      256
+#define OEM_SEL_DELL_IANA           0x0002A2
+#define OEM_SEL_REC_ID_NONE         0xFFFF  /* reserved ID, marks an empty repository position */
+
+/* One distinct event (generator, sensor, direction/type and event data) */
+typedef struct
+{
+    INT8U   Active;
+    INT8U   Closed;             /* another event of the sensor came in, summary pending */
+    INT8U   GenID [2];
+    INT8U   SensorType;
+    INT8U   SensorNum;
+    INT8U   EvtDirType;
+    INT8U   EvtData [3];
+    time_t  FirstSec;
+    INT32U  Suppressed;
+} OEMSELCoalesce_T;
+
+typedef struct
+{
+    time_t  WindowStartSec;
+    INT16U  Count;
+    INT16U  MaxEvents;
+    INT32U  Suppressed;         /* over the limit and not coalesced into a slot */
+    INT8U   SensorType;         /* last suppressed event, for the summary */
+    INT8U   EvtDirType;
+    INT8U   EvtData1;
+} OEMSELSensorRate_T;
+
+static OEMSELJournal_T      m_SELJournal;
+static OEMSELJournalStats_T m_SELJournalStats;
+static pthread_mutex_t      m_SELJournalLock = PTHREAD_MUTEX_INITIALIZER;
+
+static OEMSELCoalesce_T     m_SELCoalesce [OEM_SEL_COALESCE_SLOTS];
+static OEMSELSensorRate_T   m_SELSensorRate [OEM_SEL_SENSOR_NUM_MAX];
+static INT16U               m_SELCoalesceWindowSec = OEM_SEL_COALESCE_WINDOW_SEC;
+static INT8U                m_SELRateLimitInit = 0;
+static INT32U               m_SELSuppressedTotal = 0;
+static pthread_mutex_t      m_SELCoalesceLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Index: m_SELIndex[key] holds slots of m_SELEntry sorted by OEMSELIndexKey() */
+static OEMSELIndexEntry_T   m_SELEntry [OEM_SEL_INDEX_MAX];
+static INT16U               m_SELEntryCount = 0;
+static INT16U               m_SELIndex [OEM_SEL_KEY_MAX][OEM_SEL_INDEX_MAX];
+static INT16U               m_SELIndexCount [OEM_SEL_KEY_MAX];
+static INT8U                m_SELSortKey;
+/* Record ID last seen at each repository position, to drop what a write replaces */
+static INT16U               m_SELPosRecID [OEM_SEL_INDEX_MAX];
+static pthread_mutex_t      m_SELIndexLock = PTHREAD_MUTEX_INITIALIZER;
+
+static time_t OEMSELNowSec(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec;
+}
+
+/**
+ * @fn OEMSELJournalFlushLocked
+ * @brief Writes every pending extent to the SEL file in the order they were
+ *        journaled, so later writes win. Must be called with the lock held.
+ * @return 0 on success, -1 on failure. The journal is kept on failure and
+ *         retried on the next flush.
+ */
+static int OEMSELJournalFlushLocked(void)
+{
+    OEMSELExtent_T *pExtent;
+    char SELFile[64];
+    int i, ret = 0;
+
+    if (m_SELJournal.ExtentCount == 0)
+        return 0;
+
+    SEL_FILE(m_SELJournal.BMCInst, SELFile);
+
+    for (i = 0; i < m_SELJournal.ExtentCount; i++)
+    {
+        pExtent = &m_SELJournal.Extent[i];
+        if (API_WriteNVR(SELFile, pExtent->Offset, pExtent->Size, &m_SELJournal.Data[pExtent->DataOffset]) < 0)
+        {
+            ret = -1;
+            continue;
+        }
+        m_SELJournalStats.FlushedExtents++;
+        m_SELJournalStats.FlushedBytes += pExtent->Size;
+    }
+
+    if (ret != 0)
+    {
+        m_SELJournalStats.FlushErrors++;
+        IPMI_ERROR("OEMSEL: failed to flush SEL journal to %s\n", SELFile);
+        return -1;
+    }
+
+    m_SELJournalStats.Flushes++;
+    m_SELJournal.ExtentCount = 0;
+    m_SELJournal.Used = 0;
+    return 0;
+}
+
+/**
+ * @fn OEMSELJournalAppend
+ * @brief Puts one write into the journal. Writes that extend the last
+ *        extent, or land entirely inside the newest extent they overlap,
+ *        do not use a new extent. Any other overlap gets its own extent,
+ *        after the ones it overlaps, so the flush applies the writes in
+ *        the order they were made. Must be called with the lock held.
+ * @return 0 on success, -1 if the journal has no room.
+ */
+static int OEMSELJournalAppend(INT8U *pData, INT32U Offset, INT32U Size)
+{
+    OEMSELExtent_T *pExtent;
+    int i;
+
+    /* Rewrite of data already pending, e.g. the repository header. Only
+     * the newest extent overlapping the write may be patched, an older one
+     * would be overwritten again by the newer one on flush. */
+    for (i = m_SELJournal.ExtentCount - 1; i >= 0; i--)
+    {
+        pExtent = &m_SELJournal.Extent[i];
+        if ((Offset >= (pExtent->Offset + pExtent->Size)) || ((Offset + Size) <= pExtent->Offset))
+            continue;
+
+        if ((Offset >= pExtent->Offset) && ((Offset + Size) <= (pExtent->Offset + pExtent->Size)))
+        {
+            memcpy(&m_SELJournal.Data[pExtent->DataOffset + (Offset - pExtent->Offset)], pData, Size);
+            return 0;
+        }
+        break;
+    }
+
+    if ((m_SELJournal.Used + Size) > OEM_SEL_JOURNAL_SIZE)
+        return -1;
+
+    /* Sequential append right after the last extent */
+    if (m_SELJournal.ExtentCount > 0)
+    {
+        pExtent = &m_SELJournal.Extent[m_SELJournal.ExtentCount - 1];
+        if ((pExtent->Offset + pExtent->Size) == Offset)
+        {
+            memcpy(&m_SELJournal.Data[m_SELJournal.Used], pData, Size);
+            pExtent->Size += Size;
+            m_SELJournal.Used += Size;
+            return 0;
+        }
+    }
+
+    if (m_SELJournal.ExtentCount >= OEM_SEL_JOURNAL_EXTENT_MAX)
+        return -1;
+
+    pExtent = &m_SELJournal.Extent[m_SELJournal.ExtentCount++];
+    pExtent->Offset     = Offset;
+    pExtent->Size       = Size;
+    pExtent->DataOffset = m_SELJournal.Used;
+    memcpy(&m_SELJournal.Data[m_SELJournal.Used], pData, Size);
+    m_SELJournal.Used += Size;
+    return 0;
+}
+
+/**
+ * @fn OEM_SELJournalWrite
+ * @brief Journals a SEL file write instead of writing NVR right away. The
+ *        journal is flushed when OEM_SEL_JOURNAL_HIGH_WATER bytes are
+ *        pending, when the oldest pending write is OEM_SEL_JOURNAL_FLUSH_SEC
+ *        old (see OEM_SELJournalTick) and before a BMC reset.
+ * @param[in] pData SEL data to write.
+ * @param[in] Offset Offset in the SEL file.
+ * @param[in] Size Number of bytes.
+ * @param[in] BMCInst BMC instance.
+ * @return What API_WriteNVR returns: Size once the write is journaled,
+ *         -1 on failure.
+ */
+int OEM_SELJournalWrite(INT8U *pData, INT32U Offset, INT32U Size, int BMCInst)
+{
+    char SELFile[64];
+    int ret = (int)Size;
+
+    if ((pData == NULL) || (Size == 0))
+        return 0;
+
+    pthread_mutex_lock(&m_SELJournalLock);
+
+    if ((m_SELJournal.ExtentCount != 0) && (m_SELJournal.BMCInst != BMCInst))
+    {
+        OEMSELJournalFlushLocked();
+    }
+
+    if (Size > OEM_SEL_JOURNAL_HIGH_WATER)
+    {
+        /* Bulk rewrite (e.g. clear SEL): flush what is pending to keep the order */
+        OEMSELJournalFlushLocked();
+        SEL_FILE(BMCInst, SELFile);
+        ret = API_WriteNVR(SELFile, Offset, Size, pData);
+        m_SELJournalStats.WriteThrough++;
+        pthread_mutex_unlock(&m_SELJournalLock);
+        return ret;
+    }
+
+    if (m_SELJournal.ExtentCount == 0)
+    {
+        m_SELJournal.BMCInst = BMCInst;
+        m_SELJournal.FirstPendingSec = OEMSELNowSec();
+    }
+
+    if (OEMSELJournalAppend(pData, Offset, Size) != 0)
+    {
+        /* Journal full, make room and try again */
+        if (OEMSELJournalFlushLocked() == 0)
+        {
+            m_SELJournal.BMCInst = BMCInst;
+            m_SELJournal.FirstPendingSec = OEMSELNowSec();
+        }
+        if (OEMSELJournalAppend(pData, Offset, Size) != 0)
+        {
+            SEL_FILE(BMCInst, SELFile);
+            ret = API_WriteNVR(SELFile, Offset, Size, pData);
+            m_SELJournalStats.WriteThrough++;
+            pthread_mutex_unlock(&m_SELJournalLock);
+            return ret;
+        }
+    }
+
+    m_SELJournalStats.JournaledWrites++;
+    m_SELJournalStats.JournaledBytes += Size;
+    if (m_SELJournal.Used > m_SELJournalStats.MaxPendingBytes)
+        m_SELJournalStats.MaxPendingBytes = m_SELJournal.Used;
+
+    if (m_SELJournal.Used >= OEM_SEL_JOURNAL_HIGH_WATER)
+    {
+        OEMSELJournalFlushLocked();
+    }
+
+    pthread_mutex_unlock(&m_SELJournalLock);
+    return ret;
+}
+
+/**
+ * @fn OEM_SELJournalFlush
+ * @brief Writes everything pending to the SEL file. Used before reading
+ *        the SEL file and from the BMC reset hooks.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_SELJournalFlush(void)
+{
+    int ret;
+
+    pthread_mutex_lock(&m_SELJournalLock);
+    ret = OEMSELJournalFlushLocked();
+    pthread_mutex_unlock(&m_SELJournalLock);
+    return ret;
+}
+
+/**
+ * @fn OEM_SELJournalTick
+ * @brief Flushes the journal once its oldest write is older than
+ *        OEM_SEL_JOURNAL_FLUSH_SEC. Called from PDK_TimerTask every second.
+ */
+void OEM_SELJournalTick(void)
+{
+    pthread_mutex_lock(&m_SELJournalLock);
+    if ((m_SELJournal.ExtentCount != 0) &&
+        ((OEMSELNowSec() - m_SELJournal.FirstPendingSec) >= OEM_SEL_JOURNAL_FLUSH_SEC))
+    {
+        if (OEMSELJournalFlushLocked() != 0)
+        {
+            /* Retry after another full interval rather than every tick */
+            m_SELJournal.FirstPendingSec = OEMSELNowSec();
+        }
+    }
+    pthread_mutex_unlock(&m_SELJournalLock);
+}
+
+/**
+ * @fn OEM_SELJournalGetStats
+ * @brief Copies the journal counters.
+ * @param[out] pStats Journal statistics.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_SELJournalGetStats(OEMSELJournalStats_T *pStats)
+{
+    if (pStats == NULL)
+        return -1;
+
+    pthread_mutex_lock(&m_SELJournalLock);
+    memcpy(pStats, &m_SELJournalStats, sizeof(OEMSELJournalStats_T));
+    pthread_mutex_unlock(&m_SELJournalLock);
+    return 0;
+}
+
+
+/**
+ * @fn OEMSELIndexKey
+ * @brief Builds the 64 bit sort key of a slot for one index:
+ *        key byte (48..55) | timestamp (16..47) | slot (0..15). The slot
+ *        makes every key unique, so searches never have to handle ties.
+ */
+static INT64U OEMSELIndexKey(INT8U Key, INT16U Slot)
+{
+    const OEMSELIndexEntry_T *pEntry = &m_SELEntry[Slot];
+    INT8U value = 0;
+
+    switch (Key)
+    {
+        case OEM_SEL_KEY_SENSOR_NUM:
+            value = pEntry->SensorNum;
+            break;
+        case OEM_SEL_KEY_SENSOR_TYPE:
+            value = pEntry->SensorType;
+            break;
+        case OEM_SEL_KEY_EVENT_TYPE:
+            value = pEntry->EvtDirType & 0x7F;
+            break;
+        default:
+            break;
+    }
+    return ((INT64U)value << 48) | ((INT64U)pEntry->TimeStamp << 16) | Slot;
+}
+
+/**
+ * @fn OEMSELIndexLowerBound
+ * @brief Returns the first position in an index whose key is >= KeyValue.
+ */
+static int OEMSELIndexLowerBound(INT8U Key, INT64U KeyValue)
+{
+    int lo = 0, hi = m_SELIndexCount[Key], mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (OEMSELIndexKey(Key, m_SELIndex[Key][mid]) < KeyValue)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static int OEMSELIndexCompare(const void *pA, const void *pB)
+{
+    INT64U a = OEMSELIndexKey(m_SELSortKey, *(const INT16U *)pA);
+    INT64U b = OEMSELIndexKey(m_SELSortKey, *(const INT16U *)pB);
+
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+static int OEMSELIndexHasKey(INT8U Key, INT16U Slot)
+{
+    return (Key == OEM_SEL_KEY_TIME) || (m_SELEntry[Slot].RecType < OEM_SEL_OEM_RECORD_TYPE);
+}
+
+static void OEMSELIndexFill(INT16U Slot, const SELEventRecord_T *pRecord)
+{
+    OEMSELIndexEntry_T *pEntry = &m_SELEntry[Slot];
+
+    memset(pEntry, 0, sizeof(OEMSELIndexEntry_T));
+    pEntry->RecID   = pRecord->hdr.ID;
+    pEntry->RecType = pRecord->hdr.Type;
+    /* Non-timestamped OEM records (0xE0-0xFF) sort as time 0 */
+    if (pRecord->hdr.Type < 0xE0)
+        pEntry->TimeStamp = pRecord->hdr.TimeStamp;
+    if (pRecord->hdr.Type < OEM_SEL_OEM_RECORD_TYPE)
+    {
+        pEntry->SensorType = pRecord->SensorType;
+        pEntry->SensorNum  = pRecord->SensorNum;
+        pEntry->EvtDirType = pRecord->EvtDirType;
+        pEntry->EvtData1   = pRecord->EvtData1;
+    }
+}
+
+/**
+ * @fn OEMSELIndexRemoveSlot
+ * @brief Drops a slot from every index it is in. Must be called with the
+ *        index lock held.
+ */
+static void OEMSELIndexRemoveSlot(INT16U Slot)
+{
+    INT8U key;
+    int pos;
+
+    for (key = 0; key < OEM_SEL_KEY_MAX; key++)
+    {
+        if (!OEMSELIndexHasKey(key, Slot))
+            continue;
+
+        pos = OEMSELIndexLowerBound(key, OEMSELIndexKey(key, Slot));
+        if ((pos < m_SELIndexCount[key]) && (m_SELIndex[key][pos] == Slot))
+        {
+            memmove(&m_SELIndex[key][pos], &m_SELIndex[key][pos + 1],
+                    (m_SELIndexCount[key] - pos - 1) * sizeof(INT16U));
+            m_SELIndexCount[key]--;
+        }
+    }
+}
+
+/**
+ * @fn OEMSELIndexInsertSlot
+ * @brief Inserts a filled slot into every index it belongs to. Must be
+ *        called with the index lock held.
+ */
+static void OEMSELIndexInsertSlot(INT16U Slot)
+{
+    INT8U key;
+    int pos;
+
+    /* New records normally sort last, so the memmove is usually empty */
+    for (key = 0; key < OEM_SEL_KEY_MAX; key++)
+    {
+        if (!OEMSELIndexHasKey(key, Slot))
+            continue;
+
+        pos = OEMSELIndexLowerBound(key, OEMSELIndexKey(key, Slot));
+        memmove(&m_SELIndex[key][pos + 1], &m_SELIndex[key][pos],
+                (m_SELIndexCount[key] - pos) * sizeof(INT16U));
+        m_SELIndex[key][pos] = Slot;
+        m_SELIndexCount[key]++;
+    }
+}
+
+/**
+ * @fn OEMSELIndexRemoveRecID
+ * @brief Drops a record from the index and moves the last slot into the
+ *        hole, so slots stay dense. Must be called with the index lock
+ *        held.
+ */
+static void OEMSELIndexRemoveRecID(INT16U RecID)
+{
+    INT16U slot, last;
+
+    for (slot = 0; slot < m_SELEntryCount; slot++)
+    {
+        if (m_SELEntry[slot].RecID == RecID)
+            break;
+    }
+    if (slot == m_SELEntryCount)
+        return;
+
+    OEMSELIndexRemoveSlot(slot);
+    last = m_SELEntryCount - 1;
+    if (slot != last)
+    {
+        OEMSELIndexRemoveSlot(last);
+        m_SELEntry[slot] = m_SELEntry[last];
+        OEMSELIndexInsertSlot(slot);
+    }
+    m_SELEntryCount--;
+}
+
+/**
+ * @fn OEM_SELIndexBuild
+ * @brief Builds the SEL index from the repository just loaded by
+ *        PDKInitNVRSEL.
+ * @param[in] pRepository SEL repository as read from NVR.
+ * @param[in] Size Number of valid bytes in pRepository.
+ * @return Number of indexed records, -1 on failure.
+ */
+int OEM_SELIndexBuild(INT8U *pRepository, INT32U Size)
+{
+    SELRec_T *pRec;
+    INT32U offset, pos;
+    INT8U key;
+
+    if (pRepository == NULL)
+        return -1;
+
+    pthread_mutex_lock(&m_SELIndexLock);
+
+    m_SELEntryCount = 0;
+    memset(m_SELIndexCount, 0, sizeof(m_SELIndexCount));
+    memset(m_SELPosRecID, 0xFF, sizeof(m_SELPosRecID));
+
+    /* Records past the first OEM_SEL_INDEX_MAX positions are not indexed */
+    for (offset = offsetof(SELRepository_T, SELRecord), pos = 0;
+         ((offset + sizeof(SELRec_T)) <= Size) && (pos < OEM_SEL_INDEX_MAX);
+         offset += sizeof(SELRec_T), pos++)
+    {
+        pRec = (SELRec_T *)(pRepository + offset);
+        if (pRec->Valid != VALID_RECORD)
+            continue;
+
+        m_SELPosRecID[pos] = pRec->EvtRecord.hdr.ID;
+        OEMSELIndexFill(m_SELEntryCount, &pRec->EvtRecord);
+        for (key = 0; key < OEM_SEL_KEY_MAX; key++)
+        {
+            if (OEMSELIndexHasKey(key, m_SELEntryCount))
+                m_SELIndex[key][m_SELIndexCount[key]++] = m_SELEntryCount;
+        }
+        m_SELEntryCount++;
+    }
+
+    for (key = 0; key < OEM_SEL_KEY_MAX; key++)
+    {
+        m_SELSortKey = key;
+        qsort(m_SELIndex[key], m_SELIndexCount[key], sizeof(INT16U), OEMSELIndexCompare);
+    }
+
+    pthread_mutex_unlock(&m_SELIndexLock);
+    return m_SELEntryCount;
+}
+
+/**
+ * @fn OEM_SELIndexAdd
+ * @brief Adds a record the core has just stored. Called from
+ *        PDK_PostAddSEL. The record it replaces in a circular SEL is
+ *        dropped by OEM_SELIndexWrite; should the index itself be full,
+ *        the oldest record is dropped.
+ * @param[in] pSELEntry SEL record (SELEventRecord_T) that was added.
+ */
+void OEM_SELIndexAdd(INT8U *pSELEntry)
+{
+    INT16U slot;
+
+    if (pSELEntry == NULL)
+        return;
+
+    pthread_mutex_lock(&m_SELIndexLock);
+
+    /* Never index one record ID twice */
+    OEMSELIndexRemoveRecID(((SELEventRecord_T *)pSELEntry)->hdr.ID);
+
+    if (m_SELEntryCount < OEM_SEL_INDEX_MAX)
+    {
+        slot = m_SELEntryCount++;
+    }
+    else
+    {
+        slot = m_SELIndex[OEM_SEL_KEY_TIME][0];
+        OEMSELIndexRemoveSlot(slot);
+    }
+
+    OEMSELIndexFill(slot, (SELEventRecord_T *)pSELEntry);
+    OEMSELIndexInsertSlot(slot);
+
+    pthread_mutex_unlock(&m_SELIndexLock);
+}
+
+/**
+ * @fn OEM_SELIndexWrite
+ * @brief Drops the records a write to the SEL file replaces: the oldest
+ *        record overwritten by a circular SEL, or a record deleted by
+ *        clearing its Valid byte. Called from PDKWriteSEL, which sees
+ *        every change to the repository.
+ * @param[in] pData Data being written.
+ * @param[in] Offset Offset of the write in the SEL file.
+ * @param[in] Size Size of the write.
+ */
+void OEM_SELIndexWrite(INT8U *pData, INT32U Offset, INT32U Size)
+{
+    const INT32U base = offsetof(SELRepository_T, SELRecord);
+    const INT32U valid_off = offsetof(SELRec_T, Valid);
+    const INT32U id_off = offsetof(SELRec_T, EvtRecord) + offsetof(SELRecHdr_T, ID);
+    INT32U pos, rec_start, end = Offset + Size;
+    INT16U new_id;
+
+    if ((pData == NULL) || (end <= base))
+        return;
+
+    pthread_mutex_lock(&m_SELIndexLock);
+
+    pos = (Offset > base) ? (Offset - base) / sizeof(SELRec_T) : 0;
+    for (; pos < OEM_SEL_INDEX_MAX; pos++)
+    {
+        rec_start = base + pos * sizeof(SELRec_T);
+        if (rec_start >= end)
+            break;
+
+        new_id = m_SELPosRecID[pos];
+        if ((rec_start + valid_off >= Offset) && (rec_start + valid_off < end) &&
+            (pData[rec_start + valid_off - Offset] != VALID_RECORD))
+        {
+            new_id = OEM_SEL_REC_ID_NONE;
+        }
+        else if ((rec_start + id_off >= Offset) && (rec_start + id_off + sizeof(INT16U) <= end))
+        {
+            memcpy(&new_id, &pData[rec_start + id_off - Offset], sizeof(INT16U));
+        }
+
+        if (new_id != m_SELPosRecID[pos])
+        {
+            if (m_SELPosRecID[pos] != OEM_SEL_REC_ID_NONE)
+                OEMSELIndexRemoveRecID(m_SELPosRecID[pos]);
+            m_SELPosRecID[pos] = new_id;
+        }
+    }
+
+    pthread_mutex_unlock(&m_SELIndexLock);
+}
+
+/**
+ * @fn OEM_SELIndexClear
+ * @brief Empties the index. Called when the SEL is cleared.
+ */
+void OEM_SELIndexClear(void)
+{
+    pthread_mutex_lock(&m_SELIndexLock);
+    m_SELEntryCount = 0;
+    memset(m_SELIndexCount, 0, sizeof(m_SELIndexCount));
+    memset(m_SELPosRecID, 0xFF, sizeof(m_SELPosRecID));
+    pthread_mutex_unlock(&m_SELIndexLock);
+}
+
+/**
+ * @fn OEM_SELQuery
+ * @brief Returns one page of SEL records matching a key and time range,
+ *        oldest first. Locating the range is O(log n).
+ *        e.g. all fan events since T:
+ *        { OEM_SEL_KEY_SENSOR_TYPE, 0x04, T, 0xFFFFFFFF }
+ * @param[in] pQuery Key, key value and time range.
+ * @param[in] Cursor 0 for the first page, then the value returned in
+ *            pNextCursor.
+ * @param[out] pEntries Buffer for up to MaxCount records.
+ * @param[in] MaxCount Page size.
+ * @param[out] pNextCursor Cursor of the next page, OEM_SEL_QUERY_END when
+ *             there is none.
+ * @return Number of records returned, -1 on failure.
+ */
+int OEM_SELQuery(const OEMSELQuery_T *pQuery, INT16U Cursor, OEMSELIndexEntry_T *pEntries,
+                 int MaxCount, INT16U *pNextCursor)
+{
+    INT64U value;
+    int lo, hi, count = 0;
+
+    if ((pQuery == NULL) || (pEntries == NULL) || (pNextCursor == NULL) ||
+        (pQuery->Key >= OEM_SEL_KEY_MAX) || (MaxCount <= 0) || (pQuery->StartTime > pQuery->EndTime))
+        return -1;
+
+    value = (pQuery->Key == OEM_SEL_KEY_TIME) ? 0 : ((INT64U)pQuery->Value << 48);
+
+    pthread_mutex_lock(&m_SELIndexLock);
+
+    lo = OEMSELIndexLowerBound(pQuery->Key, value | ((INT64U)pQuery->StartTime << 16));
+    hi = OEMSELIndexLowerBound(pQuery->Key, value | ((INT64U)pQuery->EndTime << 16) | 0xFFFF);
+    /* the upper bound key itself is a valid slot value, include it */
+    if ((hi < m_SELIndexCount[pQuery->Key]) &&
+        (OEMSELIndexKey(pQuery->Key, m_SELIndex[pQuery->Key][hi]) == (value | ((INT64U)pQuery->EndTime << 16) | 0xFFFF)))
+        hi++;
+
+    for (lo += Cursor; (lo < hi) && (count < MaxCount); lo++)
+    {
+        pEntries[count++] = m_SELEntry[m_SELIndex[pQuery->Key][lo]];
+    }
+    *pNextCursor = (lo < hi) ? (INT16U)(Cursor + count) : OEM_SEL_QUERY_END;
+
+    pthread_mutex_unlock(&m_SELIndexLock);
+    return count;
+}
+
+/**
+ * @fn OEM_SELQueryCmd
+ * @brief OEM SEL query command handler, returns one page of
+ *        OEM_SELQuery() so filtered SEL reads do not walk the log with
+ *        Get SEL Entry. Registered in the OEM net function command table
+ *        of the platform OEM IPMI library.
+ * @param[in] pReq OEMSELQueryReq_T.
+ * @param[in] ReqLen Request length.
+ * @param[out] pRes OEMSELQueryRes_T.
+ * @param[in] BMCInst BMC instance.
+ * @return Response length.
+ */
+int OEM_SELQueryCmd(INT8U *pReq, INT8U ReqLen, INT8U *pRes, int BMCInst)
+{
+    OEMSELQueryReq_T *pQueryReq = (OEMSELQueryReq_T *)pReq;
+    OEMSELQueryRes_T *pQueryRes = (OEMSELQueryRes_T *)pRes;
+    OEMSELIndexEntry_T entries [OEM_SEL_QUERY_CMD_MAX_RECORDS];
+    OEMSELQuery_T query;
+    INT16U next;
+    int count, max;
+
+    UN_USED(BMCInst);
+
+    if (ReqLen != sizeof(OEMSELQueryReq_T))
+    {
+        pQueryRes->CompletionCode = CC_REQ_INV_LEN;
+        return sizeof(INT8U);
+    }
+
+    max = pQueryReq->MaxCount;
+    if ((max == 0) || (max > OEM_SEL_QUERY_CMD_MAX_RECORDS))
+        max = OEM_SEL_QUERY_CMD_MAX_RECORDS;
+
+    query.Key       = pQueryReq->Key;
+    query.Value     = pQueryReq->Value;
+    query.StartTime = pQueryReq->StartTime;
+    query.EndTime   = pQueryReq->EndTime;
+    count = OEM_SELQuery(&query, pQueryReq->Cursor, entries, max, &next);
+    if (count < 0)
+    {
+        pQueryRes->CompletionCode = CC_INV_DATA_FIELD;
+        return sizeof(INT8U);
+    }
+
+    pQueryRes->CompletionCode = CC_NORMAL;
+    pQueryRes->NextCursor     = next;
+    pQueryRes->Count          = (INT8U)count;
+    memcpy(pQueryRes->Entry, entries, count * sizeof(OEMSELIndexEntry_T));
+    return offsetof(OEMSELQueryRes_T, Entry) + count * sizeof(OEMSELIndexEntry_T);
+}
+
+
+static void OEMSELRateLimitInitLocked(void)
+{
+    int i;
+
+    if (m_SELRateLimitInit)
+        return;
+
+    for (i = 0; i < OEM_SEL_SENSOR_NUM_MAX; i++)
+    {
+        m_SELSensorRate[i].MaxEvents = OEM_SEL_RATE_LIMIT_DEFAULT;
+    }
+    m_SELRateLimitInit = 1;
+}
+
+/**
+ * @fn OEM_SELCoalesce
+ * @brief Coalescing stage run from PDK_PreAddSEL. An event identical to
+ *        one already logged inside the window, with no other event from
+ *        the same sensor and generator in between, or over its sensor's
+ *        rate limit, is dropped and counted; OEM_SELCoalesceTick later
+ *        logs one summary record with the count per event, or per sensor
+ *        for rate limited events.
+ * @param[in] pSELEntry SEL record (SELEventRecord_T) about to be added.
+ * @param[in] SelectTbl SEL/PEF selection requested by the core.
+ * @return SelectTbl to let the event through, 0 to suppress it.
+ */
+INT8U OEM_SELCoalesce(INT8U *pSELEntry, INT8U SelectTbl)
+{
+    SELEventRecord_T *pRecord = (SELEventRecord_T *)pSELEntry;
+    OEMSELCoalesce_T *pSlot = NULL, *pFree = NULL;
+    OEMSELSensorRate_T *pRate;
+    INT8U rate_limited = 0;
+    time_t now;
+    int i;
+
+    /* Only system event records; our own summaries are OEM records */
+    if ((pRecord == NULL) || (pRecord->hdr.Type != 0x02) || (m_SELCoalesceWindowSec == 0))
+        return SelectTbl;
+
+    now = OEMSELNowSec();
+
+    pthread_mutex_lock(&m_SELCoalesceLock);
+    OEMSELRateLimitInitLocked();
+
+    pRate = &m_SELSensorRate[pRecord->SensorNum];
+    if (((now - pRate->WindowStartSec) >= m_SELCoalesceWindowSec) && (pRate->Suppressed == 0))
+    {
+        pRate->WindowStartSec = now;
+        pRate->Count = 0;
+    }
+    if (pRate->Count != 0xFFFF)
+        pRate->Count++;
+    if ((pRate->MaxEvents != 0) && (pRate->Count > pRate->MaxEvents))
+        rate_limited = 1;
+
+    for (i = 0; i < OEM_SEL_COALESCE_SLOTS; i++)
+    {
+        if (!m_SELCoalesce[i].Active)
+        {
+            if (pFree == NULL)
+                pFree = &m_SELCoalesce[i];
+            continue;
+        }
+        /* Expired and closed slots wait for OEM_SELCoalesceTick to log their summary */
+        if (m_SELCoalesce[i].Closed || ((now - m_SELCoalesce[i].FirstSec) >= m_SELCoalesceWindowSec))
+            continue;
+        if ((m_SELCoalesce[i].SensorNum != pRecord->SensorNum) ||
+            (memcmp(m_SELCoalesce[i].GenID, pRecord->GenID, sizeof(m_SELCoalesce[i].GenID)) != 0))
+            continue;
+
+        if ((m_SELCoalesce[i].SensorType == pRecord->SensorType) &&
+            (m_SELCoalesce[i].EvtDirType == pRecord->EvtDirType) &&
+            (m_SELCoalesce[i].EvtData[0] == pRecord->EvtData1) &&
+            (m_SELCoalesce[i].EvtData[1] == pRecord->EvtData2) &&
+            (m_SELCoalesce[i].EvtData[2] == pRecord->EvtData3))
+        {
+            pSlot = &m_SELCoalesce[i];
+        }
+        else if (m_SELCoalesce[i].Suppressed != 0)
+        {
+            /* The sensor changed state, e.g. assert then deassert: a repeat
+             * of the old event is a new transition, not a copy to fold */
+            m_SELCoalesce[i].Closed = 1;
+        }
+        else
+        {
+            m_SELCoalesce[i].Active = 0;
+            if (pFree == NULL)
+                pFree = &m_SELCoalesce[i];
+        }
+    }
+
+    if (pSlot != NULL)
+    {
+        pSlot->Suppressed++;
+        m_SELSuppressedTotal++;
+        pthread_mutex_unlock(&m_SELCoalesceLock);
+        return 0;
+    }
+
+    if (rate_limited)
+    {
+        pRate->Suppressed++;
+        pRate->SensorType = pRecord->SensorType;
+        pRate->EvtDirType = pRecord->EvtDirType;
+        pRate->EvtData1   = pRecord->EvtData1;
+        m_SELSuppressedTotal++;
+        pthread_mutex_unlock(&m_SELCoalesceLock);
+        return 0;
+    }
+
+    if (pFree == NULL)
+    {
+        /* Nothing left to track it with, let it through rather than lose it */
+        pthread_mutex_unlock(&m_SELCoalesceLock);
+        return SelectTbl;
+    }
+
+    pFree->Active     = 1;
+    pFree->Closed     = 0;
+    pFree->GenID[0]   = pRecord->GenID[0];
+    pFree->GenID[1]   = pRecord->GenID[1];
+    pFree->SensorType = pRecord->SensorType;
+    pFree->SensorNum  = pRecord->SensorNum;
+    pFree->EvtDirType = pRecord->EvtDirType;
+    pFree->EvtData[0] = pRecord->EvtData1;
+    pFree->EvtData[1] = pRecord->EvtData2;
+    pFree->EvtData[2] = pRecord->EvtData3;
+    pFree->FirstSec   = now;
+    pFree->Suppressed = 0;
+
+    pthread_mutex_unlock(&m_SELCoalesceLock);
+    return SelectTbl;
+}
+
+/**
+ * @fn OEMSELAddSummary
+ * @brief Logs an OEM timestamped record telling how many copies of an
+ *        event were suppressed. Layout after the Dell IANA: sensor number,
+ *        sensor type, event dir/type, event data 1, count (LSB first,
+ *        saturated at 0xFFFF).
+ */
+static void OEMSELAddSummary(const OEMSELCoalesce_T *pSlot, int BMCInst)
+{
+    MsgPkt_T MsgPkt;
+    INT32U count = (pSlot->Suppressed > 0xFFFF) ? 0xFFFF : pSlot->Suppressed;
+
+    memset(&MsgPkt, 0, sizeof(MsgPkt));
+    MsgPkt.NetFnLUN = NETFN_STORAGE << 2;
+    MsgPkt.Cmd      = CMD_ADD_SEL_ENTRY;
+    /* Record ID (0,1) and timestamp (3..6) are filled in by the SEL device */
+    MsgPkt.Data[2]  = OEM_SEL_SUMMARY_RECORD_TYPE;
+    MsgPkt.Data[7]  = OEM_SEL_DELL_IANA & 0xFF;
+    MsgPkt.Data[8]  = (OEM_SEL_DELL_IANA >> 8) & 0xFF;
+    MsgPkt.Data[9]  = (OEM_SEL_DELL_IANA >> 16) & 0xFF;
+    MsgPkt.Data[10] = pSlot->SensorNum;
+    MsgPkt.Data[11] = pSlot->SensorType;
+    MsgPkt.Data[12] = pSlot->EvtDirType;
+    MsgPkt.Data[13] = pSlot->EvtData[0];
+    MsgPkt.Data[14] = count & 0xFF;
+    MsgPkt.Data[15] = (count >> 8) & 0xFF;
+    MsgPkt.Size     = 16;
+
+    API_ExecuteCmd(&MsgPkt, BMCInst);
+    if (MsgPkt.Data[0] != CC_SUCCESS)
+    {
+        IPMI_WARNING("OEMSEL: summary for sensor 0x%02x not logged (cc 0x%02x)\n", pSlot->SensorNum, MsgPkt.Data[0]);
+    }
+}
+
+/**
+ * @fn OEM_SELCoalesceTick
+ * @brief Closes expired coalescing windows and logs a summary record for
+ *        each one that suppressed events. Called from PDK_TimerTask, away
+ *        from the SEL add path the summary goes through.
+ * @param[in] BMCInst BMC instance.
+ */
+void OEM_SELCoalesceTick(int BMCInst)
+{
+    OEMSELCoalesce_T expired [OEM_SEL_COALESCE_SLOTS + OEM_SEL_SENSOR_NUM_MAX];
+    OEMSELSensorRate_T *pRate;
+    time_t now = OEMSELNowSec();
+    int i, count = 0;
+
+    pthread_mutex_lock(&m_SELCoalesceLock);
+    for (i = 0; i < OEM_SEL_COALESCE_SLOTS; i++)
+    {
+        if (m_SELCoalesce[i].Active &&
+            (m_SELCoalesce[i].Closed || ((now - m_SELCoalesce[i].FirstSec) >= m_SELCoalesceWindowSec)))
+        {
+            if (m_SELCoalesce[i].Suppressed != 0)
+                expired[count++] = m_SELCoalesce[i];
+            m_SELCoalesce[i].Active = 0;
+        }
+    }
+
+    /* One summary per rate limited sensor, whatever the events were */
+    for (i = 0; i < OEM_SEL_SENSOR_NUM_MAX; i++)
+    {
+        pRate = &m_SELSensorRate[i];
+        if ((pRate->Suppressed != 0) && ((now - pRate->WindowStartSec) >= m_SELCoalesceWindowSec))
+        {
+            memset(&expired[count], 0, sizeof(OEMSELCoalesce_T));
+            expired[count].SensorNum  = i;
+            expired[count].SensorType = pRate->SensorType;
+            expired[count].EvtDirType = pRate->EvtDirType;
+            expired[count].EvtData[0] = pRate->EvtData1;
+            expired[count].Suppressed = pRate->Suppressed;
+            count++;
+            pRate->Suppressed = 0;
+            pRate->WindowStartSec = now;
+            pRate->Count = 0;
+        }
+    }
+    pthread_mutex_unlock(&m_SELCoalesceLock);
+
+    for (i = 0; i < count; i++)
+    {
+        OEMSELAddSummary(&expired[i], BMCInst);
+    }
+}
+
+/**
+ * @fn OEM_SELSetCoalesceWindow
+ * @brief Sets the coalescing and rate limit window.
+ * @param[in] WindowSec Window in seconds, 0 disables coalescing.
+ * @return 0 on success.
+ */
+int OEM_SELSetCoalesceWindow(INT16U WindowSec)
+{
+    pthread_mutex_lock(&m_SELCoalesceLock);
+    m_SELCoalesceWindowSec = WindowSec;
+    pthread_mutex_unlock(&m_SELCoalesceLock);
+    return 0;
+}
+
+/**
+ * @fn OEM_SELSetRateLimit
+ * @brief Sets how many events a sensor may log per window.
+ * @param[in] SensorNum Sensor number or OEM_SEL_SENSOR_ANY for all sensors.
+ * @param[in] MaxEvents Events per window, 0 for no limit.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_SELSetRateLimit(INT16U SensorNum, INT16U MaxEvents)
+{
+    int i;
+
+    if ((SensorNum != OEM_SEL_SENSOR_ANY) && (SensorNum >= OEM_SEL_SENSOR_NUM_MAX))
+        return -1;
+
+    pthread_mutex_lock(&m_SELCoalesceLock);
+    OEMSELRateLimitInitLocked();
+    for (i = 0; i < OEM_SEL_SENSOR_NUM_MAX; i++)
+    {
+        if ((SensorNum == OEM_SEL_SENSOR_ANY) || (SensorNum == i))
+            m_SELSensorRate[i].MaxEvents = MaxEvents;
+    }
+    pthread_mutex_unlock(&m_SELCoalesceLock);
+    return 0;
+}
+
+/**
+ * @fn OEM_SELLoadConfig
+ * @brief Applies the coalescing settings of a config file, one per line:
+ *            coalesce_window <seconds>
+ *            rate_limit <sensor number|any> <events per window>
+ *        Lines starting with '#' are comments. Later lines override
+ *        earlier ones, so "rate_limit any" goes first. Without the file
+ *        the built-in defaults stay.
+ * @param[in] pFileName Config file, normally OEM_SEL_CONFIG_FILE.
+ * @return 0 on success or if there is no file, -1 if a line was rejected.
+ */
+int OEM_SELLoadConfig(const char *pFileName)
+{
+    char line[128], name[32], sensor[16];
+    unsigned long value, num;
+    char *pEnd;
+    FILE *fp;
+    int lineno = 0, ret = 0, ok;
+
+    fp = fopen(pFileName, "r");
+    if (fp == NULL)
+        return 0;
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        lineno++;
+        if ((sscanf(line, "%31s", name) != 1) || (name[0] == '#'))
+            continue;
+
+        ok = 0;
+        if ((strcmp(name, "coalesce_window") == 0) &&
+            (sscanf(line, "%*s %lu", &value) == 1) && (value <= 0xFFFF))
+        {
+            ok = (OEM_SELSetCoalesceWindow((INT16U)value) == 0);
+        }
+        else if ((strcmp(name, "rate_limit") == 0) &&
+                 (sscanf(line, "%*s %15s %lu", sensor, &value) == 2) && (value <= 0xFFFF))
+        {
+            if (strcmp(sensor, "any") == 0)
+            {
+                num = OEM_SEL_SENSOR_ANY;
+            }
+            else
+            {
+                num = strtoul(sensor, &pEnd, 0);
+                if ((*pEnd != '\0') || (num >= OEM_SEL_SENSOR_NUM_MAX))
+                    num = OEM_SEL_SENSOR_NUM_MAX;
+            }
+            ok = (OEM_SELSetRateLimit((INT16U)num, (INT16U)value) == 0);
+        }
+
+        if (!ok)
+        {
+            IPMI_WARNING("OEMSEL: %s:%d ignored\n", pFileName, lineno);
+            ret = -1;
+        }
+    }
+
+    fclose(fp);
+    return ret;
+}
+
+/**
+ * @fn OEM_SELGetSuppressedCount
+ * @brief Returns the number of SEL events suppressed since the BMC started.
+ */
+INT32U OEM_SELGetSuppressedCount(void)
+{
+    return m_SELSuppressedTotal;
+}
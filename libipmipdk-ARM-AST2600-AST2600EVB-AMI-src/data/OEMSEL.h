@@ -0,0 +1,118 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMSEL.h
+*** Description: OEM SEL helpers: write-back journal in front of the SEL
+*** NVR file, an in-memory index for filtered SEL queries and event
+*** storm coalescing.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#ifndef OEM_SEL_H
+#define OEM_SEL_H
+
+#include "Types.h"
+
+#define OEM_SEL_JOURNAL_SIZE            4096    /* bytes of SEL data held in RAM */
+#define OEM_SEL_JOURNAL_HIGH_WATER      3072    /* flush as soon as this much is pending */
+#define OEM_SEL_JOURNAL_EXTENT_MAX      64
+#define OEM_SEL_JOURNAL_FLUSH_SEC       5       /* worst case data loss window, plus one timer tick */
+
+#define OEM_SEL_INDEX_MAX               4096    /* records kept in the index */
+#define OEM_SEL_QUERY_END               0xFFFF  /* cursor returned after the last page */
+#define OEM_SEL_QUERY_CMD_MAX_RECORDS   20      /* records per OEM SEL query response */
+
+#define OEM_SEL_COALESCE_SLOTS          64      /* distinct events tracked at once */
+#define OEM_SEL_COALESCE_WINDOW_SEC     60      /* default, 0 disables coalescing */
+#define OEM_SEL_RATE_LIMIT_DEFAULT      20      /* events per sensor per window, 0 = unlimited */
+#define OEM_SEL_SENSOR_ANY              0xFFFF
+#define OEM_SEL_SUMMARY_RECORD_TYPE     0xC0    /* OEM timestamped record carrying the count */
+#define OEM_SEL_CONFIG_FILE             "/conf/oemsel.conf"     /* coalescing settings, optional */
+
+typedef enum
+{
+    OEM_SEL_KEY_TIME = 0,       /* all records, by timestamp */
+    OEM_SEL_KEY_SENSOR_NUM,     /* system event records, by sensor number */
+    OEM_SEL_KEY_SENSOR_TYPE,    /* system event records, by sensor type (0x04 fan, ...) */
+    OEM_SEL_KEY_EVENT_TYPE,     /* system event records, by event/reading type code */
+    OEM_SEL_KEY_MAX
+} OEMSELKey_E;
+
+typedef struct
+{
+    INT32U  TimeStamp;
+    INT16U  RecID;
+    INT8U   RecType;
+    INT8U   SensorType;
+    INT8U   SensorNum;
+    INT8U   EvtDirType;         /* bit7 deassertion, bits 6:0 event/reading type */
+    INT8U   EvtData1;
+    INT8U   Reserved;
+} OEMSELIndexEntry_T;
+
+typedef struct
+{
+    INT8U   Key;                /* OEMSELKey_E */
+    INT8U   Value;              /* sensor number/type or event type, unused for OEM_SEL_KEY_TIME */
+    INT32U  StartTime;          /* inclusive */
+    INT32U  EndTime;            /* inclusive, 0xFFFFFFFF for no upper bound */
+} OEMSELQuery_T;
+
+/* OEM SEL query command, one page of OEM_SELQuery per request */
+typedef struct
+{
+    INT8U   Key;                /* OEMSELKey_E */
+    INT8U   Value;
+    INT32U  StartTime;
+    INT32U  EndTime;
+    INT16U  Cursor;             /* 0 for the first page, then NextCursor */
+    INT8U   MaxCount;           /* 0 or above OEM_SEL_QUERY_CMD_MAX_RECORDS for the maximum */
+} PACKED OEMSELQueryReq_T;
+
+typedef struct
+{
+    INT8U               CompletionCode;
+    INT16U              NextCursor; /* OEM_SEL_QUERY_END after the last page */
+    INT8U               Count;
+    OEMSELIndexEntry_T  Entry [OEM_SEL_QUERY_CMD_MAX_RECORDS];
+} PACKED OEMSELQueryRes_T;
+
+typedef struct
+{
+    INT32U  JournaledWrites;    /* PDKWriteSEL calls absorbed by the journal */
+    INT32U  JournaledBytes;
+    INT32U  WriteThrough;       /* writes too large for the journal */
+    INT32U  Flushes;
+    INT32U  FlushedExtents;     /* API_WriteNVR calls issued by flushes */
+    INT32U  FlushedBytes;
+    INT32U  FlushErrors;
+    INT32U  MaxPendingBytes;
+} OEMSELJournalStats_T;
+
+extern int  OEM_SELJournalWrite(INT8U *pData, INT32U Offset, INT32U Size, int BMCInst);
+extern int  OEM_SELJournalFlush(void);
+extern void OEM_SELJournalTick(void);
+extern int  OEM_SELJournalGetStats(OEMSELJournalStats_T *pStats);
+
+extern INT8U OEM_SELCoalesce(INT8U *pSELEntry, INT8U SelectTbl);
+extern void OEM_SELCoalesceTick(int BMCInst);
+extern int  OEM_SELSetCoalesceWindow(INT16U WindowSec);
+extern int  OEM_SELSetRateLimit(INT16U SensorNum, INT16U MaxEvents);
+extern int  OEM_SELLoadConfig(const char *pFileName);
+extern INT32U OEM_SELGetSuppressedCount(void);
+
+extern int  OEM_SELIndexBuild(INT8U *pRepository, INT32U Size);
+extern void OEM_SELIndexAdd(INT8U *pSELEntry);
+extern void OEM_SELIndexWrite(INT8U *pData, INT32U Offset, INT32U Size);
+extern void OEM_SELIndexClear(void);
+extern int  OEM_SELQuery(const OEMSELQuery_T *pQuery, INT16U Cursor, OEMSELIndexEntry_T *pEntries,
+                         int MaxCount, INT16U *pNextCursor);
+extern int  OEM_SELQueryCmd(INT8U *pReq, INT8U ReqLen, INT8U *pRes, int BMCInst);
+
+#endif /* OEM_SEL_H */
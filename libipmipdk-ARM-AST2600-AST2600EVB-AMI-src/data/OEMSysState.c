@@ -0,0 +1,206 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMSysState.c
+*** Description: System state bitmap. Each state GPIO interrupts on both
+*** edges; the interrupt handler reads the pin and updates its bit, so
+*** PDK_GetSystemState and PDK_GetPSGood are plain memory reads.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#include <string.h>
+
+#include "Types.h"
+#include "Debug.h"
+#include "hal_hw.h"
+#include "gpioifc.h"
+#include "PDKHooks.h"
+#include "OEMIntr.h"
+#include "OEMSysState.h"
+
+typedef struct
+{
+    INT16U  Pin;
+    INT32U  Bit;
+    INT8U   ActiveLow;
+} OEMSysStatePin_T;
+
+/* Front panel buttons are not routed to BMC GPIOs on this board */
+static const OEMSysStatePin_T m_SysStatePin [] =
+{
+    { GPIO_PS_PWROK, OEM_SYS_STATE_PS_PWRGD, 0 },
+};
+
+#define OEM_SYS_STATE_PIN_COUNT     (sizeof(m_SysStatePin) / sizeof(m_SysStatePin[0]))
+
+static INT32U   m_SysState = 0;
+static int      m_SysStateValid = 0;
+static INT32U   m_SysStateReported = 0;     /* dispatch thread only */
+static int      m_SysStateBMCInst = 0;
+
+static int OEMSysStateReadPin(INT16U Pin)
+{
+    u8 val = 0;
+    hal_t hal;
+
+    hal.func = HAL_DEVICE_READ;
+    hal.pread_buf = &val;
+    hal.gpio.pin = Pin;
+    gpio_read(&hal);
+    return val ? 1 : 0;
+}
+
+/**
+ * @fn OEMSysStateUpdatePin
+ * @brief Reads one state pin and sets or clears its bit.
+ * @return Pin level.
+ */
+static int OEMSysStateUpdatePin(const OEMSysStatePin_T *pPin)
+{
+    int level = OEMSysStateReadPin(pPin->Pin);
+
+    if (level != pPin->ActiveLow)
+        __atomic_fetch_or(&m_SysState, pPin->Bit, __ATOMIC_RELEASE);
+    else
+        __atomic_fetch_and(&m_SysState, ~pPin->Bit, __ATOMIC_RELEASE);
+    return level;
+}
+
+/**
+ * @fn OEMSysStateNotify
+ * @brief Dispatch thread side of a state edge: reports the new bitmap to
+ *        PDK_OnSystemEventDetected, once per change.
+ */
+static void OEMSysStateNotify(const OEMIntrEvent_T *pEvent, void *pCtx)
+{
+    INT32U state = OEM_SysStateGet();
+
+    (void)pEvent;
+    (void)pCtx;
+
+    if (state == m_SysStateReported)
+        return;
+
+    m_SysStateReported = state;
+    PDK_OnSystemEventDetected(state, m_SysStateBMCInst);
+}
+
+/**
+ * @fn OEM_SysStateInit
+ * @brief Reads every state pin once and subscribes to their edges. The
+ *        state lines are not coalesced, every edge is delivered. The
+ *        bitmap is not valid until OEM_SysStateSetValid, once the pin
+ *        interrupts are registered too.
+ * @param[in] BMCInst BMC instance reported to PDK_OnSystemEventDetected.
+ * @return 0 on success, -1 on failure.
+ */
+int OEM_SysStateInit(int BMCInst)
+{
+    unsigned int i;
+    int ret = 0;
+
+    __atomic_store_n(&m_SysStateValid, 0, __ATOMIC_RELEASE);
+
+    m_SysStateBMCInst = BMCInst;
+    for (i = 0; i < OEM_SYS_STATE_PIN_COUNT; i++)
+    {
+        OEMSysStateUpdatePin(&m_SysStatePin[i]);
+        OEM_IntrSetCoalesceWindow(m_SysStatePin[i].Pin, 0);
+        if (OEM_IntrSubscribe(m_SysStatePin[i].Pin, OEMSysStateNotify, NULL) != 0)
+            ret = -1;
+    }
+    m_SysStateReported = OEM_SysStateGet();
+    return ret;
+}
+
+/**
+ * @fn OEM_SysStateSetValid
+ * @brief Marks the bitmap as kept by interrupts, or not. Set only when the
+ *        edges are subscribed and the pin interrupts registered; until
+ *        then, and after any failure, callers poll the pins.
+ * @param[in] Valid 1 if every edge reaches OEM_SysStateEdge, 0 otherwise.
+ */
+void OEM_SysStateSetValid(int Valid)
+{
+    unsigned int i;
+
+    if (Valid)
+    {
+        /* Edges before the registration were not seen */
+        for (i = 0; i < OEM_SYS_STATE_PIN_COUNT; i++)
+        {
+            OEMSysStateUpdatePin(&m_SysStatePin[i]);
+        }
+    }
+    __atomic_store_n(&m_SysStateValid, Valid ? 1 : 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @fn OEM_SysStateEdge
+ * @brief Called by the interrupt handler of a state pin. Updates the bit
+ *        right away and queues the edge for PDK_OnSystemEventDetected.
+ * @param[in] Pin GPIO that interrupted.
+ */
+void OEM_SysStateEdge(INT16U Pin)
+{
+    unsigned int i;
+
+    for (i = 0; i < OEM_SYS_STATE_PIN_COUNT; i++)
+    {
+        if (m_SysStatePin[i].Pin == Pin)
+        {
+            OEM_IntrRecord(Pin, OEM_INTR_SRC_GPIO, (INT8U)OEMSysStateUpdatePin(&m_SysStatePin[i]));
+            return;
+        }
+    }
+}
+
+/**
+ * @fn OEM_SysStateIsValid
+ * @return 1 once the bitmap is maintained by interrupts, 0 before.
+ */
+int OEM_SysStateIsValid(void)
+{
+    return __atomic_load_n(&m_SysStateValid, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @fn OEM_SysStateGet
+ * @return Current system state bitmap.
+ */
+INT32U OEM_SysStateGet(void)
+{
+    return __atomic_load_n(&m_SysState, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @fn OEM_SysStateResync
+ * @brief Re-reads the state pins in case an edge was lost. Called from the
+ *        timer task, which cannot post to the interrupt ring; the core's own
+ *        PDK_GetSystemState polling reports a corrected bit.
+ */
+void OEM_SysStateResync(void)
+{
+    INT32U before;
+    unsigned int i;
+
+    if (!OEM_SysStateIsValid())
+        return;
+
+    before = OEM_SysStateGet();
+    for (i = 0; i < OEM_SYS_STATE_PIN_COUNT; i++)
+    {
+        OEMSysStateUpdatePin(&m_SysStatePin[i]);
+    }
+
+    if (OEM_SysStateGet() != before)
+    {
+        IPMI_WARNING("OEMSysState: missed edge, state 0x%lx -> 0x%lx\n", (unsigned long)before, (unsigned long)OEM_SysStateGet());
+    }
+}
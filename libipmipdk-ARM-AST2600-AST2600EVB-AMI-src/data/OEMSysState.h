@@ -0,0 +1,37 @@
+/**************************************************************************
+***************************************************************************
+*** **
+*** (c)Copyright 2025 Dell Inc.
+*** **
+*** All Rights Reserved.
+*** **
+*** **
+*** File Name: OEMSysState.h
+*** Description: System state bitmap kept up to date by GPIO edge
+*** interrupts, see PDK_GetSystemState.
+*** **
+***************************************************************************
+***************************************************************************
+**************************************************************************/
+#ifndef OEM_SYS_STATE_H
+#define OEM_SYS_STATE_H
+
+#include "Types.h"
+
+#define GPIO_PS_PWROK 172         //GPIOV4
+
+/* Bits of the PDK_GetSystemState bitmap */
+#define OEM_SYS_STATE_PS_PWRGD          (1 << 0)
+#define OEM_SYS_STATE_FP_PWR_BTN        (1 << 1)
+#define OEM_SYS_STATE_FP_RST_BTN        (1 << 2)
+#define OEM_SYS_STATE_FP_NMI_BTN        (1 << 3)
+#define OEM_SYS_STATE_FP_SLEEP_BTN      (1 << 4)
+
+extern int    OEM_SysStateInit(int BMCInst);
+extern void   OEM_SysStateSetValid(int Valid);
+extern void   OEM_SysStateEdge(INT16U Pin);
+extern int    OEM_SysStateIsValid(void);
+extern INT32U OEM_SysStateGet(void);
+extern void   OEM_SysStateResync(void);
+
+#endif /* OEM_SYS_STATE_H */
@@ -37,10 +37,9 @@
 #include <PDKAccess.h>
 #include <dlfcn.h>
 #include <Ethaddr.h>
+#include "OEMAlert.h"
+#include "OEMDLCache.h"
 
-#define PRIMARY_SERVER "GetSMTP_PrimaryServer"
-#define SECONDARY_SERVER "GetSMTP_SecondaryServer"
-#define  MSGHNDLR_LIB "/usr/local/lib/libipmimsghndlr.so"
 
 int Get_SMTPSever(SMTP_STRUCT *pmail, INT8U SetSelector, INT8U EthIndex,int i, int BMCInst );
 void FillFormat(void* pEventRecord,SMTP_STRUCT *pmail,char *useremailformat,int BMCInst);
@@ -51,8 +50,9 @@ PDK_Alert ( void* pEventRecord,  int SetSelector ,INT8U  EthIndex, int BMCInst)
 
 /* We are setting the set selector as  zero based in libipmi it self  and No need to do it  again */
 
-   /* Send a email As the Oem Alert  Action */
-    return PDK_FrameAndSendMail (pEventRecord, SetSelector,EthIndex , BMCInst);
+   /* Send a email As the Oem Alert  Action. Only queued here, the SMTP
+      session runs on the alert worker so PEF is not held up by the network */
+    return OEM_AlertEnqueue (pEventRecord, SetSelector, EthIndex, BMCInst);
    /* Other   Oem Alerts go here */
 }
 
@@ -146,39 +146,18 @@ PDK_FrameAndSendMail ( void* pEventRecord, INT8U SetSelector, INT8U EthIndex, in
 
 int Get_SMTPSever(SMTP_STRUCT *pmail, INT8U SetSelector, INT8U EthIndex,int i, int BMCInst )
 {
-    void *dl_handle;
     int (*getsmtpmail) (SMTP_STRUCT *pmail, INT8U SetSelector, INT8U EthIndex, int BMCInst );
-    dl_handle = dlopen((char *)MSGHNDLR_LIB,RTLD_NOW);
-    int ret;
-    getsmtpmail  = NULL;
-    if(!dl_handle)
-    {
-        IPMI_ERROR("Error in loading IPMI library %s\n",dlerror());
-        return -1;
-    }
 
 	if(i==0)
-	{
-		getsmtpmail=dlsym(dl_handle, PRIMARY_SERVER);
-		if(getsmtpmail  == NULL)
-		{
-			dlclose(dl_handle);   
-			return -1;
-		}
-	}
+		getsmtpmail = OEM_DLCacheGet(OEM_DL_SYM_SMTP_PRIMARY);
 	else
+		getsmtpmail = OEM_DLCacheGet(OEM_DL_SYM_SMTP_SECONDARY);
+
+	if(getsmtpmail == NULL)
 	{
-		getsmtpmail=dlsym(dl_handle, SECONDARY_SERVER);
-		if(getsmtpmail  == NULL)
-		{
-			dlclose(dl_handle);   
-			return -1;
-		}
+		return -1;
 	}
-	ret=getsmtpmail(pmail,SetSelector,EthIndex,BMCInst);
-
-	dlclose(dl_handle);
-	return ret;
+	return getsmtpmail(pmail,SetSelector,EthIndex,BMCInst);
 }
 
 
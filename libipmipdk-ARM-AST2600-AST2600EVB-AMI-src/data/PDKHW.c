@@ -49,11 +49,13 @@
 
 #include "OEMPLD.h"
 #include "OEMSysInfo.h"
+#include "OEMDLCache.h"
+#include "OEMChassis.h"
+#include "OEMSysState.h"
 
 #define GPIO_BMC_RSTBTN_OUT_N 175  //GPIOV7
 #define GPIO_BMC_PWBTN_OUT_N 174  //GPIOV6
 #define GPIO_SLP_S3_N 173         //GPIOV5
-#define GPIO_PS_PWROK 172         //GPIOV4
 
 #define IO1	1
 #define IO2 2
@@ -66,7 +68,6 @@
 #define SET_MUX_TO_SYS_MASK	0xFE
 #define SET_MUX_TO_BMC_MASK	0x1
 
-#define LIBTELCOHELPER_LIB_PATH		"/usr/local/lib/libtelcohelper.so"
 /**
  * @def Parameters to controle the Chassis actions
  *
@@ -102,16 +103,11 @@ int g_UIDStatus=0;
 void telco_chassis_alert(int BMCInst, INT8U Action, INT8U result)
 {
     char *(*chassis_command_helper)() = NULL;
-	void *telco_helper = NULL;
-	telco_helper = dlopen(LIBTELCOHELPER_LIB_PATH, RTLD_NOW | RTLD_NODELETE | RTLD_GLOBAL);
-	if(telco_helper != NULL)
+
+	chassis_command_helper = OEM_DLCacheGet(OEM_DL_SYM_TELCO_CHASSIS_HELPER);
+	if(chassis_command_helper)
 	{
-		chassis_command_helper = dlsym(telco_helper,"TelcoChassisHelper");
-		if(chassis_command_helper)
-		{
-			chassis_command_helper(Action,result,BMCInst,TYPE_CHASSIS);
-		}
-		dlclose(telco_helper);
+		chassis_command_helper(Action,result,BMCInst,TYPE_CHASSIS);
 	}
 }
 /*----------------------------------------------------------------------------
@@ -213,6 +209,7 @@ PDK_WarmResetBMC (int BMCInst)
     return 0;
 }
 
+int PDK_GetPSGood (int BMCInst);
 
 /*------------------------------------------------------------------
  * @fn PDK_GetSystemState
@@ -242,6 +239,8 @@ PDK_WarmResetBMC (int BMCInst)
  *          BIT 24 - 31     For OEM State
  *------------------------------------------------------------------*/
 // GetSystemState and HP LP Signals - refer PDKHooks.
+// The bitmap is kept by the GPIO edge interrupts, see OEMSysState; if they
+// could not be registered PS_PWROK is read on every call.
 INT32U
 PDK_GetSystemState (int BMCInst)
 {
@@ -249,7 +248,11 @@ PDK_GetSystemState (int BMCInst)
     {
         BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
     }
-    return 0;
+    if(!OEM_SysStateIsValid())
+    {
+        return PDK_GetPSGood(BMCInst) ? OEM_SYS_STATE_PS_PWRGD : 0;
+    }
+    return OEM_SysStateGet();
 }
 
 /*---------------------------------------------------------------------
@@ -281,14 +284,27 @@ PDK_GetSystemState (int BMCInst)
  * @return  0x00	Success
  *			0xff	Failure
  *-----------------------------------------------------------------------*/
+static INT32U m_LastSystemState = 0;
+
 int
 PDK_OnSystemEventDetected (INT32U State, int BMCInst)
 {
+    INT32U Changed;
+
     if(0)
     {
         BMCInst=BMCInst;  /*  -Wextra, fix for unused parameters  */
-	State=State;
     }
+
+    /* Reported from the state edges and from the core's polling of
+       PDK_GetSystemState, act on each change only once */
+    Changed = State ^ __atomic_exchange_n(&m_LastSystemState, State, __ATOMIC_ACQ_REL);
+    if (Changed == 0)
+    {
+        return 0;
+    }
+
+    TDBG("System state 0x%lx, changed 0x%lx\n", (unsigned long)State, (unsigned long)Changed);
     return 0;
 }
 
@@ -312,29 +328,6 @@ bool PDK_IsACPowerOn(int BMCInst)
 	return FALSE;
 }
 
-static void ChassisPowerControl(INT8U gpio_pin, INT8U delay)
-{
-    u8 val = 0;
-    hal_t hal;
-
-    hal.func = HAL_SET_GPIO_DIR;
-    hal.pwrite_buf = &val;
-    val = 1;    // Set Power Button Pin direction as Output.
-    hal.gpio.pin = gpio_pin;
-    gpio_write(&hal);
-
-    val = 0;
-    hal.func = HAL_DEVICE_WRITE;
-    gpio_write(&hal);
-
-    sleep(delay);
-
-    val = 1;
-    hal.func = HAL_DEVICE_WRITE;
-    gpio_write(&hal);
-
-}
-
 #ifdef CONFIG_SPX_FEATURE_GPGPU_SUPPORT
 //Updating GPGPU Host status 
 int UpdateGPGPUHostStatus(int status)
@@ -365,56 +358,21 @@ int UpdateGPGPUHostStatus(int status)
 }
 #endif
 
-/*---------------------------------------------------------------------------
- * @fn PDK_PowerOnChassis
- *
- * @brief This function is invoked to power on the chassis. The default
- * implementation links to the soft processor code (PMCP). You can override
- * with your own C code implementation.
- *
- *---------------------------------------------------------------------------*/
-int 
-PDK_PowerOnChassis (int BMCInst)
+static int ChassisTelcoAlertEnabled(void)
 {
-	/** AMI DC and AC cycle stress test begin **/	
-	u8 val;
-	hal_t hal;
-    
-	hal.func = HAL_SET_GPIO_DIR;
-	hal.pwrite_buf = &val;
-    val = 1;
-	hal.gpio.pin = GPIO_BMC_PWBTN_OUT_N;
-	gpio_write(&hal);
-	
-    val = 0;
-	hal.func = HAL_DEVICE_WRITE;
-	gpio_write(&hal);
-	sleep(1);
-	val = 1;	
-	gpio_write(&hal);
-	/** test end**/
-
-    if((PDK_GetPSGood(BMCInst)) == 0)
-    {
-        if(IsFeatureEnabled("CONFIG_SPX_FEATURE_TELCO_RSYSLOG_SUPPORT") == 1 || IsFeatureEnabled("CONFIG_SPX_FEATURE_SNMPTRAP_SUPPORT")== 1)
-        {
-            telco_chassis_alert(BMCInst,CHASSIS_POWER_ON,CMD_FAIL);
-        }
-    }
-    else
-    {    
-        if(IsFeatureEnabled("CONFIG_SPX_FEATURE_TELCO_RSYSLOG_SUPPORT") == 1 || IsFeatureEnabled("CONFIG_SPX_FEATURE_SNMPTRAP_SUPPORT")== 1)
-        {
-            telco_chassis_alert(BMCInst,CHASSIS_POWER_ON,CMD_PASS);
-        }
-    }
+    return (IsFeatureEnabled("CONFIG_SPX_FEATURE_TELCO_RSYSLOG_SUPPORT") == 1 || IsFeatureEnabled("CONFIG_SPX_FEATURE_SNMPTRAP_SUPPORT")== 1);
+}
 
-	printf("POWER ON CHASSIS\n");
+/*-----------------------------------------------------------------
+ * @fn ChassisPowerStateChanged
+ * @brief Tells the GPGPU component and SSI about a host power change
+ *-----------------------------------------------------------------*/
+static void ChassisPowerStateChanged(int PowerOn, int BMCInst)
+{
 #ifdef CONFIG_SPX_FEATURE_GPGPU_SUPPORT
-    int status=1;
-    if( UpdateGPGPUHostStatus(status)==0)
+    if(UpdateGPGPUHostStatus(PowerOn)==0)
     {
-	    TDBG("Updated GPGPUHostStatus host sucessfully\n");
+	    TDBG("Updated GPGPUHostStatus sucessfully\n");
     }
 #endif
 
@@ -423,218 +381,139 @@ PDK_PowerOnChassis (int BMCInst)
         /* Do queue Operational State condition. */
         if (g_SSIHandle[SSICB_QUEUECOND] != NULL)
         {
-           ((STATUS(*)(INT8U, INT8U, INT8U, int))g_SSIHandle[SSICB_QUEUECOND]) (DEFAULT_FRU_DEV_ID, COND_POWER_ON, 1, BMCInst);
+           ((STATUS(*)(INT8U, INT8U, INT8U, int))g_SSIHandle[SSICB_QUEUECOND]) (DEFAULT_FRU_DEV_ID, COND_POWER_ON, PowerOn, BMCInst);
         }
 
         LOCK_BMC_SHARED_MEM(BMCInst);
         BMC_GET_SHARED_MEM(BMCInst)->PowerActionInProgress = FALSE;
         UNLOCK_BMC_SHARED_MEM(BMCInst);
     }
-    if(0)
-    {
-        BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
-    }
-    return 0;
 }
 
-
-/*---------------------------------------------------------------------------
- * @fn PDK_PowerOffChassis
- *
- * @brief This function is invoked to power off the chassis. The default
- * implementation links to the soft processor code (PMCP). You can override
- * with your own C code implementation.
- *---------------------------------------------------------------------------*/
-int
-PDK_PowerOffChassis (int BMCInst)
+/*-----------------------------------------------------------------
+ * @fn ChassisActionDone
+ * @brief Completion of a chassis action, called on the OEMChassis
+ * thread once the button sequence has finished.
+ *-----------------------------------------------------------------*/
+static void ChassisActionDone(INT8U Action, INT8U Result, int BMCInst)
 {
-	/** AMI DC and AC cycle stress test begin **/	
-    u8 retry = 0, ChassisOFFFlag = 0, delay = 5;
+    INT8U TelcoResult = (Result == OEM_CHASSIS_RESULT_PASS) ? CMD_PASS : CMD_FAIL;
 
-    while((PDK_GetPSGood(BMCInst))==1)
+    switch(Action)
     {
-        if ((retry < 3) && ((PDK_GetPSGood(BMCInst)) != 0))
-        {
-            ChassisPowerControl(GPIO_BMC_PWBTN_OUT_N, delay);
-            sleep(2);
-        }
-        else
-        {
-            if(delay <= 8)
+        case OEM_CHASSIS_ACT_POWER_ON:
+            if(ChassisTelcoAlertEnabled())
             {
-                delay++;
-                ChassisPowerControl(GPIO_BMC_PWBTN_OUT_N, delay);
-                sleep(2);
+                telco_chassis_alert(BMCInst,CHASSIS_POWER_ON,TelcoResult);
             }
-            else
+            printf("POWER ON CHASSIS\n");
+            ChassisPowerStateChanged(1, BMCInst);
+            break;
+
+        case OEM_CHASSIS_ACT_POWER_OFF:
+        case OEM_CHASSIS_ACT_SOFT_OFF:
+            if(ChassisTelcoAlertEnabled())
             {
-                break;
+                telco_chassis_alert(BMCInst,CHASSIS_POWER_OFF,TelcoResult);
             }
-        }
-        if((PDK_GetPSGood(BMCInst)) == 0)
-        {
-            ChassisOFFFlag = 1;
+            printf("POWER OFF CHASSIS\n");
+            ChassisPowerStateChanged(0, BMCInst);
             break;
-        }
-        retry++;
-    }
-	/** test end**/
 
-    if((retry > 5) && (!ChassisOFFFlag))
-    {
-        if(IsFeatureEnabled("CONFIG_SPX_FEATURE_TELCO_RSYSLOG_SUPPORT") == 1|| IsFeatureEnabled("CONFIG_SPX_FEATURE_SNMPTRAP_SUPPORT")== 1)
-        {
-            telco_chassis_alert(BMCInst,CHASSIS_POWER_OFF,CMD_FAIL);
-        }
-    }
-    else
-    {
-        if(IsFeatureEnabled("CONFIG_SPX_FEATURE_TELCO_RSYSLOG_SUPPORT") == 1|| IsFeatureEnabled("CONFIG_SPX_FEATURE_SNMPTRAP_SUPPORT")== 1)
-        {
-            telco_chassis_alert(BMCInst,CHASSIS_POWER_OFF,CMD_PASS);
-        }
-    }
-
-	printf("POWER OFF CHASSIS\n");
-#ifdef CONFIG_SPX_FEATURE_GPGPU_SUPPORT
-    int status=0;
-    if(UpdateGPGPUHostStatus(status)==0)
-    {
-	    TDBG("update GPGPUHostStatus sucessfully\n");
-    }
-#endif
-    if(g_corefeatures.ssi_support == ENABLED)
-    {
-        /* Do queue Operational State condition. */
-        if (g_SSIHandle[SSICB_QUEUECOND] != NULL)
-        {
-            ((STATUS(*)(INT8U, INT8U, INT8U, int))g_SSIHandle[SSICB_QUEUECOND]) (DEFAULT_FRU_DEV_ID, COND_POWER_ON, 0, BMCInst);
-        }
+        case OEM_CHASSIS_ACT_RESET:
+            if(ChassisTelcoAlertEnabled())
+            {
+                telco_chassis_alert(BMCInst,CHASSIS_POWER_RESET,CMD_PASS);
+            }
+            printf("RESET CHASSIS\n");
+            break;
 
-        LOCK_BMC_SHARED_MEM(BMCInst);
-        BMC_GET_SHARED_MEM(BMCInst)->PowerActionInProgress = FALSE;
-        UNLOCK_BMC_SHARED_MEM(BMCInst);
-    }
+        case OEM_CHASSIS_ACT_POWER_CYCLE:
+            if(ChassisTelcoAlertEnabled())
+            {
+                telco_chassis_alert(BMCInst,CHASSIS_POWER_CYCLE,CMD_PASS);
+            }
+            break;
 
-    if(0)
-    {
-        BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
+        default:
+            break;
     }
-    return 0;
 }
 
-
-void
-PDK_SoftOffChassis (int BMCInst)
+static const OEMChassisPlatform_T m_ChassisPlatform =
 {
-    u8 val;
-    hal_t hal;
-
-    //  Below code is to power off
-    val = 0;
-    hal.func = HAL_DEVICE_WRITE;
-    hal.pwrite_buf = &val;
-    hal.gpio.pin = GPIO_BMC_PWBTN_OUT_N;
-    gpio_write(&hal);
-    sleep(5);
-    val = 1;
-    gpio_write(&hal);
+    GPIO_BMC_PWBTN_OUT_N,
+    GPIO_BMC_RSTBTN_OUT_N,
+    PDK_GetPSGood,
+    ChassisActionDone,
+};
 
-    printf("SOFT POWER OFF CHASSIS\n");
+/*---------------------------------------------------------------------------
+ * @fn PDK_PowerOnChassis
+ *
+ * @brief This function is invoked to power on the chassis. The button
+ * press is sequenced by OEMChassis, this returns once it has started and
+ * ChassisActionDone reports the result.
+ *
+ * @return  0  if the power on was started
+ *          -1 if another chassis action is in progress
+ *---------------------------------------------------------------------------*/
+int 
+PDK_PowerOnChassis (int BMCInst)
+{
+    return OEM_ChassisStart(&m_ChassisPlatform, OEM_CHASSIS_ACT_POWER_ON, 0, BMCInst);
+}
 
-    if((PDK_GetPSGood(BMCInst)) != 0)
-    {
-        if(IsFeatureEnabled("CONFIG_SPX_FEATURE_TELCO_RSYSLOG_SUPPORT") == 1|| IsFeatureEnabled("CONFIG_SPX_FEATURE_SNMPTRAP_SUPPORT")== 1)
-        {
-            telco_chassis_alert(BMCInst,CHASSIS_POWER_OFF,CMD_FAIL);
-        }
-    }
-    else
-    {
-        if(IsFeatureEnabled("CONFIG_SPX_FEATURE_TELCO_RSYSLOG_SUPPORT") == 1|| IsFeatureEnabled("CONFIG_SPX_FEATURE_SNMPTRAP_SUPPORT")== 1)
-        {
-            telco_chassis_alert(BMCInst,CHASSIS_POWER_OFF,CMD_PASS);
-        }
-    }
 
-	printf("POWER OFF CHASSIS\n");
-#ifdef CONFIG_SPX_FEATURE_GPGPU_SUPPORT
-    int status=0;
-    if(UpdateGPGPUHostStatus(status)==0)
-    {
-        TDBG("Update GPGPUHostStatus sucessfully\n");
-    }
-#endif	
-    if(g_corefeatures.ssi_support == ENABLED)
-    {
-        /* Do queue Operational State condition. */
-        if (g_SSIHandle[SSICB_QUEUECOND] != NULL)
-        {
-           ((STATUS(*)(INT8U, INT8U, INT8U, int))g_SSIHandle[SSICB_QUEUECOND]) (DEFAULT_FRU_DEV_ID, COND_POWER_ON, 0, BMCInst);
-        }
+/*---------------------------------------------------------------------------
+ * @fn PDK_PowerOffChassis
+ *
+ * @brief This function is invoked to power off the chassis. The power
+ * button is held and retried with longer presses until PS_GOOD drops,
+ * see OEMChassis.
+ *
+ * @return  0  if the power off was started
+ *          -1 if another chassis action is in progress
+ *---------------------------------------------------------------------------*/
+int
+PDK_PowerOffChassis (int BMCInst)
+{
+    return OEM_ChassisStart(&m_ChassisPlatform, OEM_CHASSIS_ACT_POWER_OFF, 0, BMCInst);
+}
 
-        LOCK_BMC_SHARED_MEM(BMCInst);
-        BMC_GET_SHARED_MEM(BMCInst)->PowerActionInProgress = FALSE;
-        UNLOCK_BMC_SHARED_MEM(BMCInst);
-   }
 
+void
+PDK_SoftOffChassis (int BMCInst)
+{
+    printf("SOFT POWER OFF CHASSIS\n");
+    OEM_ChassisStart(&m_ChassisPlatform, OEM_CHASSIS_ACT_SOFT_OFF, 0, BMCInst);
     return;
 }
 /*--------------------------------------------------------------------
  * @fn PDK_PowerCycleChassis
- * @brief Power Cycle the chassis.
+ * @brief Power Cycle the chassis. Powers off, waits for PS_GOOD to drop
+ * and powers back on, all on the OEMChassis thread.
  * return 	0  Success
  *			-1 if Error
  *--------------------------------------------------------------------*/
 int
 PDK_PowerCycleChassis (int BMCInst)
 {
-	int ret = 0;
-    int retries = 3;
     BMCInfo_t *pBMCInfo = &g_BMCInfo[BMCInst];
     printf("POWER CYCLE CHASSIS\n");
 
    	IPMI_DBG_PRINT ("Power Cycle Chassis\n");
 
-    if(IsFeatureEnabled("CONFIG_SPX_FEATURE_TELCO_RSYSLOG_SUPPORT") == 1 || IsFeatureEnabled("CONFIG_SPX_FEATURE_SNMPTRAP_SUPPORT")== 1)
+    if (OEM_ChassisStart(&m_ChassisPlatform, OEM_CHASSIS_ACT_POWER_CYCLE, pBMCInfo->ChassisConfig.PowerCycleInterval, BMCInst) != 0)
     {
-        telco_chassis_alert(BMCInst,CHASSIS_POWER_CYCLE,CMD_WAIT);
+        return -1;
     }
-    /* Try to power down the host. We continue whether or not it succeeds */
-    /* in case the failure actually ends with the system off or otherwise */
-    /* stuck.                                                             */
-    PDK_PowerOffChassis(BMCInst);
-
-    /* This is for AMI automation Test only. If needed, please remove     */ 
-    /*  those and implement for OEM/ODM platform porting.                 */
-    retries = 50;
-    do
-    {
-        ret = PDK_GetPSGood(BMCInst);
-        if( ret == 1 )
-        {
-            /* Wait for some time */
-            sleep((int)(pBMCInfo->ChassisConfig.PowerCycleInterval));
-        }
-    } while ((ret == 1) && (retries-- > 0));
-
 
-    retries = 3;
-    /* Try to power up the host.  Try several times if necessary to make */
-    /* sure the host comes back up.                                      */
-    do
+    if(ChassisTelcoAlertEnabled())
     {
-        ret = PDK_PowerOnChassis(BMCInst);
-        if( ret < 0 )
-            sleep(1);
-    } while((ret < 0) && (retries-- > 0));
-
-    if(IsFeatureEnabled("CONFIG_SPX_FEATURE_TELCO_RSYSLOG_SUPPORT") == 1 || IsFeatureEnabled("CONFIG_SPX_FEATURE_SNMPTRAP_SUPPORT")== 1)
-    {
-        telco_chassis_alert(BMCInst,CHASSIS_POWER_CYCLE,CMD_PASS);
+        telco_chassis_alert(BMCInst,CHASSIS_POWER_CYCLE,CMD_WAIT);
     }
-    return ret;
-
+    return 0;
 }
 
 /*--------------------------------------------------------------------
@@ -646,20 +525,7 @@ PDK_PowerCycleChassis (int BMCInst)
 int
 PDK_ResetChassis (int BMCInst)
 {
-    //u8 val;
-    u8 delay = 1;
-    //hal_t hal;
-
-    UN_USED(BMCInst);  /*  -Wextra, fix for unused parameter  */
-   
-    ChassisPowerControl(GPIO_BMC_RSTBTN_OUT_N, delay);
-
-    if(IsFeatureEnabled("CONFIG_SPX_FEATURE_TELCO_RSYSLOG_SUPPORT") == 1 || IsFeatureEnabled("CONFIG_SPX_FEATURE_SNMPTRAP_SUPPORT")== 1)
-    {
-        telco_chassis_alert(BMCInst,CHASSIS_POWER_RESET,CMD_PASS);
-    }
-    printf("RESET CHASSIS\n");
-    return 0;
+    return OEM_ChassisStart(&m_ChassisPlatform, OEM_CHASSIS_ACT_RESET, 0, BMCInst);
 }
 
 /*--------------------------------------------------------------------
@@ -705,25 +571,15 @@ PDK_SMIInterruptChassis (int BMCInst)
 void
 PDK_ChassisIdentify (INT8U Force, INT8U Timeout, int BMCInst)
 {
-	 void *dl_handle = NULL;
 	  INT8U (*dl_func)(INT8U,INT16U,INT16U,int);
     	  if(0)
     	  {
               Force=Force;  /*  -Wextra, fix for unused parameter  */
     	  }
 
-	  dl_handle = NULL;
-	  dl_handle = dlopen("/usr/local/lib/libipmistack.so", RTLD_LAZY);
-	  if(NULL == dl_handle)
-	  {
-	    IPMI_ERROR("Error in loading libipmistack library %s\n",dlerror());
-	    return;
-	  }
-	  dl_func =  dlsym(dl_handle,"GlowLED");
+	  dl_func = OEM_DLCacheGet(OEM_DL_SYM_GLOW_LED);
 	  if(NULL == dl_func)
 	  {
-	    IPMI_ERROR("Error in getting symbol %s \n", dlerror());
-	    dlclose(dl_handle);
 	    return;
 	  }
 
@@ -732,11 +588,6 @@ PDK_ChassisIdentify (INT8U Force, INT8U Timeout, int BMCInst)
 	  else
 	    dl_func(0,0,Timeout,BMCInst);
 
-	if(dl_handle)
-	{
-		dlclose(dl_handle);
-		dl_handle = NULL;
-	}
     return;
 }
 
@@ -777,6 +628,13 @@ PDK_GetPSGood (int BMCInst)
     	{
             BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
     	}
+
+	/* Tracked by the PS_PWROK edge interrupt once it is registered */
+	if(OEM_SysStateIsValid())
+	{
+	  return (OEM_SysStateGet() & OEM_SYS_STATE_PS_PWRGD) ? 1 : 0;
+	}
+
 	val_GPIO_PS_PWROK = 0;
 	hal.func = HAL_DEVICE_READ;
 	hal.pread_buf = &val_GPIO_PS_PWROK;
@@ -54,6 +54,12 @@
 #include "bt_ioctl.h"
 
 #include "OEMSysInfo.h"
+#include "OEMPostCode.h"
+#include "OEMSEL.h"
+#include "OEMSDR.h"
+#include "OEMDLCache.h"
+#include "OEMSysState.h"
+#include "OEMLEDEngine.h"
 
 #define GET_POWER_STATUS    1
 #define GET_PS_STATUS       2
@@ -71,9 +77,6 @@
 #define PSGOOD_WAIT_TIME    3
 #define IPV6_DEFAULT_FF      0xff
 
-#define MAX_SNOOP_SIZE 1024
-#define SNOOP_DELAY_TIME 60
-
 PDK_ChannelInfo_T g_pdkChannelInfo;
 INT8U 			  g_pdkIsPktFromVLAN = FALSE;
 static INT8U 	  gPDKLastPowerEvent = PDK_LAST_POWER_DOWN_VIA_AC_FAILURE;
@@ -81,8 +84,9 @@ static INT8U 	  gPDKLastPowerEvent = PDK_LAST_POWER_DOWN_VIA_AC_FAILURE;
 // This is set to TRUE when the Init Agent has just rearmed all sensors.
 bool  g_bInitAgentRearmed = FALSE;
 
-int g_pdkSnoopCounter=0;
-int g_pdkSnoopFlag=0;
+#ifdef CONFIG_SPX_FEATURE_GPGPU_SUPPORT
+extern void PDK_FlushFPGAIntEvents (void);
+#endif
 
 
 #define USE_PECI_TO_READ_CPU_MEMORY_SENSOR_VALUEx
@@ -357,14 +361,36 @@ PDK_BeforeCreatingTasks (int BMCInst)
 int
 PDK_AfterCreatingTasks (int BMCInst)
 {
+    int (*pFSCStart)(int) = NULL;
+
     /* Porting tasks can be created here */
-    if(0)
+
+    /* Fan speed control runs in its own thread, at its own period */
+    pFSCStart = OEM_DLCacheGet(OEM_DL_SYM_FSC_START);
+    if ((pFSCStart == NULL) || (pFSCStart(BMCInst) != 0))
     {
-        BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
+        IPMI_ERROR ("Fan speed control thread not started\n");
     }
     return 0;
 }
 
+/*-----------------------------------------------------------------
+ * @fn PDKStopFSC
+ * @brief Stops the fan speed control thread before a BMC reset, the
+ *        fans keep the last PWM written.
+ *-----------------------------------------------------------------*/
+static void
+PDKStopFSC (void)
+{
+    void (*pFSCStop)(void) = NULL;
+
+    pFSCStop = OEM_DLCacheGet(OEM_DL_SYM_FSC_STOP);
+    if (pFSCStop != NULL)
+    {
+        pFSCStop();
+    }
+}
+
 /*-----------------------------------------------------------------
  * @fn PDK_OnTaskStartup
  *
@@ -421,8 +447,7 @@ PDK_LPCReset (int BMCInst)
 
     printf ("PDK LPC Reset is invoked\n");
 
-    g_pdkSnoopCounter=0;
-    g_pdkSnoopFlag=0;
+    OEM_PostCodeHostReset();
 
     API_RunInitializationAgent (BMCInst);
     return;
@@ -452,6 +477,12 @@ PDK_PostInit (int BMCInst)
 
     PDK_RegisterAllFRUs(BMCInst);
 
+    /* Resolve the helper libraries once, anything missing is retried on use */
+    if (OEM_DLCacheInit() != 0)
+    {
+        IPMI_WARNING ("Some helper library entry points could not be resolved\n");
+    }
+
 	return;
 }
 
@@ -827,9 +858,8 @@ PDK_PreAddSEL (_FAR_ INT8U* pSELEntry, INT8U SelectTbl, int BMCInst)
     if(0)
     {
         BMCInst=BMCInst;  /*  -Wextra, fix for unused parameters  */
-	pSELEntry=pSELEntry;
     }
-    return SelectTbl;
+    return OEM_SELCoalesce(pSELEntry, SelectTbl);
 }
 /*---------------------------------------------------------------------
  * @fn PDK_PostAddSEL
@@ -848,8 +878,8 @@ PDK_PostAddSEL (_FAR_ INT8U*	pSELEntry,int BMCInst)
     if(0)
     {
         BMCInst=BMCInst;  /*  -Wextra, fix for unused parameters  */
-	pSELEntry=pSELEntry;
     }
+    OEM_SELIndexAdd(pSELEntry);
     return 0xff;
 }
 
@@ -870,6 +900,7 @@ PDK_PreClearSEL ( int BMCInst )
     {
         BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
     }
+    OEM_SELIndexClear();
     return 0xff;
 }
 
@@ -961,41 +992,17 @@ PDK_ChassisTimerCB (int BMCInst)
 void
 PDK_TimerTask (int BMCInst)
 {
-	u8 PostCodeBuf[MAX_SNOOP_SIZE];
-	hal_t phal;
-	int	rd_len=0, i;
-    	if(0)
-    	{
-        	BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
-    	}
-	if (g_pdkSnoopFlag == 1)
-		return;
-	if (g_pdkSnoopCounter < SNOOP_DELAY_TIME)
-	{
-		g_pdkSnoopCounter ++;
-		return;
-	}
-	printf ("Starting to Read Current PostCode buffer...\n");
-	phal.read_len = sizeof (PostCodeBuf);
-	phal.pread_buf = PostCodeBuf;
-	rd_len=snoop_read_current_bios_code (&phal);
-	if (-1 == rd_len)
-	{
-		printf ("Error Reading Current PostCode buffer...\n");
-	}
-	else if (rd_len)
-	{
-		printf ("Current Post Codes are ...\n");
-		for (i = 0; i < rd_len; i++)
-		{
-			printf ("0x%02x ", phal.pread_buf[i]);
-		}
-		printf ("\n");
-	}
-	else
-		printf ("No Post Codes ...\n");
-	g_pdkSnoopFlag = 1;
-	return;
+#ifdef CONFIG_SPX_FEATURE_GPGPU_SUPPORT
+    PDK_FlushFPGAIntEvents ();
+#endif
+    OEM_PostCodeCapture ();
+    OEM_PostCodeDump (OEM_POSTCODE_DUMP_FILE);
+    OEM_SELJournalTick ();
+    OEM_SELCoalesceTick (BMCInst);
+    OEM_SDRIndexTick (BMCInst);
+    OEM_SysStateResync ();
+    OEM_LEDEngineRun ();
+    return;
 }
 
 /*-------------------------------------------------------------------------
@@ -1011,6 +1018,8 @@ PDK_BeforeBMCColdReset (int BMCInst)
     {
         BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
     }
+    PDKStopFSC ();
+    OEM_SELJournalFlush ();
     return 0;
 }
 
@@ -1027,6 +1036,8 @@ PDK_BeforeBMCWarmReset (int BMCInst)
     {
         BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
     }
+    PDKStopFSC ();
+    OEM_SELJournalFlush ();
     return 0;
 }
 
@@ -1742,32 +1753,8 @@ void PDK_ProcessOEMRecord(INT8U* OEMRec, int BMCInst)
 
 void PDK_AfterSDRInit(INT8U BMCInst)
 {
-
-    /* How to Access All SDR Records? */
-    if(0)
-    {
-        BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
-    }
-#if 0
-    int i;
-    _FAR_ BMCInfo_t* pBMCInfo = &g_BMCInfo[BMCInst];
-    _FAR_ SDRRecHdr_T*      pSDRRecord;
-    pSDRRecord = SDR_GetFirstSDRRec (BMCInst);
-    for (i=0; i < pBMCInfo->SDRConfig.SDRRAM->NumRecords && pSDRRecord != NULL; i++)
-    {
-        printf ("SDR TYPE : %x\n", pSDRRecord->Type);
-        switch (pSDRRecord->Type)
-        {
-        case FULL_SDR_REC:
-            break;
-        case COMPACT_SDR_REC:
-            break;
-        default:
-            break;
-        }
-        pSDRRecord = SDR_GetNextSDRRec (pSDRRecord,BMCInst);
-    }
-#endif
+    /* Sensor number -> SDR record index, see OEMSDR.c */
+    OEM_SDRBuildIndex(BMCInst);
     return;
 }
 
@@ -2128,6 +2115,8 @@ int PDK_OEMIPMIConfigs(int BMCInst)
     {
         BMCInst=BMCInst;  /*  -Wextra, fix for unused parameter  */
     }
+    /* A bad line is logged and skipped, the rest of the settings still apply */
+    OEM_SELLoadConfig(OEM_SEL_CONFIG_FILE);
 #if 0
     char Filename[MAXFILESIZE];
     INT8U (*ParHandlr)(char *,OEMConfig_T *);
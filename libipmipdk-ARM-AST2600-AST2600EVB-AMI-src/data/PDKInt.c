@@ -28,10 +28,18 @@
 #include "gpio.h"
 #include "gpioifc.h"
 #include "EINTR_wrappers.h"
+#include "OEMIntr.h"
+#include "OEMDLCache.h"
+#include "OEMSysState.h"
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
 
 #define SYSFS_GPIO_DIR          "/sys/class/gpio"
 #define MAX_BUF                 40
@@ -40,12 +48,32 @@
 #define BMC_I2C0_FPGA_ALERT_L_I CONFIG_SPX_FEATURE_BMC_I2C0_FPGA_ALERT
 #define BMC_I2C1_FPGA_ALERT_L_I CONFIG_SPX_FEATURE_BMC_I2C1_FPGA_ALERT
 #define COMP_FPGA_INTERRUPT_INFO_PIPE "/var/FPGA_interrupt_info_PIPE"
+
+#define FPGA_INT_LINE_I2C0_ALERT    1
+#define FPGA_INT_LINE_I2C1_PGOOD    2
+#define FPGA_INT_LINE_I2C1_ALERT    3
+#define FPGA_INT_LINE_MAX           3
+#define FPGA_INT_FLUSH_INTERVAL_MS  100
+
+/* Record written to COMP_FPGA_INTERRUPT_INFO_PIPE, one per line with
+ * pending interrupts. The reader consumes the pipe in units of this size. */
+typedef struct
+{
+    INT8U   Line;           /* FPGA_INT_LINE_xxx */
+    INT8U   Reserved;
+    INT16U  Count;          /* interrupts coalesced into this record */
+    INT32U  TimeStampSec;   /* CLOCK_MONOTONIC of the first one */
+    INT32U  TimeStampNSec;
+} PACKED FPGAIntEvent_T;
+
 void PDK_BMC_I2C0_FPGA_ALERT (IPMI_INTInfo_T *IntInfo);
 void PDK_BMC_I2C1_FPGA_ALERT (IPMI_INTInfo_T *IntInfo);
 void PDK_BMC_I2C1_FPGA_PGOOD (IPMI_INTInfo_T *IntInfo);
+void PDK_FlushFPGAIntEvents (void);
 #endif
 
 void PDK_SensorInterruptHandler (IPMI_INTInfo_T *IntInfo);
+void PDK_SystemStateInterruptHandler (IPMI_INTInfo_T *IntInfo);
 
 int gpio_count = 0;
 
@@ -53,6 +81,7 @@ int gpio_count = 0;
      can be done via MDS*/
 
 #define GPIO_INT_SENSOR 0x01
+#define GPIO_INT_NO_SENSOR 0xFF    /* reserved sensor number, not tied to a sensor */
 
 #define GPIO_INT_SENSOR_TYPE    0
 #define GPIO_BMC_INT_TEST1      9   //GPIOB1
@@ -61,6 +90,7 @@ IPMI_INTInfo_T m_IntInfo [] =
 {
  	//{ int_hndlr, int_num, Source, SensorNum, SensorType, TriggerMethod, TriggerType, reading_on_assertion },
     {PDK_SensorInterruptHandler, GPIO_BMC_INT_TEST1, INT_REG_HNDLR, GPIO_INT_SENSOR, GPIO_INT_SENSOR_TYPE, IPMI_INT_TRIGGER_EDGE, IPMI_INT_RISING_EDGE, 0, 0, 0 ,0},
+    {PDK_SystemStateInterruptHandler, GPIO_PS_PWROK, INT_REG_HNDLR, GPIO_INT_NO_SENSOR, GPIO_INT_SENSOR_TYPE, IPMI_INT_TRIGGER_EDGE, IPMI_INT_BOTH_EDGES, 0, 0, 0 ,0},
 #ifdef CONFIG_SPX_FEATURE_GPGPU_SUPPORT
     {PDK_BMC_I2C0_FPGA_ALERT, BMC_I2C0_FPGA_ALERT_L_I, INT_REG_HNDLR, GPIO_INT_SENSOR,GPIO_INT_SENSOR_TYPE,IPMI_INT_TRIGGER_LEVEL, IPMI_INT_HIGH_LEVEL, 0, 0, 0 ,0},
     {PDK_BMC_I2C1_FPGA_PGOOD, BMC_I2C1_FPGA_ALERT_L_I, INT_REG_HNDLR, GPIO_INT_SENSOR,GPIO_INT_SENSOR_TYPE,IPMI_INT_TRIGGER_LEVEL, IPMI_INT_HIGH_LEVEL, 0, 0, 0 ,0},
@@ -75,14 +105,15 @@ static int	   			m_total_reg_fds = 0;
 
 void PDK_SensorInterruptHandler (IPMI_INTInfo_T *IntInfo)
 {
-    switch(IntInfo->int_num)
-    { 
-		case GPIO_BMC_INT_TEST1:
-			printf("GPIO_INT_SENSOR\n");
-			break;
-		default:
-			break;
-    }
+    /* Consumers subscribe through OEM_IntrSubscribe(), nothing is done inline */
+    OEM_IntrRecord((INT16U)IntInfo->int_num, OEM_INTR_SRC_GPIO, OEM_INTR_LEVEL_UNKNOWN);
+    return;
+}
+
+/* Both edges of a system state pin (PS_PWROK, ...), see OEMSysState */
+void PDK_SystemStateInterruptHandler (IPMI_INTInfo_T *IntInfo)
+{
+    OEM_SysStateEdge((INT16U)IntInfo->int_num);
     return;
 }
 
@@ -96,6 +127,7 @@ PDK_RegGPIOInts(int fd, int BMCInst, int pinNum[IPMI_MAX_INT_FDS], int **pCount,
     UN_USED(BMCInst);
 
     int i = 0, ret = 0;
+    int sys_state_ok = 0;
     interrupt_sensor_info gpio_intr[MAX_IPMI_INT] ={0};
     int (*pRegisterInt) (interrupt_sensor_info *,unsigned int, int);
     int (*pUnRegisterInt) (int, interrupt_sensor_info *);
@@ -103,24 +135,31 @@ PDK_RegGPIOInts(int fd, int BMCInst, int pinNum[IPMI_MAX_INT_FDS], int **pCount,
 
     (*pCount) = &m_total_reg_fds;
 
-    void *lib_handle = dlopen(GPIO_LIB, RTLD_NOW);
-    if (lib_handle == NULL)
-        return -1;
-   
-    pRegisterInt = dlsym(lib_handle,"register_sensor_interrupts");
-    pUnRegisterInt = dlsym(lib_handle,"unregister_sensor_interrupts");
+    /* The state bitmap is only valid once the PS_PWROK interrupt is registered too */
+    OEM_SysStateSetValid(0);
+    if (OEM_IntrInit() != 0)
+    {
+        IPMI_WARNING ("Interrupt event dispatcher is not running\n");
+    }
+    else if (OEM_SysStateInit(BMCInst) != 0)
+    {
+        IPMI_WARNING ("System state edges are not subscribed\n");
+    }
+    else
+    {
+        sys_state_ok = 1;
+    }
+
+    pRegisterInt = OEM_DLCacheGet(OEM_DL_SYM_REGISTER_SENSOR_INT);
+    pUnRegisterInt = OEM_DLCacheGet(OEM_DL_SYM_UNREGISTER_SENSOR_INT);
     if (NULL == pRegisterInt || NULL == pUnRegisterInt)
     {
-        dlclose(lib_handle);
-	lib_handle = NULL;
         return -1;
     }
     if (m_IntInfoCount >= MAX_IPMI_INT)
     {
         /*Not enough space */
         IPMI_WARNING ("Not enough space for INT registration\n");
-        dlclose(lib_handle);
-	lib_handle = NULL;
         return -1;
     }
 
@@ -128,8 +167,6 @@ PDK_RegGPIOInts(int fd, int BMCInst, int pinNum[IPMI_MAX_INT_FDS], int **pCount,
 	{
 	    /*No Interrupts sensor in m_IntInfo table  */
         TDBG("No Interrupts sensor in m_IntInfo table\n");
-        dlclose(lib_handle);
-	lib_handle = NULL;
 	return -1;
 	}
 
@@ -145,8 +182,6 @@ PDK_RegGPIOInts(int fd, int BMCInst, int pinNum[IPMI_MAX_INT_FDS], int **pCount,
             if((ret < 0)||(ret >= (signed int)sizeof(commandStrBuf)))
             {
                 IPMI_WARNING ("Buffr Overflow");
-                dlclose(lib_handle);
-		lib_handle = NULL;
                 return -1;
             }
 
@@ -189,8 +224,6 @@ PDK_RegGPIOInts(int fd, int BMCInst, int pinNum[IPMI_MAX_INT_FDS], int **pCount,
             if ( -1 == pRegisterInt (&gpio_intr[m_total_reg_fds], m_total_reg_fds, fd) )
             {
                 IPMI_WARNING ("GPIO Interrupt registration failed \n");
-                dlclose(lib_handle);
-		        lib_handle = NULL;
                 return -1;
             }
             else
@@ -201,136 +234,281 @@ PDK_RegGPIOInts(int fd, int BMCInst, int pinNum[IPMI_MAX_INT_FDS], int **pCount,
             m_total_reg_fds++;
         }
     }
-    dlclose(lib_handle);
-    lib_handle = NULL;
+
+    OEM_SysStateSetValid(sys_state_ok);
     return 0;
 }
 
+#ifdef CONFIG_SPX_FEATURE_GPGPU_SUPPORT
 /*-----------------------------------------------------------------
- * @fn PDK_BMC_I2C0_FPGA_ALERT
- * @brief This is provide I2C0 Interrupt alert to GPGPU
+ * FPGA interrupt delivery to the GPGPU component.
  *
- * @return None.
+ * The pipe is opened once (O_NONBLOCK) and kept open.  An interrupt is
+ * written out right away unless a batch already went out in the last
+ * FPGA_INT_FLUSH_INTERVAL_MS.  During such a burst interrupts are coalesced
+ * per line into m_FPGAPending[] and the flusher thread writes them as one
+ * batch of FPGAIntEvent_T records when the interval ends.  The one second
+ * timer task (PDK_FlushFPGAIntEvents) only retries what could not be
+ * written.  If the reader goes away (EPIPE/ENXIO) the descriptor is dropped
+ * and reopened on the next flush, the pending counts are kept meanwhile.
  *-----------------------------------------------------------------*/
-#ifdef CONFIG_SPX_FEATURE_GPGPU_SUPPORT
-void PDK_BMC_I2C0_FPGA_ALERT(IPMI_INTInfo_T *IntInfo)
+static int              m_FPGAPipeFd = -1;
+static pthread_mutex_t  m_FPGAPipeLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   m_FPGAFlushCond;
+static pthread_once_t   m_FPGAFlushOnce = PTHREAD_ONCE_INIT;
+static FPGAIntEvent_T   m_FPGAPending [FPGA_INT_LINE_MAX];
+static struct timespec  m_FPGALastFlush;    /* last batch actually written */
+static struct timespec  m_FPGAFlushDue;
+static int              m_FPGAFlushArmed = 0;
+
+static INT32U
+FPGAIntElapsedMs (const struct timespec *pFrom, const struct timespec *pTo)
 {
-    int comp_pipe_fd = 0;
-
-    u8 i2c_interrupt_line = 1;
-
-    struct stat buf;
+    return (INT32U)((pTo->tv_sec - pFrom->tv_sec) * 1000 +
+                    (pTo->tv_nsec - pFrom->tv_nsec) / 1000000);
+}
 
-    memset(&buf, 0, sizeof(buf));
+/*-----------------------------------------------------------------
+ * @fn FPGAIntPipeOpen
+ * @brief Opens the GPGPU interrupt pipe if it is not open already.
+ *        Must be called with m_FPGAPipeLock held.
+ * @return 0 if the pipe is open, -1 otherwise.
+ *-----------------------------------------------------------------*/
+static int
+FPGAIntPipeOpen (void)
+{
+    if (m_FPGAPipeFd >= 0)
+        return 0;
 
-    if (0)
+    /* ENXIO just means nobody has the read side open yet */
+    m_FPGAPipeFd = sigwrap_open(COMP_FPGA_INTERRUPT_INFO_PIPE, O_WRONLY | O_NONBLOCK);
+    if (m_FPGAPipeFd == -1)
     {
-        IntInfo = IntInfo; /* -Wextra, fix for unused parameters */
+        if (errno != ENXIO)
+        {
+            TCRIT("Opening a %s is failed(%d)\n", COMP_FPGA_INTERRUPT_INFO_PIPE, errno);
+        }
+        return -1;
     }
+    return 0;
+}
 
-    if(stat(COMP_FPGA_INTERRUPT_INFO_PIPE, &buf) == -1)
+/*-----------------------------------------------------------------
+ * @fn FPGAIntPipeFlush
+ * @brief Writes all pending interrupt records to the pipe with a
+ *        single write. Must be called with m_FPGAPipeLock held.
+ *-----------------------------------------------------------------*/
+static void
+FPGAIntPipeFlush (const struct timespec *pNow)
+{
+    FPGAIntEvent_T batch [FPGA_INT_LINE_MAX];
+    sigset_t pipe_set, old_set;
+    struct timespec no_wait = {0, 0};
+    int count = 0, i;
+    ssize_t ret;
+    int err;
+
+    for (i = 0; i < FPGA_INT_LINE_MAX; i++)
     {
-        TCRIT("%s is not available\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
-        return;
+        if (m_FPGAPending[i].Count != 0)
+        {
+            batch[count++] = m_FPGAPending[i];
+        }
     }
+    if (count == 0)
+        return;
 
-    comp_pipe_fd = sigwrap_open(COMP_FPGA_INTERRUPT_INFO_PIPE, O_WRONLY);
-
-    if(comp_pipe_fd == -1)
-    {
-        TCRIT("Opening a %s is failed\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
+    if (FPGAIntPipeOpen() != 0)
         return;
-    }
 
-    if(sigwrap_write(comp_pipe_fd, &i2c_interrupt_line, sizeof(i2c_interrupt_line)) == -1)
+    /* Do not let a vanished reader kill the process, EPIPE is enough */
+    sigemptyset(&pipe_set);
+    sigaddset(&pipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_set, &old_set);
+
+    /* The batch is smaller than PIPE_BUF so the write is all or nothing */
+    ret = write(m_FPGAPipeFd, batch, count * sizeof(FPGAIntEvent_T));
+    err = errno;
+    if (ret == -1)
     {
-        TCRIT("Writing into %s is failed\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
+        /* Discard the SIGPIPE raised by the write, this clobbers errno */
+        if (err == EPIPE)
+        {
+            sigtimedwait(&pipe_set, NULL, &no_wait);
+        }
+        if (err != EAGAIN)
+        {
+            TCRIT("Writing into %s is failed(%d), reconnecting\n", COMP_FPGA_INTERRUPT_INFO_PIPE, err);
+            sigwrap_close(m_FPGAPipeFd);
+            m_FPGAPipeFd = -1;
+        }
     }
-
-    if(sigwrap_close(comp_pipe_fd) == -1)
+    else
     {
-        TCRIT("Closing %s is failed\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
+        memset(m_FPGAPending, 0, sizeof(m_FPGAPending));
+        m_FPGALastFlush = *pNow;
+        m_FPGAFlushArmed = 0;
     }
+
+    pthread_sigmask(SIG_SETMASK, &old_set, NULL);
     return;
 }
-void PDK_BMC_I2C1_FPGA_PGOOD(IPMI_INTInfo_T *IntInfo)
-{
-    int comp_pipe_fd = 0;
 
-    u8 i2c_interrupt_line = 2;
-
-    struct stat buf;
+/*-----------------------------------------------------------------
+ * @fn FPGAIntFlushTask
+ * @brief Writes out the batch coalesced during a burst once the flush
+ *        interval since the previous batch has ended.
+ *-----------------------------------------------------------------*/
+static void *
+FPGAIntFlushTask (void *pArg)
+{
+    struct timespec now;
 
-    memset(&buf, 0, sizeof(buf));
+    (void)pArg;
 
-    if (0)
+    pthread_mutex_lock(&m_FPGAPipeLock);
+    for (;;)
     {
-        IntInfo = IntInfo; /* -Wextra, fix for unused parameters */
-    }
+        if (!m_FPGAFlushArmed)
+        {
+            pthread_cond_wait(&m_FPGAFlushCond, &m_FPGAPipeLock);
+            continue;
+        }
+        if (pthread_cond_timedwait(&m_FPGAFlushCond, &m_FPGAPipeLock, &m_FPGAFlushDue) != ETIMEDOUT)
+            continue;
 
-    if(stat(COMP_FPGA_INTERRUPT_INFO_PIPE, &buf) == -1)
-    {
-        TCRIT("%s is not available\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
-        return;
+        /* Disarm even if the write fails, the next interrupt or the timer task retries */
+        m_FPGAFlushArmed = 0;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        FPGAIntPipeFlush(&now);
     }
 
-    comp_pipe_fd = sigwrap_open(COMP_FPGA_INTERRUPT_INFO_PIPE, O_WRONLY);
+    pthread_mutex_unlock(&m_FPGAPipeLock);
+    return NULL;
+}
 
-    if(comp_pipe_fd == -1)
-    {
-        TCRIT("Opening a %s is failed\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
-        return;
-    }
+static void
+FPGAIntFlushInitOnce (void)
+{
+    pthread_condattr_t attr;
+    pthread_t thread_id;
 
-    if(sigwrap_write(comp_pipe_fd, &i2c_interrupt_line, sizeof(i2c_interrupt_line)) == -1)
-    {
-        TCRIT("Writing into %s is failed\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
-    }
+    /* The flush deadline is CLOCK_MONOTONIC, the condvar has to match */
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&m_FPGAFlushCond, &attr);
+    pthread_condattr_destroy(&attr);
 
-    if(sigwrap_close(comp_pipe_fd) == -1)
+    if (pthread_create(&thread_id, NULL, FPGAIntFlushTask, NULL) != 0)
     {
-        TCRIT("Closing %s is failed\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
+        TCRIT("Failed to start the FPGA interrupt flush thread\n");
+        return;
     }
-    return;
+    pthread_detach(thread_id);
 }
-void PDK_BMC_I2C1_FPGA_ALERT(IPMI_INTInfo_T *IntInfo)
-{
-    int comp_pipe_fd = 0;
-
-    u8 i2c_interrupt_line = 3;
 
-    struct stat buf;
+/*-----------------------------------------------------------------
+ * @fn FPGAIntPost
+ * @brief Records one FPGA interrupt on the given line. It is written
+ *        out right away if no batch went out in the last flush
+ *        interval, otherwise when that interval ends.
+ *-----------------------------------------------------------------*/
+static void
+FPGAIntPost (INT8U Line)
+{
+    FPGAIntEvent_T *pEvent = &m_FPGAPending[Line - 1];
+    struct timespec now;
 
-    memset(&buf, 0, sizeof(buf));
+    pthread_once(&m_FPGAFlushOnce, FPGAIntFlushInitOnce);
+    clock_gettime(CLOCK_MONOTONIC, &now);
 
-    if (0)
+    pthread_mutex_lock(&m_FPGAPipeLock);
+    if (pEvent->Count == 0)
     {
-        IntInfo = IntInfo; /* -Wextra, fix for unused parameters */
+        pEvent->Line          = Line;
+        pEvent->TimeStampSec  = (INT32U)now.tv_sec;
+        pEvent->TimeStampNSec = (INT32U)now.tv_nsec;
     }
-
-    if(stat(COMP_FPGA_INTERRUPT_INFO_PIPE, &buf) == -1)
+    if (pEvent->Count != 0xFFFF)
     {
-        TCRIT("%s is not available\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
-        return;
+        pEvent->Count++;
     }
 
-    comp_pipe_fd = sigwrap_open(COMP_FPGA_INTERRUPT_INFO_PIPE, O_WRONLY);
-
-    if(comp_pipe_fd == -1)
+    if (FPGAIntElapsedMs(&m_FPGALastFlush, &now) >= FPGA_INT_FLUSH_INTERVAL_MS)
     {
-        TCRIT("Opening a %s is failed\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
-        return;
+        FPGAIntPipeFlush(&now);
     }
-
-    if(sigwrap_write(comp_pipe_fd, &i2c_interrupt_line, sizeof(i2c_interrupt_line)) == -1)
+    else if (!m_FPGAFlushArmed)
     {
-        TCRIT("Writing into %s is failed\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
+        m_FPGAFlushDue = m_FPGALastFlush;
+        m_FPGAFlushDue.tv_nsec += FPGA_INT_FLUSH_INTERVAL_MS * 1000000L;
+        if (m_FPGAFlushDue.tv_nsec >= 1000000000L)
+        {
+            m_FPGAFlushDue.tv_sec++;
+            m_FPGAFlushDue.tv_nsec -= 1000000000L;
+        }
+        m_FPGAFlushArmed = 1;
+        pthread_cond_signal(&m_FPGAFlushCond);
     }
+    pthread_mutex_unlock(&m_FPGAPipeLock);
+    return;
+}
 
-    if(sigwrap_close(comp_pipe_fd) == -1)
-    {
-        TCRIT("Closing %s is failed\n", COMP_FPGA_INTERRUPT_INFO_PIPE);
-    }
+/*-----------------------------------------------------------------
+ * @fn PDK_FlushFPGAIntEvents
+ * @brief Retries FPGA interrupt records that could not be written
+ *        (no reader, pipe full). Called from PDK_TimerTask.
+ *
+ * @return None.
+ *-----------------------------------------------------------------*/
+void PDK_FlushFPGAIntEvents (void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&m_FPGAPipeLock);
+    FPGAIntPipeFlush(&now);
+    pthread_mutex_unlock(&m_FPGAPipeLock);
+    return;
+}
+
+/*-----------------------------------------------------------------
+ * @fn PDK_BMC_I2C0_FPGA_ALERT
+ * @brief This is provide I2C0 Interrupt alert to GPGPU
+ *
+ * @return None.
+ *-----------------------------------------------------------------*/
+void PDK_BMC_I2C0_FPGA_ALERT(IPMI_INTInfo_T *IntInfo)
+{
+    OEM_IntrRecord((INT16U)IntInfo->int_num, OEM_INTR_SRC_CPLD, OEM_INTR_LEVEL_UNKNOWN);
+    FPGAIntPost(FPGA_INT_LINE_I2C0_ALERT);
+    return;
+}
+
+/*-----------------------------------------------------------------
+ * @fn PDK_BMC_I2C1_FPGA_PGOOD
+ * @brief This is provide I2C1 power good interrupt to GPGPU
+ *
+ * @return None.
+ *-----------------------------------------------------------------*/
+void PDK_BMC_I2C1_FPGA_PGOOD(IPMI_INTInfo_T *IntInfo)
+{
+    OEM_IntrRecord((INT16U)IntInfo->int_num, OEM_INTR_SRC_CPLD, OEM_INTR_LEVEL_UNKNOWN);
+    FPGAIntPost(FPGA_INT_LINE_I2C1_PGOOD);
+    return;
+}
+
+/*-----------------------------------------------------------------
+ * @fn PDK_BMC_I2C1_FPGA_ALERT
+ * @brief This is provide I2C1 Interrupt alert to GPGPU
+ *
+ * @return None.
+ *-----------------------------------------------------------------*/
+void PDK_BMC_I2C1_FPGA_ALERT(IPMI_INTInfo_T *IntInfo)
+{
+    OEM_IntrRecord((INT16U)IntInfo->int_num, OEM_INTR_SRC_CPLD, OEM_INTR_LEVEL_UNKNOWN);
+    FPGAIntPost(FPGA_INT_LINE_I2C1_ALERT);
     return;
 }
 
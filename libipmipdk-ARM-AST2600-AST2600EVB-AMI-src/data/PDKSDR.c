@@ -23,6 +23,7 @@
 #include "PDKSDR.h"
 #include "NVRAPI.h"
 #include "IPMIConf.h"
+#include "OEMSDR.h"
 
 
 /**
@@ -56,6 +57,8 @@ int PDKWriteSDR(INT8U* pData,INT32U Offset,INT16U Size, int BMCInst)
     SDR_FILE(BMCInst,&PlatformID[0],SDRFile);
      //This API to write NVRAM can be replaced by OEM's if they need to use EEPROM
     len = API_WriteNVR(SDRFile,Offset,Size,pData);
+    //Records may have moved in RAM, PDK_TimerTask rebuilds the sensor index
+    OEM_SDRInvalidateIndex();
     return len;
 }
 
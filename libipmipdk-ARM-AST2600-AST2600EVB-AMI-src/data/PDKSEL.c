@@ -22,6 +22,7 @@
 
 #include "PDKSEL.h"
 #include "NVRAPI.h"
+#include "OEMSEL.h"
 
 /**
 *@fn PDKInitNVRSEL 
@@ -35,8 +36,14 @@ int PDKInitNVRSEL(INT8U* pData,INT32U Size, int BMCInst)
     char SELFile[64];
     int len;
     SEL_FILE(BMCInst,SELFile);
+    //Anything still journaled has to reach the file before it is read back
+    OEM_SELJournalFlush();
     //This API to read NVRAM can be replaced by OEM's if they need to use EEPROM
     len = API_ReadNVR(SELFile,0,Size,pData);
+    if (len >= 0)
+    {
+        OEM_SELIndexBuild(pData,(INT32U)len);
+    }
     return len;
 }
 
@@ -49,12 +56,10 @@ int PDKInitNVRSEL(INT8U* pData,INT32U Size, int BMCInst)
 */
 int PDKWriteSEL(INT8U* pData,INT32U Offset,INT32U Size,int BMCInst)
 {
-    char SELFile[64];
-    int len;
-    SEL_FILE(BMCInst,SELFile);
-    //This API to write NVRAM can be replaced by OEM's if they need to use EEPROM
-    len = API_WriteNVR(SELFile,Offset,Size,pData);
-    return len;
+    //Records the write replaces or deletes leave the index
+    OEM_SELIndexWrite(pData,Offset,Size);
+    //Writes are batched in a RAM journal and flushed to NVRAM by OEMSEL.c
+    return OEM_SELJournalWrite(pData,Offset,Size,BMCInst);
 }
 
 
@@ -24,6 +24,7 @@
 
 #include "OEMSensor.h"
 #include "OEMFAN.h"
+#include "OEMLEDEngine.h"
 
 
 static SensorHooks_T pdk_sensor_hooks []=
@@ -293,6 +294,7 @@ int PDK_PostMonitorFanSensors (void* pSenInfo, INT8U *pReadFlags, int BMCInst)
     }
 
     ret = OEM_GetFanTrayRPM(fan_id, fan_rotor, &fan_rpm);
+    OEM_LEDEngineFanReading(fan_id, fan_rotor, ret, fan_rpm);
     if (ret == 0)
     {
         fan_rpm_raw = (INT8U)(fan_rpm / FAN_RPM_MULTIPLIER);
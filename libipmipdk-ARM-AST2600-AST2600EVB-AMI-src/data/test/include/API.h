@@ -0,0 +1,17 @@
+/*************************************************************************
+ *
+ * API.h
+ * Host stand-in for the SPX API.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_API_H
+#define PDK_TEST_API_H
+
+#include "Types.h"
+#include "IPMIDefs.h"
+
+extern int API_ExecuteCmd(MsgPkt_T *pMsgPkt, int BMCInst);
+extern int API_ReadNVR(char *pFile, INT32U Offset, INT32U Size, INT8U *pData);
+extern int API_WriteNVR(char *pFile, INT32U Offset, INT32U Size, INT8U *pData);
+
+#endif // PDK_TEST_API_H
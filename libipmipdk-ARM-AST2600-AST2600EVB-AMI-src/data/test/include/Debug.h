@@ -0,0 +1,18 @@
+/*************************************************************************
+ *
+ * Debug.h
+ * Host stand-in for the SPX Debug.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_DEBUG_H
+#define PDK_TEST_DEBUG_H
+
+#include <stdio.h>
+
+#define IPMI_ERROR(fmt, ...)    fprintf(stderr, fmt, ##__VA_ARGS__)
+#define IPMI_WARNING(fmt, ...)  fprintf(stderr, fmt, ##__VA_ARGS__)
+#define IPMI_INFO(fmt, ...)     do { } while (0)
+#define TCRIT(fmt, ...)         fprintf(stderr, fmt, ##__VA_ARGS__)
+#define TDBG(fmt, ...)          do { } while (0)
+
+#endif // PDK_TEST_DEBUG_H
@@ -0,0 +1,38 @@
+/*************************************************************************
+ *
+ * IPMIConf.h
+ * Host stand-in for the SPX IPMIConf.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_IPMICONF_H
+#define PDK_TEST_IPMICONF_H
+
+#include <pthread.h>
+
+#include "Types.h"
+
+// SDR repository header, the records follow it
+typedef struct
+{
+    INT8U   Signature [4];
+    INT16U  NumRecords;
+    INT16U  Size;
+    INT16U  FreeSpace;
+} PACKED SDRRepository_T;
+
+// Only the fields the OEM sources use
+typedef struct
+{
+    SDRRepository_T *SDRRAM;
+    pthread_mutex_t SDRMutex;
+} SDRConfig_T;
+
+typedef struct
+{
+    SDRConfig_T SDRConfig;
+} BMCInfo_t;
+
+// Provided by the test
+extern BMCInfo_t g_BMCInfo[];
+
+#endif // PDK_TEST_IPMICONF_H
@@ -0,0 +1,28 @@
+/*************************************************************************
+ *
+ * IPMIDefs.h
+ * Host stand-in for the SPX IPMIDefs.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_IPMIDEFS_H
+#define PDK_TEST_IPMIDEFS_H
+
+#include "Types.h"
+
+#define NETFN_STORAGE           0x0A
+#define CC_SUCCESS              0x00
+#define CC_NORMAL               0x00
+#define CC_REQ_INV_LEN          0xC7
+#define CC_INV_DATA_FIELD       0xCC
+
+#define MSG_PAYLOAD_SIZE        256
+
+typedef struct
+{
+    INT8U   NetFnLUN;
+    INT8U   Cmd;
+    INT32U  Size;
+    INT8U   Data[MSG_PAYLOAD_SIZE];
+} MsgPkt_T;
+
+#endif // PDK_TEST_IPMIDEFS_H
@@ -0,0 +1,66 @@
+/*************************************************************************
+ *
+ * IPMI_SDRRecord.h
+ * Host stand-in for the SPX IPMI_SDRRecord.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_IPMI_SDRRECORD_H
+#define PDK_TEST_IPMI_SDRRECORD_H
+
+#include "Types.h"
+
+#define FULL_SDR_REC            0x01
+#define COMPACT_SDR_REC         0x02
+
+typedef struct
+{
+    INT16U  ID;
+    INT8U   Version;
+    INT8U   Type;
+    INT8U   Len;                // Bytes after the header
+} PACKED SDRRecHdr_T;
+
+// Full sensor record up to the conversion factors, at their IPMI offsets
+typedef struct
+{
+    SDRRecHdr_T hdr;
+    INT8U   OwnerID;
+    INT8U   OwnerLUN;
+    INT8U   SensorNum;
+    INT8U   EntityID;
+    INT8U   EntityIns;
+    INT8U   SensorInit;
+    INT8U   SensorCaps;
+    INT8U   SensorType;
+    INT8U   EventTypeCode;
+    INT16U  AssertionEventMask;
+    INT16U  DeAssertionEventMask;
+    INT16U  DiscreteReadingMask;
+    INT8U   Units1;
+    INT8U   Units2;
+    INT8U   Units3;
+    INT8U   Linearization;
+    INT8U   M;
+    INT8U   M_Tolerance;
+    INT8U   B;
+    INT8U   B_Accuracy;
+    INT8U   Accuracy;
+    INT8U   R_B_Exp;
+} PACKED FullSensorRec_T;
+
+// Compact sensor record up to the event type
+typedef struct
+{
+    SDRRecHdr_T hdr;
+    INT8U   OwnerID;
+    INT8U   OwnerLUN;
+    INT8U   SensorNum;
+    INT8U   EntityID;
+    INT8U   EntityIns;
+    INT8U   SensorInit;
+    INT8U   SensorCaps;
+    INT8U   SensorType;
+    INT8U   EventTypeCode;
+} PACKED CompactSensorRec_T;
+
+#endif // PDK_TEST_IPMI_SDRRECORD_H
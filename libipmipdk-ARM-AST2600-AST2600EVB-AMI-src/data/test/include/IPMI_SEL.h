@@ -0,0 +1,34 @@
+/*************************************************************************
+ *
+ * IPMI_SEL.h
+ * Host stand-in for the SPX IPMI_SEL.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_IPMI_SEL_H
+#define PDK_TEST_IPMI_SEL_H
+
+#include "Types.h"
+
+#define CMD_ADD_SEL_ENTRY       0x44
+
+typedef struct
+{
+    INT16U  ID;
+    INT8U   Type;
+    INT32U  TimeStamp;
+} PACKED SELRecHdr_T;
+
+typedef struct
+{
+    SELRecHdr_T hdr;
+    INT8U   GenID[2];
+    INT8U   EvMsgRev;
+    INT8U   SensorType;
+    INT8U   SensorNum;
+    INT8U   EvtDirType;
+    INT8U   EvtData1;
+    INT8U   EvtData2;
+    INT8U   EvtData3;
+} PACKED SELEventRecord_T;
+
+#endif // PDK_TEST_IPMI_SEL_H
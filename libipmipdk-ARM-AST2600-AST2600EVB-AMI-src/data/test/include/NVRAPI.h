@@ -0,0 +1,12 @@
+/*************************************************************************
+ *
+ * NVRAPI.h
+ * Host stand-in for the SPX NVRAPI.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_NVRAPI_H
+#define PDK_TEST_NVRAPI_H
+
+#include "API.h"
+
+#endif // PDK_TEST_NVRAPI_H
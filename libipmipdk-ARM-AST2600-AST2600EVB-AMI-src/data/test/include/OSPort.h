@@ -0,0 +1,17 @@
+/*************************************************************************
+ *
+ * OSPort.h
+ * Host stand-in for the SPX OSPort.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_OSPORT_H
+#define PDK_TEST_OSPORT_H
+
+#include <pthread.h>
+
+#define WAIT_INFINITE                           (-1)
+
+#define OS_THREAD_MUTEX_ACQUIRE(pMutex, Timeout) pthread_mutex_lock(pMutex)
+#define OS_THREAD_MUTEX_RELEASE(pMutex)          pthread_mutex_unlock(pMutex)
+
+#endif // PDK_TEST_OSPORT_H
@@ -0,0 +1,15 @@
+/*************************************************************************
+ *
+ * PDKAlert.h
+ * Host stand-in for the PDK alert hooks, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_PDKALERT_H
+#define PDK_TEST_PDKALERT_H
+
+#include "Types.h"
+
+// Provided by the test, frames the mail of an alert and sends it
+extern int PDK_FrameAndSendMail(void *pEventRecord, INT8U SetSelector, INT8U EthIndex, int BMCInst);
+
+#endif // PDK_TEST_PDKALERT_H
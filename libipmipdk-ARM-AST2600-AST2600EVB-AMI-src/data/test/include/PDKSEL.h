@@ -0,0 +1,16 @@
+/*************************************************************************
+ *
+ * PDKSEL.h
+ * Host stand-in for the SPX PDKSEL.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_PDKSEL_H
+#define PDK_TEST_PDKSEL_H
+
+#include "Types.h"
+#include "SEL.h"
+
+extern int PDKInitNVRSEL(INT8U *pData, INT32U Size, int BMCInst);
+extern int PDKWriteSEL(INT8U *pData, INT32U Offset, INT32U Size, int BMCInst);
+
+#endif // PDK_TEST_PDKSEL_H
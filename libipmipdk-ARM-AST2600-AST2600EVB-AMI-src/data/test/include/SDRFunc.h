@@ -0,0 +1,17 @@
+/*************************************************************************
+ *
+ * SDRFunc.h
+ * Host stand-in for the SPX SDRFunc.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_SDRFUNC_H
+#define PDK_TEST_SDRFUNC_H
+
+#include "Types.h"
+#include "IPMI_SDRRecord.h"
+
+// Provided by the test, walk the repository in g_BMCInfo
+extern SDRRecHdr_T *SDR_GetFirstSDRRec(int BMCInst);
+extern SDRRecHdr_T *SDR_GetNextSDRRec(SDRRecHdr_T *pSDRRec, int BMCInst);
+
+#endif // PDK_TEST_SDRFUNC_H
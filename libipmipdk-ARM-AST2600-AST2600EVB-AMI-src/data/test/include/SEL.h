@@ -0,0 +1,36 @@
+/*************************************************************************
+ *
+ * SEL.h
+ * Host stand-in for the SPX SEL.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_SEL_H
+#define PDK_TEST_SEL_H
+
+#include <stdio.h>
+
+#include "Types.h"
+#include "IPMI_SEL.h"
+
+#define VALID_RECORD            0x5A
+#define SEL_FILE(Inst, File)    sprintf(File, "/test/sel%d.dat", Inst)
+
+typedef struct
+{
+    INT8U   Valid;
+    INT8U   Len;
+    SELEventRecord_T EvtRecord;
+} PACKED SELRec_T;
+
+typedef struct
+{
+    INT8U   Signature[4];
+    INT16U  NumRecords;
+    INT16U  Padding;
+    INT32U  AddTimeStamp;
+    INT32U  EraseTimeStamp;
+    INT8U   Reserved[16];
+    SELRec_T SELRecord[1];
+} PACKED SELRepository_T;
+
+#endif // PDK_TEST_SEL_H
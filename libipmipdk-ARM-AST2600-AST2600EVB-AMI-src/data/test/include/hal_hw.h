@@ -0,0 +1,23 @@
+/*************************************************************************
+ *
+ * hal_hw.h
+ * Host stand-in for the SPX hal_hw.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_HAL_HW_H
+#define PDK_TEST_HAL_HW_H
+
+#include <stddef.h>
+
+#include "Types.h"
+
+typedef struct
+{
+    size_t  read_len;
+    INT8U  *pread_buf;
+} hal_t;
+
+// Provided by the test, stands in for the LPC snoop driver
+extern int snoop_read_current_bios_code(hal_t *phal);
+
+#endif // PDK_TEST_HAL_HW_H
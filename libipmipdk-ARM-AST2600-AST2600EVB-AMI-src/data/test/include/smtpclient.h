@@ -0,0 +1,32 @@
+/*************************************************************************
+ *
+ * smtpclient.h
+ * Host stand-in for the SPX smtpclient.h, used by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef PDK_TEST_SMTPCLIENT_H
+#define PDK_TEST_SMTPCLIENT_H
+
+#include "Types.h"
+
+#define EMAIL_ADDR_SIZE         64
+#define EMAIL_SUBJECT_SIZE      64
+#define EMAIL_MESSAGE_SIZE      512
+
+#define EMAIL_NO_CONNECT        2
+#define EMAIL_REJECTED          3
+
+typedef struct
+{
+    char    smtp_server [64];
+    INT16U  smtp_port;
+    char    from_addr [EMAIL_ADDR_SIZE];
+    char    to_addr [EMAIL_ADDR_SIZE];
+    char    Subject [EMAIL_SUBJECT_SIZE];
+    char    Message [EMAIL_MESSAGE_SIZE];
+} SMTP_STRUCT;
+
+// test/test_smtp.c, a minimal client for the loopback server of the tests
+extern int smtp_mail(SMTP_STRUCT *pmail);
+
+#endif // PDK_TEST_SMTPCLIENT_H
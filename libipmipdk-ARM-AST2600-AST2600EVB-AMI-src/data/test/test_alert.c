@@ -0,0 +1,293 @@
+/*************************************************************************
+ *
+ * test_alert.c
+ * Host test of the alert queue in OEMAlert.c against a loopback SMTP
+ * server
+ *
+ * Alerts go through the worker thread, the mail framing of the stand-in
+ * PDK_FrameAndSendMail and a real SMTP session on 127.0.0.1. The server
+ * keeps what every client sent, so the test checks the whole dialogue
+ * and the message body of each alert.
+ *
+ ************************************************************************/
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "Types.h"
+#include "PDKAlert.h"
+#include "smtpclient.h"
+#include "OEMAlert.h"
+#include "test_bmc.h"
+
+#define TEST_TRANSCRIPT_SIZE    8192
+
+static INT16U m_TestPort = 0;
+static volatile int m_TestServerUp = 1;
+static char m_TestTranscript[TEST_TRANSCRIPT_SIZE];
+static int m_TestTranscriptLen = 0;
+static pthread_mutex_t m_TestLock = PTHREAD_MUTEX_INITIALIZER;
+
+int PDK_FrameAndSendMail(void *pEventRecord, INT8U SetSelector, INT8U EthIndex, int BMCInst)
+{
+    const INT8U *pRecord = (const INT8U *)pEventRecord;
+    SMTP_STRUCT mail;
+    int i, len = 0;
+
+    (void)EthIndex;
+    (void)BMCInst;
+
+    memset(&mail, 0, sizeof(mail));
+    snprintf(mail.smtp_server, sizeof(mail.smtp_server), "127.0.0.1");
+    mail.smtp_port = m_TestPort;
+    snprintf(mail.from_addr, sizeof(mail.from_addr), "bmc@test");
+    snprintf(mail.to_addr, sizeof(mail.to_addr), "dest%d@test", SetSelector);
+    snprintf(mail.Subject, sizeof(mail.Subject), "Alert sensor 0x%02x", pRecord[11]);
+    for (i = 0; i < OEM_ALERT_RECORD_SIZE; i++)
+        len += snprintf(&mail.Message[len], sizeof(mail.Message) - len, "%02x", pRecord[i]);
+
+    return smtp_mail(&mail);
+}
+
+static int TestListen(void)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int fd, on = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(m_TestPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(fd, 4) != 0))
+    {
+        close(fd);
+        return -1;
+    }
+    getsockname(fd, (struct sockaddr *)&addr, &addr_len);
+    m_TestPort = ntohs(addr.sin_port);
+    return fd;
+}
+
+static void TestReply(int fd, const char *pReply)
+{
+    if (write(fd, pReply, strlen(pReply)) < 0)
+        g_TestFailed++;
+}
+
+/* One SMTP session, every line the client sends goes to the transcript */
+static void TestServe(int fd)
+{
+    char line[1024];
+    int len = 0, data = 0;
+
+    TestReply(fd, "220 test ESMTP\r\n");
+    while ((len < (int)sizeof(line) - 1) && (read(fd, &line[len], 1) == 1))
+    {
+        if (line[len++] != '\n')
+            continue;
+        line[len] = '\0';
+
+        pthread_mutex_lock(&m_TestLock);
+        if (m_TestTranscriptLen + len < TEST_TRANSCRIPT_SIZE)
+        {
+            memcpy(&m_TestTranscript[m_TestTranscriptLen], line, len);
+            m_TestTranscriptLen += len;
+        }
+        pthread_mutex_unlock(&m_TestLock);
+
+        if (data)
+        {
+            if (strcmp(line, ".\r\n") == 0)
+            {
+                data = 0;
+                TestReply(fd, "250 queued\r\n");
+            }
+        }
+        else if (strncmp(line, "DATA", 4) == 0)
+        {
+            data = 1;
+            TestReply(fd, "354 go ahead\r\n");
+        }
+        else if (strncmp(line, "QUIT", 4) == 0)
+        {
+            TestReply(fd, "221 bye\r\n");
+            break;
+        }
+        else
+        {
+            TestReply(fd, "250 ok\r\n");
+        }
+        len = 0;
+    }
+    close(fd);
+}
+
+/* Listens while m_TestServerUp is set, refuses connections otherwise */
+static void *TestServer(void *pArg)
+{
+    struct pollfd pfd;
+    int fd = *(int *)pArg;
+
+    for (;;)
+    {
+        if (m_TestServerUp && (fd < 0))
+            fd = TestListen();
+        if (!m_TestServerUp && (fd >= 0))
+        {
+            close(fd);
+            fd = -1;
+        }
+        if (fd < 0)
+        {
+            usleep(10000);
+            continue;
+        }
+
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, 10) == 1)
+            TestServe(accept(fd, NULL, NULL));
+    }
+    return NULL;
+}
+
+static OEMAlertStats_T TestStats(void)
+{
+    OEMAlertStats_T stats;
+
+    OEM_AlertGetStats(&stats);
+    return stats;
+}
+
+static int TestWaitSent(INT32U Sent, int TimeoutMs)
+{
+    while ((TestStats().Sent < Sent) && (TimeoutMs > 0))
+    {
+        usleep(10000);
+        TimeoutMs -= 10;
+    }
+    return TestStats().Sent >= Sent;
+}
+
+static void TestTranscriptReset(void)
+{
+    pthread_mutex_lock(&m_TestLock);
+    m_TestTranscriptLen = 0;
+    m_TestTranscript[0] = '\0';
+    pthread_mutex_unlock(&m_TestLock);
+}
+
+static int TestTranscriptIs(const char *pExpected)
+{
+    int ret;
+
+    pthread_mutex_lock(&m_TestLock);
+    m_TestTranscript[m_TestTranscriptLen] = '\0';
+    ret = (strcmp(m_TestTranscript, pExpected) == 0);
+    if (!ret)
+        printf("transcript:\n%s\nexpected:\n%s\n", m_TestTranscript, pExpected);
+    pthread_mutex_unlock(&m_TestLock);
+    return ret;
+}
+
+static void TestRecord(INT8U *pRecord, INT8U SensorNum)
+{
+    int i;
+
+    for (i = 0; i < OEM_ALERT_RECORD_SIZE; i++)
+        pRecord[i] = (INT8U)(0x10 + i);
+    pRecord[11] = SensorNum;
+}
+
+/* Expected session of one alert of TestRecord */
+static void TestSession(char *pBuf, size_t Size, INT8U SetSelector, INT8U SensorNum)
+{
+    snprintf(pBuf, Size,
+             "HELO bmc\r\n"
+             "MAIL FROM:<bmc@test>\r\n"
+             "RCPT TO:<dest%d@test>\r\n"
+             "DATA\r\n"
+             "Subject: Alert sensor 0x%02x\r\n"
+             "\r\n"
+             "101112131415161718191a%02x1c1d1e1f\r\n"
+             ".\r\n"
+             "QUIT\r\n",
+             SetSelector, SensorNum, SensorNum);
+}
+
+/* One alert, one full SMTP session with the record in the body */
+static void TestDialogue(void)
+{
+    char expected[1024];
+    INT8U record[OEM_ALERT_RECORD_SIZE];
+    INT32U sent = TestStats().Sent;
+
+    TestTranscriptReset();
+    TestRecord(record, 0x30);
+    TEST_CHECK(OEM_AlertEnqueue(record, 1, 0, 0) == 0);
+    TEST_CHECK(TestWaitSent(sent + 1, 5000));
+
+    TestSession(expected, sizeof(expected), 1, 0x30);
+    TEST_CHECK(TestTranscriptIs(expected));
+}
+
+/* Alerts to an unreachable server back off and go out in order later */
+static void TestServerDown(void)
+{
+    char expected[2048];
+    INT8U record[OEM_ALERT_RECORD_SIZE];
+    INT32U sent = TestStats().Sent;
+    INT32U retries = TestStats().Retries;
+    size_t len;
+    int i;
+
+    m_TestServerUp = 0;
+    usleep(100000);
+    TestTranscriptReset();
+
+    for (i = 0; i < 3; i++)
+    {
+        TestRecord(record, (INT8U)(0x40 + i));
+        TEST_CHECK(OEM_AlertEnqueue(record, 2, 0, 0) == 0);
+    }
+    for (i = 0; (i < 100) && (TestStats().Retries == retries); i++)
+        usleep(10000);
+    TEST_CHECK(TestStats().Retries > retries);
+    TEST_CHECK(TestStats().Sent == sent);
+
+    m_TestServerUp = 1;
+    TEST_CHECK(TestWaitSent(sent + 3, 5000));
+
+    for (i = 0, len = 0; i < 3; i++)
+    {
+        TestSession(&expected[len], sizeof(expected) - len, 2, (INT8U)(0x40 + i));
+        len += strlen(&expected[len]);
+    }
+    TEST_CHECK(TestTranscriptIs(expected));
+}
+
+int main(void)
+{
+    pthread_t thread_id;
+    int fd;
+
+    fd = TestListen();
+    TEST_CHECK(fd >= 0);
+    pthread_create(&thread_id, NULL, TestServer, &fd);
+
+    TestDialogue();
+    TestServerDown();
+
+    TEST_CHECK(TestStats().Failed == 0);
+    TEST_CHECK(TestStats().Dropped == 0);
+
+    printf("test_alert: %s\n", g_TestFailed ? "FAILED" : "passed");
+    return g_TestFailed ? 1 : 0;
+}
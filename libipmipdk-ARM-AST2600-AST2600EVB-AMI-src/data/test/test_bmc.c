@@ -0,0 +1,90 @@
+/*************************************************************************
+ *
+ * test_bmc.c
+ * BMC services stood in for by the PDK host tests
+ *
+ * The SEL NVR file is a RAM buffer; SEL entries added through
+ * API_ExecuteCmd are only counted.
+ *
+ ************************************************************************/
+#include <string.h>
+
+#include "Types.h"
+#include "API.h"
+#include "IPMIDefs.h"
+#include "IPMI_SEL.h"
+#include "test_bmc.h"
+
+int g_TestFailed = 0;
+
+static INT8U m_TestNVR[TEST_NVR_SIZE];
+static INT32U m_TestNVRLength = TEST_NVR_SIZE;
+static int m_TestNVRWrites = 0;
+static int m_TestSELAdded = 0;
+
+INT8U *TestNVR(void)
+{
+    return m_TestNVR;
+}
+
+void TestNVRReset(void)
+{
+    memset(m_TestNVR, 0, sizeof(m_TestNVR));
+    m_TestNVRLength = TEST_NVR_SIZE;
+    m_TestNVRWrites = 0;
+}
+
+void TestNVRSetLength(INT32U Length)
+{
+    m_TestNVRLength = Length;
+}
+
+int TestNVRWrites(void)
+{
+    return m_TestNVRWrites;
+}
+
+int TestSELAdded(void)
+{
+    return m_TestSELAdded;
+}
+
+int API_ReadNVR(char *pFile, INT32U Offset, INT32U Size, INT8U *pData)
+{
+    UN_USED(pFile);
+
+    if (Offset + Size > TEST_NVR_SIZE)
+        return -1;
+
+    /* A short file reads short */
+    if (Offset >= m_TestNVRLength)
+        return 0;
+    if (Offset + Size > m_TestNVRLength)
+        Size = m_TestNVRLength - Offset;
+
+    memcpy(pData, &m_TestNVR[Offset], Size);
+    return (int)Size;
+}
+
+int API_WriteNVR(char *pFile, INT32U Offset, INT32U Size, INT8U *pData)
+{
+    UN_USED(pFile);
+
+    if (Offset + Size > TEST_NVR_SIZE)
+        return -1;
+
+    memcpy(&m_TestNVR[Offset], pData, Size);
+    m_TestNVRWrites++;
+    return (int)Size;
+}
+
+int API_ExecuteCmd(MsgPkt_T *pMsgPkt, int BMCInst)
+{
+    UN_USED(BMCInst);
+
+    if (pMsgPkt->Cmd == CMD_ADD_SEL_ENTRY)
+        m_TestSELAdded++;
+
+    pMsgPkt->Data[0] = CC_SUCCESS;
+    return 0;
+}
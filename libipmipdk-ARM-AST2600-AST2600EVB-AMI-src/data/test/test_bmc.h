@@ -0,0 +1,33 @@
+/*************************************************************************
+ *
+ * test_bmc.h
+ * BMC services stood in for by the PDK host tests
+ *
+ ************************************************************************/
+#ifndef TEST_BMC_H
+#define TEST_BMC_H
+
+#include <stdio.h>
+
+#include "Types.h"
+
+#define TEST_NVR_SIZE           65536
+
+// Fails the test, and goes on with the next check
+#define TEST_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_TestFailed++; \
+        } \
+    } while (0)
+
+extern int g_TestFailed;
+
+extern INT8U *TestNVR(void);
+extern void TestNVRReset(void);
+extern void TestNVRSetLength(INT32U Length);
+extern int TestNVRWrites(void);
+extern int TestSELAdded(void);
+
+#endif // TEST_BMC_H
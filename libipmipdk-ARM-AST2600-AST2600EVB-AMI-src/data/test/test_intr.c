@@ -0,0 +1,99 @@
+/*************************************************************************
+ *
+ * test_intr.c
+ * Host test of the interrupt event ring in OEMIntr.c
+ *
+ ************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Types.h"
+#include "OEMIntr.h"
+#include "test_bmc.h"
+
+#define TEST_LINE               5
+#define TEST_WINDOW_MS          50
+
+static volatile int m_TestEvents = 0;
+static OEMIntrEvent_T m_TestLast;
+
+static void TestCallback(const OEMIntrEvent_T *pEvent, void *pCtx)
+{
+    (void)pCtx;
+
+    m_TestLast = *pEvent;
+    __atomic_add_fetch(&m_TestEvents, 1, __ATOMIC_RELEASE);
+}
+
+static int TestWaitEvents(int Count, int TimeoutMs)
+{
+    while ((__atomic_load_n(&m_TestEvents, __ATOMIC_ACQUIRE) < Count) && (TimeoutMs > 0))
+    {
+        usleep(1000);
+        TimeoutMs--;
+    }
+    return __atomic_load_n(&m_TestEvents, __ATOMIC_ACQUIRE);
+}
+
+/* The last edges of a burst arrive once the window is over, with the
+ * last level, even if no interrupt follows */
+static void TestBurstFlushed(void)
+{
+    OEMIntrLineStats_T stats;
+
+    OEM_IntrRecord(TEST_LINE, OEM_INTR_SRC_GPIO, 1);
+    TEST_CHECK(TestWaitEvents(1, 1000) == 1);
+    TEST_CHECK(m_TestLast.Level == 1);
+    TEST_CHECK(m_TestLast.Coalesced == 0);
+
+    OEM_IntrRecord(TEST_LINE, OEM_INTR_SRC_GPIO, 0);
+    OEM_IntrRecord(TEST_LINE, OEM_INTR_SRC_GPIO, 1);
+    OEM_IntrRecord(TEST_LINE, OEM_INTR_SRC_GPIO, 0);
+
+    /* Not before the window is over */
+    usleep(TEST_WINDOW_MS * 1000 / 2);
+    TEST_CHECK(__atomic_load_n(&m_TestEvents, __ATOMIC_ACQUIRE) == 1);
+
+    TEST_CHECK(TestWaitEvents(2, 1000) == 2);
+    TEST_CHECK(m_TestLast.Level == 0);
+    TEST_CHECK(m_TestLast.Coalesced == 2);
+
+    /* Nothing is delivered twice */
+    usleep(TEST_WINDOW_MS * 1000 * 2);
+    TEST_CHECK(__atomic_load_n(&m_TestEvents, __ATOMIC_ACQUIRE) == 2);
+
+    TEST_CHECK(OEM_IntrGetLineStats(TEST_LINE, &stats) == 0);
+    TEST_CHECK(stats.Count == 4);
+    TEST_CHECK(stats.Coalesced == 3);
+}
+
+/* An interrupt after the window still carries what was coalesced if the
+ * dispatcher has not flushed it yet, and is never counted twice */
+static void TestBurstThenEdge(void)
+{
+    int before = __atomic_load_n(&m_TestEvents, __ATOMIC_ACQUIRE);
+
+    OEM_IntrRecord(TEST_LINE, OEM_INTR_SRC_GPIO, 1);
+    OEM_IntrRecord(TEST_LINE, OEM_INTR_SRC_GPIO, 0);
+    usleep(TEST_WINDOW_MS * 1000 * 2);
+    OEM_IntrRecord(TEST_LINE, OEM_INTR_SRC_GPIO, 1);
+
+    TEST_CHECK(TestWaitEvents(before + 3, 1000) == before + 3);
+    usleep(TEST_WINDOW_MS * 1000 * 2);
+    TEST_CHECK(__atomic_load_n(&m_TestEvents, __ATOMIC_ACQUIRE) == before + 3);
+    TEST_CHECK(m_TestLast.Level == 1);
+}
+
+int main(void)
+{
+    TEST_CHECK(OEM_IntrInit() == 0);
+    TEST_CHECK(OEM_IntrSetCoalesceWindow(TEST_LINE, TEST_WINDOW_MS) == 0);
+    TEST_CHECK(OEM_IntrSubscribe(TEST_LINE, TestCallback, NULL) == 0);
+
+    TestBurstFlushed();
+    TestBurstThenEdge();
+
+    printf("test_intr: %s\n", g_TestFailed ? "FAILED" : "passed");
+    return g_TestFailed ? 1 : 0;
+}
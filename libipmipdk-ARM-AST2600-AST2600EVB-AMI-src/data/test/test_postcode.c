@@ -0,0 +1,143 @@
+/*************************************************************************
+ *
+ * test_postcode.c
+ * Host test of the POST code capture in OEMPostCode.c
+ *
+ * The snoop driver keeps the last 1024 codes of the current boot; once
+ * full it drops the oldest code for every new one.
+ *
+ ************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "Types.h"
+#include "hal_hw.h"
+#include "OEMPostCode.h"
+#include "test_bmc.h"
+
+#define TEST_SNOOP_SIZE         1024
+#define TEST_SENT_MAX           8192
+#define TEST_DUMP_FILE          "/tmp/test_postcode_dump"
+
+static INT8U m_TestSnoop[TEST_SNOOP_SIZE];
+static int m_TestSnoopLen = 0;
+static INT8U m_TestSent[TEST_SENT_MAX];
+static INT32U m_TestSentNum = 0;
+static INT32U m_TestSeed = 28;
+
+int snoop_read_current_bios_code(hal_t *phal)
+{
+    int len = (m_TestSnoopLen < (int)phal->read_len) ? m_TestSnoopLen : (int)phal->read_len;
+
+    memcpy(phal->pread_buf, m_TestSnoop, len);
+    return len;
+}
+
+// Pseudo random codes, so a window of the buffer does not show up twice
+static void TestSend(int Count)
+{
+    while (Count-- > 0)
+    {
+        m_TestSeed = m_TestSeed * 1103515245 + 12345;
+        m_TestSent[m_TestSentNum++] = (INT8U)(m_TestSeed >> 16);
+        if (m_TestSnoopLen == TEST_SNOOP_SIZE)
+        {
+            memmove(m_TestSnoop, &m_TestSnoop[1], TEST_SNOOP_SIZE - 1);
+            m_TestSnoopLen--;
+        }
+        m_TestSnoop[m_TestSnoopLen++] = m_TestSent[m_TestSentNum - 1];
+    }
+}
+
+// The last Count codes captured are the last Count codes sent
+static int TestLastMatch(int Count)
+{
+    OEMPostCode_T codes[OEM_POSTCODE_RING_SIZE];
+    int i;
+
+    if (OEM_GetLastPostCodes(codes, Count) != Count)
+        return 0;
+
+    for (i = 0; i < Count; i++)
+    {
+        if (codes[i].Code != m_TestSent[m_TestSentNum - Count + i])
+            return 0;
+    }
+    return 1;
+}
+
+// The dump holds the last OEM_POSTCODE_DUMP_COUNT codes, oldest first
+static int TestDumpMatch(void)
+{
+    char line[64];
+    unsigned int boot, code;
+    unsigned long long ms;
+    FILE *fp;
+    int count = 0, ok = 1;
+
+    fp = fopen(TEST_DUMP_FILE, "r");
+    if (fp == NULL)
+        return 0;
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (line[0] == '#')
+            continue;
+        if ((sscanf(line, "%u %llu %x", &boot, &ms, &code) != 3) ||
+            (code != m_TestSent[m_TestSentNum - OEM_POSTCODE_DUMP_COUNT + count]))
+            ok = 0;
+        count++;
+    }
+    fclose(fp);
+    return ok && (count == OEM_POSTCODE_DUMP_COUNT);
+}
+
+int main(void)
+{
+    // Fills up the driver buffer, then runs on past it
+    TestSend(1000);
+    OEM_PostCodeCapture();
+    TEST_CHECK(OEM_GetPostCodeTotal() == 1000);
+
+    TestSend(100);
+    OEM_PostCodeCapture();
+    TEST_CHECK(OEM_GetPostCodeTotal() == 1100);
+    TEST_CHECK(TestLastMatch(100));
+
+    TestSend(300);
+    OEM_PostCodeCapture();
+    TEST_CHECK(OEM_GetPostCodeTotal() == 1400);
+    TEST_CHECK(TestLastMatch(300));
+
+    // Nothing new
+    OEM_PostCodeCapture();
+    TEST_CHECK(OEM_GetPostCodeTotal() == 1400);
+
+    // More than the whole buffer between two captures
+    TestSend(2 * TEST_SNOOP_SIZE);
+    OEM_PostCodeCapture();
+    TEST_CHECK(OEM_GetPostCodeTotal() == 1400 + TEST_SNOOP_SIZE);
+    TEST_CHECK(TestLastMatch(TEST_SNOOP_SIZE));
+
+    // A new boot starts a new buffer
+    OEM_PostCodeHostReset();
+    m_TestSnoopLen = 0;
+    TestSend(10);
+    OEM_PostCodeCapture();
+    TEST_CHECK(OEM_GetPostCodeTotal() == 1410 + TEST_SNOOP_SIZE);
+    TEST_CHECK(TestLastMatch(10));
+
+    // The dump is only rewritten when new codes came in
+    remove(TEST_DUMP_FILE);
+    TEST_CHECK(OEM_PostCodeDump(TEST_DUMP_FILE) == 1);
+    TEST_CHECK(TestDumpMatch());
+    TEST_CHECK(OEM_PostCodeDump(TEST_DUMP_FILE) == 0);
+    TestSend(5);
+    OEM_PostCodeCapture();
+    TEST_CHECK(OEM_PostCodeDump(TEST_DUMP_FILE) == 1);
+    TEST_CHECK(TestDumpMatch());
+    remove(TEST_DUMP_FILE);
+
+    printf("test_postcode: %s\n", g_TestFailed ? "FAILED" : "passed");
+    return g_TestFailed ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+/*************************************************************************
+ *
+ * test_sdr.c
+ * Host test of the sensor number indexed SDR view in OEMSDR.c
+ *
+ * The repository is built in a buffer laid out like the core's SDR RAM
+ * copy, a header followed by the records, and walked by the stand-in
+ * SDR_GetFirstSDRRec and SDR_GetNextSDRRec below.
+ *
+ ************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Types.h"
+#include "IPMIConf.h"
+#include "IPMI_SDRRecord.h"
+#include "SDRFunc.h"
+#include "OEMSDR.h"
+#include "test_bmc.h"
+
+#define TEST_SDR_SIZE           1024
+
+BMCInfo_t g_BMCInfo[1] = { { { NULL, PTHREAD_MUTEX_INITIALIZER } } };
+
+static INT8U m_TestSDR[TEST_SDR_SIZE];
+static INT32U m_TestSDRLen;
+
+SDRRecHdr_T *SDR_GetFirstSDRRec(int BMCInst)
+{
+    (void)BMCInst;
+
+    return (SDRRecHdr_T *)&m_TestSDR[sizeof(SDRRepository_T)];
+}
+
+SDRRecHdr_T *SDR_GetNextSDRRec(SDRRecHdr_T *pSDRRec, int BMCInst)
+{
+    INT8U *pNext = (INT8U *)pSDRRec + sizeof(SDRRecHdr_T) + pSDRRec->Len;
+
+    (void)BMCInst;
+
+    return (pNext < &m_TestSDR[m_TestSDRLen]) ? (SDRRecHdr_T *)pNext : NULL;
+}
+
+static void TestSDRReset(void)
+{
+    memset(m_TestSDR, 0, sizeof(m_TestSDR));
+    m_TestSDRLen = sizeof(SDRRepository_T);
+    g_BMCInfo[0].SDRConfig.SDRRAM = (SDRRepository_T *)m_TestSDR;
+}
+
+static INT32U TestSDRAdd(const void *pRec, INT32U Size)
+{
+    INT32U offset = m_TestSDRLen;
+    SDRRecHdr_T *pHdr;
+
+    memcpy(&m_TestSDR[offset], pRec, Size);
+    pHdr = (SDRRecHdr_T *)&m_TestSDR[offset];
+    pHdr->Len = (INT8U)(Size - sizeof(SDRRecHdr_T));
+    m_TestSDRLen += Size;
+    g_BMCInfo[0].SDRConfig.SDRRAM->NumRecords++;
+    return offset;
+}
+
+/* M and B are 10 bit two's complement, split over two bytes */
+static INT32U TestAddFull(INT16U RecID, INT8U LUN, INT8U SensorNum, INT8U Format, int M, int B, int RExp, int BExp)
+{
+    FullSensorRec_T rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.hdr.ID         = RecID;
+    rec.hdr.Type       = FULL_SDR_REC;
+    rec.OwnerLUN       = LUN;
+    rec.SensorNum      = SensorNum;
+    rec.SensorType     = 0x01;
+    rec.EventTypeCode  = 0x01;
+    rec.Units1         = (INT8U)(Format << 6);
+    rec.M              = (INT8U)(M & 0xFF);
+    rec.M_Tolerance    = (INT8U)((M >> 2) & 0xC0);
+    rec.B              = (INT8U)(B & 0xFF);
+    rec.B_Accuracy     = (INT8U)((B >> 2) & 0xC0);
+    rec.R_B_Exp        = (INT8U)(((RExp & 0x0F) << 4) | (BExp & 0x0F));
+    return TestSDRAdd(&rec, sizeof(rec));
+}
+
+static INT32U TestAddCompact(INT16U RecID, INT8U SensorNum, INT8U SensorType)
+{
+    CompactSensorRec_T rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.hdr.ID         = RecID;
+    rec.hdr.Type       = COMPACT_SDR_REC;
+    rec.SensorNum      = SensorNum;
+    rec.SensorType     = SensorType;
+    rec.EventTypeCode  = 0x6F;
+    return TestSDRAdd(&rec, sizeof(rec));
+}
+
+static int TestNear(float Value, float Expected)
+{
+    return fabsf(Value - Expected) < 0.001f;
+}
+
+/* Every record is found by LUN and number, with its own offset and factors */
+static void TestIndex(void)
+{
+    OEMSDRSensor_T sensor;
+    INT32U full_offset, compact_offset;
+    float value;
+
+    TestSDRReset();
+    full_offset = TestAddFull(1, 0, 0x30, OEM_SDR_FORMAT_UNSIGNED, 2, -5, -1, 1);
+    compact_offset = TestAddCompact(2, 0x31, 0x04);
+    TestAddFull(3, 1, 0x30, OEM_SDR_FORMAT_2S_COMP, 1, 0, 0, 0);
+
+    TEST_CHECK(OEM_SDRBuildIndex(0) == 3);
+
+    TEST_CHECK(OEM_SDRGetSensor(0x30, 0, &sensor) == 0);
+    TEST_CHECK(sensor.RecID == 1);
+    TEST_CHECK(sensor.RecOffset == full_offset);
+    TEST_CHECK(sensor.Linear == 1);
+    TEST_CHECK(TestNear(sensor.Scale, 0.2f));
+    TEST_CHECK(TestNear(sensor.BOffset, -5.0f));
+
+    TEST_CHECK(OEM_SDRGetSensor(0x31, 0, &sensor) == 0);
+    TEST_CHECK(sensor.RecOffset == compact_offset);
+    TEST_CHECK(OEM_SDRGetSensorType(0x31, 0) == 0x04);
+    TEST_CHECK(OEM_SDRGetSensorType(0x32, 0) == -1);
+
+    /* y = (2 * 100 + -5 * 10) / 10 */
+    TEST_CHECK(OEM_SDRConvertReading(0x30, 0, 100, &value) == 0);
+    TEST_CHECK(TestNear(value, 15.0f));
+
+    /* Same number on LUN 1, signed reading */
+    TEST_CHECK(OEM_SDRConvertReading(0x30, 1, 0xFE, &value) == 0);
+    TEST_CHECK(TestNear(value, -2.0f));
+
+    /* Compact records have no conversion */
+    TEST_CHECK(OEM_SDRConvertReading(0x31, 0, 10, &value) == -1);
+}
+
+/* A stale index is not used, the timer tick rebuilds it */
+static void TestInvalidate(void)
+{
+    TestSDRReset();
+    TestAddCompact(1, 0x40, 0x04);
+    TEST_CHECK(OEM_SDRBuildIndex(0) == 1);
+
+    TestAddCompact(2, 0x41, 0x02);
+    OEM_SDRInvalidateIndex();
+    TEST_CHECK(OEM_SDRGetSensorType(0x40, 0) == -1);
+
+    TEST_CHECK(OEM_SDRIndexTick(0) == 2);
+    TEST_CHECK(OEM_SDRIndexTick(0) == 0);
+    TEST_CHECK(OEM_SDRGetSensorType(0x40, 0) == 0x04);
+    TEST_CHECK(OEM_SDRGetSensorType(0x41, 0) == 0x02);
+}
+
+int main(void)
+{
+    TestIndex();
+    TestInvalidate();
+
+    printf("test_sdr: %s\n", g_TestFailed ? "FAILED" : "passed");
+    return g_TestFailed ? 1 : 0;
+}
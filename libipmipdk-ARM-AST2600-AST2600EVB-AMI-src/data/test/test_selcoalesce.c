@@ -0,0 +1,132 @@
+/*************************************************************************
+ *
+ * test_selcoalesce.c
+ * Host test of the SEL event storm coalescing in OEMSEL.c
+ *
+ ************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Types.h"
+#include "IPMI_SEL.h"
+#include "OEMSEL.h"
+#include "test_bmc.h"
+
+#define TEST_SELECT_TBL         0x03
+#define TEST_ASSERT             0x01
+#define TEST_DEASSERT           0x81
+#define TEST_CONFIG_FILE        "/tmp/test_selcoalesce.conf"
+
+static INT8U TestEvent(INT8U SensorNum, INT8U EvtDirType)
+{
+    SELEventRecord_T record;
+
+    memset(&record, 0, sizeof(record));
+    record.hdr.Type   = 0x02;
+    record.GenID[0]   = 0x20;
+    record.SensorType = 0x04;
+    record.SensorNum  = SensorNum;
+    record.EvtDirType = EvtDirType;
+    record.EvtData1   = 0x52;
+    return OEM_SELCoalesce((INT8U *)&record, TEST_SELECT_TBL);
+}
+
+/* Repeats of one event are folded into one summary */
+static void TestRepeats(void)
+{
+    int added = TestSELAdded();
+
+    TEST_CHECK(TestEvent(0x30, TEST_ASSERT) == TEST_SELECT_TBL);
+    TEST_CHECK(TestEvent(0x30, TEST_ASSERT) == 0);
+    TEST_CHECK(TestEvent(0x30, TEST_ASSERT) == 0);
+
+    /* The window is still open, no summary yet */
+    OEM_SELCoalesceTick(0);
+    TEST_CHECK(TestSELAdded() == added);
+}
+
+/* Assert, deassert, assert: every transition gets through */
+static void TestFlap(void)
+{
+    int added = TestSELAdded();
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        TEST_CHECK(TestEvent(0x31, TEST_ASSERT) == TEST_SELECT_TBL);
+        TEST_CHECK(TestEvent(0x31, TEST_DEASSERT) == TEST_SELECT_TBL);
+    }
+
+    /* Nothing was suppressed, so no summary either */
+    OEM_SELCoalesceTick(0);
+    TEST_CHECK(TestSELAdded() == added);
+}
+
+/* Repeats, then a new state: the summary of the repeats is logged right
+ * away and the old state is let through again */
+static void TestRepeatsThenFlap(void)
+{
+    int added = TestSELAdded();
+
+    TEST_CHECK(TestEvent(0x32, TEST_ASSERT) == TEST_SELECT_TBL);
+    TEST_CHECK(TestEvent(0x32, TEST_ASSERT) == 0);
+    TEST_CHECK(TestEvent(0x32, TEST_DEASSERT) == TEST_SELECT_TBL);
+    TEST_CHECK(TestEvent(0x32, TEST_ASSERT) == TEST_SELECT_TBL);
+
+    OEM_SELCoalesceTick(0);
+    TEST_CHECK(TestSELAdded() == added + 1);
+}
+
+/* Another sensor does not close the slot */
+static void TestOtherSensor(void)
+{
+    TEST_CHECK(TestEvent(0x33, TEST_ASSERT) == TEST_SELECT_TBL);
+    TEST_CHECK(TestEvent(0x34, TEST_DEASSERT) == TEST_SELECT_TBL);
+    TEST_CHECK(TestEvent(0x33, TEST_ASSERT) == 0);
+}
+
+/* The config file sets the rate limits; a bad line is skipped, the rest applies */
+static void TestLoadConfig(void)
+{
+    FILE *fp;
+
+    unlink(TEST_CONFIG_FILE);
+    TEST_CHECK(OEM_SELLoadConfig(TEST_CONFIG_FILE) == 0);
+
+    fp = fopen(TEST_CONFIG_FILE, "w");
+    TEST_CHECK(fp != NULL);
+    if (fp == NULL)
+        return;
+    fprintf(fp, "# storm settings\n"
+                "coalesce_window 60\n"
+                "rate_limit any 0\n"
+                "rate_limit 0x40 2\n"
+                "rate_limit 0x400 2\n");
+    fclose(fp);
+
+    TEST_CHECK(OEM_SELLoadConfig(TEST_CONFIG_FILE) == -1);
+    unlink(TEST_CONFIG_FILE);
+
+    /* Transitions are not coalesced, only the limit stops the third */
+    TEST_CHECK(TestEvent(0x40, TEST_ASSERT) == TEST_SELECT_TBL);
+    TEST_CHECK(TestEvent(0x40, TEST_DEASSERT) == TEST_SELECT_TBL);
+    TEST_CHECK(TestEvent(0x40, TEST_ASSERT) == 0);
+    TEST_CHECK(TestEvent(0x41, TEST_ASSERT) == TEST_SELECT_TBL);
+    TEST_CHECK(TestEvent(0x41, TEST_DEASSERT) == TEST_SELECT_TBL);
+    TEST_CHECK(TestEvent(0x41, TEST_ASSERT) == TEST_SELECT_TBL);
+}
+
+int main(void)
+{
+    OEM_SELSetRateLimit(OEM_SEL_SENSOR_ANY, 0);
+
+    TestRepeats();
+    TestFlap();
+    TestRepeatsThenFlap();
+    TestOtherSensor();
+    TestLoadConfig();
+
+    printf("test_selcoalesce: %s\n", g_TestFailed ? "FAILED" : "passed");
+    return g_TestFailed ? 1 : 0;
+}
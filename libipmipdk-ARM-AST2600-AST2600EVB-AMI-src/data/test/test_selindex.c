@@ -0,0 +1,227 @@
+/*************************************************************************
+ *
+ * test_selindex.c
+ * Host test of the SEL index in OEMSEL.c
+ *
+ * Records are stored the way the core does it: written to the SEL file
+ * through PDKWriteSEL, then reported through OEM_SELIndexAdd as
+ * PDK_PostAddSEL does.
+ *
+ ************************************************************************/
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Types.h"
+#include "IPMIDefs.h"
+#include "SEL.h"
+#include "PDKSEL.h"
+#include "OEMSEL.h"
+#include "test_bmc.h"
+
+#define TEST_SEL_RECORDS        8
+#define TEST_SEL_SIZE           (offsetof(SELRepository_T, SELRecord) + TEST_SEL_RECORDS * sizeof(SELRec_T))
+
+static INT8U m_Repository[TEST_NVR_SIZE];
+
+static INT32U TestRecordOffset(INT32U Pos)
+{
+    return offsetof(SELRepository_T, SELRecord) + Pos * sizeof(SELRec_T);
+}
+
+static void TestFillRecord(SELRec_T *pRec, INT16U RecID)
+{
+    memset(pRec, 0, sizeof(SELRec_T));
+    pRec->Valid                   = VALID_RECORD;
+    pRec->Len                     = sizeof(SELEventRecord_T);
+    pRec->EvtRecord.hdr.ID        = RecID;
+    pRec->EvtRecord.hdr.Type      = 0x02;
+    pRec->EvtRecord.hdr.TimeStamp = 1000 + RecID;
+    pRec->EvtRecord.SensorType    = 0x04;
+    pRec->EvtRecord.SensorNum     = 0x30;
+}
+
+/* Stores a record at a repository position, as the core does */
+static void TestAddRecord(INT32U Pos, INT16U RecID)
+{
+    SELRec_T rec;
+
+    TestFillRecord(&rec, RecID);
+    TEST_CHECK(PDKWriteSEL((INT8U *)&rec, TestRecordOffset(Pos), sizeof(rec), 0) == (int)sizeof(rec));
+    OEM_SELIndexAdd((INT8U *)&rec.EvtRecord);
+}
+
+/* Returns the number of indexed records, oldest first in pRecIDs */
+static int TestQueryAll(INT16U *pRecIDs)
+{
+    OEMSELQuery_T query = { OEM_SEL_KEY_TIME, 0, 0, 0xFFFFFFFF };
+    OEMSELIndexEntry_T entries[OEM_SEL_INDEX_MAX];
+    INT16U next;
+    int count, i;
+
+    count = OEM_SELQuery(&query, 0, entries, OEM_SEL_INDEX_MAX, &next);
+    for (i = 0; (i < count) && (pRecIDs != NULL); i++)
+        pRecIDs[i] = entries[i].RecID;
+    return count;
+}
+
+static int TestIndexed(INT16U RecID)
+{
+    INT16U ids[OEM_SEL_INDEX_MAX];
+    int count = TestQueryAll(ids), i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (ids[i] == RecID)
+            return 1;
+    }
+    return 0;
+}
+
+/* Loads a repository of Count records through PDKInitNVRSEL */
+static void TestLoad(int Count)
+{
+    int i;
+
+    OEM_SELJournalFlush();
+    TestNVRReset();
+    for (i = 0; i < Count; i++)
+        TestFillRecord((SELRec_T *)&TestNVR()[TestRecordOffset(i)], (INT16U)(i + 1));
+
+    TEST_CHECK(PDKInitNVRSEL(m_Repository, TEST_SEL_SIZE, 0) == (int)TEST_SEL_SIZE);
+    TEST_CHECK(TestQueryAll(NULL) == Count);
+}
+
+/* A short read only indexes what was read, not what was in the buffer */
+static void TestShortRead(void)
+{
+    TestLoad(0);
+
+    memset(m_Repository, 0, sizeof(m_Repository));
+    TestFillRecord((SELRec_T *)&m_Repository[TestRecordOffset(0)], 100);
+    TestFillRecord((SELRec_T *)&m_Repository[TestRecordOffset(1)], 101);
+    TestFillRecord((SELRec_T *)&TestNVR()[TestRecordOffset(0)], 1);
+    TestNVRSetLength(TestRecordOffset(1));
+
+    TEST_CHECK(PDKInitNVRSEL(m_Repository, TEST_SEL_SIZE, 0) == (int)TestRecordOffset(1));
+    TEST_CHECK(TestQueryAll(NULL) == 1);
+    TEST_CHECK(TestIndexed(1));
+    TEST_CHECK(!TestIndexed(101));
+}
+
+/* A full circular SEL overwrites its oldest record */
+static void TestCircularOverwrite(void)
+{
+    INT16U ids[OEM_SEL_INDEX_MAX];
+    int i;
+
+    TestLoad(TEST_SEL_RECORDS);
+
+    for (i = 0; i < TEST_SEL_RECORDS + 3; i++)
+        TestAddRecord(i % TEST_SEL_RECORDS, (INT16U)(TEST_SEL_RECORDS + 1 + i));
+
+    TEST_CHECK(TestQueryAll(ids) == TEST_SEL_RECORDS);
+    for (i = 0; i < TEST_SEL_RECORDS; i++)
+        TEST_CHECK(ids[i] == 3 + TEST_SEL_RECORDS + 1 + i);
+}
+
+/* The record added before the write that stores it is dropped all the same */
+static void TestAddBeforeWrite(void)
+{
+    SELRec_T rec;
+
+    TestLoad(TEST_SEL_RECORDS);
+
+    TestFillRecord(&rec, 50);
+    OEM_SELIndexAdd((INT8U *)&rec.EvtRecord);
+    TEST_CHECK(PDKWriteSEL((INT8U *)&rec, TestRecordOffset(0), sizeof(rec), 0) == (int)sizeof(rec));
+
+    TEST_CHECK(TestQueryAll(NULL) == TEST_SEL_RECORDS);
+    TEST_CHECK(!TestIndexed(1));
+    TEST_CHECK(TestIndexed(50));
+}
+
+/* Deleting clears the Valid byte, on its own or with the whole record */
+static void TestDelete(void)
+{
+    SELRec_T rec;
+    INT8U invalid = 0;
+
+    TestLoad(TEST_SEL_RECORDS);
+
+    TEST_CHECK(PDKWriteSEL(&invalid, TestRecordOffset(2) + offsetof(SELRec_T, Valid), 1, 0) == 1);
+    TEST_CHECK(!TestIndexed(3));
+
+    TestFillRecord(&rec, 5);
+    rec.Valid = 0;
+    TEST_CHECK(PDKWriteSEL((INT8U *)&rec, TestRecordOffset(4), sizeof(rec), 0) == (int)sizeof(rec));
+    TEST_CHECK(!TestIndexed(5));
+
+    TEST_CHECK(TestQueryAll(NULL) == TEST_SEL_RECORDS - 2);
+
+    /* The freed slots are used again */
+    TestAddRecord(2, 60);
+    TestAddRecord(4, 61);
+    TEST_CHECK(TestQueryAll(NULL) == TEST_SEL_RECORDS);
+    TEST_CHECK(TestIndexed(60) && TestIndexed(61));
+}
+
+/* Clearing empties the index, and the rewritten repository adds nothing */
+static void TestClear(void)
+{
+    INT8U empty[TEST_SEL_SIZE];
+
+    TestLoad(TEST_SEL_RECORDS);
+
+    OEM_SELIndexClear();
+    memset(empty, 0, sizeof(empty));
+    TEST_CHECK(PDKWriteSEL(empty, 0, sizeof(empty), 0) == (int)sizeof(empty));
+    TEST_CHECK(TestQueryAll(NULL) == 0);
+
+    TestAddRecord(0, 70);
+    TEST_CHECK(TestQueryAll(NULL) == 1);
+}
+
+/* The OEM SEL query command pages through the index and checks its request */
+static void TestQueryCmd(void)
+{
+    OEMSELQueryReq_T req = { OEM_SEL_KEY_SENSOR_TYPE, 0x04, 0, 0xFFFFFFFF, 0, 3 };
+    OEMSELQueryRes_T res;
+    INT16U expect = 1;
+    int len, pages = 0, i;
+
+    TestLoad(TEST_SEL_RECORDS);
+
+    do
+    {
+        len = OEM_SELQueryCmd((INT8U *)&req, sizeof(req), (INT8U *)&res, 0);
+        TEST_CHECK(res.CompletionCode == CC_NORMAL);
+        TEST_CHECK(len == (int)(offsetof(OEMSELQueryRes_T, Entry) + res.Count * sizeof(OEMSELIndexEntry_T)));
+        for (i = 0; i < res.Count; i++)
+            TEST_CHECK(res.Entry[i].RecID == expect++);
+        req.Cursor = res.NextCursor;
+        pages++;
+    } while ((res.NextCursor != OEM_SEL_QUERY_END) && (pages < TEST_SEL_RECORDS));
+    TEST_CHECK(pages == 3);
+    TEST_CHECK(expect == TEST_SEL_RECORDS + 1);
+
+    TEST_CHECK(OEM_SELQueryCmd((INT8U *)&req, sizeof(req) - 1, (INT8U *)&res, 0) == 1);
+    TEST_CHECK(res.CompletionCode == CC_REQ_INV_LEN);
+
+    req.Key = OEM_SEL_KEY_MAX;
+    TEST_CHECK(OEM_SELQueryCmd((INT8U *)&req, sizeof(req), (INT8U *)&res, 0) == 1);
+    TEST_CHECK(res.CompletionCode == CC_INV_DATA_FIELD);
+}
+
+int main(void)
+{
+    TestShortRead();
+    TestCircularOverwrite();
+    TestAddBeforeWrite();
+    TestDelete();
+    TestClear();
+    TestQueryCmd();
+
+    printf("test_selindex: %s\n", g_TestFailed ? "FAILED" : "passed");
+    return g_TestFailed ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/*************************************************************************
+ *
+ * test_seljournal.c
+ * Host test of the SEL write-back journal in OEMSEL.c
+ *
+ * Every scenario applies the same writes to a reference copy of the SEL
+ * file, in the order they are made, and compares it with the NVR file
+ * after the journal is flushed.
+ *
+ ************************************************************************/
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Types.h"
+#include "SEL.h"
+#include "PDKSEL.h"
+#include "OEMSEL.h"
+#include "test_bmc.h"
+
+static INT8U m_Expected[TEST_NVR_SIZE];
+
+static void TestReset(void)
+{
+    OEM_SELJournalFlush();
+    TestNVRReset();
+    memset(m_Expected, 0, sizeof(m_Expected));
+}
+
+static void TestWrite(INT32U Offset, INT32U Size, INT8U Fill)
+{
+    INT8U data[TEST_NVR_SIZE];
+
+    memset(data, Fill, Size);
+    TEST_CHECK(PDKWriteSEL(data, Offset, Size, 0) == (int)Size);
+    memcpy(&m_Expected[Offset], data, Size);
+}
+
+static void TestWriteRecord(INT32U Slot, INT32U Offset, INT32U Size, INT8U Fill)
+{
+    TestWrite(offsetof(SELRepository_T, SELRecord) + Slot * sizeof(SELRec_T) + Offset, Size, Fill);
+}
+
+static int TestMatches(void)
+{
+    return memcmp(TestNVR(), m_Expected, TEST_NVR_SIZE) == 0;
+}
+
+/* Two overlapping writes to one SEL record, then a rewrite contained in
+ * the older write but overlapping the newer one */
+static void TestOverlapSameRecord(void)
+{
+    TestReset();
+
+    TestWriteRecord(3, 0, 12, 0x11);
+    TestWriteRecord(3, 8, sizeof(SELRec_T) - 8, 0x22);
+    TestWriteRecord(3, 2, 8, 0x33);
+
+    TEST_CHECK(TestNVRWrites() == 0);
+    TEST_CHECK(OEM_SELJournalFlush() == 0);
+    TEST_CHECK(TestMatches());
+}
+
+/* A record rewritten in place, e.g. the repository header */
+static void TestRewriteInPlace(void)
+{
+    OEMSELJournalStats_T before, after;
+
+    TestReset();
+    OEM_SELJournalGetStats(&before);
+
+    TestWriteRecord(0, 0, sizeof(SELRec_T), 0x44);
+    TestWriteRecord(1, 0, sizeof(SELRec_T), 0x55);
+    TestWrite(0, 8, 0x66);
+    TestWriteRecord(0, 2, 4, 0x77);
+
+    TEST_CHECK(OEM_SELJournalFlush() == 0);
+    TEST_CHECK(TestMatches());
+
+    OEM_SELJournalGetStats(&after);
+    /* Header, records 0 and 1, header again: the last two fold in */
+    TEST_CHECK(after.FlushedExtents - before.FlushedExtents == 2);
+}
+
+/* Random overlapping writes over a few records, flushed now and then */
+static void TestRandomOverlaps(void)
+{
+    INT32U span = 8 * sizeof(SELRec_T);
+    INT32U offset, size;
+    int i;
+
+    TestReset();
+    srand(29);
+
+    for (i = 0; i < 5000; i++)
+    {
+        offset = rand() % span;
+        size = 1 + rand() % sizeof(SELRec_T);
+        if (offset + size > span)
+            size = span - offset;
+
+        TestWrite(offset, size, (INT8U)(i + 1));
+        if ((rand() % 50) == 0)
+        {
+            TEST_CHECK(OEM_SELJournalFlush() == 0);
+            TEST_CHECK(TestMatches());
+        }
+    }
+
+    TEST_CHECK(OEM_SELJournalFlush() == 0);
+    TEST_CHECK(TestMatches());
+}
+
+/* Too large for the journal, written through after what is pending */
+static void TestWriteThrough(void)
+{
+    TestReset();
+
+    TestWriteRecord(0, 0, sizeof(SELRec_T), 0x88);
+    TestWrite(0, OEM_SEL_JOURNAL_HIGH_WATER + 1, 0x99);
+    TEST_CHECK(TestMatches());
+}
+
+int main(void)
+{
+    TestOverlapSameRecord();
+    TestRewriteInPlace();
+    TestRandomOverlaps();
+    TestWriteThrough();
+
+    printf("test_seljournal: %s\n", g_TestFailed ? "FAILED" : "passed");
+    return g_TestFailed ? 1 : 0;
+}
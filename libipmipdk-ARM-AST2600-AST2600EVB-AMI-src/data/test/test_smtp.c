@@ -0,0 +1,79 @@
+/*************************************************************************
+ *
+ * test_smtp.c
+ * Minimal SMTP client standing in for the SPX smtpclient library, enough
+ * to talk to the loopback server of the PDK host tests
+ *
+ ************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "Types.h"
+#include "smtpclient.h"
+
+/* Sends a line, if any, and returns the code of the reply, -1 on failure */
+static int TestSMTPCommand(int fd, const char *pLine)
+{
+    char reply[256];
+    int len = 0, ret;
+
+    if ((pLine != NULL) && (write(fd, pLine, strlen(pLine)) != (ssize_t)strlen(pLine)))
+        return -1;
+
+    while (len < (int)sizeof(reply) - 1)
+    {
+        ret = read(fd, &reply[len], 1);
+        if (ret <= 0)
+            return -1;
+        if (reply[len++] == '\n')
+            break;
+    }
+    reply[len] = '\0';
+    return atoi(reply);
+}
+
+int smtp_mail(SMTP_STRUCT *pmail)
+{
+    struct sockaddr_in addr;
+    char line[EMAIL_MESSAGE_SIZE + EMAIL_SUBJECT_SIZE + 32];
+    int fd, ret = EMAIL_REJECTED;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(pmail->smtp_port);
+    if (inet_pton(AF_INET, pmail->smtp_server, &addr.sin_addr) != 1)
+        return EMAIL_NO_CONNECT;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return EMAIL_NO_CONNECT;
+    if ((connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (TestSMTPCommand(fd, NULL) != 220))
+    {
+        close(fd);
+        return EMAIL_NO_CONNECT;
+    }
+
+    if (TestSMTPCommand(fd, "HELO bmc\r\n") != 250)
+        goto END;
+    snprintf(line, sizeof(line), "MAIL FROM:<%s>\r\n", pmail->from_addr);
+    if (TestSMTPCommand(fd, line) != 250)
+        goto END;
+    snprintf(line, sizeof(line), "RCPT TO:<%s>\r\n", pmail->to_addr);
+    if (TestSMTPCommand(fd, line) != 250)
+        goto END;
+    if (TestSMTPCommand(fd, "DATA\r\n") != 354)
+        goto END;
+    snprintf(line, sizeof(line), "Subject: %s\r\n\r\n%s\r\n.\r\n", pmail->Subject, pmail->Message);
+    if (TestSMTPCommand(fd, line) != 250)
+        goto END;
+    TestSMTPCommand(fd, "QUIT\r\n");
+    ret = 0;
+
+END:
+    close(fd);
+    return ret;
+}
@@ -3,6 +3,17 @@
 
 #include "Types.h"
 
+// One cycle for a caller that drives the loop itself, a no-op while the
+// FSC thread runs
 extern int FanControlLoop(int BMCInst);
 
+// FSC thread, runs the loop at the configured period
+extern int FSCStart(int BMCInst);
+extern void FSCStop(void);
+extern int FSCThreadRunning(void);
+
+// Between the FSC thread and the loop
+extern int FSCLoadLoop(void);
+extern int FSCLoopCycle(int BMCInst);
+
 #endif // FSC_H
\ No newline at end of file
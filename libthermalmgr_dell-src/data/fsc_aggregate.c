@@ -0,0 +1,132 @@
+/*************************************************************************
+ *
+ * fsc_aggregate.c
+ * Single pass aggregation of profile outputs into a fan PWM
+ *
+ * Outputs are added one at a time and only a few running values are
+ * kept, so the system and every zone are combined in the same pass over
+ * the profiles. The soft-max is computed as a running log-sum-exp
+ * rescaled to the highest output seen, which cannot overflow.
+ *
+ ************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Types.h"
+#include "fsc.h"
+#include "fsc_parser.h"
+#include "fsc_utils.h"
+#include "fsc_core.h"
+#include "fsc_aggregate.h"
+
+/**
+ * @fn FSCAggregateInit
+ * @brief Starts a new aggregation.
+ * @param[out] pAgg Aggregator to start.
+ * @param[in] pConfig How the outputs are combined.
+ */
+void FSCAggregateInit(FSCAggregator *pAgg, const FSC_JSON_AGGREGATION *pConfig)
+{
+    memset(pAgg, 0, sizeof(FSCAggregator));
+    pAgg->pConfig = pConfig;
+}
+
+/**
+ * @fn FSCAggregateAdd
+ * @brief Adds the valid output of one profile.
+ * @param[in,out] pAgg Aggregator.
+ * @param[in] pwm Profile output.
+ * @param[in] weight Profile weight, only used by weighted_mean.
+ */
+void FSCAggregateAdd(FSCAggregator *pAgg, INT8U pwm, float weight)
+{
+    float value = pwm;
+
+    switch (pAgg->pConfig->Type)
+    {
+        case FSC_AGG_WEIGHTED_MEAN:
+            pAgg->Sum += weight * value;
+            pAgg->WeightSum += weight;
+            break;
+
+        case FSC_AGG_SOFT_MAX:
+            if (pAgg->Num == 0)
+            {
+                pAgg->Sum = 1;
+            }
+            else if (value > pAgg->First)
+            {
+                pAgg->Sum = pAgg->Sum * expf((pAgg->First - value) / pAgg->pConfig->Softness) + 1;
+            }
+            else
+            {
+                pAgg->Sum += expf((value - pAgg->First) / pAgg->pConfig->Softness);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (pAgg->Num == 0 || value > pAgg->First)
+    {
+        pAgg->Second = pAgg->First;
+        pAgg->First = value;
+    }
+    else if (value > pAgg->Second)
+    {
+        pAgg->Second = value;
+    }
+
+    pAgg->Num++;
+}
+
+/**
+ * @fn FSCAggregateResult
+ * @brief Combined PWM of the outputs added so far, bounded by fan_max_pwm.
+ * @param[in] pAgg Aggregator.
+ * @param[in] fallback PWM returned when no output was added.
+ * @return Combined PWM.
+ */
+INT8U FSCAggregateResult(const FSCAggregator *pAgg, INT8U fallback)
+{
+    float result;
+
+    if (pAgg->Num == 0)
+    {
+        return fallback;
+    }
+
+    switch (pAgg->pConfig->Type)
+    {
+        case FSC_AGG_WEIGHTED_MEAN:
+            // With every weight 0, fall back to the highest output
+            result = (pAgg->WeightSum > 0) ? pAgg->Sum / pAgg->WeightSum : pAgg->First;
+            break;
+
+        case FSC_AGG_MAX_MARGIN:
+            result = pAgg->First + pAgg->pConfig->MarginGain * pAgg->Second;
+            break;
+
+        case FSC_AGG_SOFT_MAX:
+            result = pAgg->First + pAgg->pConfig->Softness * logf(pAgg->Sum);
+            break;
+
+        case FSC_AGG_MAX:
+        default:
+            result = pAgg->First;
+            break;
+    }
+
+    if (result > g_FscSystemInfo.FanMaxPWM)
+    {
+        result = g_FscSystemInfo.FanMaxPWM;
+    }
+    if (result < 0)
+    {
+        result = 0;
+    }
+
+    return (INT8U)roundf(result);
+}
@@ -0,0 +1,28 @@
+/*************************************************************************
+ *
+ * fsc_aggregate.h
+ * Single pass aggregation of profile outputs into a fan PWM
+ *
+ ************************************************************************/
+#ifndef FSC_AGGREGATE_H
+#define FSC_AGGREGATE_H
+
+#include "Types.h"
+#include "fsc.h"
+#include "fsc_parser.h"
+
+typedef struct
+{
+    const FSC_JSON_AGGREGATION *pConfig;
+    INT8U  Num;                             // Outputs added so far
+    float  First;                           // Highest output
+    float  Second;                          // Second highest output
+    float  Sum;                             // Weighted sum, or sum of exp((pwm - First) / Softness)
+    float  WeightSum;                       // Sum of the weights
+} FSCAggregator;
+
+extern void FSCAggregateInit(FSCAggregator *pAgg, const FSC_JSON_AGGREGATION *pConfig);
+extern void FSCAggregateAdd(FSCAggregator *pAgg, INT8U pwm, float weight);
+extern INT8U FSCAggregateResult(const FSCAggregator *pAgg, INT8U fallback);
+
+#endif // FSC_AGGREGATE_H
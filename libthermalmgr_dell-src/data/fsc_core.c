@@ -14,9 +14,11 @@
 #include "fsc_core.h"
 #include "fsc.h"
 #include "fsc_utils.h"
+#include "fsc_telemetry.h"
 
 FSCTempSensor pFSCTempSensorInfo[FSC_SENSOR_CNT_MAX];
 FSCAmbientCalibration g_AmbientCalibration;
+float g_FscCycleScale = 1.0;
 
 /*---------------------------------------------------------------------------
 * @fn FSCGetPWMValue_PID
@@ -26,10 +28,13 @@ FSCAmbientCalibration g_AmbientCalibration;
 int FSCGetPWMValue_PID(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo, INT8U verbose, int BMCInst)
 {
     UN_USED(BMCInst);
+    UN_USED(verbose);
 
     FSCPID pPIDInfo;
 
     float CurrentPWM = 0.0;
+    float d_term = 0.0;
+    float last_scale = 0.0;
     INT16S p_temp = 0.0;
     INT16S i_temp = 0.0;
     INT16S d_temp = 0.0;
@@ -42,11 +47,6 @@ int FSCGetPWMValue_PID(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo, INT8U
 
     if(pFSCTempSensorInfo->Present == SENSOR_SCAN_DISABLE)
     {
-        if(verbose > 1)
-        {
-            FSCPRINT(" > PID - %-20s is disabled \n", pFSCTempSensorInfo->Label);
-        }
-
         return -1;
     }
 
@@ -56,44 +56,47 @@ int FSCGetPWMValue_PID(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo, INT8U
     pPIDInfo.SetPoint = pFSCTempSensorInfo->fscparam.pidparam.SetPoint;
     pPIDInfo.SetPointType = pFSCTempSensorInfo->fscparam.pidparam.SetPointType;
 
-    if(verbose > 1)
-    {
-        FSCPRINT(" > P = %4.2f, I = %4.2f, D = %4.2f, Setpoint = %d, SetpointType = %d\n",
-                         pPIDInfo.Pvalue, pPIDInfo.Ivalue, pPIDInfo.Dvalue, pPIDInfo.SetPoint, pPIDInfo.SetPointType );
-    }
-
     p_temp = pFSCTempSensorInfo->CurrentTemp - pFSCTempSensorInfo->LastTemp;
     i_temp = (pFSCTempSensorInfo->CurrentTemp) - (pPIDInfo.SetPoint);
     d_temp = pFSCTempSensorInfo->CurrentTemp - 2 * pFSCTempSensorInfo->LastTemp + pFSCTempSensorInfo->LastLastTemp;
 
+    // Right after a period change the two differences span different
+    // periods, each is turned into a rate per nominal period on its own
+    last_scale = (pFSCTempSensorInfo->LastCycleScale > 0) ? pFSCTempSensorInfo->LastCycleScale : g_FscCycleScale;
+    if (last_scale == g_FscCycleScale)
+    {
+        d_term = d_temp / g_FscCycleScale;
+    }
+    else
+    {
+        d_term = (pFSCTempSensorInfo->CurrentTemp - pFSCTempSensorInfo->LastTemp) / g_FscCycleScale
+                 - (pFSCTempSensorInfo->LastTemp - pFSCTempSensorInfo->LastLastTemp) / last_scale;
+    }
+
+    // Gains are tuned per nominal period; P acts on a difference and needs no scaling
     CurrentPWM = pFSCTempSensorInfo->LastPWM
                  + pPIDInfo.Pvalue * p_temp
-                 + pPIDInfo.Ivalue * i_temp
-                 + pPIDInfo.Dvalue * d_temp;
+                 + pPIDInfo.Ivalue * i_temp * g_FscCycleScale
+                 + pPIDInfo.Dvalue * d_term;
 
-
-    if(verbose > 1)
-    {
-        FSCPRINT(" > %-20s = %4d, lastTemp = %4d, lastlastTemp = %4d, currentPWM = %d,lastPWM = %02d\n",
-                         pFSCTempSensorInfo->Label, pFSCTempSensorInfo->CurrentTemp, (int)pFSCTempSensorInfo->LastTemp,
-                         (int)pFSCTempSensorInfo->LastLastTemp,(int)CurrentPWM,(int)(pFSCTempSensorInfo->LastPWM));
-    }
+    pFSCTempSensorInfo->RawPWM = CurrentPWM;
 
     if(CurrentPWM > pFSCTempSensorInfo->MaxPWM)
+    {
         CurrentPWM = pFSCTempSensorInfo->MaxPWM;
+        pFSCTempSensorInfo->Flags |= FSC_TLM_CLAMP_MAX;
+    }
 
     if(CurrentPWM < pFSCTempSensorInfo->MinPWM)
-        CurrentPWM = pFSCTempSensorInfo->MinPWM;
-
-    if(verbose > 0)
     {
-        FSCPRINT("%-20s = %4d, currentPWM = %2d\n",
-                         pFSCTempSensorInfo->Label, pFSCTempSensorInfo->CurrentTemp, (int)CurrentPWM);
+        CurrentPWM = pFSCTempSensorInfo->MinPWM;
+        pFSCTempSensorInfo->Flags |= FSC_TLM_CLAMP_MIN;
     }
 
     pFSCTempSensorInfo->LastPWM = CurrentPWM;
     pFSCTempSensorInfo->LastLastTemp = pFSCTempSensorInfo->LastTemp;
     pFSCTempSensorInfo->LastTemp = pFSCTempSensorInfo->CurrentTemp;
+    pFSCTempSensorInfo->LastCycleScale = g_FscCycleScale;
 
     *PWMValue = round(CurrentPWM);
 
@@ -102,6 +105,24 @@ int FSCGetPWMValue_PID(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo, INT8U
 }
 
 
+/*---------------------------------------------------------------------------
+* @fn FSCScaleRate
+*
+* @brief Scales a rate limit per nominal period to the period of this cycle,
+*        a limit that is not zero stays at least 1.
+*---------------------------------------------------------------------------*/
+static INT16S FSCScaleRate(INT8U rate)
+{
+    INT16S scaled = (INT16S)(rate * g_FscCycleScale + 0.5);
+
+    if (scaled < 1 && rate > 0)
+    {
+        scaled = 1;
+    }
+
+    return scaled;
+}
+
 /*---------------------------------------------------------------------------
 * @fn FSCGetAmbientTemperature
 *
@@ -112,6 +133,8 @@ float FSCGetAmbientTemperature(INT16S inlet_temp, INT8U last_pwm, INT8U verbose)
 {
     float delta_temp = 0.0;
     int i;
+
+    UN_USED(verbose);
     
     if (g_AmbientCalibration.CalType == FSC_AMBIENT_CAL_POLYNOMIAL)
     {
@@ -122,11 +145,6 @@ float FSCGetAmbientTemperature(INT16S inlet_temp, INT8U last_pwm, INT8U verbose)
             delta_temp += g_AmbientCalibration.Coefficients[i] * pwm_power;
             pwm_power *= last_pwm;
         }
-        
-        if (verbose > 1)
-        {
-            FSCPRINT(" > Ambient Cal (Polynomial): PWM=%d, ΔT=%.2f\n", last_pwm, delta_temp);
-        }
     }
     else if (g_AmbientCalibration.CalType == FSC_AMBIENT_CAL_PIECEWISE)
     {
@@ -161,20 +179,10 @@ float FSCGetAmbientTemperature(INT16S inlet_temp, INT8U last_pwm, INT8U verbose)
                 }
             }
         }
-        
-        if (verbose > 1)
-        {
-            FSCPRINT(" > Ambient Cal (Piecewise): PWM=%d, ΔT=%.2f\n", last_pwm, delta_temp);
-        }
     }
     
     float ambient_temp = inlet_temp - delta_temp;
     
-    if (verbose > 0)
-    {
-        FSCPRINT("Inlet=%d, ΔT=%.2f, Ambient=%.2f\n", inlet_temp, delta_temp, ambient_temp);
-    }
-    
     return ambient_temp;
 }
 
@@ -186,6 +194,7 @@ float FSCGetAmbientTemperature(INT16S inlet_temp, INT8U last_pwm, INT8U verbose)
 int FSCGetPWMValue_Polynomial(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo, INT8U verbose, int BMCInst)
 {
     UN_USED(BMCInst);
+    UN_USED(verbose);
     
     FSCPolynomial *pPolynomial = NULL;
     INT16S CurrentPWM = 0;
@@ -200,10 +209,6 @@ int FSCGetPWMValue_Polynomial(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo
 
     if(pFSCTempSensorInfo->Present == SENSOR_SCAN_DISABLE)
     {
-        if(verbose > 1)
-        {
-            FSCPRINT(" > Polynomial - %-20s is disabled \n", pFSCTempSensorInfo->Label);
-        }
         return -1;
     }
     
@@ -212,17 +217,13 @@ int FSCGetPWMValue_Polynomial(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo
     // Convert inlet temperature to ambient temperature using calibration
     ambient_temp = FSCGetAmbientTemperature(pFSCTempSensorInfo->CurrentTemp, 
                                           pFSCTempSensorInfo->LastPWM, verbose);
+    pFSCTempSensorInfo->Ambient = ambient_temp;
     
     // Filter dirty data - same as linear algorithm
     if(abs(pFSCTempSensorInfo->CurrentTemp - pFSCTempSensorInfo->LastTemp) > TEMP_READING_RANGE)
     {
-        if(verbose > 1)
-        {
-            FSCPRINT(" > %-20s = %4d, lastTemp = %4d, currentPWM = %02d, lastPWM = %02d - Reading change large than %d, ignore\n",
-                             pFSCTempSensorInfo->Label, (int)pFSCTempSensorInfo->CurrentTemp, (int)pFSCTempSensorInfo->LastTemp,
-                             (int)CurrentPWM, (int)pFSCTempSensorInfo->LastPWM, TEMP_READING_RANGE);
-        }
-
+        pFSCTempSensorInfo->Flags |= FSC_TLM_FILTERED;
+        pFSCTempSensorInfo->RawPWM = pFSCTempSensorInfo->LastPWM;
         pFSCTempSensorInfo->LastTemp = pFSCTempSensorInfo->CurrentTemp;
         *PWMValue = pFSCTempSensorInfo->LastPWM;
         return 0;
@@ -278,6 +279,8 @@ int FSCGetPWMValue_Polynomial(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo
         }
     }
     
+    pFSCTempSensorInfo->RawPWM = CurrentPWM;
+
     // Apply hysteresis for temperature declining
     if(ambient_temp < (pFSCTempSensorInfo->LastTemp - g_AmbientCalibration.PiecewisePoints[0].delta_temp))
     {
@@ -302,10 +305,7 @@ int FSCGetPWMValue_Polynomial(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo
             }
         }
         
-        if(verbose > 1)
-        {
-            FSCPRINT(" > PWM: %d, Ambient Temp Declining with Hysteresis\n", CurrentPWM);
-        }
+        pFSCTempSensorInfo->Flags |= FSC_TLM_HYSTERESIS;
     }
     
     // Apply rate limiting
@@ -315,12 +315,12 @@ int FSCGetPWMValue_Polynomial(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo
     if (pwm_diff > 0)
     {
         // Rising rate limit
-        max_change = pPolynomial->MaxRisingRate;
+        max_change = FSCScaleRate(pPolynomial->MaxRisingRate);
     }
     else if (pwm_diff < 0)
     {
         // Falling rate limit
-        max_change = pPolynomial->MaxFallingRate;
+        max_change = FSCScaleRate(pPolynomial->MaxFallingRate);
         pwm_diff = -pwm_diff; // Make positive for comparison
     }
     
@@ -335,23 +335,20 @@ int FSCGetPWMValue_Polynomial(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo
             CurrentPWM = pFSCTempSensorInfo->LastPWM - max_change;
         }
         
-        if(verbose > 1)
-        {
-            FSCPRINT(" > PWM rate limited: %d\n", CurrentPWM);
-        }
+        pFSCTempSensorInfo->Flags |= FSC_TLM_RATE_LIMITED;
     }
     
     // Boundary clamping
     if(CurrentPWM > (INT16S)pFSCTempSensorInfo->MaxPWM)
+    {
         CurrentPWM = (INT16S)pFSCTempSensorInfo->MaxPWM;
+        pFSCTempSensorInfo->Flags |= FSC_TLM_CLAMP_MAX;
+    }
 
     if(CurrentPWM < (INT16S)pFSCTempSensorInfo->MinPWM)
-        CurrentPWM = (INT16S)pFSCTempSensorInfo->MinPWM;
-    
-    if(verbose > 0)
     {
-        FSCPRINT("%-20s Ambient=%.1f, currentPWM = %2d\n",
-                         pFSCTempSensorInfo->Label, ambient_temp, (INT8U)CurrentPWM);
+        CurrentPWM = (INT16S)pFSCTempSensorInfo->MinPWM;
+        pFSCTempSensorInfo->Flags |= FSC_TLM_CLAMP_MIN;
     }
     
     pFSCTempSensorInfo->LastTemp = pFSCTempSensorInfo->CurrentTemp;
@@ -375,26 +372,22 @@ int FSCGetPWMValue(INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo, INT8U ver
 
     if(pFSCTempSensorInfo != NULL)
     {
+        // Intermediate results for the telemetry, see fsc_telemetry.h
+        pFSCTempSensorInfo->Flags = 0;
+        pFSCTempSensorInfo->Ambient = 0;
+        pFSCTempSensorInfo->RawPWM = 0;
 
         switch(pFSCTempSensorInfo->Algorithm)
         {
             case FSC_CTL_PID:
 
                 ret = FSCGetPWMValue_PID(PWMValue, pFSCTempSensorInfo, verbose, BMCInst);
-                if(verbose > 2)
-                {
-                    FSCPRINT("  >> Get PID    PWM ret: %d\n", ret);
-                }
 
                 return ret;
 
             case FSC_CTL_POLYNOMIAL:
 
                 ret = FSCGetPWMValue_Polynomial(PWMValue, pFSCTempSensorInfo, verbose, BMCInst);
-                if(verbose > 2)
-                {
-                    FSCPRINT("  >> Get POLYNOMIAL PWM ret: %d\n", ret);
-                }
 
                 return ret;
                 
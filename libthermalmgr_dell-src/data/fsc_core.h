@@ -15,6 +15,12 @@
 #define FSC_CTL_PID             1
 #define FSC_CTL_POLYNOMIAL      2 //polynomial
 
+// Profile output aggregation
+#define FSC_AGG_MAX             0
+#define FSC_AGG_WEIGHTED_MEAN   1 // sum of weight * pwm over the sum of weights
+#define FSC_AGG_MAX_MARGIN      2 // max plus a share of the second highest
+#define FSC_AGG_SOFT_MAX        3 // log-sum-exp
+
 // Ambient calibration algorithm types
 #define FSC_AMBIENT_CAL_POLYNOMIAL  0
 #define FSC_AMBIENT_CAL_PIECEWISE   1
@@ -85,8 +91,8 @@ typedef struct
         INT8U pwm;                          // PWM value at this temperature
     } PiecewisePoints[MAX_PIECEWISE_POINTS];
     INT8U FallingHyst;                      // Falling hysteresis in degrees C (default 2)
-    INT8U MaxRisingRate;                    // Maximum rising rate %/cycle (default 10)
-    INT8U MaxFallingRate;                   // Maximum falling rate %/cycle (default 5)
+    INT8U MaxRisingRate;                    // Maximum rising rate %/nominal period (default 10)
+    INT8U MaxFallingRate;                   // Maximum falling rate %/nominal period (default 5)
 } PACKED FSCPolynomial;
 
 typedef struct
@@ -96,6 +102,7 @@ typedef struct
     float  LastPWM;                 // Last PWM generated by this location
     INT16S LastTemp;                // Last max temp of this location
     INT16S LastLastTemp;
+    float  LastCycleScale;          // g_FscCycleScale of the cycle LastTemp was read in, 0 = none yet
     INT8U  Present;                 // Indicate whether current sensor is present or not
                                     // 0 = absent
                                     // 1 = present
@@ -104,6 +111,10 @@ typedef struct
     char  Label[32];
     INT8U  Algorithm;
     INT8U  CurrentPWM;
+    INT8U  OutputValid;             // 1 = CurrentPWM was computed this cycle
+    INT8U  Flags;                   // FSC_TLM_* profile flags of the last computation
+    float  Ambient;                 // Ambient of the last computation, polynomial only
+    float  RawPWM;                  // PWM of the last computation before limiting and clamping
     union fscparam_t{
         FSCPID pidparam;
         FSCLinear linearparam;
@@ -114,6 +125,7 @@ typedef struct
 
 extern FSCTempSensor pFSCTempSensorInfo[FSC_SENSOR_CNT_MAX];
 extern FSCAmbientCalibration g_AmbientCalibration;
+extern float g_FscCycleScale;       // Period of this cycle over the nominal period
 
 extern int FSCGetPWMValue( INT8U *PWMValue, FSCTempSensor *pFSCTempSensorInfo, INT8U verbose, int BMCInst );
 extern float FSCGetAmbientTemperature(INT16S inlet_temp, INT8U last_pwm, INT8U verbose);
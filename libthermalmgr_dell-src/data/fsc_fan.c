@@ -0,0 +1,331 @@
+/*************************************************************************
+ *
+ * fsc_fan.c
+ * Chassis fan status, fan redundancy policy and per-tray PWM output
+ *
+ ************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "IPMIConf.h"
+#include "SensorAPI.h"
+#include "OEMFAN.h"
+#include "OEMSensor.h"
+#include "fsc.h"
+#include "fsc_parser.h"
+#include "fsc_utils.h"
+#include "fsc_fan.h"
+#include "fsc_fanhealth.h"
+#include "fsc_record.h"
+#include "fsc_timing.h"
+
+FSCFanTray g_FscFanTray[SYS_FAN_NUM_MAX];
+FSCFanRedundancyState g_FscFanRedundancyState;
+
+// Trays whose last write succeeded, with their presence and the time then (ns)
+static INT8U m_TrayPWMSet[SYS_FAN_NUM_MAX];
+static INT8U m_TrayPWMPresent[SYS_FAN_NUM_MAX];
+static INT64U m_TrayPWMTime[SYS_FAN_NUM_MAX];
+
+// RPM sensors filled by PDK_PreMonitorFanSensors, front rotor first
+static const INT8U m_FanRPMSensor[SYS_FAN_NUM_MAX][FSC_FAN_ROTOR_MAX] =
+{
+    { FAN1_FRONT_RPM_SENSOR, FAN1_REAR_RPM_SENSOR },
+    { FAN2_FRONT_RPM_SENSOR, FAN2_REAR_RPM_SENSOR },
+    { FAN3_FRONT_RPM_SENSOR, FAN3_REAR_RPM_SENSOR },
+    { FAN4_FRONT_RPM_SENSOR, FAN4_REAR_RPM_SENSOR },
+    { FAN5_FRONT_RPM_SENSOR, FAN5_REAR_RPM_SENSOR },
+};
+
+/**
+ * @fn FSCFanUsedNum
+ * @return Number of fan trays the configuration uses, bounded by the chassis.
+ */
+INT8U FSCFanUsedNum(void)
+{
+    if (g_FscSystemInfo.ChassisFanUsedNum > SYS_FAN_NUM_MAX)
+    {
+        return SYS_FAN_NUM_MAX;
+    }
+    return g_FscSystemInfo.ChassisFanUsedNum;
+}
+
+/**
+ * @fn FSCFanRotorNum
+ * @return Number of rotors per fan tray, bounded by FSC_FAN_ROTOR_MAX.
+ */
+INT8U FSCFanRotorNum(void)
+{
+    if (g_FscSystemInfo.ChassisFanRotorNum > FSC_FAN_ROTOR_MAX)
+    {
+        return FSC_FAN_ROTOR_MAX;
+    }
+    return g_FscSystemInfo.ChassisFanRotorNum;
+}
+
+/**
+ * @fn FSCFanRotorSensor
+ * @param[in] fan_id The fan tray ID (SYS_FAN1, SYS_FAN2, etc.).
+ * @param[in] rotor Rotor index in g_FscFanTray, 0 is the front rotor.
+ * @return RPM sensor number of the rotor.
+ */
+INT8U FSCFanRotorSensor(INT8U fan_id, INT8U rotor)
+{
+    return m_FanRPMSensor[fan_id][rotor];
+}
+
+/**
+ * @fn FSCUpdateFanStatus
+ * @brief Refreshes g_FscFanTray for every used fan tray.
+ *
+ * Presence is read from the fan board CPLD. RPM comes from the fan RPM
+ * sensors the sensor scan already reads, so the tachometers are not read
+ * a second time.
+ * @param[in] BMCInst The BMC instance number.
+ * @return 0 on success, -1 if the presence of a tray could not be read.
+ */
+int FSCUpdateFanStatus(int BMCInst)
+{
+    SensorInfo_T* pSensorInfo = NULL;
+    INT8U used_num = FSCFanUsedNum();
+    INT8U rotor_num = FSCFanRotorNum();
+    int present;
+    int ret = 0;
+    int i, j;
+
+    for (i = 0; i < used_num; i++)
+    {
+        present = FSCRecordGetFanTrayPresent(i);
+        if (present < 0)
+        {
+            // Keep the last known presence
+            ret = -1;
+        }
+        else
+        {
+            g_FscFanTray[i].Present = (FAN_PRESENT == present) ? 1 : 0;
+        }
+
+        for (j = 0; j < rotor_num; j++)
+        {
+            g_FscFanTray[i].RotorValid[j] = 0;
+            g_FscFanTray[i].RotorRPM[j] = 0;
+
+            if (!g_FscFanTray[i].Present)
+            {
+                continue;
+            }
+
+            pSensorInfo = FSCRecordGetSensorInfo(m_FanRPMSensor[i][j], BMCInst);
+            if (pSensorInfo && pSensorInfo->Err != CC_DEST_UNAVAILABLE &&
+                (pSensorInfo->EventFlags & 0x20) != 0x20) // Bit 5 -  Unable to read
+            {
+                g_FscFanTray[i].RotorValid[j] = 1;
+                g_FscFanTray[i].RotorRPM[j] = (INT16U)(pSensorInfo->SensorReading * FAN_RPM_MULTIPLIER);
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @fn FSCApplyRedundancyPolicy
+ * @brief Raises the fan tray PWMs when fan redundancy is lost.
+ *
+ * Counts the healthy rotors of the used trays; a rotor with a health
+ * warning counts as lost, so a failing fan is compensated for before it
+ * stops. Rotors lost beyond the redundant trays (chassis_fan_redundant_num)
+ * select the boost level with the highest lost_rotor_num not above that
+ * count, and every tray PWM is scaled and offset by it. The number of
+ * missing trays then selects a minimum PWM the same way. The results are
+ * bounded by fan_max_pwm.
+ * @param[in,out] tray_pwm PWM for each of the SYS_FAN_NUM_MAX trays.
+ * @param[in] verbose Verbosity level for debug printing.
+ */
+void FSCApplyRedundancyPolicy(INT8U *tray_pwm, INT8U verbose)
+{
+    FSCFanRedundancyState *pState = &g_FscFanRedundancyState;
+    const FSC_JSON_FAN_REDUNDANCY *pPolicy = &g_FscFanRedundancy;
+    const FSC_JSON_BOOST_LEVEL *pLevel = NULL;
+    INT8U used_num = FSCFanUsedNum();
+    INT8U rotor_num = FSCFanRotorNum();
+    INT8U allowed_lost = 0;
+    INT8U floor_pwm = 0;
+    int boost_pwm;
+    int i, j;
+
+    pState->Boosted = 0;
+
+    if (!pPolicy->Enable)
+    {
+        return;
+    }
+
+    pState->ExpectedRotorNum = used_num * rotor_num;
+    pState->HealthyRotorNum = 0;
+    pState->MissingFanNum = 0;
+
+    for (i = 0; i < used_num; i++)
+    {
+        if (!g_FscFanTray[i].Present)
+        {
+            pState->MissingFanNum++;
+            continue;
+        }
+
+        for (j = 0; j < rotor_num; j++)
+        {
+            if (g_FscFanTray[i].RotorValid[j] && g_FscFanTray[i].RotorRPM[j] >= pPolicy->RotorMinRPM &&
+                !FSCFanHealthSuspect(i, j))
+            {
+                pState->HealthyRotorNum++;
+            }
+        }
+    }
+
+    allowed_lost = g_FscSystemInfo.ChassisFanRedundantNum * rotor_num;
+    pState->LostRotorNum = pState->ExpectedRotorNum - pState->HealthyRotorNum;
+    pState->LostRotorNum = (pState->LostRotorNum > allowed_lost) ? (pState->LostRotorNum - allowed_lost) : 0;
+
+    for (i = 0; i < pPolicy->BoostLevelNum; i++)
+    {
+        if (pPolicy->BoostLevel[i].LostRotorNum <= pState->LostRotorNum &&
+            (pLevel == NULL || pPolicy->BoostLevel[i].LostRotorNum > pLevel->LostRotorNum))
+        {
+            pLevel = &pPolicy->BoostLevel[i];
+        }
+    }
+
+    for (i = 0; i < pPolicy->FloorNum; i++)
+    {
+        if (pPolicy->Floor[i].MissingFanNum <= pState->MissingFanNum &&
+            pPolicy->Floor[i].MinPWM > floor_pwm)
+        {
+            floor_pwm = pPolicy->Floor[i].MinPWM;
+        }
+    }
+
+    if (pLevel == NULL && floor_pwm == 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+    {
+        boost_pwm = tray_pwm[i];
+
+        if (pLevel != NULL)
+        {
+            boost_pwm = (boost_pwm * pLevel->PwmGain) / 100 + pLevel->PwmOffset;
+        }
+
+        if (boost_pwm < floor_pwm)
+        {
+            boost_pwm = floor_pwm;
+        }
+
+        if (boost_pwm > g_FscSystemInfo.FanMaxPWM)
+        {
+            boost_pwm = g_FscSystemInfo.FanMaxPWM;
+        }
+
+        if (boost_pwm != tray_pwm[i])
+        {
+            pState->Boosted = 1;
+            if (verbose > 0)
+            {
+                FSCTRACE("Fan redundancy: healthy rotors %d/%d, missing fans %d, Fan%d PWM %d -> %d\n",
+                         pState->HealthyRotorNum, pState->ExpectedRotorNum, pState->MissingFanNum,
+                         i + 1, tray_pwm[i], boost_pwm);
+            }
+        }
+
+        tray_pwm[i] = (INT8U)boost_pwm;
+    }
+}
+
+/**
+ * @fn FSCFanTrayRPM
+ * @brief Averages the readable rotors of a fan tray.
+ * @param[in] fan_id The fan tray ID (SYS_FAN1, SYS_FAN2, etc.).
+ * @return Tray RPM, 0 if no rotor could be read.
+ */
+INT16U FSCFanTrayRPM(INT8U fan_id)
+{
+    INT8U rotor_num = FSCFanRotorNum();
+    INT32U rpm_sum = 0;
+    int valid_num = 0;
+    int j;
+
+    if (fan_id >= SYS_FAN_NUM_MAX || !g_FscFanTray[fan_id].Present)
+    {
+        return 0;
+    }
+
+    for (j = 0; j < rotor_num; j++)
+    {
+        if (g_FscFanTray[fan_id].RotorValid[j])
+        {
+            rpm_sum += g_FscFanTray[fan_id].RotorRPM[j];
+            valid_num++;
+        }
+    }
+
+    return valid_num ? (INT16U)(rpm_sum / valid_num) : 0;
+}
+
+/**
+ * @fn FSCFanTrayRefresh
+ * @brief Makes the next cycle write every tray, whether its PWM changed or not.
+ */
+void FSCFanTrayRefresh(void)
+{
+    memset(m_TrayPWMSet, 0, sizeof(m_TrayPWMSet));
+}
+
+/**
+ * @fn FSCSetFanTraysPWM
+ * @brief Writes one PWM per fan tray and remembers what was written.
+ *
+ * A tray already running at its PWM is not written again, unless its
+ * presence changed or FSC_FAN_PWM_REFRESH_SEC went by. Trays whose
+ * write failed are retried every cycle.
+ * @param[in] tray_pwm PWM for each of the SYS_FAN_NUM_MAX trays.
+ * @return 0 on success, -1 if any tray could not be set.
+ */
+int FSCSetFanTraysPWM(const INT8U *tray_pwm)
+{
+    INT64U now = FSCTimingNow();
+    INT8U written = 0;
+    int final_ret = 0;
+    int i;
+
+    for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+    {
+        g_FscFanTray[i].PrevPWM = g_FscFanTray[i].CommandPWM;
+
+        if (m_TrayPWMSet[i] && tray_pwm[i] == g_FscFanTray[i].CommandPWM &&
+            m_TrayPWMPresent[i] == g_FscFanTray[i].Present &&
+            now - m_TrayPWMTime[i] < FSC_FAN_PWM_REFRESH_SEC * 1000000000ull)
+            continue;
+
+        written++;
+        m_TrayPWMPresent[i] = g_FscFanTray[i].Present;
+        m_TrayPWMTime[i] = now;
+
+        // OEM_SetFanTrayPWM returns -1 if the fan is absent or if the write fails.
+        if (FSCRecordSetFanTrayPWM(i, tray_pwm[i]) != 0)
+        {
+            g_FscFanTray[i].CommandPWM = 0;
+            m_TrayPWMSet[i] = 0;
+            final_ret = -1;
+            continue;
+        }
+        g_FscFanTray[i].CommandPWM = tray_pwm[i];
+        m_TrayPWMSet[i] = 1;
+    }
+
+    FSCTimingCountTrays(written, SYS_FAN_NUM_MAX - written);
+    return final_ret;
+}
@@ -0,0 +1,50 @@
+/*************************************************************************
+ *
+ * fsc_fan.h
+ * Chassis fan status, fan redundancy policy and per-tray PWM output
+ *
+ ************************************************************************/
+#ifndef FSC_FAN_H
+#define FSC_FAN_H
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "fsc.h"
+
+#define FSC_FAN_ROTOR_MAX       2
+
+// A tray kept at the same PWM is written again after this many seconds,
+// whatever the period of the loop
+#define FSC_FAN_PWM_REFRESH_SEC     60
+
+typedef struct
+{
+    INT8U  Present;                         // 1 = tray present
+    INT8U  RotorValid[FSC_FAN_ROTOR_MAX];   // 1 = RPM reading available
+    INT16U RotorRPM[FSC_FAN_ROTOR_MAX];     // Last RPM read by the sensor scan
+    INT8U  CommandPWM;                      // PWM written by the last cycle
+    INT8U  PrevPWM;                         // PWM written by the cycle before
+} PACKED FSCFanTray;
+
+typedef struct
+{
+    INT8U  ExpectedRotorNum;                // Rotors of all used trays
+    INT8U  HealthyRotorNum;                 // Present, readable and above the minimum RPM
+    INT8U  MissingFanNum;                   // Used trays that are absent
+    INT8U  LostRotorNum;                    // Lost rotors beyond the redundant trays
+    INT8U  Boosted;                         // 1 if the last policy pass raised any tray
+} PACKED FSCFanRedundancyState;
+
+extern FSCFanTray g_FscFanTray[SYS_FAN_NUM_MAX];
+extern FSCFanRedundancyState g_FscFanRedundancyState;
+
+extern INT8U FSCFanUsedNum(void);
+extern INT8U FSCFanRotorNum(void);
+extern INT8U FSCFanRotorSensor(INT8U fan_id, INT8U rotor);
+extern int FSCUpdateFanStatus(int BMCInst);
+extern void FSCApplyRedundancyPolicy(INT8U *tray_pwm, INT8U verbose);
+extern INT16U FSCFanTrayRPM(INT8U fan_id);
+extern void FSCFanTrayRefresh(void);
+extern int FSCSetFanTraysPWM(const INT8U *tray_pwm);
+
+#endif // FSC_FAN_H
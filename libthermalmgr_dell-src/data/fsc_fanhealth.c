@@ -0,0 +1,447 @@
+/*************************************************************************
+ *
+ * fsc_fanhealth.c
+ * Fan rotor health analytics and predictive failure warnings
+ *
+ * Each rotor keeps a baseline of RPM per PWM, learned from its first
+ * settled samples at every curve point and frozen afterwards. Every
+ * settled cycle the measured RPM is divided by the baseline RPM at the
+ * commanded PWM and folded into a rolling mean and variance, so the cost
+ * per rotor is constant. A rotor is flagged when it stalls, when its mean
+ * drifts below the baseline, or when it falls behind the other rotor of
+ * its tray. Flagged rotors are reported to the SEL as predictive failure
+ * and count as lost for the fan redundancy policy.
+ *
+ * Frozen baselines are kept in FSC_FAN_HEALTH_STORE_FILE per tray
+ * position, so a restart does not learn a worn rotor as new. A tray that
+ * is removed is taken as replaced: its baseline is dropped and learned
+ * again from the tray that comes back. A tray swapped while the BMC is
+ * down cannot be told apart and keeps the stored baseline.
+ *
+ ************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Types.h"
+#include "API.h"
+#include "IPMIDefs.h"
+#include "IPMI_SEL.h"
+#include "OEMFAN.h"
+#include "fsc.h"
+#include "fsc_parser.h"
+#include "fsc_utils.h"
+#include "fsc_fan.h"
+#include "fsc_rpm.h"
+#include "fsc_fanhealth.h"
+#include "fsc_record.h"
+
+FSCRotorHealth g_FscRotorHealth[SYS_FAN_NUM_MAX][FSC_FAN_ROTOR_MAX];
+
+/**
+ * @fn FSCFanHealthLoad
+ * @brief Restores the baselines stored by an earlier run. Call once the
+ *        configuration is loaded and before the recording starts, so a
+ *        recording holds them in its state.
+ * @param[in] verbose Verbosity level for debug printing.
+ */
+void FSCFanHealthLoad(INT8U verbose)
+{
+    FSCFanHealthStore store;
+    FILE *file;
+    int i, j;
+
+    // A replay restores the recorded state instead
+    if (!g_FscFanHealth.Enable || FSCRecordReplaying())
+    {
+        return;
+    }
+
+    file = fopen(FSC_FAN_HEALTH_STORE_FILE, "rb");
+    if (file == NULL)
+    {
+        return;
+    }
+
+    if (fread(&store, sizeof(store), 1, file) != 1 ||
+        store.Magic != FSC_FAN_HEALTH_STORE_MAGIC ||
+        store.Version != FSC_FAN_HEALTH_STORE_VERSION ||
+        store.Size != sizeof(store))
+    {
+        printf("FSC: %s does not match this build, fan baselines learned again\n", FSC_FAN_HEALTH_STORE_FILE);
+        fclose(file);
+        return;
+    }
+    fclose(file);
+
+    for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+    {
+        for (j = 0; j < FSC_FAN_ROTOR_MAX; j++)
+        {
+            memcpy(g_FscRotorHealth[i][j].Baseline, store.Rotor[i][j].Baseline,
+                   sizeof(g_FscRotorHealth[i][j].Baseline));
+            memcpy(g_FscRotorHealth[i][j].BaselineSamples, store.Rotor[i][j].BaselineSamples,
+                   sizeof(g_FscRotorHealth[i][j].BaselineSamples));
+        }
+    }
+
+    if (verbose > 0)
+    {
+        FSCPRINT("Fan baselines restored from %s\n", FSC_FAN_HEALTH_STORE_FILE);
+    }
+}
+
+/**
+ * @fn FSCFanHealthSave
+ * @brief Stores the baselines, through a temporary file so a power loss
+ *        leaves either the old or the new ones.
+ */
+static void FSCFanHealthSave(void)
+{
+    FSCFanHealthStore store;
+    char tmp_path[sizeof(FSC_FAN_HEALTH_STORE_FILE) + 4];
+    FILE *file;
+    int ok;
+    int i, j;
+
+    if (FSCRecordReplaying())
+    {
+        return;
+    }
+
+    memset(&store, 0, sizeof(store));
+    store.Magic = FSC_FAN_HEALTH_STORE_MAGIC;
+    store.Version = FSC_FAN_HEALTH_STORE_VERSION;
+    store.Size = sizeof(store);
+    for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+    {
+        for (j = 0; j < FSC_FAN_ROTOR_MAX; j++)
+        {
+            memcpy(store.Rotor[i][j].Baseline, g_FscRotorHealth[i][j].Baseline,
+                   sizeof(store.Rotor[i][j].Baseline));
+            memcpy(store.Rotor[i][j].BaselineSamples, g_FscRotorHealth[i][j].BaselineSamples,
+                   sizeof(store.Rotor[i][j].BaselineSamples));
+        }
+    }
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", FSC_FAN_HEALTH_STORE_FILE);
+    file = fopen(tmp_path, "wb");
+    if (file == NULL)
+    {
+        return;
+    }
+    ok = (fwrite(&store, sizeof(store), 1, file) == 1);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp_path, FSC_FAN_HEALTH_STORE_FILE) != 0)
+    {
+        remove(tmp_path);
+    }
+}
+
+/**
+ * @fn FSCFanHealthLearned
+ * @return 1 if any rotor of a tray has baseline samples, 0 otherwise.
+ */
+static int FSCFanHealthLearned(INT8U fan_id)
+{
+    int j, k;
+
+    for (j = 0; j < FSC_FAN_ROTOR_MAX; j++)
+    {
+        for (k = 0; k < FSC_RPM_CURVE_POINTS; k++)
+        {
+            if (g_FscRotorHealth[fan_id][j].BaselineSamples[k] != 0)
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @fn FSCFanHealthAddSEL
+ * @brief Logs a predictive failure event for a rotor.
+ *
+ * Event data 2 holds the FSC_FAN_HEALTH_* flags that changed, event data 3
+ * the rolling mean of RPM / baseline RPM in percent.
+ * @param[in] fan_id The fan tray ID (SYS_FAN1, SYS_FAN2, etc.).
+ * @param[in] rotor Rotor index, 0 is the front rotor.
+ * @param[in] assert 1 when the warning starts, 0 when it clears.
+ * @param[in] flags Warning flags reported.
+ * @param[in] BMCInst The BMC instance number.
+ */
+static void FSCFanHealthAddSEL(INT8U fan_id, INT8U rotor, INT8U assert, INT8U flags, int BMCInst)
+{
+    const FSCRotorHealth *pHealth = &g_FscRotorHealth[fan_id][rotor];
+    MsgPkt_T MsgPkt;
+    float pct = pHealth->MeanValid ? pHealth->Mean * 100 : 100;
+
+    if (pct > 0xFF)
+    {
+        pct = 0xFF;
+    }
+    if (pct < 0)
+    {
+        pct = 0;
+    }
+
+    memset(&MsgPkt, 0, sizeof(MsgPkt));
+    MsgPkt.NetFnLUN = NETFN_STORAGE << 2;
+    MsgPkt.Cmd      = CMD_ADD_SEL_ENTRY;
+    // Record ID (0,1) and timestamp (3..6) are filled in by the SEL device
+    MsgPkt.Data[2]  = 0x02;                             // System event record
+    MsgPkt.Data[7]  = FSC_FAN_HEALTH_GENERATOR_ID;
+    MsgPkt.Data[8]  = 0x00;
+    MsgPkt.Data[9]  = 0x04;                             // IPMI 2.0 event message
+    MsgPkt.Data[10] = FSC_FAN_HEALTH_SENSOR_TYPE;
+    MsgPkt.Data[11] = FSCFanRotorSensor(fan_id, rotor);
+    MsgPkt.Data[12] = (assert ? 0x00 : 0x80) | FSC_FAN_HEALTH_EVENT_TYPE;
+    MsgPkt.Data[13] = 0xA0 | 0x01;                      // OEM data 2 and 3, predictive failure asserted
+    MsgPkt.Data[14] = flags;
+    MsgPkt.Data[15] = (INT8U)pct;
+    MsgPkt.Size     = 16;
+
+    API_ExecuteCmd(&MsgPkt, BMCInst);
+    if (MsgPkt.Data[0] != CC_SUCCESS)
+    {
+        FSCPRINT("Fan%d rotor %d health event not logged (cc 0x%02x)\n", fan_id + 1, rotor, MsgPkt.Data[0]);
+    }
+}
+
+/**
+ * @fn FSCFanHealthSample
+ * @brief Learns the baseline or updates the rolling statistics of a rotor
+ *        with one settled sample.
+ * @return 1 if the sample froze a baseline point, 0 otherwise.
+ */
+static int FSCFanHealthSample(FSCRotorHealth *pHealth, INT8U pwm, INT16U rpm)
+{
+    int point = (pwm + FSC_RPM_CURVE_STEP / 2) / FSC_RPM_CURVE_STEP;
+    float ratio = (float)rpm / pwm;
+    float d, diff, incr;
+
+    if (pHealth->BaselineSamples[point] < FSC_FAN_HEALTH_BASELINE_SAMPLES)
+    {
+        // A point first reached after the rotor has drifted is scaled back
+        // to what the rotor did when new, so the drift is not learned
+        if (pHealth->MeanValid && pHealth->Mean > 0)
+        {
+            ratio /= pHealth->Mean;
+        }
+        pHealth->BaselineSamples[point]++;
+        pHealth->Baseline[point] += (ratio - pHealth->Baseline[point]) / pHealth->BaselineSamples[point];
+        return pHealth->BaselineSamples[point] == FSC_FAN_HEALTH_BASELINE_SAMPLES;
+    }
+
+    if (pHealth->Baseline[point] <= 0)
+    {
+        return 0;
+    }
+
+    d = ratio / pHealth->Baseline[point];
+
+    if (!pHealth->MeanValid)
+    {
+        pHealth->Mean = d;
+        pHealth->Var = 0;
+        pHealth->MeanValid = 1;
+        return 0;
+    }
+
+    diff = d - pHealth->Mean;
+    incr = diff / FSC_FAN_HEALTH_WEIGHT;
+    pHealth->Mean += incr;
+    pHealth->Var = (1.0f - 1.0f / FSC_FAN_HEALTH_WEIGHT) * (pHealth->Var + diff * incr);
+    return 0;
+}
+
+/**
+ * @fn FSCFanHealthExpected
+ * @return RPM a rotor should turn at a PWM, 0 if unknown.
+ */
+static float FSCFanHealthExpected(const FSCRotorHealth *pHealth, INT8U fan_id, INT8U pwm)
+{
+    int point = (pwm + FSC_RPM_CURVE_STEP / 2) / FSC_RPM_CURVE_STEP;
+
+    if (pHealth->BaselineSamples[point] >= FSC_FAN_HEALTH_BASELINE_SAMPLES)
+    {
+        return pHealth->Baseline[point] * pwm;
+    }
+
+    return FSCRpmExpected(fan_id, pwm);
+}
+
+/**
+ * @fn FSCFanHealthUpdate
+ * @brief Runs the rotor health analytics for one cycle.
+ *
+ * Call after FSCUpdateFanStatus. A tray that is removed starts over with
+ * a new baseline when it comes back. The baselines are stored whenever a
+ * point freezes or a tray is removed, a few times in a tray's life.
+ * @param[in] BMCInst The BMC instance number.
+ * @param[in] verbose Verbosity level for debug printing.
+ */
+void FSCFanHealthUpdate(int BMCInst, INT8U verbose)
+{
+    const FSC_JSON_FAN_HEALTH *pConfig = &g_FscFanHealth;
+    FSCRotorHealth *pHealth = NULL;
+    FSCRotorHealth *pOther = NULL;
+    INT8U used_num = FSCFanUsedNum();
+    INT8U rotor_num = FSCFanRotorNum();
+    INT8U flags[FSC_FAN_ROTOR_MAX];
+    INT8U changed;
+    INT8U pwm;
+    INT16U rpm;
+    float expected;
+    float degrade = pConfig->DegradePct / 100.0f;
+    float mismatch = pConfig->MismatchPct / 100.0f;
+    int stalled;
+    int save = 0;
+    int i, j;
+
+    if (!pConfig->Enable)
+    {
+        return;
+    }
+
+    for (i = 0; i < used_num; i++)
+    {
+        if (!g_FscFanTray[i].Present)
+        {
+            if (FSCFanHealthLearned(i))
+            {
+                save = 1;
+            }
+            memset(g_FscRotorHealth[i], 0, sizeof(g_FscRotorHealth[i]));
+            continue;
+        }
+
+        pwm = g_FscFanTray[i].CommandPWM;
+
+        for (j = 0; j < rotor_num; j++)
+        {
+            pHealth = &g_FscRotorHealth[i][j];
+            flags[j] = pHealth->Flags;
+            rpm = g_FscFanTray[i].RotorValid[j] ? g_FscFanTray[i].RotorRPM[j] : 0;
+
+            if (pwm < pConfig->MinPWM)
+            {
+                continue;
+            }
+
+            // Stall: no reading or far below the expected RPM, settled or not
+            expected = FSCFanHealthExpected(pHealth, i, pwm);
+            stalled = !g_FscFanTray[i].RotorValid[j] || rpm == 0 ||
+                      (expected > 0 && rpm < expected * pConfig->StallPct / 100);
+            if (stalled)
+            {
+                if (pHealth->StallCount < 0xFF)
+                {
+                    pHealth->StallCount++;
+                }
+                if (pHealth->StallCount >= pConfig->StallCycles)
+                {
+                    flags[j] |= FSC_FAN_HEALTH_STALL;
+                }
+                continue;
+            }
+            pHealth->StallCount = 0;
+            flags[j] &= ~FSC_FAN_HEALTH_STALL;
+
+            if (pwm != g_FscFanTray[i].PrevPWM)
+            {
+                continue;
+            }
+
+            if (FSCFanHealthSample(pHealth, pwm, rpm))
+            {
+                save = 1;
+            }
+            if (!pHealth->MeanValid)
+            {
+                continue;
+            }
+
+            // Slow degradation, cleared at half the threshold
+            if (pHealth->Mean < 1.0f - degrade)
+            {
+                flags[j] |= FSC_FAN_HEALTH_DEGRADED;
+            }
+            else if (pHealth->Mean > 1.0f - degrade / 2)
+            {
+                flags[j] &= ~FSC_FAN_HEALTH_DEGRADED;
+            }
+        }
+
+        // Front / rear mismatch, flagged on the slower rotor
+        if (rotor_num == FSC_FAN_ROTOR_MAX)
+        {
+            for (j = 0; j < FSC_FAN_ROTOR_MAX; j++)
+            {
+                pHealth = &g_FscRotorHealth[i][j];
+                pOther = &g_FscRotorHealth[i][1 - j];
+                if (!pHealth->MeanValid || !pOther->MeanValid)
+                {
+                    continue;
+                }
+
+                if (pOther->Mean - pHealth->Mean > mismatch)
+                {
+                    flags[j] |= FSC_FAN_HEALTH_MISMATCH;
+                }
+                else if (pOther->Mean - pHealth->Mean < mismatch / 2)
+                {
+                    flags[j] &= ~FSC_FAN_HEALTH_MISMATCH;
+                }
+            }
+        }
+
+        for (j = 0; j < rotor_num; j++)
+        {
+            pHealth = &g_FscRotorHealth[i][j];
+            changed = flags[j] ^ pHealth->Flags;
+            if (!changed)
+            {
+                continue;
+            }
+
+            if (verbose > 0)
+            {
+                FSCPRINT("Fan%d rotor %d health 0x%02x -> 0x%02x, mean %.2f, stddev %.3f\n",
+                         i + 1, j, pHealth->Flags, flags[j], pHealth->Mean, sqrtf(pHealth->Var));
+            }
+
+            if (flags[j] & changed)
+            {
+                FSCFanHealthAddSEL(i, j, 1, flags[j] & changed, BMCInst);
+            }
+            if (flags[j] == 0)
+            {
+                FSCFanHealthAddSEL(i, j, 0, pHealth->Flags, BMCInst);
+            }
+            pHealth->Flags = flags[j];
+        }
+    }
+
+    if (save)
+    {
+        FSCFanHealthSave();
+    }
+}
+
+/**
+ * @fn FSCFanHealthSuspect
+ * @param[in] fan_id The fan tray ID (SYS_FAN1, SYS_FAN2, etc.).
+ * @param[in] rotor Rotor index, 0 is the front rotor.
+ * @return 1 if the rotor has a health warning, 0 otherwise.
+ */
+int FSCFanHealthSuspect(INT8U fan_id, INT8U rotor)
+{
+    if (fan_id >= SYS_FAN_NUM_MAX || rotor >= FSC_FAN_ROTOR_MAX)
+    {
+        return 0;
+    }
+
+    return g_FscRotorHealth[fan_id][rotor].Flags ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+/*************************************************************************
+ *
+ * fsc_fanhealth.h
+ * Fan rotor health analytics and predictive failure warnings
+ *
+ ************************************************************************/
+#ifndef FSC_FANHEALTH_H
+#define FSC_FANHEALTH_H
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "fsc.h"
+#include "fsc_fan.h"
+#include "fsc_rpm.h"
+
+// Rotor warnings
+#define FSC_FAN_HEALTH_STALL        0x01    // Not turning while driven
+#define FSC_FAN_HEALTH_DEGRADED     0x02    // Slower than when it was new
+#define FSC_FAN_HEALTH_MISMATCH     0x04    // Slower than the other rotor of the tray
+
+// Settled samples per curve point before the baseline is frozen
+#define FSC_FAN_HEALTH_BASELINE_SAMPLES 16
+
+// Baselines kept across restarts, per tray position
+#define FSC_FAN_HEALTH_STORE_FILE   "/conf/fsc/fsc_fanhealth.bin"
+#define FSC_FAN_HEALTH_STORE_MAGIC  0x4C424846  // "FHBL"
+#define FSC_FAN_HEALTH_STORE_VERSION 1
+
+// Weight of a new sample in the rolling statistics is 1/FSC_FAN_HEALTH_WEIGHT
+#define FSC_FAN_HEALTH_WEIGHT       16
+
+// IPMI event sent for a warning, fan sensor type and predictive failure event type
+#define FSC_FAN_HEALTH_SENSOR_TYPE  0x04
+#define FSC_FAN_HEALTH_EVENT_TYPE   0x04
+#define FSC_FAN_HEALTH_GENERATOR_ID 0x20
+
+typedef struct
+{
+    float  Baseline[FSC_RPM_CURVE_POINTS];  // RPM per PWM when the rotor was new
+    INT8U  BaselineSamples[FSC_RPM_CURVE_POINTS];
+    float  Mean;                            // Rolling mean of RPM / baseline RPM
+    float  Var;                             // Rolling variance of the same
+    INT8U  MeanValid;
+    INT8U  StallCount;                      // Consecutive stalled cycles
+    INT8U  Flags;                           // FSC_FAN_HEALTH_*
+} PACKED FSCRotorHealth;
+
+typedef struct
+{
+    float  Baseline[FSC_RPM_CURVE_POINTS];
+    INT8U  BaselineSamples[FSC_RPM_CURVE_POINTS];
+} PACKED FSCRotorBaseline;
+
+typedef struct
+{
+    INT32U Magic;                           // FSC_FAN_HEALTH_STORE_MAGIC
+    INT16U Version;                         // FSC_FAN_HEALTH_STORE_VERSION
+    INT16U Size;                            // sizeof(FSCFanHealthStore)
+    FSCRotorBaseline Rotor[SYS_FAN_NUM_MAX][FSC_FAN_ROTOR_MAX];
+} PACKED FSCFanHealthStore;
+
+extern FSCRotorHealth g_FscRotorHealth[SYS_FAN_NUM_MAX][FSC_FAN_ROTOR_MAX];
+
+extern void FSCFanHealthLoad(INT8U verbose);
+extern void FSCFanHealthUpdate(int BMCInst, INT8U verbose);
+extern int FSCFanHealthSuspect(INT8U fan_id, INT8U rotor);
+
+#endif // FSC_FANHEALTH_H
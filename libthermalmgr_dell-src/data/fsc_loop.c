@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -9,6 +10,51 @@
 #include "fsc_parser.h"
 #include "fsc_utils.h"
 #include "fsc_core.h"
+#include "fsc_fan.h"
+#include "fsc_rpm.h"
+#include "fsc_fanhealth.h"
+#include "fsc_aggregate.h"
+#include "fsc_zone.h"
+#include "fsc_record.h"
+#include "fsc_telemetry.h"
+#include "fsc_timing.h"
+#include "fsc_period.h"
+
+/**
+ * @fn FSCConfigPath
+ * @brief Picks the JSON configuration file of the system airflow direction.
+ * @param[out] json_path Buffer for the path.
+ * @param[in] size Size of the buffer.
+ */
+static void FSCConfigPath(char *json_path, size_t size)
+{
+    // Determine which profile to use
+    int system_airflow = OEM_GetSystemAirflow();
+
+    if (AIRFLOW_F2B == system_airflow)
+    {
+        snprintf(json_path, size, "%s", FSC_CONF_F2B_FILE);
+    }
+    else
+    {
+        snprintf(json_path, size, "%s", FSC_CONF_B2F_FILE);
+    }
+}
+
+/**
+ * @fn FSCLoadLoop
+ * @brief Parses only the 'loop' object, for the FSC thread to set up its
+ *        priority and CPU before the first cycle. The first cycle parses
+ *        it again with the rest of the configuration.
+ * @return 0 on success, -1 on failure, g_FscLoop then has the defaults.
+ */
+int FSCLoadLoop(void)
+{
+    char json_path[128] = {0};
+
+    FSCConfigPath(json_path, sizeof(json_path));
+    return ParseLoopFromJson(json_path, &g_FscLoop, 0);
+}
 
 /**
  * @fn FSCInitialize
@@ -22,19 +68,9 @@
  */
 static int FSCInitialize(INT8U *verbose)
 {
-    char json_path[32] = {0};
+    char json_path[128] = {0};
 
-    // Determine which profile to use
-    int system_airflow = OEM_GetSystemAirflow();
-
-    if (AIRFLOW_F2B == system_airflow)
-    {
-        snprintf(json_path, sizeof(json_path), "%s", FSC_CONF_F2B_FILE);
-    }
-    else
-    {
-        snprintf(json_path, sizeof(json_path), "%s", FSC_CONF_B2F_FILE);
-    }
+    FSCConfigPath(json_path, sizeof(json_path));
 
     TINFO("Fan speed control configuration loaded: %s", json_path);
 
@@ -56,6 +92,114 @@ static int FSCInitialize(INT8U *verbose)
         return -1;
     }
 
+    if (0 != ParseAggregationFromJson(json_path, &g_FscAggregation, *verbose))
+    {
+        printf("FSC: Failed to parse 'aggregation' from %s.\n", json_path);
+        return -1;
+    }
+
+    if (0 != ParseZoneInfoFromJson(json_path, &g_FscZoneInfo, &g_FscProfileInfo, &g_FscAggregation, *verbose))
+    {
+        printf("FSC: Failed to parse 'zone_info' from %s.\n", json_path);
+        return -1;
+    }
+
+    if (0 != ParseFanRedundancyFromJson(json_path, &g_FscFanRedundancy, *verbose))
+    {
+        printf("FSC: Failed to parse 'fan_redundancy' from %s.\n", json_path);
+        return -1;
+    }
+
+    if (0 != ParseRpmControlFromJson(json_path, &g_FscRpmControl, *verbose))
+    {
+        printf("FSC: Failed to parse 'rpm_control' from %s.\n", json_path);
+        return -1;
+    }
+
+    if (0 != ParseFanHealthFromJson(json_path, &g_FscFanHealth, *verbose))
+    {
+        printf("FSC: Failed to parse 'fan_health' from %s.\n", json_path);
+        return -1;
+    }
+
+    FSCFanHealthLoad(*verbose);
+
+    if (0 != ParseRecorderFromJson(json_path, &g_FscRecorder, *verbose))
+    {
+        printf("FSC: Failed to parse 'recorder' from %s.\n", json_path);
+        return -1;
+    }
+
+    FSCRecordStart(json_path, *verbose);
+
+    if (0 != ParseTelemetryFromJson(json_path, &g_FscTelemetry, *verbose))
+    {
+        printf("FSC: Failed to parse 'telemetry' from %s.\n", json_path);
+        return -1;
+    }
+
+    if (g_FscTelemetry.Enable && 0 != FSCTelemetryOpen(FSC_TLM_SHM_NAME, g_FscTelemetry.Records))
+    {
+        // Fan control does not depend on it
+        printf("FSC: Failed to create the telemetry ring %s.\n", FSC_TLM_SHM_NAME);
+    }
+
+    if (0 != ParseLoopFromJson(json_path, &g_FscLoop, *verbose))
+    {
+        printf("FSC: Failed to parse 'loop' from %s.\n", json_path);
+        return -1;
+    }
+
+    FSCTimingOpen(g_FscLoop.PeriodMs * 1000, g_FscLoop.LateMs * 1000);
+    FSCPeriodReset();
+
+    return 0;
+}
+
+/*
+ * Everything a profile computation depends on besides its configuration.
+ * Both algorithms keep their whole state in these fields, so when they are
+ * the same as before the last computation, that computation left its own
+ * inputs unchanged and would give the same output again.
+ */
+typedef struct
+{
+    INT16S CurrentTemp;
+    INT16S LastTemp;
+    INT16S LastLastTemp;
+    INT8U  Present;
+    float  LastPWM;
+    float  CycleScale;
+} PACKED FSCProfileFingerprint;
+
+static FSCProfileFingerprint m_ProfileFingerprint[FSC_SENSOR_CNT_MAX];
+static INT8U m_ProfileFingerprintValid[FSC_SENSOR_CNT_MAX];
+
+/**
+ * @fn FSCProfileReuse
+ * @brief Tells whether the output of a profile can be reused, and if not
+ *        keeps its inputs for the next cycle.
+ * @param[in] i Profile index.
+ * @return 1 if last cycle's output is still valid, 0 if it must be computed.
+ */
+static int FSCProfileReuse(int i)
+{
+    FSCProfileFingerprint print;
+
+    memset(&print, 0, sizeof(print));
+    print.CurrentTemp = pFSCTempSensorInfo[i].CurrentTemp;
+    print.LastTemp = pFSCTempSensorInfo[i].LastTemp;
+    print.LastLastTemp = pFSCTempSensorInfo[i].LastLastTemp;
+    print.Present = pFSCTempSensorInfo[i].Present;
+    print.LastPWM = pFSCTempSensorInfo[i].LastPWM;
+    print.CycleScale = g_FscCycleScale;
+
+    if (m_ProfileFingerprintValid[i] && 0 == memcmp(&print, &m_ProfileFingerprint[i], sizeof(print)))
+    {
+        return 1;
+    }
+
+    m_ProfileFingerprint[i] = print;
     return 0;
 }
 
@@ -65,8 +209,11 @@ static int FSCInitialize(INT8U *verbose)
  *
  * This function iterates through all configured temperature sensor profiles,
  * reads the current temperature for each, and calculates a required PWM value
- * using the defined algorithm (PID or Linear). It then determines the maximum
- * PWM value among all sensors, which becomes the final output PWM for the fans.
+ * using the defined algorithm (PID or Linear). It then combines the PWM
+ * values of all sensors with the configured aggregation (the maximum by
+ * default), which becomes the global output PWM. Profiles whose algorithm
+ * fails this cycle are marked invalid and left out. Profiles whose inputs
+ * did not change keep their output without computing it again.
  * @param[out] pwm Pointer to store the final calculated PWM value.
  * @param[in] verbose Verbosity level for debug printing.
  * @param[in] BMCInst The BMC instance number.
@@ -77,12 +224,15 @@ static int FSCUpdateOutputPWM(INT8U *pwm, INT8U verbose, int BMCInst)
     SensorInfo_T* pSensorInfo = NULL;
     INT8U pwm_value = 0;
     INT8U output_pwm = 0;
+    FSCAggregator agg;
     int i = 0;
 
+    FSCAggregateInit(&agg, &g_FscAggregation);
+
     for (i = 0; i < g_FscProfileInfo.TotalProfileNum; i++)
     {
         pFSCTempSensorInfo[i].SensorNumber = g_FscProfileInfo.ProfileInfo[i].SensorNum;
-        pSensorInfo = API_GetSensorInfo(pFSCTempSensorInfo[i].SensorNumber, 0, BMCInst);
+        pSensorInfo = FSCRecordGetSensorInfo(pFSCTempSensorInfo[i].SensorNumber, BMCInst);
 
         if(pSensorInfo && pSensorInfo->Err != CC_DEST_UNAVAILABLE)
         {
@@ -134,54 +284,123 @@ static int FSCUpdateOutputPWM(INT8U *pwm, INT8U verbose, int BMCInst)
                 break;
 
             default:
-                FSCPRINT("Invalid Cooling algorithm. \n");
-                return -1;
+                // Leave the other profiles in control, reported by the parser
+                if (verbose > 0)
+                {
+                    FSCPRINT("Invalid Cooling algorithm. \n");
+                }
+                pFSCTempSensorInfo[i].OutputValid = 0;
+                continue;
         }
 
-        FSCGetPWMValue(&pwm_value, &pFSCTempSensorInfo[i], verbose, BMCInst);
-        pFSCTempSensorInfo[i].CurrentPWM = pwm_value;
+        if (FSCProfileReuse(i))
+        {
+            pFSCTempSensorInfo[i].Flags |= FSC_TLM_REUSED;
+            FSCTimingCountProfile(1);
+        }
+        else
+        {
+            pwm_value = 0;
+            pFSCTempSensorInfo[i].OutputValid = (0 == FSCGetPWMValue(&pwm_value, &pFSCTempSensorInfo[i], verbose, BMCInst));
+            pFSCTempSensorInfo[i].CurrentPWM = pwm_value;
+            m_ProfileFingerprintValid[i] = pFSCTempSensorInfo[i].OutputValid;
+            FSCTimingCountProfile(0);
+        }
 
-        if (pFSCTempSensorInfo[i].CurrentPWM > output_pwm)
+        if (pFSCTempSensorInfo[i].OutputValid)
         {
-            output_pwm = pFSCTempSensorInfo[i].CurrentPWM;
+            FSCAggregateAdd(&agg, pFSCTempSensorInfo[i].CurrentPWM, g_FscProfileInfo.ProfileInfo[i].Weight);
         }
     }
 
-    if(verbose > 0)
-    {
-        FSCPRINT("Output PWM = %d\n", output_pwm);
-    }
+    output_pwm = FSCAggregateResult(&agg, 0);
+
     *pwm = output_pwm;
 
     return 0;
 }
 
 /**
- * @fn FanControlLoop
- * @brief The main loop for fan speed control.
+ * @fn FSCUpdateTelemetry
+ * @brief Writes the records of a cycle to the telemetry ring.
+ *
+ * One record per profile with its reading, intermediate results and
+ * output, then one with the global PWM and the PWM written to each tray.
+ * @param[in] pwm Global PWM of the cycle.
+ * @param[in] tray_pwm PWM written to each of the SYS_FAN_NUM_MAX trays.
+ */
+static void FSCUpdateTelemetry(INT8U pwm, const INT8U *tray_pwm)
+{
+    static INT32U seq = 0;
+    FSCTelemetryRecord record;
+    const FSCTempSensor *pSensor = NULL;
+    INT32U now = FSCTelemetryTime();
+    int i;
+
+    memset(&record, 0, sizeof(record));
+    record.Seq = seq++;
+    record.Time = now;
+    record.Type = FSC_TLM_PROFILE;
+
+    for (i = 0; i < g_FscProfileInfo.TotalProfileNum && i < FSC_SENSOR_CNT_MAX; i++)
+    {
+        pSensor = &pFSCTempSensorInfo[i];
+        record.Profile = (INT8U)i;
+        record.SensorNum = pSensor->SensorNumber;
+        record.Flags = pSensor->Flags & ~(FSC_TLM_PRESENT | FSC_TLM_VALID);
+        record.Flags |= (pSensor->Present ? FSC_TLM_PRESENT : 0) | (pSensor->OutputValid ? FSC_TLM_VALID : 0);
+        record.Temp = pSensor->CurrentTemp;
+        record.LastTemp = pSensor->LastTemp;
+        record.Ambient = pSensor->Ambient;
+        record.RawPWM = pSensor->RawPWM;
+        record.PWM = pSensor->CurrentPWM;
+        FSCTelemetryWrite(&record);
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.Seq = seq - 1;
+    record.Time = now;
+    record.Type = FSC_TLM_CYCLE;
+    record.Flags = (g_FscFanRedundancyState.Boosted ? FSC_TLM_BOOSTED : 0) | (g_FscRpmControl.Enable ? FSC_TLM_RPM_CONTROL : 0);
+    record.PWM = pwm;
+    memcpy(record.TrayPWM, tray_pwm, SYS_FAN_NUM_MAX);
+    FSCTelemetryWrite(&record);
+}
+
+// Held for a whole cycle, whoever runs it
+static pthread_mutex_t m_FscCycleLock = PTHREAD_MUTEX_INITIALIZER;
+// The FSC thread ran cycles since FanControlLoop last did
+static bool m_FscThreadCycled = false;
+
+/**
+ * @fn FSCCycle
+ * @brief One cycle of fan speed control, under m_FscCycleLock.
  *
- * This function serves as the main entry point for the fan control logic.
  * It ensures one-time initialization, calculates the required PWM based on
  * current conditions, and then applies that PWM value to all chassis fans.
  * @param BMCInst The BMC instance number.
  * @return 0 on success, -1 on failure.
  */
-int FanControlLoop(int BMCInst)
+static int FSCCycle(int BMCInst)
 {
     static bool init_flag = false;
+    static INT8U conf_verbose = 0;
     INT8U pwm = 0;
+    INT8U tray_pwm[SYS_FAN_NUM_MAX];
     INT8U verbose = 0;
 
+    // Never run on a partly loaded configuration, the next call loads it again
     if (!init_flag)
     {
-        if (0 != FSCInitialize(&verbose))
+        if (0 != FSCInitialize(&conf_verbose))
         {
-            init_flag = true;
             TCRIT("FSC: Initialization failed. Fan control will not run.\n");
             return -1;
         }
+        init_flag = true;
         TINFO("Fan speed control strategy started (%s)...", g_FscSystemInfo.FSCVersion);
     }
+    verbose = conf_verbose;
 
     // overwrite verbose by oem command
     if(g_OEMDebugArray[OEM_DEBUG_Item_FSC])
@@ -189,10 +408,82 @@ int FanControlLoop(int BMCInst)
         verbose = 3;
     }
 
+    FSCTimingCycleBegin();
+    FSCRecordCycleBegin();
+
+    // Control terms are tuned for the nominal period, the FSC thread may run faster or slower
+    g_FscCycleScale = (float)FSCRecordGetPeriod(g_FscPeriodMs) / g_FscLoop.PeriodMs;
+
     FSCUpdateOutputPWM(&pwm, verbose, BMCInst);
 
-    // Set the calculated PWM to all chassis fans
-    OEM_SetAllFanTraysPWM(pwm);
+    // Each tray follows the zones it cools
+    FSCZoneOutputPWM(pwm, tray_pwm, verbose);
+
+    // Boost the fans that are left when redundancy is lost
+    FSCUpdateFanStatus(BMCInst);
+    FSCRpmLearn();
+    FSCFanHealthUpdate(BMCInst, verbose);
+    FSCApplyRedundancyPolicy(tray_pwm, verbose);
+
+    // Set the calculated PWM to the chassis fans, per tray in RPM mode
+    FSCRpmControl(tray_pwm, verbose);
+    FSCTimingMark(FSC_STAGE_COMPUTE);
+    FSCSetFanTraysPWM(tray_pwm);
+    FSCTimingMark(FSC_STAGE_ACTUATE);
+
+    FSCRecordCycleEnd(pwm);
+    FSCUpdateTelemetry(pwm, tray_pwm);
+    FSCTimingMark(FSC_STAGE_DIAG);
+    FSCTimingCycleEnd(g_OEMDebugArray[OEM_DEBUG_Item_FSC]);
 
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * @fn FSCLoopCycle
+ * @brief Runs a cycle for the FSC thread.
+ * @param BMCInst The BMC instance number.
+ * @return 0 on success, -1 on failure.
+ */
+int FSCLoopCycle(int BMCInst)
+{
+    int ret;
+
+    pthread_mutex_lock(&m_FscCycleLock);
+    m_FscThreadCycled = true;
+    ret = FSCCycle(BMCInst);
+    pthread_mutex_unlock(&m_FscCycleLock);
+
+    return ret;
+}
+
+/**
+ * @fn FanControlLoop
+ * @brief The main loop for fan speed control.
+ *
+ * This function serves as the main entry point for the fan control logic
+ * of a caller that drives the loop itself. While the FSC thread runs it
+ * does nothing, the thread owns the loop. A cycle already started here
+ * completes before the thread runs its first one. Once the thread has
+ * stopped, the period goes back to the nominal one.
+ * @param BMCInst The BMC instance number.
+ * @return 0 on success or while the FSC thread runs, -1 on failure.
+ */
+int FanControlLoop(int BMCInst)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&m_FscCycleLock);
+    if (!FSCThreadRunning())
+    {
+        if (m_FscThreadCycled)
+        {
+            m_FscThreadCycled = false;
+            FSCPeriodReset();
+        }
+        ret = FSCCycle(BMCInst);
+    }
+    pthread_mutex_unlock(&m_FscCycleLock);
+
+    return ret;
+}
@@ -11,6 +11,14 @@
 
 FSC_JSON_SYSTEM_INFO            g_FscSystemInfo;
 FSC_JSON_ALL_PROFILES_INFO      g_FscProfileInfo;
+FSC_JSON_FAN_REDUNDANCY         g_FscFanRedundancy;
+FSC_JSON_RPM_CONTROL            g_FscRpmControl;
+FSC_JSON_FAN_HEALTH             g_FscFanHealth;
+FSC_JSON_ALL_ZONES_INFO         g_FscZoneInfo;
+FSC_JSON_AGGREGATION            g_FscAggregation;
+FSC_JSON_RECORDER               g_FscRecorder;
+FSC_JSON_TELEMETRY              g_FscTelemetry;
+FSC_JSON_LOOP                   g_FscLoop;
 
 /**
  * @fn ReadFileToString
@@ -562,6 +570,15 @@ int ParseFSCProfileFromJson(char *filename, FSC_JSON_ALL_PROFILES_INFO *pFscProf
         }
         snprintf(pFscProfileInfo->ProfileInfo[i].Label, sizeof(pFscProfileInfo->ProfileInfo[i].Label), "%s", cString);
 
+        // Optional, only used by a weighted_mean aggregation
+        dTmp = 1.0;
+        if(ConvertcJSONToValue(pProfileItemInfo, "weight", &dTmp) || dTmp < 0)
+        {
+            printf("fsc_parser: get weight error\n");
+            goto END;
+        }
+        pFscProfileInfo->ProfileInfo[i].Weight = (float) dTmp;
+
         if(ConvertcJSONToValue(pProfileItemInfo, "type", cString) || !strlen(cString))
         {
             printf("fsc_parser: get type error\n");
@@ -718,6 +735,10 @@ int ParseFSCProfileFromJson(char *filename, FSC_JSON_ALL_PROFILES_INFO *pFscProf
             }
             pFscProfileInfo->ProfileInfo[i].PolynomialParameter.MaxFallingRate = (INT8U) dTmp;
         }
+        else
+        {
+            printf("fsc_parser: profile[%d]: type %s is not supported, profile ignored\n", i, cString);
+        }
     }
 
     ret = 0;
@@ -737,6 +758,7 @@ int ParseFSCProfileFromJson(char *filename, FSC_JSON_ALL_PROFILES_INFO *pFscProf
             FSCPRINT("   >>> SensorNum               : %d\n", pFscProfileInfo->ProfileInfo[i].SensorNum);
             FSCPRINT("   >>> SensorName              : %s\n", pFscProfileInfo->ProfileInfo[i].SensorName);
             FSCPRINT("   >>> ProfileType             : %d\n", pFscProfileInfo->ProfileInfo[i].ProfileType);
+            FSCPRINT("   >>> Weight                  : %f\n", pFscProfileInfo->ProfileInfo[i].Weight);
 
             if(pFscProfileInfo->ProfileInfo[i].ProfileType == FSC_CTL_PID)
             {
@@ -791,4 +813,890 @@ END:
         free(file);
     }
     return ret;
-}
\ No newline at end of file
+}
+
+/**
+ * @fn ParseFanRedundancyFromJson
+ * @brief Parses the optional 'fan_redundancy' object from a JSON configuration file.
+ *
+ * Without the object the redundancy policy is disabled and the profile
+ * output is applied to the fans unchanged.
+ * @param[in] filename The path to the JSON configuration file.
+ * @param[out] pFanRedundancy Pointer to the FSC_JSON_FAN_REDUNDANCY structure to be populated.
+ * @param[in] verbose Verbosity level for debug printing.
+ * @return 0 on success, -1 on failure.
+ */
+int ParseFanRedundancyFromJson(char *filename, FSC_JSON_FAN_REDUNDANCY *pFanRedundancy, INT8U verbose)
+{
+    char *file = NULL;
+    cJSON *cjson_input = NULL;
+    cJSON *pRedundancyInfo = NULL;
+    cJSON *pListInfo = NULL;
+    cJSON *pItemInfo = NULL;
+
+    int i;
+    double dTmp;
+    int ret = -1;
+
+    memset(pFanRedundancy, 0, sizeof(FSC_JSON_FAN_REDUNDANCY));
+
+    file = ReadFileToString(filename);
+    cjson_input = cJSON_Parse(file);
+
+    pRedundancyInfo = cJSON_GetObjectItem(cjson_input, "fan_redundancy");
+    if(pRedundancyInfo == NULL)
+    {
+        ret = 0;
+        goto END;
+    }
+
+    if(ConvertcJSONToValue(pRedundancyInfo, "rotor_min_rpm", &dTmp))
+    {
+        printf("fsc_parser: fan_redundancy: get rotor_min_rpm error\n");
+        goto END;
+    }
+    pFanRedundancy->RotorMinRPM = (INT16U) dTmp;
+
+    pListInfo = cJSON_GetObjectItem(pRedundancyInfo, "boost_list");
+    if(pListInfo != NULL)
+    {
+        pFanRedundancy->BoostLevelNum = (INT8U) cJSON_GetArraySize(pListInfo);
+        if(pFanRedundancy->BoostLevelNum > FSC_REDUNDANCY_LEVEL_MAX)
+        {
+            printf("fsc_parser: fan_redundancy: too many boost levels\n");
+            goto END;
+        }
+
+        for(i = 0; i < pFanRedundancy->BoostLevelNum; i++)
+        {
+            pItemInfo = cJSON_GetArrayItem(pListInfo, i);
+
+            if(ConvertcJSONToValue(pItemInfo, "lost_rotor_num", &dTmp))
+            {
+                printf("fsc_parser: fan_redundancy: get lost_rotor_num for level[%d] error\n", i);
+                goto END;
+            }
+            pFanRedundancy->BoostLevel[i].LostRotorNum = (INT8U) dTmp;
+
+            if(ConvertcJSONToValue(pItemInfo, "pwm_gain", &dTmp))
+            {
+                printf("fsc_parser: fan_redundancy: get pwm_gain for level[%d] error\n", i);
+                goto END;
+            }
+            pFanRedundancy->BoostLevel[i].PwmGain = (INT8U) dTmp;
+
+            if(ConvertcJSONToValue(pItemInfo, "pwm_offset", &dTmp))
+            {
+                printf("fsc_parser: fan_redundancy: get pwm_offset for level[%d] error\n", i);
+                goto END;
+            }
+            pFanRedundancy->BoostLevel[i].PwmOffset = (INT8U) dTmp;
+        }
+    }
+
+    pListInfo = cJSON_GetObjectItem(pRedundancyInfo, "missing_fan_floor");
+    if(pListInfo != NULL)
+    {
+        pFanRedundancy->FloorNum = (INT8U) cJSON_GetArraySize(pListInfo);
+        if(pFanRedundancy->FloorNum > FSC_REDUNDANCY_LEVEL_MAX)
+        {
+            printf("fsc_parser: fan_redundancy: too many missing fan floors\n");
+            goto END;
+        }
+
+        for(i = 0; i < pFanRedundancy->FloorNum; i++)
+        {
+            pItemInfo = cJSON_GetArrayItem(pListInfo, i);
+
+            if(ConvertcJSONToValue(pItemInfo, "missing_fan_num", &dTmp))
+            {
+                printf("fsc_parser: fan_redundancy: get missing_fan_num for floor[%d] error\n", i);
+                goto END;
+            }
+            pFanRedundancy->Floor[i].MissingFanNum = (INT8U) dTmp;
+
+            if(ConvertcJSONToValue(pItemInfo, "min_pwm", &dTmp))
+            {
+                printf("fsc_parser: fan_redundancy: get min_pwm for floor[%d] error\n", i);
+                goto END;
+            }
+            pFanRedundancy->Floor[i].MinPWM = (INT8U) dTmp;
+        }
+    }
+
+    pFanRedundancy->Enable = 1;
+    ret = 0;
+
+    if(verbose > 1)
+    {
+        FSCPRINT(" > fan_redundancy: \n");
+        FSCPRINT("  >> RotorMinRPM               : %d\n", pFanRedundancy->RotorMinRPM);
+        for(i = 0; i < pFanRedundancy->BoostLevelNum; i++)
+        {
+            FSCPRINT("  >> Boost[%d]: LostRotor=%d, Gain=%d%%, Offset=%d\n", i,
+                    pFanRedundancy->BoostLevel[i].LostRotorNum,
+                    pFanRedundancy->BoostLevel[i].PwmGain,
+                    pFanRedundancy->BoostLevel[i].PwmOffset);
+        }
+        for(i = 0; i < pFanRedundancy->FloorNum; i++)
+        {
+            FSCPRINT("  >> Floor[%d]: MissingFan=%d, MinPWM=%d\n", i,
+                    pFanRedundancy->Floor[i].MissingFanNum,
+                    pFanRedundancy->Floor[i].MinPWM);
+        }
+    }
+
+END:
+    if(ret != 0)
+    {
+        pFanRedundancy->Enable = 0;
+    }
+    cJSON_Delete(cjson_input);
+    if (file)
+    {
+        free(file);
+    }
+    return ret;
+}
+
+/**
+ * @fn ParseRpmControlFromJson
+ * @brief Parses the optional 'rpm_control' object from a JSON configuration file.
+ *
+ * Without the object, or with 'enable' set to 0, the fans run open loop.
+ * @param[in] filename The path to the JSON configuration file.
+ * @param[out] pRpmControl Pointer to the FSC_JSON_RPM_CONTROL structure to be populated.
+ * @param[in] verbose Verbosity level for debug printing.
+ * @return 0 on success, -1 on failure.
+ */
+int ParseRpmControlFromJson(char *filename, FSC_JSON_RPM_CONTROL *pRpmControl, INT8U verbose)
+{
+    char *file = NULL;
+    cJSON *cjson_input = NULL;
+    cJSON *pRpmControlInfo = NULL;
+
+    double dTmp;
+    int ret = -1;
+
+    memset(pRpmControl, 0, sizeof(FSC_JSON_RPM_CONTROL));
+
+    file = ReadFileToString(filename);
+    cjson_input = cJSON_Parse(file);
+
+    pRpmControlInfo = cJSON_GetObjectItem(cjson_input, "rpm_control");
+    if(pRpmControlInfo == NULL)
+    {
+        ret = 0;
+        goto END;
+    }
+
+    if(ConvertcJSONToValue(pRpmControlInfo, "enable", &dTmp))
+    {
+        printf("fsc_parser: rpm_control: get enable error\n");
+        goto END;
+    }
+    pRpmControl->Enable = (INT8U) dTmp;
+
+    if(ConvertcJSONToValue(pRpmControlInfo, "fan_max_rpm", &dTmp))
+    {
+        printf("fsc_parser: rpm_control: get fan_max_rpm error\n");
+        goto END;
+    }
+    pRpmControl->FanMaxRPM = (INT16U) dTmp;
+
+    if(ConvertcJSONToValue(pRpmControlInfo, "kp", &dTmp))
+    {
+        printf("fsc_parser: rpm_control: get kp error\n");
+        goto END;
+    }
+    pRpmControl->Kp = (float) dTmp;
+
+    if(ConvertcJSONToValue(pRpmControlInfo, "ki", &dTmp))
+    {
+        printf("fsc_parser: rpm_control: get ki error\n");
+        goto END;
+    }
+    pRpmControl->Ki = (float) dTmp;
+
+    if(ConvertcJSONToValue(pRpmControlInfo, "trim_max_pwm", &dTmp))
+    {
+        printf("fsc_parser: rpm_control: get trim_max_pwm error\n");
+        goto END;
+    }
+    pRpmControl->TrimMaxPWM = (INT8U) dTmp;
+
+    ret = 0;
+
+    if(verbose > 1)
+    {
+        FSCPRINT(" > rpm_control: \n");
+        FSCPRINT("  >> Enable                    : %d\n", pRpmControl->Enable);
+        FSCPRINT("  >> FanMaxRPM                 : %d\n", pRpmControl->FanMaxRPM);
+        FSCPRINT("  >> Kp                        : %f\n", pRpmControl->Kp);
+        FSCPRINT("  >> Ki                        : %f\n", pRpmControl->Ki);
+        FSCPRINT("  >> TrimMaxPWM                : %d\n", pRpmControl->TrimMaxPWM);
+    }
+
+END:
+    if(ret != 0)
+    {
+        pRpmControl->Enable = 0;
+    }
+    cJSON_Delete(cjson_input);
+    if (file)
+    {
+        free(file);
+    }
+    return ret;
+}
+
+/**
+ * @fn ParseFanHealthFromJson
+ * @brief Parses the optional 'fan_health' object from a JSON configuration file.
+ *
+ * Without the object the rotor health analytics are disabled.
+ * @param[in] filename The path to the JSON configuration file.
+ * @param[out] pFanHealth Pointer to the FSC_JSON_FAN_HEALTH structure to be populated.
+ * @param[in] verbose Verbosity level for debug printing.
+ * @return 0 on success, -1 on failure.
+ */
+int ParseFanHealthFromJson(char *filename, FSC_JSON_FAN_HEALTH *pFanHealth, INT8U verbose)
+{
+    char *file = NULL;
+    cJSON *cjson_input = NULL;
+    cJSON *pFanHealthInfo = NULL;
+
+    double dTmp;
+    int ret = -1;
+
+    memset(pFanHealth, 0, sizeof(FSC_JSON_FAN_HEALTH));
+
+    file = ReadFileToString(filename);
+    cjson_input = cJSON_Parse(file);
+
+    pFanHealthInfo = cJSON_GetObjectItem(cjson_input, "fan_health");
+    if(pFanHealthInfo == NULL)
+    {
+        ret = 0;
+        goto END;
+    }
+
+    if(ConvertcJSONToValue(pFanHealthInfo, "min_pwm", &dTmp))
+    {
+        printf("fsc_parser: fan_health: get min_pwm error\n");
+        goto END;
+    }
+    pFanHealth->MinPWM = (INT8U) dTmp;
+
+    if(ConvertcJSONToValue(pFanHealthInfo, "degrade_pct", &dTmp))
+    {
+        printf("fsc_parser: fan_health: get degrade_pct error\n");
+        goto END;
+    }
+    pFanHealth->DegradePct = (INT8U) dTmp;
+
+    if(ConvertcJSONToValue(pFanHealthInfo, "mismatch_pct", &dTmp))
+    {
+        printf("fsc_parser: fan_health: get mismatch_pct error\n");
+        goto END;
+    }
+    pFanHealth->MismatchPct = (INT8U) dTmp;
+
+    if(ConvertcJSONToValue(pFanHealthInfo, "stall_pct", &dTmp))
+    {
+        printf("fsc_parser: fan_health: get stall_pct error\n");
+        goto END;
+    }
+    pFanHealth->StallPct = (INT8U) dTmp;
+
+    if(ConvertcJSONToValue(pFanHealthInfo, "stall_cycles", &dTmp))
+    {
+        printf("fsc_parser: fan_health: get stall_cycles error\n");
+        goto END;
+    }
+    pFanHealth->StallCycles = (INT8U) dTmp;
+
+    pFanHealth->Enable = 1;
+    ret = 0;
+
+    if(verbose > 1)
+    {
+        FSCPRINT(" > fan_health: \n");
+        FSCPRINT("  >> MinPWM                    : %d\n", pFanHealth->MinPWM);
+        FSCPRINT("  >> DegradePct                : %d\n", pFanHealth->DegradePct);
+        FSCPRINT("  >> MismatchPct               : %d\n", pFanHealth->MismatchPct);
+        FSCPRINT("  >> StallPct                  : %d\n", pFanHealth->StallPct);
+        FSCPRINT("  >> StallCycles               : %d\n", pFanHealth->StallCycles);
+    }
+
+END:
+    if(ret != 0)
+    {
+        pFanHealth->Enable = 0;
+    }
+    cJSON_Delete(cjson_input);
+    if (file)
+    {
+        free(file);
+    }
+    return ret;
+}
+
+/**
+ * @fn ConvertcJSONToAggregation
+ * @brief Reads an 'aggregation' object over the defaults already in pAggregation.
+ * @param[in] pAggInfo The 'aggregation' object, may be NULL.
+ * @param[in,out] pAggregation Aggregation to update.
+ * @return 0 on success, -1 on failure.
+ */
+static int ConvertcJSONToAggregation(cJSON *pAggInfo, FSC_JSON_AGGREGATION *pAggregation)
+{
+    char cString[LABEL_LENGTH_MAX] = {0};
+    double dTmp;
+
+    if(pAggInfo == NULL)
+    {
+        return 0;
+    }
+
+    if(ConvertcJSONToValue(pAggInfo, "type", cString) || !strlen(cString))
+    {
+        printf("fsc_parser: aggregation: get type error\n");
+        return -1;
+    }
+
+    if(strcmp(cString, CJSON_Aggregation_Max) == 0)
+    {
+        pAggregation->Type = FSC_AGG_MAX;
+    }
+    else if(strcmp(cString, CJSON_Aggregation_WeightedMean) == 0)
+    {
+        pAggregation->Type = FSC_AGG_WEIGHTED_MEAN;
+    }
+    else if(strcmp(cString, CJSON_Aggregation_MaxMargin) == 0)
+    {
+        pAggregation->Type = FSC_AGG_MAX_MARGIN;
+    }
+    else if(strcmp(cString, CJSON_Aggregation_SoftMax) == 0)
+    {
+        pAggregation->Type = FSC_AGG_SOFT_MAX;
+    }
+    else
+    {
+        printf("fsc_parser: aggregation: unknown type %s\n", cString);
+        return -1;
+    }
+
+    dTmp = pAggregation->MarginGain;
+    if(ConvertcJSONToValue(pAggInfo, "margin_gain", &dTmp) || dTmp < 0 || dTmp > 1)
+    {
+        printf("fsc_parser: aggregation: get margin_gain error\n");
+        return -1;
+    }
+    pAggregation->MarginGain = (float) dTmp;
+
+    dTmp = pAggregation->Softness;
+    if(ConvertcJSONToValue(pAggInfo, "softness", &dTmp) || dTmp <= 0)
+    {
+        printf("fsc_parser: aggregation: get softness error\n");
+        return -1;
+    }
+    pAggregation->Softness = (float) dTmp;
+
+    return 0;
+}
+
+/**
+ * @fn ParseAggregationFromJson
+ * @brief Parses the optional 'aggregation' object from a JSON configuration file.
+ *
+ * Selects how the outputs of all profiles are combined into the system
+ * PWM: "max" (the default), "weighted_mean" by the profile 'weight's,
+ * "max_margin" adding 'margin_gain' times the second highest output to
+ * the highest, or "soft_max" with 'softness' PWM percent of smoothing.
+ * @param[in] filename The path to the JSON configuration file.
+ * @param[out] pAggregation Pointer to the FSC_JSON_AGGREGATION structure to be populated.
+ * @param[in] verbose Verbosity level for debug printing.
+ * @return 0 on success, -1 on failure.
+ */
+int ParseAggregationFromJson(char *filename, FSC_JSON_AGGREGATION *pAggregation, INT8U verbose)
+{
+    char *file = NULL;
+    cJSON *cjson_input = NULL;
+    int ret = -1;
+
+    pAggregation->Type = FSC_AGG_MAX;
+    pAggregation->MarginGain = FSC_AGG_DEFAULT_MARGIN_GAIN;
+    pAggregation->Softness = FSC_AGG_DEFAULT_SOFTNESS;
+
+    file = ReadFileToString(filename);
+    cjson_input = cJSON_Parse(file);
+
+    if(ConvertcJSONToAggregation(cJSON_GetObjectItem(cjson_input, "aggregation"), pAggregation))
+    {
+        goto END;
+    }
+
+    ret = 0;
+
+    if(verbose > 1)
+    {
+        FSCPRINT(" > aggregation: \n");
+        FSCPRINT("  >> Type                      : %d\n", pAggregation->Type);
+        FSCPRINT("  >> MarginGain                : %f\n", pAggregation->MarginGain);
+        FSCPRINT("  >> Softness                  : %f\n", pAggregation->Softness);
+    }
+
+END:
+    if(ret != 0)
+    {
+        pAggregation->Type = FSC_AGG_MAX;
+    }
+    cJSON_Delete(cjson_input);
+    if (file)
+    {
+        free(file);
+    }
+    return ret;
+}
+
+/**
+ * @fn ParseZoneInfoFromJson
+ * @brief Parses the optional 'zone_info' object from a JSON configuration file.
+ *
+ * Each zone lists the fan trays it drives ('fans', 1 to SYS_FAN_NUM_MAX)
+ * and the profiles that cool it ('profiles', by profile_index). Without the
+ * object there is a single zone and every tray gets the output of every
+ * profile.
+ * A zone may have its own 'aggregation' object, otherwise it combines its
+ * profiles like the system does. Must be called after
+ * ParseFSCProfileFromJson and ParseAggregationFromJson.
+ * @param[in] filename The path to the JSON configuration file.
+ * @param[out] pZoneInfo Pointer to the FSC_JSON_ALL_ZONES_INFO structure to be populated.
+ * @param[in] pFscProfileInfo Profiles the zones refer to.
+ * @param[in] pAggregation Aggregation of zones without their own.
+ * @param[in] verbose Verbosity level for debug printing.
+ * @return 0 on success, -1 on failure.
+ */
+int ParseZoneInfoFromJson(char *filename, FSC_JSON_ALL_ZONES_INFO *pZoneInfo, const FSC_JSON_ALL_PROFILES_INFO *pFscProfileInfo,
+                          const FSC_JSON_AGGREGATION *pAggregation, INT8U verbose)
+{
+    char *file = NULL;
+    cJSON *cjson_input = NULL;
+    cJSON *pZonesInfo = NULL;
+    cJSON *pZoneListInfo = NULL;
+    cJSON *pZoneItemInfo = NULL;
+    cJSON *pListInfo = NULL;
+    FSC_JSON_ZONE_INFO *pZone = NULL;
+
+    int i, j, k;
+    int num;
+    char cString[LABEL_LENGTH_MAX] = {0};
+    double dTmp;
+    int ret = -1;
+
+    memset(pZoneInfo, 0, sizeof(FSC_JSON_ALL_ZONES_INFO));
+
+    file = ReadFileToString(filename);
+    cjson_input = cJSON_Parse(file);
+
+    pZonesInfo = cJSON_GetObjectItem(cjson_input, "zone_info");
+    if(pZonesInfo == NULL)
+    {
+        ret = 0;
+        goto END;
+    }
+
+    pZoneListInfo = cJSON_GetObjectItem(pZonesInfo, "zone_list");
+    if(pZoneListInfo == NULL)
+    {
+        printf("fsc_parser: get zone_list error\n");
+        goto END;
+    }
+
+    num = cJSON_GetArraySize(pZoneListInfo);
+    if(num > FSC_ZONE_MAX)
+    {
+        printf("fsc_parser: the number of zones is out of range\n");
+        goto END;
+    }
+
+    for(i = 0; i < num; i++)
+    {
+        pZone = &pZoneInfo->ZoneInfo[i];
+        pZoneItemInfo = cJSON_GetArrayItem(pZoneListInfo, i);
+
+        if(ConvertcJSONToValue(pZoneItemInfo, "zone_index", &dTmp))
+        {
+            printf("fsc_parser: get zone_index error\n");
+            goto END;
+        }
+        pZone->ZoneIndex = (INT8U) dTmp;
+
+        if(ConvertcJSONToValue(pZoneItemInfo, "label", cString) || !strlen(cString))
+        {
+            printf("fsc_parser: zone[%d]: get label error\n", i);
+            goto END;
+        }
+        snprintf(pZone->Label, sizeof(pZone->Label), "%s", cString);
+
+        pZone->Aggregation = *pAggregation;
+        if(ConvertcJSONToAggregation(cJSON_GetObjectItem(pZoneItemInfo, "aggregation"), &pZone->Aggregation))
+        {
+            printf("fsc_parser: zone[%d]: get aggregation error\n", i);
+            goto END;
+        }
+
+        pListInfo = cJSON_GetObjectItem(pZoneItemInfo, "fans");
+        if(pListInfo == NULL || cJSON_GetArraySize(pListInfo) == 0)
+        {
+            printf("fsc_parser: zone[%d]: get fans error\n", i);
+            goto END;
+        }
+
+        for(j = 0; j < cJSON_GetArraySize(pListInfo); j++)
+        {
+            dTmp = cJSON_GetNumberValue(cJSON_GetArrayItem(pListInfo, j));
+            if(dTmp < 1 || dTmp > SYS_FAN_NUM_MAX)
+            {
+                printf("fsc_parser: zone[%d]: fan %d is out of range\n", i, (int)dTmp);
+                goto END;
+            }
+            pZone->FanMask |= (INT8U)(1 << ((int)dTmp - 1));
+        }
+
+        pListInfo = cJSON_GetObjectItem(pZoneItemInfo, "profiles");
+        if(pListInfo == NULL || cJSON_GetArraySize(pListInfo) == 0)
+        {
+            printf("fsc_parser: zone[%d]: get profiles error\n", i);
+            goto END;
+        }
+
+        for(j = 0; j < cJSON_GetArraySize(pListInfo); j++)
+        {
+            dTmp = cJSON_GetNumberValue(cJSON_GetArrayItem(pListInfo, j));
+            for(k = 0; k < pFscProfileInfo->TotalProfileNum; k++)
+            {
+                if(pFscProfileInfo->ProfileInfo[k].ProfileIndex == (INT8U) dTmp)
+                {
+                    pZone->ProfileMask |= (INT32U)1 << k;
+                    break;
+                }
+            }
+
+            if(k == pFscProfileInfo->TotalProfileNum)
+            {
+                printf("fsc_parser: zone[%d]: profile_index %d not found\n", i, (int)dTmp);
+                goto END;
+            }
+        }
+    }
+
+    pZoneInfo->TotalZoneNum = (INT8U) num;
+    ret = 0;
+
+    if(verbose > 1)
+    {
+        FSCPRINT(" > zone_info: \n");
+        FSCPRINT("  >> TotalZoneNum              : %d\n", pZoneInfo->TotalZoneNum);
+        for(i = 0; i < pZoneInfo->TotalZoneNum; i++)
+        {
+            FSCPRINT("  >> zone [%d]: \n", i);
+            FSCPRINT("   >>> Label                   : %s\n", pZoneInfo->ZoneInfo[i].Label);
+            FSCPRINT("   >>> ZoneIndex               : %d\n", pZoneInfo->ZoneInfo[i].ZoneIndex);
+            FSCPRINT("   >>> FanMask                 : 0x%02x\n", pZoneInfo->ZoneInfo[i].FanMask);
+            FSCPRINT("   >>> ProfileMask             : 0x%05x\n", (unsigned int)pZoneInfo->ZoneInfo[i].ProfileMask);
+            FSCPRINT("   >>> Aggregation             : %d\n", pZoneInfo->ZoneInfo[i].Aggregation.Type);
+        }
+    }
+
+END:
+    if(ret != 0)
+    {
+        pZoneInfo->TotalZoneNum = 0;
+    }
+    cJSON_Delete(cjson_input);
+    if (file)
+    {
+        free(file);
+    }
+    return ret;
+}
+
+/**
+ * @fn ParseRecorderFromJson
+ * @brief Parses the optional 'recorder' object from a JSON configuration file.
+ *
+ * Without the object nothing is recorded. 'file' and 'max_kb' default to
+ * FSC_RECORD_DEFAULT_FILE and FSC_RECORD_DEFAULT_MAX_KB.
+ * @param[in] filename The path to the JSON configuration file.
+ * @param[out] pRecorder Pointer to the FSC_JSON_RECORDER structure to be populated.
+ * @param[in] verbose Verbosity level for debug printing.
+ * @return 0 on success, -1 on failure.
+ */
+int ParseRecorderFromJson(char *filename, FSC_JSON_RECORDER *pRecorder, INT8U verbose)
+{
+    char *file = NULL;
+    cJSON *cjson_input = NULL;
+    cJSON *pRecorderInfo = NULL;
+
+    double dTmp;
+    int ret = -1;
+
+    memset(pRecorder, 0, sizeof(FSC_JSON_RECORDER));
+    snprintf(pRecorder->File, sizeof(pRecorder->File), "%s", FSC_RECORD_DEFAULT_FILE);
+    pRecorder->MaxKB = FSC_RECORD_DEFAULT_MAX_KB;
+
+    file = ReadFileToString(filename);
+    cjson_input = cJSON_Parse(file);
+
+    pRecorderInfo = cJSON_GetObjectItem(cjson_input, "recorder");
+    if(pRecorderInfo == NULL)
+    {
+        ret = 0;
+        goto END;
+    }
+
+    if(ConvertcJSONToValue(pRecorderInfo, "enable", &dTmp))
+    {
+        printf("fsc_parser: recorder: get enable error\n");
+        goto END;
+    }
+    pRecorder->Enable = (INT8U) dTmp;
+
+    if(ConvertcJSONToValue(pRecorderInfo, "file", pRecorder->File))
+    {
+        printf("fsc_parser: recorder: get file error\n");
+        goto END;
+    }
+
+    dTmp = pRecorder->MaxKB;
+    if(ConvertcJSONToValue(pRecorderInfo, "max_kb", &dTmp) || dTmp < 1)
+    {
+        printf("fsc_parser: recorder: get max_kb error\n");
+        goto END;
+    }
+    pRecorder->MaxKB = (INT16U) dTmp;
+
+    ret = 0;
+
+    if(verbose > 1)
+    {
+        FSCPRINT(" > recorder: \n");
+        FSCPRINT("  >> Enable                    : %d\n", pRecorder->Enable);
+        FSCPRINT("  >> File                      : %s\n", pRecorder->File);
+        FSCPRINT("  >> MaxKB                     : %d\n", pRecorder->MaxKB);
+    }
+
+END:
+    if(ret != 0)
+    {
+        pRecorder->Enable = 0;
+    }
+    cJSON_Delete(cjson_input);
+    if (file)
+    {
+        free(file);
+    }
+    return ret;
+}
+
+/**
+ * @fn ParseTelemetryFromJson
+ * @brief Parses the optional 'telemetry' object from a JSON configuration file.
+ *
+ * The telemetry ring is cheap enough to stay on, so without the object it
+ * is enabled with FSC_TLM_DEFAULT_RECORDS records.
+ * @param[in] filename The path to the JSON configuration file.
+ * @param[out] pTelemetry Pointer to the FSC_JSON_TELEMETRY structure to be populated.
+ * @param[in] verbose Verbosity level for debug printing.
+ * @return 0 on success, -1 on failure.
+ */
+int ParseTelemetryFromJson(char *filename, FSC_JSON_TELEMETRY *pTelemetry, INT8U verbose)
+{
+    char *file = NULL;
+    cJSON *cjson_input = NULL;
+    cJSON *pTelemetryInfo = NULL;
+
+    double dTmp;
+    int ret = -1;
+
+    pTelemetry->Enable = 1;
+    pTelemetry->Records = FSC_TLM_DEFAULT_RECORDS;
+
+    file = ReadFileToString(filename);
+    cjson_input = cJSON_Parse(file);
+
+    pTelemetryInfo = cJSON_GetObjectItem(cjson_input, "telemetry");
+    if(pTelemetryInfo == NULL)
+    {
+        ret = 0;
+        goto END;
+    }
+
+    if(ConvertcJSONToValue(pTelemetryInfo, "enable", &dTmp))
+    {
+        printf("fsc_parser: telemetry: get enable error\n");
+        goto END;
+    }
+    pTelemetry->Enable = (INT8U) dTmp;
+
+    dTmp = pTelemetry->Records;
+    if(ConvertcJSONToValue(pTelemetryInfo, "records", &dTmp) || dTmp < 1 || dTmp > 0xFFFF)
+    {
+        printf("fsc_parser: telemetry: get records error\n");
+        goto END;
+    }
+    pTelemetry->Records = (INT16U) dTmp;
+
+    ret = 0;
+
+    if(verbose > 1)
+    {
+        FSCPRINT(" > telemetry: \n");
+        FSCPRINT("  >> Enable                    : %d\n", pTelemetry->Enable);
+        FSCPRINT("  >> Records                   : %d\n", pTelemetry->Records);
+    }
+
+END:
+    cJSON_Delete(cjson_input);
+    if (file)
+    {
+        free(file);
+    }
+    return ret;
+}
+
+/**
+ * @fn ParseLoopFromJson
+ * @brief Parses the optional 'loop' object from a JSON configuration file.
+ *
+ * The period is the one the FSC thread, or a caller driving
+ * FanControlLoop itself, runs the loop at; the loop times itself against
+ * it. Such a caller runs at the nominal period unless it asks
+ * FSCPeriodNext itself, and only while the FSC thread is stopped,
+ * FanControlLoop does nothing while it runs.
+ * Priority, CPU and the adaptive period range only apply to the FSC
+ * thread. Without the object the defaults are used, a fixed period thread
+ * that is neither real time nor pinned.
+ * @param[in] filename The path to the JSON configuration file.
+ * @param[out] pLoop Pointer to the FSC_JSON_LOOP structure to be populated.
+ * @param[in] verbose Verbosity level for debug printing.
+ * @return 0 on success, -1 on failure.
+ */
+int ParseLoopFromJson(char *filename, FSC_JSON_LOOP *pLoop, INT8U verbose)
+{
+    char *file = NULL;
+    cJSON *cjson_input = NULL;
+    cJSON *pLoopInfo = NULL;
+
+    double dTmp;
+    int ret = -1;
+
+    pLoop->PeriodMs = FSC_LOOP_DEFAULT_PERIOD_MS;
+    pLoop->LateMs = FSC_LOOP_DEFAULT_LATE_MS;
+    pLoop->Priority = 0;
+    pLoop->Cpu = -1;
+    pLoop->MinPeriodMs = pLoop->PeriodMs;
+    pLoop->MaxPeriodMs = pLoop->PeriodMs;
+    pLoop->RateThreshold = FSC_LOOP_DEFAULT_RATE;
+    pLoop->SetpointMargin = FSC_LOOP_DEFAULT_MARGIN;
+
+    file = ReadFileToString(filename);
+    cjson_input = cJSON_Parse(file);
+
+    pLoopInfo = cJSON_GetObjectItem(cjson_input, "loop");
+    if(pLoopInfo == NULL)
+    {
+        ret = 0;
+        goto END;
+    }
+
+    dTmp = pLoop->PeriodMs;
+    if(ConvertcJSONToValue(pLoopInfo, "period_ms", &dTmp) || dTmp < 1 || dTmp > 60000)
+    {
+        printf("fsc_parser: loop: get period_ms error\n");
+        goto END;
+    }
+    pLoop->PeriodMs = (INT32U) dTmp;
+
+    dTmp = pLoop->LateMs;
+    if(ConvertcJSONToValue(pLoopInfo, "late_ms", &dTmp) || dTmp < 0 || dTmp > 60000)
+    {
+        printf("fsc_parser: loop: get late_ms error\n");
+        goto END;
+    }
+    pLoop->LateMs = (INT32U) dTmp;
+
+    dTmp = pLoop->Priority;
+    if(ConvertcJSONToValue(pLoopInfo, "priority", &dTmp) || dTmp < 0 || dTmp > 99)
+    {
+        printf("fsc_parser: loop: get priority error\n");
+        goto END;
+    }
+    pLoop->Priority = (INT8U) dTmp;
+
+    dTmp = pLoop->Cpu;
+    if(ConvertcJSONToValue(pLoopInfo, "cpu", &dTmp) || dTmp < -1 || dTmp > 127)
+    {
+        printf("fsc_parser: loop: get cpu error\n");
+        goto END;
+    }
+    pLoop->Cpu = (INT8S) dTmp;
+
+    dTmp = pLoop->PeriodMs;
+    if(ConvertcJSONToValue(pLoopInfo, "min_period_ms", &dTmp) || dTmp < 1 || dTmp > pLoop->PeriodMs)
+    {
+        printf("fsc_parser: loop: get min_period_ms error\n");
+        goto END;
+    }
+    pLoop->MinPeriodMs = (INT32U) dTmp;
+
+    dTmp = pLoop->PeriodMs;
+    if(ConvertcJSONToValue(pLoopInfo, "max_period_ms", &dTmp) || dTmp < pLoop->PeriodMs ||
+       (dTmp > pLoop->PeriodMs && dTmp > FSC_LOOP_MAX_ADAPTIVE_PERIOD_MS))
+    {
+        printf("fsc_parser: loop: get max_period_ms error\n");
+        goto END;
+    }
+    pLoop->MaxPeriodMs = (INT32U) dTmp;
+
+    dTmp = pLoop->RateThreshold;
+    if(ConvertcJSONToValue(pLoopInfo, "rate_threshold", &dTmp) || dTmp <= 0)
+    {
+        printf("fsc_parser: loop: get rate_threshold error\n");
+        goto END;
+    }
+    pLoop->RateThreshold = (float) dTmp;
+
+    dTmp = pLoop->SetpointMargin;
+    if(ConvertcJSONToValue(pLoopInfo, "setpoint_margin", &dTmp) || dTmp < 0 || dTmp > 100)
+    {
+        printf("fsc_parser: loop: get setpoint_margin error\n");
+        goto END;
+    }
+    pLoop->SetpointMargin = (INT8U) dTmp;
+
+    ret = 0;
+
+    if(verbose > 1)
+    {
+        FSCPRINT(" > loop: \n");
+        FSCPRINT("  >> PeriodMs                  : %u\n", pLoop->PeriodMs);
+        FSCPRINT("  >> LateMs                    : %u\n", pLoop->LateMs);
+        FSCPRINT("  >> Priority                  : %d\n", pLoop->Priority);
+        FSCPRINT("  >> Cpu                       : %d\n", pLoop->Cpu);
+        FSCPRINT("  >> MinPeriodMs               : %u\n", pLoop->MinPeriodMs);
+        FSCPRINT("  >> MaxPeriodMs               : %u\n", pLoop->MaxPeriodMs);
+        FSCPRINT("  >> RateThreshold             : %.2f\n", pLoop->RateThreshold);
+        FSCPRINT("  >> SetpointMargin            : %d\n", pLoop->SetpointMargin);
+    }
+
+END:
+    cJSON_Delete(cjson_input);
+    if (file)
+    {
+        free(file);
+    }
+    return ret;
+}
@@ -8,6 +8,11 @@
 #define CJSON_ProfileType_PID       "pid"
 #define CJSON_ProfileType_AmbientBase "polynomial"
 
+#define CJSON_Aggregation_Max           "max"
+#define CJSON_Aggregation_WeightedMean  "weighted_mean"
+#define CJSON_Aggregation_MaxMargin     "max_margin"
+#define CJSON_Aggregation_SoftMax       "soft_max"
+
 #define CJSON_FSCMode_Auto          "auto"
 #define CJSON_FSCMode_Manual        "manual"
 
@@ -64,6 +69,7 @@ typedef struct
     INT8U   ProfileType;
     FSC_JSON_PROFILE_PID    PIDParameter;
     FSC_JSON_PROFILE_POLYNOMIAL PolynomialParameter;
+    float   Weight;                         // Share in a weighted_mean aggregation (default 1)
 } PACKED FSC_JSON_PROFILE_INFO;
 
 typedef struct
@@ -74,13 +80,141 @@ typedef struct
     FSC_JSON_PROFILE_INFO   ProfileInfo[FSC_SENSOR_CNT_MAX];
 } PACKED FSC_JSON_ALL_PROFILES_INFO;
 
+#define FSC_REDUNDANCY_LEVEL_MAX   8
+
+typedef struct
+{
+    INT8U   LostRotorNum;                   // Applies from this many lost rotors beyond redundancy
+    INT8U   PwmGain;                        // Percent of the profile output PWM
+    INT8U   PwmOffset;                      // PWM added after the gain
+} PACKED FSC_JSON_BOOST_LEVEL;
+
+typedef struct
+{
+    INT8U   MissingFanNum;                  // Applies from this many missing fan trays
+    INT8U   MinPWM;                         // Lowest PWM allowed
+} PACKED FSC_JSON_MISSING_FLOOR;
+
+typedef struct
+{
+    INT8U   Enable;                         // 0 if 'fan_redundancy' is not configured
+    INT16U  RotorMinRPM;                    // Rotors below this RPM count as lost
+    INT8U   BoostLevelNum;
+    FSC_JSON_BOOST_LEVEL    BoostLevel[FSC_REDUNDANCY_LEVEL_MAX];
+    INT8U   FloorNum;
+    FSC_JSON_MISSING_FLOOR  Floor[FSC_REDUNDANCY_LEVEL_MAX];
+} PACKED FSC_JSON_FAN_REDUNDANCY;
+
+typedef struct
+{
+    INT8U   Enable;                         // 0 = open loop, profile PWM written to every tray
+    INT16U  FanMaxRPM;                      // RPM at 100% demand, 0 = average learned curve
+    float   Kp;                             // PWM per RPM of error
+    float   Ki;                             // PWM per RPM of error per cycle
+    INT8U   TrimMaxPWM;                     // Limit of the correction on top of the learned curve
+} PACKED FSC_JSON_RPM_CONTROL;
+
+typedef struct
+{
+    INT8U   Enable;                         // 0 if 'fan_health' is not configured
+    INT8U   MinPWM;                         // Rotors are judged only at or above this PWM
+    INT8U   DegradePct;                     // Warn when this much slower than the baseline
+    INT8U   MismatchPct;                    // Warn when this much slower than the other rotor
+    INT8U   StallPct;                       // Stalled below this percent of the expected RPM
+    INT8U   StallCycles;                    // Consecutive stalled cycles before warning
+} PACKED FSC_JSON_FAN_HEALTH;
+
+#define FSC_AGG_DEFAULT_MARGIN_GAIN     0.25
+#define FSC_AGG_DEFAULT_SOFTNESS        5
+
+typedef struct
+{
+    INT8U   Type;                           // FSC_AGG_*
+    float   MarginGain;                     // max_margin: share of the second highest added
+    float   Softness;                       // soft_max: PWM scale of the log-sum-exp
+} PACKED FSC_JSON_AGGREGATION;
+
+#define FSC_ZONE_MAX    8
+
+typedef struct
+{
+    char    Label[LABEL_LENGTH_MAX];
+    INT8U   ZoneIndex;
+    INT32U  ProfileMask;                    // Bit i = g_FscProfileInfo.ProfileInfo[i] cools this zone
+    INT8U   FanMask;                        // Bit i = fan tray SYS_FAN1 + i belongs to this zone
+    FSC_JSON_AGGREGATION Aggregation;       // Defaults to the system aggregation
+} PACKED FSC_JSON_ZONE_INFO;
+
+typedef struct
+{
+    INT8U   TotalZoneNum;                   // 0 = one zone with every profile and fan tray
+    FSC_JSON_ZONE_INFO  ZoneInfo[FSC_ZONE_MAX];
+} PACKED FSC_JSON_ALL_ZONES_INFO;
+
+#define FSC_RECORD_DEFAULT_FILE         "/tmp/fsc_record.bin"
+#define FSC_RECORD_DEFAULT_MAX_KB       256
+
+typedef struct
+{
+    INT8U   Enable;                         // 0 if 'recorder' is not configured
+    char    File[LABEL_LENGTH_MAX];         // Recording, the one before is kept as <File>.1
+    INT16U  MaxKB;                          // Start a new recording beyond this size
+} PACKED FSC_JSON_RECORDER;
+
+#define FSC_TLM_DEFAULT_RECORDS         1024
+
+typedef struct
+{
+    INT8U   Enable;                         // On unless 'telemetry' disables it
+    INT16U  Records;                        // Ring capacity, rounded up to a power of two
+} PACKED FSC_JSON_TELEMETRY;
+
+#define FSC_LOOP_DEFAULT_PERIOD_MS      1000
+#define FSC_LOOP_DEFAULT_LATE_MS        100
+#define FSC_LOOP_DEFAULT_RATE           0.5     // C/s
+#define FSC_LOOP_DEFAULT_MARGIN         3       // C
+// The adaptive period grows to at most this, a failed fan is seen by the
+// next cycle and stall detection counts cycles
+#define FSC_LOOP_MAX_ADAPTIVE_PERIOD_MS 10000
+
+typedef struct
+{
+    INT32U  PeriodMs;                       // Period FanControlLoop is called at, the one the control terms are tuned for
+    INT32U  LateMs;                         // A cycle starting later than this is a missed deadline
+    INT8U   Priority;                       // SCHED_FIFO priority of the FSC thread, 0 = not real time
+    INT8S   Cpu;                            // CPU the FSC thread is pinned to, -1 = any
+    INT32U  MinPeriodMs;                    // FSC thread period range, fixed at PeriodMs if equal
+    INT32U  MaxPeriodMs;
+    float   RateThreshold;                  // C/s of any reading that brings the period to the minimum
+    INT8U   SetpointMargin;                 // C from its setpoint a PID sensor may be off before it does
+} PACKED FSC_JSON_LOOP;
+
 extern FSC_JSON_SYSTEM_INFO            g_FscSystemInfo;
 extern FSC_JSON_ALL_PROFILES_INFO      g_FscProfileInfo;
 extern FSCAmbientCalibration           g_AmbientCalibration;
+extern FSC_JSON_FAN_REDUNDANCY         g_FscFanRedundancy;
+extern FSC_JSON_RPM_CONTROL            g_FscRpmControl;
+extern FSC_JSON_FAN_HEALTH             g_FscFanHealth;
+extern FSC_JSON_ALL_ZONES_INFO         g_FscZoneInfo;
+extern FSC_JSON_AGGREGATION            g_FscAggregation;
+extern FSC_JSON_RECORDER               g_FscRecorder;
+extern FSC_JSON_TELEMETRY              g_FscTelemetry;
+extern FSC_JSON_LOOP                   g_FscLoop;
+
+extern char* ReadFileToString(const char *filename);
 
 extern int ParseDebugVerboseFromJson(char *filename, INT8U *verbose);
 int ParseSystemInfoFromJson(char *filename, FSC_JSON_SYSTEM_INFO *pFscSystemInfo, INT8U verbose);
 int ParseFSCProfileFromJson(char *filename, FSC_JSON_ALL_PROFILES_INFO *pFscProfileInfo, INT8U verbose);
 int ParseAmbientCalibrationFromJson(char *filename, FSCAmbientCalibration *pAmbientCalibration, INT8U verbose);
+int ParseFanRedundancyFromJson(char *filename, FSC_JSON_FAN_REDUNDANCY *pFanRedundancy, INT8U verbose);
+int ParseRpmControlFromJson(char *filename, FSC_JSON_RPM_CONTROL *pRpmControl, INT8U verbose);
+int ParseFanHealthFromJson(char *filename, FSC_JSON_FAN_HEALTH *pFanHealth, INT8U verbose);
+int ParseAggregationFromJson(char *filename, FSC_JSON_AGGREGATION *pAggregation, INT8U verbose);
+int ParseZoneInfoFromJson(char *filename, FSC_JSON_ALL_ZONES_INFO *pZoneInfo, const FSC_JSON_ALL_PROFILES_INFO *pFscProfileInfo,
+                          const FSC_JSON_AGGREGATION *pAggregation, INT8U verbose);
+int ParseRecorderFromJson(char *filename, FSC_JSON_RECORDER *pRecorder, INT8U verbose);
+int ParseTelemetryFromJson(char *filename, FSC_JSON_TELEMETRY *pTelemetry, INT8U verbose);
+int ParseLoopFromJson(char *filename, FSC_JSON_LOOP *pLoop, INT8U verbose);
 
 #endif // FSC_PARSER_H
\ No newline at end of file
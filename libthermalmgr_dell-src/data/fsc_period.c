@@ -0,0 +1,203 @@
+/*************************************************************************
+ *
+ * fsc_period.c
+ * Control period adapted to how fast the temperatures move
+ *
+ * The FSC thread asks for the next period after every cycle. It drops to
+ * the minimum as soon as a reading moves faster than the rate threshold
+ * or a PID sensor is off its setpoint by more than the margin, and
+ * doubles up to the maximum for every cycle where neither is the case.
+ * Load steps get the fast period within one cycle while the long steady
+ * stretches read the sensors a lot less often.
+ *
+ * Fan stall detection and the redundancy boost count cycles, so any change
+ * of the fan trays, a rotor warning or the redundancy state, and a rotor
+ * counting towards a stall, also drop the period to the minimum. A failed
+ * fan is seen by the next cycle, the parser keeps the maximum period at
+ * FSC_LOOP_MAX_ADAPTIVE_PERIOD_MS or below, and is confirmed in StallCycles
+ * times the minimum period.
+ *
+ * The control terms are tuned for the nominal period, the loop scales
+ * them by g_FscCycleScale for the period a cycle actually runs at.
+ *
+ * A caller driving FanControlLoop itself runs at the nominal period,
+ * unless it asks FSCPeriodNext like the simulator does. It may do so only
+ * while the FSC thread is stopped, FanControlLoop returns without a cycle
+ * while the thread runs, and starts again from the nominal period after.
+ *
+ ************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "Types.h"
+#include "fsc_parser.h"
+#include "fsc_utils.h"
+#include "fsc_core.h"
+#include "fsc_fan.h"
+#include "fsc_fanhealth.h"
+#include "fsc_telemetry.h"
+#include "fsc_timing.h"
+#include "fsc_period.h"
+
+INT32U g_FscPeriodMs = 0;
+
+// Fan state of the cycle before, any change asks for the minimum period
+typedef struct
+{
+    INT8U  Present[SYS_FAN_NUM_MAX];
+    INT8U  HealthFlags[SYS_FAN_NUM_MAX][FSC_FAN_ROTOR_MAX];
+    INT8U  HealthyRotorNum;
+    INT8U  MissingFanNum;
+    INT8U  LostRotorNum;
+    INT8U  Boosted;
+} PACKED FSCPeriodFanState;
+
+// Readings the rates are taken against, those of the cycle before
+static INT16S m_PeriodTemp[FSC_SENSOR_CNT_MAX];
+static INT8U  m_PeriodTempValid[FSC_SENSOR_CNT_MAX];
+static FSCPeriodFanState m_PeriodFan;
+static INT8U  m_PeriodFanValid = 0;
+
+/**
+ * @fn FSCPeriodReset
+ * @brief Starts over at the nominal period, once the 'loop' configuration
+ *        is loaded.
+ */
+void FSCPeriodReset(void)
+{
+    int i;
+
+    g_FscPeriodMs = g_FscLoop.PeriodMs;
+    for (i = 0; i < FSC_SENSOR_CNT_MAX; i++)
+    {
+        m_PeriodTempValid[i] = 0;
+    }
+    m_PeriodFanValid = 0;
+}
+
+/**
+ * @fn FSCPeriodFanFast
+ * @brief Tells whether the fans need the minimum period: a tray came or
+ *        went, a rotor warning or the redundancy state changed, or a rotor
+ *        is counting towards a stall.
+ * @return 1 if they do, 0 otherwise.
+ */
+static int FSCPeriodFanFast(void)
+{
+    FSCPeriodFanState state;
+    INT8U used_num = FSCFanUsedNum();
+    int fast = 0;
+    int i, j;
+
+    memset(&state, 0, sizeof(state));
+    for (i = 0; i < used_num && i < SYS_FAN_NUM_MAX; i++)
+    {
+        state.Present[i] = g_FscFanTray[i].Present;
+        for (j = 0; j < FSC_FAN_ROTOR_MAX; j++)
+        {
+            state.HealthFlags[i][j] = g_FscRotorHealth[i][j].Flags;
+            if (g_FscRotorHealth[i][j].StallCount > 0 &&
+                g_FscRotorHealth[i][j].StallCount < g_FscFanHealth.StallCycles)
+            {
+                fast = 1;
+            }
+        }
+    }
+    state.HealthyRotorNum = g_FscFanRedundancyState.HealthyRotorNum;
+    state.MissingFanNum = g_FscFanRedundancyState.MissingFanNum;
+    state.LostRotorNum = g_FscFanRedundancyState.LostRotorNum;
+    state.Boosted = g_FscFanRedundancyState.Boosted;
+
+    if (m_PeriodFanValid && memcmp(&state, &m_PeriodFan, sizeof(state)) != 0)
+    {
+        fast = 1;
+    }
+    m_PeriodFan = state;
+    m_PeriodFanValid = 1;
+
+    return fast;
+}
+
+/**
+ * @fn FSCPeriodFast
+ * @brief Tells whether a profile needs the minimum period, and keeps its
+ *        reading for the next cycle.
+ * @param[in] i Profile index.
+ * @return 1 if it does, 0 otherwise.
+ */
+static int FSCPeriodFast(int i)
+{
+    const FSCTempSensor *pSensor = &pFSCTempSensorInfo[i];
+    int fast = 0;
+    int error;
+
+    if (!pSensor->Present || !pSensor->OutputValid)
+    {
+        m_PeriodTempValid[i] = 0;
+        return 0;
+    }
+
+    if (m_PeriodTempValid[i] &&
+        abs(pSensor->CurrentTemp - m_PeriodTemp[i]) * 1000.0f / g_FscPeriodMs >= g_FscLoop.RateThreshold)
+    {
+        fast = 1;
+    }
+    m_PeriodTemp[i] = pSensor->CurrentTemp;
+    m_PeriodTempValid[i] = 1;
+
+    if (pSensor->Algorithm == FSC_CTL_PID)
+    {
+        // Below the setpoint with the fans at their minimum is idle, not a transient
+        error = pSensor->CurrentTemp - pSensor->fscparam.pidparam.SetPoint;
+        if (error > g_FscLoop.SetpointMargin ||
+            (error < -g_FscLoop.SetpointMargin && !(pSensor->Flags & FSC_TLM_CLAMP_MIN)))
+        {
+            fast = 1;
+        }
+    }
+
+    return fast;
+}
+
+/**
+ * @fn FSCPeriodNext
+ * @brief Chooses the period of the next cycle from the cycle that just ran.
+ * @param[in] verbose Verbosity level for debug printing.
+ * @return The period in ms, also left in g_FscPeriodMs.
+ */
+INT32U FSCPeriodNext(INT8U verbose)
+{
+    INT32U period = g_FscPeriodMs;
+    int fast = 0;
+    int i;
+
+    if (g_FscLoop.MinPeriodMs >= g_FscLoop.MaxPeriodMs)
+    {
+        return g_FscPeriodMs;
+    }
+
+    // Every profile is looked at, each keeps its reading for the next rate
+    for (i = 0; i < g_FscProfileInfo.TotalProfileNum && i < FSC_SENSOR_CNT_MAX; i++)
+    {
+        fast |= FSCPeriodFast(i);
+    }
+    fast |= FSCPeriodFanFast();
+
+    if (fast)
+    {
+        period = g_FscLoop.MinPeriodMs;
+    }
+    else
+    {
+        period = (period > g_FscLoop.MaxPeriodMs / 2) ? g_FscLoop.MaxPeriodMs : period * 2;
+    }
+
+    if (verbose > 0 && period != g_FscPeriodMs)
+    {
+        FSCTRACE("Period %u ms\n", period);
+    }
+
+    g_FscPeriodMs = period;
+    FSCTimingSetPeriod(period * 1000);
+    return period;
+}
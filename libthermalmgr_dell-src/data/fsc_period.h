@@ -0,0 +1,17 @@
+/*************************************************************************
+ *
+ * fsc_period.h
+ * Control period adapted to how fast the temperatures move
+ *
+ ************************************************************************/
+#ifndef FSC_PERIOD_H
+#define FSC_PERIOD_H
+
+#include "Types.h"
+
+extern INT32U g_FscPeriodMs;
+
+extern void FSCPeriodReset(void);
+extern INT32U FSCPeriodNext(INT8U verbose);
+
+#endif // FSC_PERIOD_H
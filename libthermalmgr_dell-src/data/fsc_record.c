@@ -0,0 +1,671 @@
+/*************************************************************************
+ *
+ * fsc_record.c
+ * Recording of the FSC inputs and outputs, and their replay on a host
+ *
+ * The loop reads its inputs and writes the fan trays through the
+ * FSCRecord* calls. When recording, each call is appended to the cycle
+ * and the cycle is written to the recording when it ends. When replaying,
+ * the inputs come from the recorded cycle instead of the BMC, and the
+ * outputs are compared with the recorded ones, so the same controller
+ * code can be run again on a host against a field incident.
+ *
+ ************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Types.h"
+#include "IPMIConf.h"
+#include "SensorAPI.h"
+#include "OEMFAN.h"
+#include "fsc.h"
+#include "fsc_parser.h"
+#include "fsc_utils.h"
+#include "fsc_core.h"
+#include "fsc_fan.h"
+#include "fsc_rpm.h"
+#include "fsc_fanhealth.h"
+#include "fsc_zone.h"
+#include "fsc_record.h"
+#include "fsc_timing.h"
+
+typedef struct
+{
+    void   *pData;
+    INT32U Size;
+} FSCRecordRegion;
+
+// Everything the controller carries from one cycle to the next
+static const FSCRecordRegion m_FscRecordState[] =
+{
+    { pFSCTempSensorInfo,       sizeof(pFSCTempSensorInfo) },
+    { g_FscFanTray,             sizeof(g_FscFanTray) },
+    { &g_FscFanRedundancyState, sizeof(g_FscFanRedundancyState) },
+    { g_FscRpmCurve,            sizeof(g_FscRpmCurve) },
+    { g_FscRotorHealth,         sizeof(g_FscRotorHealth) },
+    { g_FscZoneState,           sizeof(g_FscZoneState) },
+};
+
+#define FSC_RECORD_STATE_NUM    (sizeof(m_FscRecordState) / sizeof(m_FscRecordState[0]))
+
+static const char *m_RecordOverride = NULL;
+static char   m_RecordPath[128];
+static FILE  *m_RecordFile = NULL;
+static INT32U m_RecordHash = 0;
+static INT32U m_RecordSeq = 0;
+static long   m_RecordSize = 0;
+static INT8U  m_RecordBuf[sizeof(FSCRecordCycle) + FSC_RECORD_CYCLE_MAX];
+static INT16U m_RecordLen = 0;
+static INT8U  m_RecordOverflow = 0;
+
+static FILE  *m_ReplayFile = NULL;
+static INT32U m_ReplayHash = 0;
+static INT8U  m_ReplayBuf[FSC_RECORD_CYCLE_MAX];
+static INT16U m_ReplayOffset[FSC_RECORD_ENTRY_MAX];
+static INT8U  m_ReplayUsed[FSC_RECORD_ENTRY_MAX];
+static INT8U  m_ReplayEntryNum = 0;
+static FSCReplayResult m_ReplayResult;
+static SensorInfo_T m_ReplaySensorInfo;
+
+/**
+ * @fn FSCRecordHash
+ * @return FNV-1a of a file, 0 if it cannot be read.
+ */
+static INT32U FSCRecordHash(const char *path)
+{
+    char *file = ReadFileToString(path);
+    INT32U hash = 2166136261u;
+    const char *p;
+
+    if (file == NULL)
+    {
+        return 0;
+    }
+
+    for (p = file; *p; p++)
+    {
+        hash = (hash ^ (INT8U)*p) * 16777619u;
+    }
+
+    free(file);
+    return hash;
+}
+
+/**
+ * @fn FSCRecordOpen
+ * @brief Starts a new recording, keeping the previous one as <path>.1.
+ * @return 0 on success, -1 on failure.
+ */
+static int FSCRecordOpen(void)
+{
+    FSCRecordHeader header;
+    char old_path[sizeof(m_RecordPath) + 2];
+    size_t i;
+
+    snprintf(old_path, sizeof(old_path), "%s.1", m_RecordPath);
+    rename(m_RecordPath, old_path);
+
+    m_RecordFile = fopen(m_RecordPath, "wb");
+    if (m_RecordFile == NULL)
+    {
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Magic, FSC_RECORD_MAGIC, sizeof(header.Magic));
+    header.Version = FSC_RECORD_VERSION;
+    header.ConfigHash = m_RecordHash;
+    header.FirstSeq = m_RecordSeq;
+    header.StateNum = FSC_RECORD_STATE_NUM;
+
+    if (fwrite(&header, sizeof(header), 1, m_RecordFile) != 1)
+    {
+        goto ERROR;
+    }
+
+    for (i = 0; i < FSC_RECORD_STATE_NUM; i++)
+    {
+        if (fwrite(&m_FscRecordState[i].Size, sizeof(INT32U), 1, m_RecordFile) != 1 ||
+            fwrite(m_FscRecordState[i].pData, m_FscRecordState[i].Size, 1, m_RecordFile) != 1)
+        {
+            goto ERROR;
+        }
+    }
+
+    fflush(m_RecordFile);
+    m_RecordSize = ftell(m_RecordFile);
+
+    // Replays start with no tray written, so neither does the recording
+    FSCFanTrayRefresh();
+    return 0;
+
+ERROR:
+    fclose(m_RecordFile);
+    m_RecordFile = NULL;
+    return -1;
+}
+
+/**
+ * @fn FSCRecordAppend
+ * @brief Adds an entry to the cycle being recorded.
+ */
+static void FSCRecordAppend(const void *pEntry, INT16U size)
+{
+    if (m_RecordLen + size > FSC_RECORD_CYCLE_MAX)
+    {
+        m_RecordOverflow = 1;
+        return;
+    }
+
+    memcpy(&m_RecordBuf[sizeof(FSCRecordCycle) + m_RecordLen], pEntry, size);
+    m_RecordLen += size;
+}
+
+/**
+ * @fn FSCReplayFind
+ * @brief Takes the first entry of the replayed cycle with a tag and, but
+ *        for FSC_REC_OUTPUT, an ID not taken yet.
+ * @return The entry, NULL if the cycle has none left.
+ */
+static const INT8U *FSCReplayFind(INT8U tag, INT8U id)
+{
+    const INT8U *pEntry = NULL;
+    int i;
+
+    for (i = 0; i < m_ReplayEntryNum; i++)
+    {
+        pEntry = &m_ReplayBuf[m_ReplayOffset[i]];
+        if (m_ReplayUsed[i] || pEntry[0] != tag || (tag != FSC_REC_OUTPUT && pEntry[1] != id))
+        {
+            continue;
+        }
+
+        m_ReplayUsed[i] = 1;
+        return pEntry;
+    }
+
+    if (tag != FSC_REC_OUTPUT && m_ReplayResult.Missing < 0xFF)
+    {
+        m_ReplayResult.Missing++;
+    }
+    return NULL;
+}
+
+/**
+ * @fn FSCReplayEntrySize
+ * @return Size of the entry at the start of pEntry, 0 if it is not valid.
+ */
+static INT16U FSCReplayEntrySize(const INT8U *pEntry, INT16U left)
+{
+    INT16U size = 0;
+
+    switch (pEntry[0])
+    {
+        case FSC_REC_SENSOR:        size = sizeof(FSCRecordSensor); break;
+        case FSC_REC_FAN_PRESENT:   size = sizeof(FSCRecordFanPresent); break;
+        case FSC_REC_FAN_PWM:       size = sizeof(FSCRecordFanPWM); break;
+        case FSC_REC_PERIOD:        size = sizeof(FSCRecordPeriod); break;
+        case FSC_REC_OUTPUT:
+            if (left >= sizeof(FSCRecordOutput))
+            {
+                size = sizeof(FSCRecordOutput) + 2 * ((const FSCRecordOutput *)pEntry)->ProfileNum;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return (size <= left) ? size : 0;
+}
+
+/**
+ * @fn FSCRecordSetFile
+ * @brief Records to a file whatever the 'recorder' configuration says,
+ *        for host tools such as the simulator. Call before the first cycle.
+ * @param[in] path Recording to write, NULL to follow the configuration.
+ */
+void FSCRecordSetFile(const char *path)
+{
+    m_RecordOverride = path;
+}
+
+/**
+ * @fn FSCRecordReplaying
+ * @return 1 while a recording is replayed, 0 otherwise.
+ */
+int FSCRecordReplaying(void)
+{
+    return m_ReplayFile != NULL;
+}
+
+/**
+ * @fn FSCRecordStart
+ * @brief Opens the recording once the configuration is loaded.
+ *
+ * When replaying, only checks that the configuration is the recorded one.
+ * @param[in] json_path The configuration file in use.
+ * @param[in] verbose Verbosity level for debug printing.
+ */
+void FSCRecordStart(const char *json_path, INT8U verbose)
+{
+    const char *path = m_RecordOverride;
+
+    if (m_ReplayFile != NULL)
+    {
+        if (FSCRecordHash(json_path) != m_ReplayHash)
+        {
+            printf("FSC: %s is not the recorded configuration, outputs may differ\n", json_path);
+        }
+        return;
+    }
+
+    if (path == NULL && g_FscRecorder.Enable)
+    {
+        path = g_FscRecorder.File;
+    }
+    if (path == NULL || m_RecordFile != NULL)
+    {
+        return;
+    }
+
+    snprintf(m_RecordPath, sizeof(m_RecordPath), "%s", path);
+    m_RecordHash = FSCRecordHash(json_path);
+
+    if (FSCRecordOpen() != 0)
+    {
+        printf("FSC: cannot record to %s\n", m_RecordPath);
+        return;
+    }
+
+    if (verbose > 0)
+    {
+        FSCPRINT("Recording to %s, config hash %08x\n", m_RecordPath, m_RecordHash);
+    }
+}
+
+/**
+ * @fn FSCRecordCycleBegin
+ * @brief Starts recording a cycle, before its first input is read.
+ */
+void FSCRecordCycleBegin(void)
+{
+    m_RecordLen = 0;
+    m_RecordOverflow = 0;
+}
+
+/**
+ * @fn FSCRecordCycleEnd
+ * @brief Ends a cycle, after the fan trays are written.
+ *
+ * Records the global PWM and the output of every profile and writes the
+ * cycle, starting a new recording beyond 'max_kb'. When replaying, compares
+ * them with the recorded ones instead.
+ * @param[in] pwm Global PWM of the cycle.
+ */
+void FSCRecordCycleEnd(INT8U pwm)
+{
+    INT8U buf[sizeof(FSCRecordOutput) + 2 * FSC_SENSOR_CNT_MAX];
+    FSCRecordOutput *pOutput = (FSCRecordOutput *)buf;
+    const FSCRecordOutput *pRecorded = NULL;
+    FSCRecordCycle *pCycle = (FSCRecordCycle *)m_RecordBuf;
+    int profile_num = g_FscProfileInfo.TotalProfileNum;
+    int i;
+
+    if (profile_num > FSC_SENSOR_CNT_MAX)
+    {
+        profile_num = FSC_SENSOR_CNT_MAX;
+    }
+
+    if (m_ReplayFile != NULL)
+    {
+        m_ReplayResult.ReplayedPWM = pwm;
+        pRecorded = (const FSCRecordOutput *)FSCReplayFind(FSC_REC_OUTPUT, 0);
+        if (pRecorded == NULL || pRecorded->ProfileNum != profile_num)
+        {
+            m_ReplayResult.Mismatch++;
+        }
+        else
+        {
+            m_ReplayResult.RecordedPWM = pRecorded->PWM;
+            m_ReplayResult.Mismatch += (pRecorded->PWM != pwm);
+            for (i = 0; i < profile_num; i++)
+            {
+                m_ReplayResult.Mismatch += (((const INT8U *)(pRecorded + 1))[2 * i] != pFSCTempSensorInfo[i].CurrentPWM ||
+                                            ((const INT8U *)(pRecorded + 1))[2 * i + 1] != pFSCTempSensorInfo[i].OutputValid);
+            }
+        }
+
+        for (i = 0; i < m_ReplayEntryNum; i++)
+        {
+            m_ReplayResult.Unused += !m_ReplayUsed[i];
+        }
+        return;
+    }
+
+    if (m_RecordFile == NULL)
+    {
+        return;
+    }
+
+    pOutput->Tag = FSC_REC_OUTPUT;
+    pOutput->PWM = pwm;
+    pOutput->ProfileNum = (INT8U)profile_num;
+    for (i = 0; i < profile_num; i++)
+    {
+        buf[sizeof(FSCRecordOutput) + 2 * i] = pFSCTempSensorInfo[i].CurrentPWM;
+        buf[sizeof(FSCRecordOutput) + 2 * i + 1] = pFSCTempSensorInfo[i].OutputValid;
+    }
+    FSCRecordAppend(buf, (INT16U)(sizeof(FSCRecordOutput) + 2 * profile_num));
+
+    if (m_RecordOverflow)
+    {
+        printf("FSC: cycle %u does not fit the recording, entries dropped\n", m_RecordSeq);
+    }
+
+    pCycle->Tag = FSC_RECORD_CYCLE_TAG;
+    pCycle->Seq = m_RecordSeq++;
+    pCycle->Time = (INT32U)time(NULL);
+    pCycle->Length = m_RecordLen;
+
+    if (fwrite(m_RecordBuf, sizeof(FSCRecordCycle) + m_RecordLen, 1, m_RecordFile) != 1)
+    {
+        printf("FSC: write to %s failed, recording stopped\n", m_RecordPath);
+        fclose(m_RecordFile);
+        m_RecordFile = NULL;
+        return;
+    }
+    fflush(m_RecordFile);
+    m_RecordSize += sizeof(FSCRecordCycle) + m_RecordLen;
+
+    if (m_RecordSize > (long)g_FscRecorder.MaxKB * 1024)
+    {
+        fclose(m_RecordFile);
+        if (FSCRecordOpen() != 0)
+        {
+            printf("FSC: cannot record to %s\n", m_RecordPath);
+        }
+    }
+}
+
+/**
+ * @fn FSCRecordGetSensorInfo
+ * @brief API_GetSensorInfo as seen by the loop.
+ * @param[in] SensorNum The sensor number.
+ * @param[in] BMCInst The BMC instance number.
+ * @return The sensor info, NULL if the sensor is unknown.
+ */
+SensorInfo_T *FSCRecordGetSensorInfo(INT8U SensorNum, int BMCInst)
+{
+    SensorInfo_T *pSensorInfo = NULL;
+    const FSCRecordSensor *pRecorded = NULL;
+    FSCRecordSensor entry;
+    INT64U start;
+
+    if (m_ReplayFile != NULL)
+    {
+        pRecorded = (const FSCRecordSensor *)FSCReplayFind(FSC_REC_SENSOR, SensorNum);
+        if (pRecorded == NULL || !pRecorded->Valid)
+        {
+            return NULL;
+        }
+
+        memset(&m_ReplaySensorInfo, 0, sizeof(m_ReplaySensorInfo));
+        m_ReplaySensorInfo.SensorNumber = SensorNum;
+        m_ReplaySensorInfo.IsSensorPresent = pRecorded->IsSensorPresent;
+        m_ReplaySensorInfo.Err = pRecorded->Err;
+        m_ReplaySensorInfo.EventFlags = pRecorded->EventFlags;
+        m_ReplaySensorInfo.SensorReading = pRecorded->SensorReading;
+        return &m_ReplaySensorInfo;
+    }
+
+    start = FSCTimingNow();
+    pSensorInfo = API_GetSensorInfo(SensorNum, 0, BMCInst);
+    FSCTimingAddFetch(FSCTimingNow() - start);
+
+    if (m_RecordFile != NULL)
+    {
+        memset(&entry, 0, sizeof(entry));
+        entry.Tag = FSC_REC_SENSOR;
+        entry.SensorNum = SensorNum;
+        if (pSensorInfo)
+        {
+            entry.Valid = 1;
+            entry.IsSensorPresent = pSensorInfo->IsSensorPresent;
+            entry.Err = pSensorInfo->Err;
+            entry.EventFlags = pSensorInfo->EventFlags;
+            entry.SensorReading = pSensorInfo->SensorReading;
+        }
+        FSCRecordAppend(&entry, sizeof(entry));
+    }
+
+    return pSensorInfo;
+}
+
+/**
+ * @fn FSCRecordGetFanTrayPresent
+ * @brief OEM_GetFanTrayPresent as seen by the loop.
+ */
+int FSCRecordGetFanTrayPresent(INT8U fan_id)
+{
+    const FSCRecordFanPresent *pRecorded = NULL;
+    FSCRecordFanPresent entry;
+    INT64U start;
+    int ret;
+
+    if (m_ReplayFile != NULL)
+    {
+        pRecorded = (const FSCRecordFanPresent *)FSCReplayFind(FSC_REC_FAN_PRESENT, fan_id);
+        return pRecorded ? pRecorded->Ret : -1;
+    }
+
+    start = FSCTimingNow();
+    ret = OEM_GetFanTrayPresent(fan_id);
+    FSCTimingAddFetch(FSCTimingNow() - start);
+
+    if (m_RecordFile != NULL)
+    {
+        entry.Tag = FSC_REC_FAN_PRESENT;
+        entry.FanId = fan_id;
+        entry.Ret = (INT8S)ret;
+        FSCRecordAppend(&entry, sizeof(entry));
+    }
+
+    return ret;
+}
+
+/**
+ * @fn FSCRecordSetFanTrayPWM
+ * @brief OEM_SetFanTrayPWM as seen by the loop.
+ */
+int FSCRecordSetFanTrayPWM(INT8U fan_id, INT8U pwm)
+{
+    const FSCRecordFanPWM *pRecorded = NULL;
+    FSCRecordFanPWM entry;
+    int ret;
+
+    if (m_ReplayFile != NULL)
+    {
+        pRecorded = (const FSCRecordFanPWM *)FSCReplayFind(FSC_REC_FAN_PWM, fan_id);
+        if (pRecorded == NULL || fan_id >= SYS_FAN_NUM_MAX)
+        {
+            m_ReplayResult.Mismatch++;
+            return -1;
+        }
+
+        m_ReplayResult.RecordedTrayPWM[fan_id] = pRecorded->PWM;
+        m_ReplayResult.ReplayedTrayPWM[fan_id] = pwm;
+        m_ReplayResult.Mismatch += (pRecorded->PWM != pwm);
+        return pRecorded->Ret;
+    }
+
+    ret = OEM_SetFanTrayPWM(fan_id, pwm);
+
+    if (m_RecordFile != NULL)
+    {
+        entry.Tag = FSC_REC_FAN_PWM;
+        entry.FanId = fan_id;
+        entry.PWM = pwm;
+        entry.Ret = (INT8S)ret;
+        FSCRecordAppend(&entry, sizeof(entry));
+    }
+
+    return ret;
+}
+
+/**
+ * @fn FSCRecordGetPeriod
+ * @brief Period of the cycle as seen by the loop. It scales the control
+ *        terms, so it is an input like the sensor readings.
+ * @param[in] period_ms Period the cycle was scheduled at.
+ * @return The period, the recorded one when replaying.
+ */
+INT32U FSCRecordGetPeriod(INT32U period_ms)
+{
+    const FSCRecordPeriod *pRecorded = NULL;
+    FSCRecordPeriod entry;
+
+    if (m_ReplayFile != NULL)
+    {
+        pRecorded = (const FSCRecordPeriod *)FSCReplayFind(FSC_REC_PERIOD, 0);
+        return pRecorded ? pRecorded->PeriodMs : period_ms;
+    }
+
+    if (m_RecordFile != NULL)
+    {
+        entry.Tag = FSC_REC_PERIOD;
+        entry.Id = 0;
+        entry.PeriodMs = (INT16U)period_ms;
+        FSCRecordAppend(&entry, sizeof(entry));
+    }
+
+    return period_ms;
+}
+
+/**
+ * @fn FSCReplayOpen
+ * @brief Opens a recording for replay and restores the recorded state.
+ *
+ * State regions whose size differs in this build are left as they are, the
+ * replay is then exact only if the recording starts with the FSC.
+ * @param[in] path The recording.
+ * @return 0 on success, -1 if it is not a readable recording.
+ */
+int FSCReplayOpen(const char *path)
+{
+    FSCRecordHeader header;
+    INT32U size;
+    int i;
+
+    m_ReplayFile = fopen(path, "rb");
+    if (m_ReplayFile == NULL)
+    {
+        printf("FSC: cannot open %s\n", path);
+        return -1;
+    }
+
+    if (fread(&header, sizeof(header), 1, m_ReplayFile) != 1 ||
+        memcmp(header.Magic, FSC_RECORD_MAGIC, sizeof(header.Magic)) != 0 ||
+        header.Version != FSC_RECORD_VERSION)
+    {
+        printf("FSC: %s is not a version %d recording\n", path, FSC_RECORD_VERSION);
+        goto ERROR;
+    }
+
+    for (i = 0; i < header.StateNum; i++)
+    {
+        if (fread(&size, sizeof(size), 1, m_ReplayFile) != 1)
+        {
+            goto TRUNCATED;
+        }
+
+        if (i < (int)FSC_RECORD_STATE_NUM && size == m_FscRecordState[i].Size)
+        {
+            if (fread(m_FscRecordState[i].pData, size, 1, m_ReplayFile) != 1)
+            {
+                goto TRUNCATED;
+            }
+            continue;
+        }
+
+        if (header.FirstSeq != 0)
+        {
+            printf("FSC: state %d of %s does not match this build, not restored\n", i, path);
+        }
+        if (fseek(m_ReplayFile, size, SEEK_CUR) != 0)
+        {
+            goto TRUNCATED;
+        }
+    }
+
+    m_ReplayHash = header.ConfigHash;
+    return 0;
+
+TRUNCATED:
+    printf("FSC: %s is truncated\n", path);
+ERROR:
+    fclose(m_ReplayFile);
+    m_ReplayFile = NULL;
+    return -1;
+}
+
+/**
+ * @fn FSCReplayNextCycle
+ * @brief Loads the next recorded cycle, to be fed to FanControlLoop.
+ * @return 1 if a cycle was loaded, 0 at the end, -1 if the recording is corrupt.
+ */
+int FSCReplayNextCycle(void)
+{
+    FSCRecordCycle cycle;
+    INT16U offset = 0;
+    INT16U size;
+
+    if (m_ReplayFile == NULL || fread(&cycle, sizeof(cycle), 1, m_ReplayFile) != 1)
+    {
+        return 0;
+    }
+
+    if (cycle.Tag != FSC_RECORD_CYCLE_TAG || cycle.Length > FSC_RECORD_CYCLE_MAX ||
+        fread(m_ReplayBuf, 1, cycle.Length, m_ReplayFile) != cycle.Length)
+    {
+        return -1;
+    }
+
+    memset(&m_ReplayResult, 0, sizeof(m_ReplayResult));
+    memset(m_ReplayUsed, 0, sizeof(m_ReplayUsed));
+    m_ReplayResult.Seq = cycle.Seq;
+    m_ReplayEntryNum = 0;
+
+    while (offset < cycle.Length)
+    {
+        size = FSCReplayEntrySize(&m_ReplayBuf[offset], cycle.Length - offset);
+        if (size == 0 || m_ReplayEntryNum >= FSC_RECORD_ENTRY_MAX)
+        {
+            return -1;
+        }
+
+        m_ReplayOffset[m_ReplayEntryNum++] = offset;
+        offset += size;
+    }
+
+    return 1;
+}
+
+/**
+ * @fn FSCReplayGetResult
+ * @brief Comparison of the cycle FanControlLoop just replayed.
+ */
+void FSCReplayGetResult(FSCReplayResult *pResult)
+{
+    memcpy(pResult, &m_ReplayResult, sizeof(FSCReplayResult));
+}
+
+void FSCReplayClose(void)
+{
+    if (m_ReplayFile != NULL)
+    {
+        fclose(m_ReplayFile);
+        m_ReplayFile = NULL;
+    }
+}
@@ -0,0 +1,121 @@
+/*************************************************************************
+ *
+ * fsc_record.h
+ * Recording of the FSC inputs and outputs, and their replay on a host
+ *
+ ************************************************************************/
+#ifndef FSC_RECORD_H
+#define FSC_RECORD_H
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "SensorAPI.h"
+#include "fsc.h"
+
+/*
+ * A recording is a FSCRecordHeader, the controller state at the start of
+ * the recording, then one FSCRecordCycle per cycle followed by its
+ * entries in the order the loop made the calls. Fields are little endian,
+ * as on the BMC and on the hosts the replayer runs on.
+ */
+#define FSC_RECORD_MAGIC            "FSCR"
+#define FSC_RECORD_VERSION          3
+#define FSC_RECORD_CYCLE_TAG        0xCC
+
+// Entries of a cycle, at most FSC_RECORD_CYCLE_MAX bytes
+#define FSC_RECORD_CYCLE_MAX        1024
+#define FSC_RECORD_ENTRY_MAX        128
+
+// Entry tags
+#define FSC_REC_SENSOR              1       // Sensor read, input
+#define FSC_REC_FAN_PRESENT         2       // Fan tray presence read, input
+#define FSC_REC_FAN_PWM             3       // PWM written to a tray, output, with the result of the write, input
+#define FSC_REC_OUTPUT              4       // Global PWM and PWM of every profile, output
+#define FSC_REC_PERIOD              5       // Period the cycle ran at, input
+
+typedef struct
+{
+    char   Magic[4];                        // FSC_RECORD_MAGIC
+    INT8U  Version;                         // FSC_RECORD_VERSION
+    INT32U ConfigHash;                      // FNV-1a of the configuration file
+    INT32U FirstSeq;                        // Cycle the state below was taken before
+    INT8U  StateNum;                        // State regions, each an INT32U size then its bytes
+} PACKED FSCRecordHeader;
+
+typedef struct
+{
+    INT8U  Tag;                             // FSC_RECORD_CYCLE_TAG
+    INT32U Seq;                             // Cycles since the FSC started
+    INT32U Time;                            // Seconds since the epoch
+    INT16U Length;                          // Bytes of entries that follow
+} PACKED FSCRecordCycle;
+
+typedef struct
+{
+    INT8U  Tag;                             // FSC_REC_SENSOR
+    INT8U  SensorNum;
+    INT8U  Valid;                           // 0 = no sensor info returned
+    INT8U  IsSensorPresent;
+    INT8U  Err;
+    INT8U  EventFlags;
+    INT16U SensorReading;
+} PACKED FSCRecordSensor;
+
+typedef struct
+{
+    INT8U  Tag;                             // FSC_REC_FAN_PRESENT
+    INT8U  FanId;
+    INT8S  Ret;                             // OEM_GetFanTrayPresent result
+} PACKED FSCRecordFanPresent;
+
+typedef struct
+{
+    INT8U  Tag;                             // FSC_REC_FAN_PWM
+    INT8U  FanId;
+    INT8U  PWM;
+    INT8S  Ret;                             // OEM_SetFanTrayPWM result
+} PACKED FSCRecordFanPWM;
+
+typedef struct
+{
+    INT8U  Tag;                             // FSC_REC_OUTPUT
+    INT8U  PWM;                             // Global PWM
+    INT8U  ProfileNum;                      // Followed by CurrentPWM and OutputValid of each profile
+} PACKED FSCRecordOutput;
+
+typedef struct
+{
+    INT8U  Tag;                             // FSC_REC_PERIOD
+    INT8U  Id;                              // Always 0
+    INT16U PeriodMs;
+} PACKED FSCRecordPeriod;
+
+// Comparison of a replayed cycle with the recording
+typedef struct
+{
+    INT32U Seq;
+    INT8U  RecordedPWM;                     // Global PWM
+    INT8U  ReplayedPWM;
+    INT8U  RecordedTrayPWM[SYS_FAN_NUM_MAX];
+    INT8U  ReplayedTrayPWM[SYS_FAN_NUM_MAX];
+    INT8U  Mismatch;                        // Outputs that differ, global, profiles and trays
+    INT8U  Missing;                         // Inputs read by the replay but not recorded
+    INT8U  Unused;                          // Recorded inputs the replay did not read
+} PACKED FSCReplayResult;
+
+extern void FSCRecordSetFile(const char *path);
+extern int FSCRecordReplaying(void);
+extern void FSCRecordStart(const char *json_path, INT8U verbose);
+extern void FSCRecordCycleBegin(void);
+extern void FSCRecordCycleEnd(INT8U pwm);
+extern SensorInfo_T *FSCRecordGetSensorInfo(INT8U SensorNum, int BMCInst);
+extern int FSCRecordGetFanTrayPresent(INT8U fan_id);
+extern int FSCRecordSetFanTrayPWM(INT8U fan_id, INT8U pwm);
+extern INT32U FSCRecordGetPeriod(INT32U period_ms);
+
+extern int FSCReplayOpen(const char *path);
+extern int FSCReplayNextCycle(void);
+extern void FSCReplayGetResult(FSCReplayResult *pResult);
+extern void FSCReplayClose(void);
+
+#endif // FSC_RECORD_H
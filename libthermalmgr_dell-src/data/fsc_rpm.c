@@ -0,0 +1,246 @@
+/*************************************************************************
+ *
+ * fsc_rpm.c
+ * Per fan tray PWM to RPM calibration and closed loop RPM control
+ *
+ ************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "fsc.h"
+#include "fsc_parser.h"
+#include "fsc_utils.h"
+#include "fsc_fan.h"
+#include "fsc_rpm.h"
+
+FSCRpmCurve g_FscRpmCurve[SYS_FAN_NUM_MAX];
+
+/**
+ * @fn FSCRpmRatio
+ * @brief Looks up RPM per PWM of a tray at a PWM, interpolating between
+ *        the nearest learned points on each side.
+ * @return RPM per PWM, 0 if nothing has been learned yet.
+ */
+static float FSCRpmRatio(const FSCRpmCurve *pCurve, float pwm)
+{
+    float x = pwm / FSC_RPM_CURVE_STEP;
+    int lo, hi;
+
+    if (x < 0)
+    {
+        x = 0;
+    }
+    if (x > FSC_RPM_CURVE_POINTS - 1)
+    {
+        x = FSC_RPM_CURVE_POINTS - 1;
+    }
+
+    for (lo = (int)x; lo >= 0 && !pCurve->Samples[lo]; lo--);
+    for (hi = (int)ceilf(x); hi < FSC_RPM_CURVE_POINTS && !pCurve->Samples[hi]; hi++);
+
+    if (lo < 0 && hi >= FSC_RPM_CURVE_POINTS)
+    {
+        return 0;
+    }
+    if (lo < 0)
+    {
+        return pCurve->RpmPerPwm[hi];
+    }
+    if (hi >= FSC_RPM_CURVE_POINTS || hi == lo)
+    {
+        return pCurve->RpmPerPwm[lo];
+    }
+
+    return pCurve->RpmPerPwm[lo] + (pCurve->RpmPerPwm[hi] - pCurve->RpmPerPwm[lo]) * (x - lo) / (hi - lo);
+}
+
+/**
+ * @fn FSCRpmLearn
+ * @brief Updates the PWM to RPM curve of every used tray.
+ *
+ * A tray is sampled only when the same PWM was written on the last two
+ * cycles, so the RPM read by the sensor scan belongs to that PWM. Call
+ * after FSCUpdateFanStatus.
+ */
+void FSCRpmLearn(void)
+{
+    FSCRpmCurve *pCurve = NULL;
+    INT8U pwm;
+    INT16U rpm;
+    float ratio;
+    int point;
+    int i;
+
+    for (i = 0; i < g_FscSystemInfo.ChassisFanUsedNum && i < SYS_FAN_NUM_MAX; i++)
+    {
+        pwm = g_FscFanTray[i].CommandPWM;
+        if (pwm < FSC_RPM_LEARN_MIN_PWM || pwm != g_FscFanTray[i].PrevPWM)
+        {
+            continue;
+        }
+
+        rpm = FSCFanTrayRPM(i);
+        if (rpm == 0)
+        {
+            continue;
+        }
+
+        pCurve = &g_FscRpmCurve[i];
+        point = (pwm + FSC_RPM_CURVE_STEP / 2) / FSC_RPM_CURVE_STEP;
+        ratio = (float)rpm / pwm;
+
+        if (pCurve->Samples[point] == 0)
+        {
+            pCurve->RpmPerPwm[point] = ratio;
+        }
+        else
+        {
+            pCurve->RpmPerPwm[point] += (ratio - pCurve->RpmPerPwm[point]) / FSC_RPM_LEARN_WEIGHT;
+        }
+
+        if (pCurve->Samples[point] < 0xFF)
+        {
+            pCurve->Samples[point]++;
+        }
+    }
+}
+
+/**
+ * @fn FSCRpmExpected
+ * @brief RPM a tray is expected to reach at a PWM, from its learned curve.
+ * @param[in] fan_id The fan tray ID (SYS_FAN1, SYS_FAN2, etc.).
+ * @param[in] pwm PWM in percent.
+ * @return Expected RPM, 0 if the curve of the tray is not learned yet.
+ */
+float FSCRpmExpected(INT8U fan_id, INT8U pwm)
+{
+    if (fan_id >= SYS_FAN_NUM_MAX)
+    {
+        return 0;
+    }
+
+    return FSCRpmRatio(&g_FscRpmCurve[fan_id], pwm) * pwm;
+}
+
+/**
+ * @fn FSCRpmControl
+ * @brief Turns the FSC output of each fan tray into the PWM to write.
+ *
+ * Open loop, every tray gets its FSC output unchanged. With 'rpm_control'
+ * enabled the FSC output is an airflow demand: the target RPM is that
+ * percentage of fan_max_rpm, or the average learned curve of the present
+ * trays at that demand when fan_max_rpm is 0. Each tray is fed forward
+ * through the inverse of its own learned curve and trimmed by a PI loop on
+ * its measured RPM, so a weak tray is driven harder instead of all trays
+ * being driven for it. Trays without a learned curve or RPM reading stay
+ * open loop.
+ * @param[in,out] tray_pwm FSC output in, PWM to write out, for each of the
+ *                SYS_FAN_NUM_MAX trays.
+ * @param[in] verbose Verbosity level for debug printing.
+ */
+void FSCRpmControl(INT8U *tray_pwm, INT8U verbose)
+{
+    const FSC_JSON_RPM_CONTROL *pControl = &g_FscRpmControl;
+    FSCRpmCurve *pCurve = NULL;
+    float target_rpm;
+    float ff_pwm, ratio, err, trim, out;
+    float trim_max = pControl->TrimMaxPWM;
+    INT8U pwm;
+    INT16U rpm;
+    int used_num = g_FscSystemInfo.ChassisFanUsedNum;
+    int ref_num;
+    int i, k, n;
+
+    if (!pControl->Enable)
+    {
+        return;
+    }
+
+    if (used_num > SYS_FAN_NUM_MAX)
+    {
+        used_num = SYS_FAN_NUM_MAX;
+    }
+
+    for (i = 0; i < used_num; i++)
+    {
+        pCurve = &g_FscRpmCurve[i];
+        pwm = tray_pwm[i];
+        rpm = FSCFanTrayRPM(i);
+
+        if (rpm == 0 || FSCRpmRatio(pCurve, pwm) <= 0)
+        {
+            pCurve->Integral = 0;
+            continue;
+        }
+
+        if (pControl->FanMaxRPM != 0)
+        {
+            target_rpm = (float)pControl->FanMaxRPM * pwm / 100;
+        }
+        else
+        {
+            target_rpm = 0;
+            ref_num = 0;
+            for (n = 0; n < used_num; n++)
+            {
+                if (g_FscFanTray[n].Present && FSCRpmExpected(n, pwm) > 0)
+                {
+                    target_rpm += FSCRpmExpected(n, pwm);
+                    ref_num++;
+                }
+            }
+            if (ref_num == 0)
+            {
+                continue;
+            }
+            target_rpm /= ref_num;
+        }
+
+        // Inverse of the learned curve, refined once at the first estimate
+        ff_pwm = pwm;
+        for (k = 0; k < 2; k++)
+        {
+            ratio = FSCRpmRatio(pCurve, ff_pwm);
+            if (ratio <= 0)
+            {
+                break;
+            }
+            ff_pwm = target_rpm / ratio;
+            if (ff_pwm > g_FscSystemInfo.FanMaxPWM)
+            {
+                ff_pwm = g_FscSystemInfo.FanMaxPWM;
+            }
+        }
+
+        err = target_rpm - rpm;
+
+        pCurve->Integral += pControl->Ki * err;
+        if (pCurve->Integral > trim_max)
+            pCurve->Integral = trim_max;
+        if (pCurve->Integral < -trim_max)
+            pCurve->Integral = -trim_max;
+
+        trim = pControl->Kp * err + pCurve->Integral;
+        if (trim > trim_max)
+            trim = trim_max;
+        if (trim < -trim_max)
+            trim = -trim_max;
+
+        out = ff_pwm + trim;
+        if (out > g_FscSystemInfo.FanMaxPWM)
+            out = g_FscSystemInfo.FanMaxPWM;
+        if (out < 0)
+            out = 0;
+
+        tray_pwm[i] = (INT8U)roundf(out);
+
+        if (verbose > 1)
+        {
+            FSCTRACE(" > Fan%d demand = %d, target RPM = %d, RPM = %d, ff PWM = %.1f, trim = %.1f, PWM = %d\n",
+                     i + 1, pwm, (int)target_rpm, rpm, ff_pwm, trim, tray_pwm[i]);
+        }
+    }
+}
@@ -0,0 +1,37 @@
+/*************************************************************************
+ *
+ * fsc_rpm.h
+ * Per fan tray PWM to RPM calibration and closed loop RPM control
+ *
+ ************************************************************************/
+#ifndef FSC_RPM_H
+#define FSC_RPM_H
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "fsc.h"
+
+// Curve has one point every FSC_RPM_CURVE_STEP percent PWM, 0% to 100%
+#define FSC_RPM_CURVE_STEP          10
+#define FSC_RPM_CURVE_POINTS        (100 / FSC_RPM_CURVE_STEP + 1)
+
+// RPM per PWM is not meaningful with the fan nearly stopped
+#define FSC_RPM_LEARN_MIN_PWM       5
+
+// Weight of a new sample is 1/FSC_RPM_LEARN_WEIGHT
+#define FSC_RPM_LEARN_WEIGHT        8
+
+typedef struct
+{
+    float  RpmPerPwm[FSC_RPM_CURVE_POINTS]; // Learned RPM / PWM around each point
+    INT8U  Samples[FSC_RPM_CURVE_POINTS];   // Samples behind each point, saturates at 255
+    float  Integral;                        // Integral part of the RPM trim
+} PACKED FSCRpmCurve;
+
+extern FSCRpmCurve g_FscRpmCurve[SYS_FAN_NUM_MAX];
+
+extern void FSCRpmLearn(void);
+extern float FSCRpmExpected(INT8U fan_id, INT8U pwm);
+extern void FSCRpmControl(INT8U *tray_pwm, INT8U verbose);
+
+#endif // FSC_RPM_H
@@ -0,0 +1,209 @@
+/*************************************************************************
+ *
+ * fsc_telemetry.c
+ * Per cycle telemetry ring in shared memory
+ *
+ * The loop writes one fixed size record per profile and one per cycle
+ * into a ring in POSIX shared memory; fsc_tlm formats them in its own
+ * process. Writing a record is a copy into the ring, so the telemetry can
+ * stay on in production where printing every cycle could not.
+ *
+ * There is one writer. Each slot works as a seqlock: the writer marks it
+ * busy, fills it and then stores its ring position, readers copy a slot
+ * and keep the copy only if the position is the expected one before and
+ * after. Readers never block the loop; a reader too slow for the ring
+ * loses the records that were overwritten.
+ *
+ ************************************************************************/
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Types.h"
+#include "fsc_telemetry.h"
+
+static FSCTelemetryRing *m_TlmRing = NULL;
+
+/**
+ * @fn FSCTelemetryOpen
+ * @brief Creates, or recreates, the ring the loop writes to.
+ * @param[in] name Shared memory object, FSC_TLM_SHM_NAME.
+ * @param[in] records Capacity, rounded up to a power of two.
+ * @return 0 on success, -1 on failure.
+ */
+int FSCTelemetryOpen(const char *name, INT32U records)
+{
+    FSCTelemetryRing *pRing = NULL;
+    INT32U capacity = 1;
+    size_t size;
+    int fd;
+
+    if (m_TlmRing != NULL)
+    {
+        return 0;
+    }
+
+    while (capacity < records && capacity < 0x10000)
+    {
+        capacity <<= 1;
+    }
+    size = sizeof(FSCTelemetryRing) + capacity * sizeof(FSCTelemetryRecord);
+
+    fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (ftruncate(fd, size) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    pRing = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pRing == MAP_FAILED)
+    {
+        return -1;
+    }
+
+    // Readers check the magic, so it is written once the rest is set
+    __atomic_store_n(&pRing->Magic, 0, __ATOMIC_RELAXED);
+    memset(pRing->Record, 0xFF, capacity * sizeof(FSCTelemetryRecord));
+    pRing->Version = FSC_TLM_VERSION;
+    pRing->RecordSize = sizeof(FSCTelemetryRecord);
+    pRing->Capacity = capacity;
+    pRing->Head = 0;
+    __atomic_store_n(&pRing->Magic, FSC_TLM_MAGIC, __ATOMIC_RELEASE);
+
+    m_TlmRing = pRing;
+    return 0;
+}
+
+/**
+ * @fn FSCTelemetryWrite
+ * @brief Appends a record to the ring, if it is open.
+ * @param[in] pRecord The record, Index is set by this function.
+ */
+void FSCTelemetryWrite(FSCTelemetryRecord *pRecord)
+{
+    FSCTelemetryRing *pRing = m_TlmRing;
+    FSCTelemetryRecord *pSlot = NULL;
+    INT32U head;
+
+    if (pRing == NULL)
+    {
+        return;
+    }
+
+    head = pRing->Head;
+    pSlot = &pRing->Record[head & (pRing->Capacity - 1)];
+
+    __atomic_store_n(&pSlot->Index, FSC_TLM_INDEX_BUSY, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    pRecord->Index = head;
+    memcpy((INT8U *)pSlot + sizeof(pSlot->Index), (const INT8U *)pRecord + sizeof(pRecord->Index),
+           sizeof(FSCTelemetryRecord) - sizeof(pRecord->Index));
+
+    __atomic_store_n(&pSlot->Index, head, __ATOMIC_RELEASE);
+    __atomic_store_n(&pRing->Head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @fn FSCTelemetryTime
+ * @return ms of CLOCK_MONOTONIC, wrapping every 49 days.
+ */
+INT32U FSCTelemetryTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (INT32U)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+/**
+ * @fn FSCTelemetryAttach
+ * @brief Maps the ring read only, for a reader process.
+ * @param[in] name Shared memory object, FSC_TLM_SHM_NAME.
+ * @return The ring, NULL if it does not exist or is not of this version.
+ */
+FSCTelemetryRing *FSCTelemetryAttach(const char *name)
+{
+    FSCTelemetryRing *pRing = NULL;
+    struct stat st;
+    int fd;
+
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FSCTelemetryRing))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    pRing = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pRing == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    if (__atomic_load_n(&pRing->Magic, __ATOMIC_ACQUIRE) != FSC_TLM_MAGIC ||
+        pRing->Version != FSC_TLM_VERSION || pRing->RecordSize != sizeof(FSCTelemetryRecord) ||
+        sizeof(FSCTelemetryRing) + (size_t)pRing->Capacity * sizeof(FSCTelemetryRecord) > (size_t)st.st_size)
+    {
+        munmap(pRing, st.st_size);
+        return NULL;
+    }
+
+    return pRing;
+}
+
+/**
+ * @fn FSCTelemetryHead
+ * @return Records written so far, the next one will have this index.
+ */
+INT32U FSCTelemetryHead(const FSCTelemetryRing *pRing)
+{
+    return __atomic_load_n(&pRing->Head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @fn FSCTelemetryRead
+ * @brief Copies a record out of the ring.
+ * @param[in] pRing The ring.
+ * @param[in] index Index of the record.
+ * @param[out] pRecord The record.
+ * @return 0 on success, -1 if it was overwritten or is being written.
+ */
+int FSCTelemetryRead(const FSCTelemetryRing *pRing, INT32U index, FSCTelemetryRecord *pRecord)
+{
+    const FSCTelemetryRecord *pSlot = &pRing->Record[index & (pRing->Capacity - 1)];
+
+    if (__atomic_load_n(&pSlot->Index, __ATOMIC_ACQUIRE) != index)
+    {
+        return -1;
+    }
+
+    memcpy(pRecord, pSlot, sizeof(FSCTelemetryRecord));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    if (__atomic_load_n(&pSlot->Index, __ATOMIC_RELAXED) != index)
+    {
+        return -1;
+    }
+
+    pRecord->Index = index;
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*************************************************************************
+ *
+ * fsc_telemetry.h
+ * Per cycle telemetry ring in shared memory
+ *
+ ************************************************************************/
+#ifndef FSC_TELEMETRY_H
+#define FSC_TELEMETRY_H
+
+#include "Types.h"
+#include "OEMFAN.h"
+
+#define FSC_TLM_SHM_NAME            "/fsc_telemetry"
+#define FSC_TLM_MAGIC               0x4D4C5446  // "FTLM"
+#define FSC_TLM_VERSION             1
+#define FSC_TLM_INDEX_BUSY          0xFFFFFFFF
+
+// Record types
+#define FSC_TLM_PROFILE             0       // One profile, written for every profile of a cycle
+#define FSC_TLM_CYCLE               1       // Cycle outputs, written after its profiles
+
+// Profile flags
+#define FSC_TLM_PRESENT             0x01    // Sensor present
+#define FSC_TLM_VALID               0x02    // Output used this cycle
+#define FSC_TLM_FILTERED            0x04    // Reading jumped too far, last PWM kept
+#define FSC_TLM_HYSTERESIS          0x08    // Falling hysteresis applied
+#define FSC_TLM_RATE_LIMITED        0x10    // PWM change limited
+#define FSC_TLM_CLAMP_MAX           0x20    // Clamped to the maximum PWM
+#define FSC_TLM_CLAMP_MIN           0x40    // Clamped to the minimum PWM
+#define FSC_TLM_REUSED              0x80    // Inputs unchanged, output of the computation before reused
+
+// Cycle flags
+#define FSC_TLM_BOOSTED             0x01    // Redundancy policy raised the trays
+#define FSC_TLM_RPM_CONTROL         0x02    // Trays driven by the RPM loop
+
+/*
+ * Not PACKED: the ring is shared between processes of the same build, and
+ * Index and Head are accessed atomically, so they stay naturally aligned.
+ */
+typedef struct
+{
+    INT32U Index;                           // Ring position, written last, ~0 while being written
+    INT32U Seq;                             // Control cycle
+    INT32U Time;                            // ms of CLOCK_MONOTONIC
+    INT8U  Type;                            // FSC_TLM_PROFILE or FSC_TLM_CYCLE
+    INT8U  Profile;                         // Profile index
+    INT8U  SensorNum;
+    INT8U  Flags;                           // FSC_TLM_* of the record type
+    INT16S Temp;                            // Reading used
+    INT16S LastTemp;                        // Reading of the cycle before
+    float  Ambient;                         // Inlet corrected for the fan heating, polynomial only
+    float  RawPWM;                          // PWM before hysteresis, rate limit and clamping
+    INT8U  PWM;                             // Profile PWM, or global PWM of a cycle
+    INT8U  TrayPWM[SYS_FAN_NUM_MAX];        // PWM written to each tray, cycle only
+} FSCTelemetryRecord;
+
+typedef struct
+{
+    INT32U Magic;                           // FSC_TLM_MAGIC
+    INT16U Version;                         // FSC_TLM_VERSION
+    INT16U RecordSize;                      // sizeof(FSCTelemetryRecord)
+    INT32U Capacity;                        // Records, a power of two
+    INT32U Head;                            // Records written since the ring was created
+    FSCTelemetryRecord Record[];
+} FSCTelemetryRing;
+
+extern int FSCTelemetryOpen(const char *name, INT32U records);
+extern void FSCTelemetryWrite(FSCTelemetryRecord *pRecord);
+extern INT32U FSCTelemetryTime(void);
+
+extern FSCTelemetryRing *FSCTelemetryAttach(const char *name);
+extern INT32U FSCTelemetryHead(const FSCTelemetryRing *pRing);
+extern int FSCTelemetryRead(const FSCTelemetryRing *pRing, INT32U index, FSCTelemetryRecord *pRecord);
+
+#endif // FSC_TELEMETRY_H
@@ -0,0 +1,311 @@
+/*************************************************************************
+ *
+ * fsc_thread.c
+ * Thread running the fan speed control loop
+ *
+ * The loop runs in its own thread, woken by a timerfd armed on absolute
+ * CLOCK_MONOTONIC deadlines, so the period neither drifts nor depends on
+ * how busy the IPMI tasks are. The thread can run SCHED_FIFO and be
+ * pinned to a core, on the AST2600 the second one. A cycle that ends past
+ * its next deadline does not cause back to back cycles, the missed
+ * deadlines are skipped and counted in the timing stats. The period
+ * adapts between the configured limits, see fsc_period.c.
+ *
+ ************************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE             // pthread_setaffinity_np, pthread_setname_np
+#endif
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "Types.h"
+#include "OEMDBG.h"
+#include "fsc.h"
+#include "fsc_parser.h"
+#include "fsc_timing.h"
+#include "fsc_period.h"
+
+// m_FscControlLock serializes FSCStart and FSCStop, m_FscThreadLock guards
+// the fields below and is never held while waiting for the thread
+static pthread_mutex_t m_FscControlLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t m_FscThreadLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t m_FscThread;
+static int m_FscThreadRunning = 0;
+static int m_FscStopFd = -1;
+static int m_FscBMCInst = 0;
+
+/**
+ * @fn FSCThreadSchedule
+ * @brief Applies the configured priority and CPU to the calling thread.
+ *        Fan control keeps running without them if they cannot be set.
+ */
+static void FSCThreadSchedule(void)
+{
+    struct sched_param param;
+    cpu_set_t cpus;
+    int err;
+
+    if (g_FscLoop.Priority > 0)
+    {
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = g_FscLoop.Priority;
+        err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0)
+        {
+            printf("FSC: Failed to set SCHED_FIFO priority %d: %s\n", g_FscLoop.Priority, strerror(err));
+        }
+    }
+
+    if (g_FscLoop.Cpu >= 0)
+    {
+        if (g_FscLoop.Cpu >= sysconf(_SC_NPROCESSORS_CONF))
+        {
+            printf("FSC: No CPU %d, thread not pinned\n", g_FscLoop.Cpu);
+            return;
+        }
+
+        CPU_ZERO(&cpus);
+        CPU_SET(g_FscLoop.Cpu, &cpus);
+        err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (err != 0)
+        {
+            printf("FSC: Failed to pin the thread to CPU %d: %s\n", g_FscLoop.Cpu, strerror(err));
+        }
+    }
+}
+
+/**
+ * @fn FSCThreadArm
+ * @brief Arms the timer for an absolute CLOCK_MONOTONIC time.
+ * @param[in] fd The timerfd.
+ * @param[in] deadline ns of CLOCK_MONOTONIC.
+ * @return 0 on success, -1 on failure.
+ */
+static int FSCThreadArm(int fd, INT64U deadline)
+{
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = deadline / 1000000000ull;
+    its.it_value.tv_nsec = deadline % 1000000000ull;
+
+    return timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/**
+ * @fn FSCThreadAbort
+ * @brief Marks the thread as no longer running when it gives up on its
+ *        own, so that FSCStart can start it again. Unless FSCStop is
+ *        already waiting for it, nobody joins the thread, it detaches.
+ */
+static void FSCThreadAbort(void)
+{
+    pthread_mutex_lock(&m_FscThreadLock);
+
+    if (m_FscThreadRunning)
+    {
+        close(m_FscStopFd);
+        m_FscStopFd = -1;
+        __atomic_store_n(&m_FscThreadRunning, 0, __ATOMIC_RELEASE);
+        pthread_detach(pthread_self());
+    }
+
+    pthread_mutex_unlock(&m_FscThreadLock);
+}
+
+/**
+ * @fn FSCThread
+ * @brief Runs a loop cycle every period until FSCStop.
+ *
+ * Priority and CPU are set from the 'loop' object before the first cycle,
+ * which loads the rest of the configuration. The thread ends if that
+ * cycle fails.
+ */
+static void *FSCThread(void *arg)
+{
+    struct pollfd fds[2];
+    INT64U deadline, period, now;
+    uint64_t expirations;
+    int timer_fd;
+
+    UN_USED(arg);
+
+    FSCLoadLoop();
+    FSCThreadSchedule();
+
+    if (0 != FSCLoopCycle(m_FscBMCInst))
+    {
+        FSCThreadAbort();
+        return NULL;
+    }
+    FSCPeriodNext(g_OEMDebugArray[OEM_DEBUG_Item_FSC]);
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (timer_fd < 0)
+    {
+        TCRIT("FSC: Failed to create the loop timer: %s\n", strerror(errno));
+        FSCThreadAbort();
+        return NULL;
+    }
+
+    fds[0].fd = timer_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_FscStopFd;
+    fds[1].events = POLLIN;
+
+    deadline = FSCTimingNow();
+
+    for (;;)
+    {
+        period = (INT64U)g_FscPeriodMs * 1000000ull;
+        deadline += period;
+
+        // Overran, skip the deadlines already past instead of catching up
+        now = FSCTimingNow();
+        if (deadline <= now)
+        {
+            deadline += ((now - deadline) / period + 1) * period;
+        }
+
+        if (0 != FSCThreadArm(timer_fd, deadline))
+        {
+            TCRIT("FSC: Failed to arm the loop timer: %s\n", strerror(errno));
+            FSCThreadAbort();
+            break;
+        }
+
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                // Wait again for the same deadline
+                deadline -= period;
+                continue;
+            }
+            TCRIT("FSC: Loop timer wait failed: %s\n", strerror(errno));
+            FSCThreadAbort();
+            break;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            break;
+        }
+
+        if (read(timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        {
+            continue;
+        }
+
+        FSCLoopCycle(m_FscBMCInst);
+        FSCPeriodNext(g_OEMDebugArray[OEM_DEBUG_Item_FSC]);
+    }
+
+    close(timer_fd);
+    return NULL;
+}
+
+/**
+ * @fn FSCStart
+ * @brief Starts the FSC thread, does nothing if it is running.
+ * @param[in] BMCInst The BMC instance number.
+ * @return 0 on success, -1 on failure.
+ */
+int FSCStart(int BMCInst)
+{
+    int err;
+    int ret = -1;
+
+    pthread_mutex_lock(&m_FscControlLock);
+    pthread_mutex_lock(&m_FscThreadLock);
+
+    if (m_FscThreadRunning)
+    {
+        ret = 0;
+        goto END;
+    }
+
+    m_FscStopFd = eventfd(0, EFD_CLOEXEC);
+    if (m_FscStopFd < 0)
+    {
+        TCRIT("FSC: Failed to create the stop event: %s\n", strerror(errno));
+        goto END;
+    }
+
+    m_FscBMCInst = BMCInst;
+    err = pthread_create(&m_FscThread, NULL, FSCThread, NULL);
+    if (err != 0)
+    {
+        TCRIT("FSC: Failed to create the FSC thread: %s\n", strerror(err));
+        close(m_FscStopFd);
+        m_FscStopFd = -1;
+        goto END;
+    }
+
+    pthread_setname_np(m_FscThread, "fsc");
+    __atomic_store_n(&m_FscThreadRunning, 1, __ATOMIC_RELEASE);
+    ret = 0;
+
+END:
+    pthread_mutex_unlock(&m_FscThreadLock);
+    pthread_mutex_unlock(&m_FscControlLock);
+    return ret;
+}
+
+/**
+ * @fn FSCThreadRunning
+ * @brief Tells whether the FSC thread owns the loop.
+ * @return 1 if it runs, 0 otherwise.
+ */
+int FSCThreadRunning(void)
+{
+    return __atomic_load_n(&m_FscThreadRunning, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @fn FSCStop
+ * @brief Stops the FSC thread and waits for the cycle in progress, the
+ *        fans keep the last PWM written.
+ */
+void FSCStop(void)
+{
+    uint64_t one = 1;
+    pthread_t thread;
+    int stop_fd = -1;
+
+    pthread_mutex_lock(&m_FscControlLock);
+    pthread_mutex_lock(&m_FscThreadLock);
+
+    if (m_FscThreadRunning)
+    {
+        if (write(m_FscStopFd, &one, sizeof(one)) == sizeof(one))
+        {
+            thread = m_FscThread;
+            stop_fd = m_FscStopFd;
+            m_FscStopFd = -1;
+            __atomic_store_n(&m_FscThreadRunning, 0, __ATOMIC_RELEASE);
+        }
+        else
+        {
+            TCRIT("FSC: Failed to stop the FSC thread: %s\n", strerror(errno));
+        }
+    }
+
+    pthread_mutex_unlock(&m_FscThreadLock);
+
+    if (stop_fd >= 0)
+    {
+        pthread_join(thread, NULL);
+        close(stop_fd);
+    }
+
+    pthread_mutex_unlock(&m_FscControlLock);
+}
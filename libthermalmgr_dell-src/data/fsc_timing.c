@@ -0,0 +1,461 @@
+/*************************************************************************
+ *
+ * fsc_timing.c
+ * Control loop stage timing, period jitter and missed deadlines
+ *
+ * Every cycle is timed with CLOCK_MONOTONIC, stage by stage, and folded
+ * into log2 histograms kept in POSIX shared memory, so 'fsc_tlm -t' can
+ * show at any time whether the loop keeps its period. Sensor reads are
+ * spread over the compute stage, they are timed where they are made and
+ * moved from compute to fetch. The block also counts the profile
+ * computations and fan tray writes the loop could skip.
+ *
+ ************************************************************************/
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Types.h"
+#include "fsc_timing.h"
+
+static const char *m_StageName[FSC_STAGE_NUM] =
+{
+    "fetch", "compute", "actuate", "diag", "cycle",
+};
+
+// Kept here when the shared memory cannot be created
+static FSCTimingStats m_LocalStats;
+static FSCTimingStats *m_pStats = NULL;
+
+static INT64U m_CycleStart = 0;
+static INT64U m_LastStart = 0;
+static INT64U m_LastMark = 0;
+static INT64U m_FetchNs = 0;
+static INT64U m_StageNs[FSC_STAGE_NUM];
+static INT32U m_ProfileComputed = 0;
+static INT32U m_ProfileReused = 0;
+static INT32U m_TrayWritten = 0;
+static INT32U m_TraySkipped = 0;
+
+/**
+ * @fn FSCTimingNow
+ * @return ns of CLOCK_MONOTONIC.
+ */
+INT64U FSCTimingNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (INT64U)ts.tv_sec * 1000000000ull + (INT64U)ts.tv_nsec;
+}
+
+static void FSCHistogramAdd(FSCHistogram *pHist, INT64U us)
+{
+    INT32U value = (us > 0xFFFFFFFFull) ? 0xFFFFFFFF : (INT32U)us;
+    int bucket = 0;
+
+    if (value >= 2)
+    {
+        bucket = 31 - __builtin_clz(value);
+        if (bucket >= FSC_TIMING_BUCKETS)
+        {
+            bucket = FSC_TIMING_BUCKETS - 1;
+        }
+    }
+
+    if (pHist->Count == 0 || value < pHist->Min)
+    {
+        pHist->Min = value;
+    }
+    if (value > pHist->Max)
+    {
+        pHist->Max = value;
+    }
+    pHist->Count++;
+    pHist->Sum += value;
+    pHist->Bucket[bucket]++;
+}
+
+/**
+ * @fn FSCHistogramPercentile
+ * @return Upper bound in us of the bucket holding a percentile.
+ */
+static INT32U FSCHistogramPercentile(const FSCHistogram *pHist, INT32U pct)
+{
+    INT64U rank = ((INT64U)pHist->Count * pct + 99) / 100;
+    INT64U seen = 0;
+    int b;
+
+    for (b = 0; b < FSC_TIMING_BUCKETS; b++)
+    {
+        seen += pHist->Bucket[b];
+        if (seen >= rank && seen > 0)
+        {
+            return (b == FSC_TIMING_BUCKETS - 1 || (2u << b) - 1 > pHist->Max) ? pHist->Max : (2u << b) - 1;
+        }
+    }
+
+    return pHist->Max;
+}
+
+/**
+ * @fn FSCTimingOpen
+ * @brief Creates, or resets, the stats block.
+ * @param[in] period_us Period the loop is expected to run at.
+ * @param[in] late_us Lateness of a cycle start that counts as a missed deadline.
+ */
+void FSCTimingOpen(INT32U period_us, INT32U late_us)
+{
+    FSCTimingStats *pStats = NULL;
+    int fd;
+
+    if (m_pStats == NULL)
+    {
+        fd = shm_open(FSC_TIMING_SHM_NAME, O_CREAT | O_RDWR, 0644);
+        if (fd >= 0)
+        {
+            if (ftruncate(fd, sizeof(FSCTimingStats)) == 0)
+            {
+                pStats = mmap(NULL, sizeof(FSCTimingStats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            close(fd);
+        }
+
+        if (pStats == NULL || pStats == MAP_FAILED)
+        {
+            printf("FSC: Failed to create the timing stats %s.\n", FSC_TIMING_SHM_NAME);
+            pStats = &m_LocalStats;
+        }
+        m_pStats = pStats;
+    }
+
+    pStats = m_pStats;
+    __atomic_store_n(&pStats->Magic, 0, __ATOMIC_RELAXED);
+    memset(pStats, 0, sizeof(FSCTimingStats));
+    pStats->Version = FSC_TIMING_VERSION;
+    pStats->Size = sizeof(FSCTimingStats);
+    pStats->PeriodUs = period_us;
+    pStats->LateUs = late_us;
+    __atomic_store_n(&pStats->Magic, FSC_TIMING_MAGIC, __ATOMIC_RELEASE);
+
+    m_LastStart = 0;
+}
+
+/**
+ * @fn FSCTimingCycleBegin
+ * @brief Starts timing a cycle, first thing in FanControlLoop.
+ */
+void FSCTimingCycleBegin(void)
+{
+    m_CycleStart = FSCTimingNow();
+    m_LastMark = m_CycleStart;
+    m_FetchNs = 0;
+    memset(m_StageNs, 0, sizeof(m_StageNs));
+    m_ProfileComputed = 0;
+    m_ProfileReused = 0;
+    m_TrayWritten = 0;
+    m_TraySkipped = 0;
+}
+
+/**
+ * @fn FSCTimingCountProfile
+ * @brief Counts a profile output of the cycle.
+ * @param[in] reused 1 if last cycle's output was reused, 0 if computed.
+ */
+void FSCTimingCountProfile(INT8U reused)
+{
+    if (reused)
+    {
+        m_ProfileReused++;
+    }
+    else
+    {
+        m_ProfileComputed++;
+    }
+}
+
+/**
+ * @fn FSCTimingCountTrays
+ * @brief Counts the fan tray writes of the cycle.
+ * @param[in] written Trays written.
+ * @param[in] skipped Trays not written, their PWM was already set.
+ */
+void FSCTimingCountTrays(INT8U written, INT8U skipped)
+{
+    m_TrayWritten += written;
+    m_TraySkipped += skipped;
+}
+
+/**
+ * @fn FSCTimingAddFetch
+ * @brief Accounts a sensor or fan tray read to the fetch stage.
+ * @param[in] ns Time the read took.
+ */
+void FSCTimingAddFetch(INT64U ns)
+{
+    m_FetchNs += ns;
+}
+
+/**
+ * @fn FSCTimingMark
+ * @brief Ends a stage, which ran from the previous mark. Reads made
+ *        during the stage are accounted to fetch instead.
+ * @param[in] stage FSC_STAGE_* that just ended.
+ */
+void FSCTimingMark(INT8U stage)
+{
+    INT64U now = FSCTimingNow();
+    INT64U ns = now - m_LastMark;
+
+    if (stage < FSC_STAGE_NUM)
+    {
+        ns = (ns > m_FetchNs) ? ns - m_FetchNs : 0;
+        m_StageNs[stage] += ns;
+        m_StageNs[FSC_STAGE_FETCH] += m_FetchNs;
+    }
+
+    m_FetchNs = 0;
+    m_LastMark = now;
+}
+
+/**
+ * @fn FSCTimingCycleEnd
+ * @brief Folds the cycle into the stats, last thing in FanControlLoop.
+ * @param[in] verbose Verbosity level, the stats are printed now and then above 0.
+ */
+void FSCTimingCycleEnd(INT8U verbose)
+{
+    FSCTimingStats *pStats = m_pStats;
+    INT64U period_ns = 0;
+    INT64U jitter_ns;
+    INT64U cycle_ns;
+    int i;
+
+    if (pStats == NULL)
+    {
+        return;
+    }
+
+    cycle_ns = FSCTimingNow() - m_CycleStart;
+    m_StageNs[FSC_STAGE_CYCLE] = cycle_ns;
+    if (m_LastStart != 0)
+    {
+        period_ns = m_CycleStart - m_LastStart;
+    }
+    m_LastStart = m_CycleStart;
+
+    __atomic_store_n(&pStats->Seq, pStats->Seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    pStats->Cycles++;
+    for (i = 0; i < FSC_STAGE_NUM; i++)
+    {
+        FSCHistogramAdd(&pStats->Stage[i], m_StageNs[i] / 1000);
+    }
+
+    if (period_ns != 0)
+    {
+        jitter_ns = (period_ns > (INT64U)pStats->PeriodUs * 1000) ? period_ns - (INT64U)pStats->PeriodUs * 1000
+                                                                 : (INT64U)pStats->PeriodUs * 1000 - period_ns;
+        FSCHistogramAdd(&pStats->Period, period_ns / 1000);
+        FSCHistogramAdd(&pStats->Jitter, jitter_ns / 1000);
+
+        if (period_ns > ((INT64U)pStats->PeriodUs + pStats->LateUs) * 1000)
+        {
+            pStats->Missed++;
+        }
+    }
+
+    if (cycle_ns > (INT64U)pStats->PeriodUs * 1000)
+    {
+        pStats->Overrun++;
+    }
+
+    pStats->ProfileComputed += m_ProfileComputed;
+    pStats->ProfileReused += m_ProfileReused;
+    pStats->TrayWritten += m_TrayWritten;
+    pStats->TraySkipped += m_TraySkipped;
+    if (m_TrayWritten == 0)
+    {
+        pStats->ActuateSkipped++;
+    }
+
+    __atomic_store_n(&pStats->Seq, pStats->Seq + 1, __ATOMIC_RELEASE);
+
+    if (verbose > 0 && pStats->Cycles % FSC_TIMING_DUMP_CYCLES == 0)
+    {
+        FSCTimingDump(pStats, stdout);
+    }
+}
+
+/**
+ * @fn FSCTimingSetPeriod
+ * @brief Sets the period the next cycle is due after, when it adapts.
+ * @param[in] period_us The period.
+ */
+void FSCTimingSetPeriod(INT32U period_us)
+{
+    FSCTimingStats *pStats = m_pStats;
+
+    if (pStats == NULL || pStats->PeriodUs == period_us)
+    {
+        return;
+    }
+
+    __atomic_store_n(&pStats->Seq, pStats->Seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    pStats->PeriodUs = period_us;
+    __atomic_store_n(&pStats->Seq, pStats->Seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @fn FSCTimingAttach
+ * @brief Maps the stats block read only, for a reader process.
+ * @return The stats, NULL if they do not exist or are not of this version.
+ */
+const FSCTimingStats *FSCTimingAttach(const char *name)
+{
+    FSCTimingStats *pStats = NULL;
+    struct stat st;
+    int fd;
+
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FSCTimingStats))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    pStats = mmap(NULL, sizeof(FSCTimingStats), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pStats == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    if (__atomic_load_n(&pStats->Magic, __ATOMIC_ACQUIRE) != FSC_TIMING_MAGIC ||
+        pStats->Version != FSC_TIMING_VERSION || pStats->Size != sizeof(FSCTimingStats))
+    {
+        munmap(pStats, sizeof(FSCTimingStats));
+        return NULL;
+    }
+
+    return pStats;
+}
+
+/**
+ * @fn FSCTimingCopy
+ * @brief Takes a consistent copy of the stats while the loop runs.
+ * @return 0 on success, -1 if the loop kept updating them.
+ */
+int FSCTimingCopy(const FSCTimingStats *pStats, FSCTimingStats *pCopy)
+{
+    INT32U seq;
+    int retry;
+
+    for (retry = 0; retry < 100; retry++)
+    {
+        seq = __atomic_load_n(&pStats->Seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+        {
+            usleep(100);
+            continue;
+        }
+
+        memcpy(pCopy, pStats, sizeof(FSCTimingStats));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&pStats->Seq, __ATOMIC_RELAXED) == seq)
+        {
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @fn FSCTimingPercent
+ * @return Share of part in part + other in percent, 0 if both are 0.
+ */
+static double FSCTimingPercent(INT32U part, INT32U other)
+{
+    INT64U total = (INT64U)part + other;
+
+    return total ? 100.0 * part / total : 0;
+}
+
+static void FSCTimingDumpHistogram(const char *name, const FSCHistogram *pHist, FILE *out)
+{
+    if (pHist->Count == 0)
+    {
+        fprintf(out, "%-8s %10u\n", name, 0);
+        return;
+    }
+
+    fprintf(out, "%-8s %10u %10u %10llu %10u %10u %10u\n", name, pHist->Count, pHist->Min,
+            (unsigned long long)(pHist->Sum / pHist->Count), FSCHistogramPercentile(pHist, 50),
+            FSCHistogramPercentile(pHist, 99), pHist->Max);
+}
+
+/**
+ * @fn FSCTimingDump
+ * @brief Prints the stats, with percentiles to the resolution of the buckets.
+ */
+void FSCTimingDump(const FSCTimingStats *pStats, FILE *out)
+{
+    int i, b;
+
+    fprintf(out, "FSC timing: %u cycles, period %u ms, %u missed deadlines (> %u ms late), %u overruns\n",
+            pStats->Cycles, pStats->PeriodUs / 1000, pStats->Missed, pStats->LateUs / 1000, pStats->Overrun);
+    fprintf(out, "Profiles reused: %.1f %% (%u of %u), tray writes skipped: %.1f %% (%u of %u), %u cycles without actuation\n",
+            FSCTimingPercent(pStats->ProfileReused, pStats->ProfileComputed), pStats->ProfileReused,
+            pStats->ProfileReused + pStats->ProfileComputed,
+            FSCTimingPercent(pStats->TraySkipped, pStats->TrayWritten), pStats->TraySkipped,
+            pStats->TraySkipped + pStats->TrayWritten, pStats->ActuateSkipped);
+    fprintf(out, "%-8s %10s %10s %10s %10s %10s %10s\n", "us", "count", "min", "mean", "p50<=", "p99<=", "max");
+
+    for (i = 0; i < FSC_STAGE_NUM; i++)
+    {
+        FSCTimingDumpHistogram(m_StageName[i], &pStats->Stage[i], out);
+    }
+    FSCTimingDumpHistogram("period", &pStats->Period, out);
+    FSCTimingDumpHistogram("jitter", &pStats->Jitter, out);
+
+    fprintf(out, "%-8s", "bucket");
+    for (i = 0; i < FSC_STAGE_NUM; i++)
+    {
+        fprintf(out, " %8s", m_StageName[i]);
+    }
+    fprintf(out, " %8s %8s\n", "period", "jitter");
+
+    for (b = 0; b < FSC_TIMING_BUCKETS; b++)
+    {
+        INT32U any = pStats->Period.Bucket[b] | pStats->Jitter.Bucket[b];
+
+        for (i = 0; i < FSC_STAGE_NUM; i++)
+        {
+            any |= pStats->Stage[i].Bucket[b];
+        }
+        if (!any)
+        {
+            continue;
+        }
+
+        fprintf(out, "<%-7u", 2u << b);
+        for (i = 0; i < FSC_STAGE_NUM; i++)
+        {
+            fprintf(out, " %8u", pStats->Stage[i].Bucket[b]);
+        }
+        fprintf(out, " %8u %8u\n", pStats->Period.Bucket[b], pStats->Jitter.Bucket[b]);
+    }
+}
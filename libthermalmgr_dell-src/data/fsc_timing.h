@@ -0,0 +1,81 @@
+/*************************************************************************
+ *
+ * fsc_timing.h
+ * Control loop stage timing, period jitter and missed deadlines
+ *
+ ************************************************************************/
+#ifndef FSC_TIMING_H
+#define FSC_TIMING_H
+
+#include <stdio.h>
+
+#include "Types.h"
+
+#define FSC_TIMING_SHM_NAME         "/fsc_timing"
+#define FSC_TIMING_MAGIC            0x4D495446  // "FTIM"
+#define FSC_TIMING_VERSION          2
+
+// Bucket b counts [2^b, 2^(b+1)) us, bucket 0 also 0 and 1 us, the last
+// one everything from 2^(FSC_TIMING_BUCKETS-1) us (8.4 s)
+#define FSC_TIMING_BUCKETS          24
+
+// Stages of a cycle
+#define FSC_STAGE_FETCH             0       // Sensor and fan tray reads
+#define FSC_STAGE_COMPUTE           1       // Profiles, zones, fan health, redundancy and RPM loop
+#define FSC_STAGE_ACTUATE           2       // Fan tray PWM writes
+#define FSC_STAGE_DIAG              3       // Recording and telemetry
+#define FSC_STAGE_CYCLE             4       // Whole cycle
+#define FSC_STAGE_NUM               5
+
+// With the FSC debug item on, the stats are printed every this many cycles
+#define FSC_TIMING_DUMP_CYCLES      60
+
+typedef struct
+{
+    INT32U Count;
+    INT32U Min;                             // us
+    INT32U Max;                             // us
+    INT64U Sum;                             // us
+    INT32U Bucket[FSC_TIMING_BUCKETS];
+} FSCHistogram;
+
+/*
+ * Not PACKED, Seq is accessed atomically. The loop is the only writer,
+ * readers copy the block and retry while Seq is odd or has changed.
+ */
+typedef struct
+{
+    INT32U Magic;                           // FSC_TIMING_MAGIC
+    INT16U Version;                         // FSC_TIMING_VERSION
+    INT16U Size;                            // sizeof(FSCTimingStats)
+    INT32U Seq;                             // Odd while the loop updates the block
+    INT32U PeriodUs;                        // Period the next cycle is due after
+    INT32U LateUs;                          // Start later than this past its due time is a missed deadline
+    INT32U Cycles;
+    INT32U Missed;                          // Cycles that started past their deadline
+    INT32U Overrun;                         // Cycles that ran longer than the period
+    INT32U ProfileComputed;                 // Profile outputs computed
+    INT32U ProfileReused;                   // Profile outputs reused, inputs unchanged
+    INT32U TrayWritten;                     // Fan tray PWM writes
+    INT32U TraySkipped;                     // Fan tray PWM writes skipped, PWM unchanged
+    INT32U ActuateSkipped;                  // Cycles that wrote no tray at all
+    FSCHistogram Stage[FSC_STAGE_NUM];      // Run time of each stage
+    FSCHistogram Period;                    // Start to start
+    FSCHistogram Jitter;                    // Distance of the start to start time from the period it was due after
+} FSCTimingStats;
+
+extern INT64U FSCTimingNow(void);
+extern void FSCTimingOpen(INT32U period_us, INT32U late_us);
+extern void FSCTimingCycleBegin(void);
+extern void FSCTimingAddFetch(INT64U ns);
+extern void FSCTimingMark(INT8U stage);
+extern void FSCTimingCycleEnd(INT8U verbose);
+extern void FSCTimingSetPeriod(INT32U period_us);
+extern void FSCTimingCountProfile(INT8U reused);
+extern void FSCTimingCountTrays(INT8U written, INT8U skipped);
+
+extern const FSCTimingStats *FSCTimingAttach(const char *name);
+extern int FSCTimingCopy(const FSCTimingStats *pStats, FSCTimingStats *pCopy);
+extern void FSCTimingDump(const FSCTimingStats *pStats, FILE *out);
+
+#endif // FSC_TIMING_H
@@ -3,15 +3,26 @@
 
 #include <stdio.h>
 
-#define     FSC_DEBUG
+// Set by the build: FSC_DEBUG for the debug prints, FSC_TRACE on top of
+// it for the per-cycle ones, which the telemetry ring otherwise carries
 #ifdef      FSC_DEBUG
 #define     FSCPRINT(fmt,...) printf((const char*)"[%15s-%30s:%04d] "fmt,__FILE__,__func__,__LINE__, ##__VA_ARGS__)
 #else
 #define     FSCPRINT(fmt,...)
 #endif
+#if         defined(FSC_DEBUG) && defined(FSC_TRACE)
+#define     FSCTRACE(fmt,...) FSCPRINT(fmt, ##__VA_ARGS__)
+#else
+#define     FSCTRACE(fmt,...)
+#endif
 
+// Host builds such as the simulator point these elsewhere
+#ifndef     FSC_CONF_B2F_FILE
 #define     FSC_CONF_B2F_FILE    "/conf/fsc/fsc_z9964f_b2f.json"
+#endif
+#ifndef     FSC_CONF_F2B_FILE
 #define     FSC_CONF_F2B_FILE    "/conf/fsc/fsc_z9964f_f2b.json"
+#endif
 #define     FSC_CONF_LIQUID_FILE "/conf/fsc/fsc_z9964fl.json"
 
 #endif // FSC_UTILS_H
\ No newline at end of file
@@ -0,0 +1,104 @@
+/*************************************************************************
+ *
+ * fsc_zone.c
+ * Thermal zones, mapping profiles to the fan trays that cool them
+ *
+ ************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "fsc.h"
+#include "fsc_parser.h"
+#include "fsc_utils.h"
+#include "fsc_core.h"
+#include "fsc_aggregate.h"
+#include "fsc_zone.h"
+
+FSCZoneState g_FscZoneState[FSC_ZONE_MAX];
+
+/**
+ * @fn FSCZoneOutputPWM
+ * @brief Spreads the profile outputs of this cycle over the fan trays.
+ *
+ * Every zone combines the valid outputs of its profiles with its own
+ * aggregation, in one pass over the profiles. A zone none of whose
+ * profiles has a valid output asks for the global output, so a zone
+ * whose sensors are all unreadable is never left cooled below the rest
+ * of the system. A tray in several zones follows the highest of them.
+ * Trays in no zone, and every tray when 'zone_info' is not configured,
+ * get the global output. Call after FSCUpdateOutputPWM.
+ * @param[in] global_pwm Aggregated output of all profiles.
+ * @param[out] tray_pwm PWM for each of the SYS_FAN_NUM_MAX trays.
+ * @param[in] verbose Verbosity level for debug printing.
+ */
+void FSCZoneOutputPWM(INT8U global_pwm, INT8U *tray_pwm, INT8U verbose)
+{
+    const FSC_JSON_ZONE_INFO *pZone = NULL;
+    FSCZoneState *pState = NULL;
+    FSCAggregator agg[FSC_ZONE_MAX];
+    INT8U zone_num = g_FscZoneInfo.TotalZoneNum;
+    INT8U covered = 0;
+    int i, j;
+
+    if (zone_num == 0)
+    {
+        memset(tray_pwm, global_pwm, SYS_FAN_NUM_MAX);
+        return;
+    }
+
+    for (i = 0; i < zone_num; i++)
+    {
+        FSCAggregateInit(&agg[i], &g_FscZoneInfo.ZoneInfo[i].Aggregation);
+    }
+
+    for (j = 0; j < g_FscProfileInfo.TotalProfileNum; j++)
+    {
+        if (!pFSCTempSensorInfo[j].OutputValid)
+        {
+            continue;
+        }
+
+        for (i = 0; i < zone_num; i++)
+        {
+            if (g_FscZoneInfo.ZoneInfo[i].ProfileMask & ((INT32U)1 << j))
+            {
+                FSCAggregateAdd(&agg[i], pFSCTempSensorInfo[j].CurrentPWM, g_FscProfileInfo.ProfileInfo[j].Weight);
+            }
+        }
+    }
+
+    memset(tray_pwm, 0, SYS_FAN_NUM_MAX);
+
+    for (i = 0; i < zone_num; i++)
+    {
+        pZone = &g_FscZoneInfo.ZoneInfo[i];
+        pState = &g_FscZoneState[i];
+        pState->ValidNum = agg[i].Num;
+        pState->OutputPWM = FSCAggregateResult(&agg[i], global_pwm);
+
+        for (j = 0; j < SYS_FAN_NUM_MAX; j++)
+        {
+            if ((pZone->FanMask & (1 << j)) && pState->OutputPWM > tray_pwm[j])
+            {
+                tray_pwm[j] = pState->OutputPWM;
+            }
+        }
+        covered |= pZone->FanMask;
+
+        if (verbose > 0)
+        {
+            FSCTRACE("Zone %d (%s) PWM = %d, %d valid profiles\n",
+                     pZone->ZoneIndex, pZone->Label, pState->OutputPWM, pState->ValidNum);
+        }
+    }
+
+    for (j = 0; j < SYS_FAN_NUM_MAX; j++)
+    {
+        if (!(covered & (1 << j)))
+        {
+            tray_pwm[j] = global_pwm;
+        }
+    }
+}
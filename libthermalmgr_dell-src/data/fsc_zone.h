@@ -0,0 +1,25 @@
+/*************************************************************************
+ *
+ * fsc_zone.h
+ * Thermal zones, mapping profiles to the fan trays that cool them
+ *
+ ************************************************************************/
+#ifndef FSC_ZONE_H
+#define FSC_ZONE_H
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "fsc.h"
+#include "fsc_parser.h"
+
+typedef struct
+{
+    INT8U  OutputPWM;                       // PWM the zone asked for on the last cycle
+    INT8U  ValidNum;                        // Profiles of the zone with a valid output
+} PACKED FSCZoneState;
+
+extern FSCZoneState g_FscZoneState[FSC_ZONE_MAX];
+
+extern void FSCZoneOutputPWM(INT8U global_pwm, INT8U *tray_pwm, INT8U verbose);
+
+#endif // FSC_ZONE_H
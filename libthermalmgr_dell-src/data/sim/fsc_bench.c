@@ -0,0 +1,509 @@
+/*************************************************************************
+ *
+ * fsc_bench.c
+ * Microbenchmarks of the per cycle FSC computations
+ *
+ * Every benchmark calls one FSC function over a large synthetic input
+ * set, generated from a fixed seed so runs are comparable, and reports
+ * the median and fastest ns per call over several repetitions. On hosts
+ * that allow perf_event_open, instructions and cache misses per call
+ * are counted as well, otherwise they are reported as null.
+ *
+ *   fsc_bench [-c <fsc config>] [-n <calls>] [-r <repetitions>]
+ *             [-b <benchmark>] [-o <output>]
+ *
+ * Results are written as one JSON object per benchmark and line to stdout
+ * or the -o file, so they can be kept and compared between builds. Output
+ * of the FSC itself goes to stderr. The full control cycle needs
+ * a config, it is skipped without -c.
+ *
+ ************************************************************************/
+#include <errno.h>
+#include <getopt.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "fsc.h"
+#include "fsc_core.h"
+#include "fsc_parser.h"
+#include "sim_plant.h"
+#include "sim_bmc.h"
+
+// Sensor states cycled through, large enough to leave the L1 cache
+#define BENCH_SENSOR_NUM        4096
+
+// Temperature readings cycled through
+#define BENCH_INPUT_NUM         (1 << 20)
+
+#define BENCH_REP_MAX           32
+
+#define BENCH_COUNTER_NUM       2
+
+typedef struct
+{
+    const char *Name;
+    void (*Setup)(void);
+    void (*Run)(long calls);
+    INT8U NeedConfig;
+} FSCBench;
+
+typedef struct
+{
+    int    Fd[BENCH_COUNTER_NUM];
+    INT8U  Valid;
+} BenchCounters;
+
+static FSCTempSensor *m_BenchSensor = NULL;
+static INT16S *m_BenchInput = NULL;
+static INT8U *m_BenchPWM = NULL;
+static volatile INT32U m_BenchSink;
+
+/**
+ * @fn BenchRandom
+ * @return Next value of a fixed seed LCG, so inputs are the same every run.
+ */
+static INT32U BenchRandom(void)
+{
+    static INT32U state = 2463534242u;
+
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+/**
+ * @fn BenchNow
+ * @return CLOCK_MONOTONIC in ns.
+ */
+static INT64U BenchNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (INT64U)ts.tv_sec * 1000000000ull + (INT64U)ts.tv_nsec;
+}
+
+/**
+ * @fn BenchCountersOpen
+ * @brief Opens an instructions / cache misses group for this thread.
+ */
+static void BenchCountersOpen(BenchCounters *pCounters)
+{
+    static const INT32U config[BENCH_COUNTER_NUM] =
+    {
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+    };
+    struct perf_event_attr attr;
+    int i;
+
+    pCounters->Valid = 1;
+    for (i = 0; i < BENCH_COUNTER_NUM; i++)
+    {
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config[i];
+        attr.disabled = (i == 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        pCounters->Fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, (i == 0) ? -1 : pCounters->Fd[0], 0);
+        if (pCounters->Fd[i] < 0)
+        {
+            pCounters->Valid = 0;
+        }
+    }
+}
+
+static void BenchCountersClose(BenchCounters *pCounters)
+{
+    int i;
+
+    for (i = 0; i < BENCH_COUNTER_NUM; i++)
+    {
+        if (pCounters->Fd[i] >= 0)
+        {
+            close(pCounters->Fd[i]);
+        }
+    }
+}
+
+static void BenchCountersStart(const BenchCounters *pCounters)
+{
+    if (pCounters->Valid)
+    {
+        ioctl(pCounters->Fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(pCounters->Fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+/**
+ * @fn BenchCountersStop
+ * @return 0 with the counts in value, -1 if they are not available.
+ */
+static int BenchCountersStop(const BenchCounters *pCounters, INT64U *value)
+{
+    INT64U data[1 + BENCH_COUNTER_NUM];
+
+    if (!pCounters->Valid)
+    {
+        return -1;
+    }
+
+    ioctl(pCounters->Fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    if (read(pCounters->Fd[0], data, sizeof(data)) != (ssize_t)sizeof(data) || data[0] != BENCH_COUNTER_NUM)
+    {
+        return -1;
+    }
+
+    memcpy(value, &data[1], sizeof(INT64U) * BENCH_COUNTER_NUM);
+    return 0;
+}
+
+/**
+ * @fn BenchSetupSensors
+ * @brief Fills the sensor states and a random walk of readings.
+ */
+static void BenchSetupSensors(INT8U algorithm, INT8U curve_type)
+{
+    FSCTempSensor *pSensor = NULL;
+    FSCPolynomial *pCurve = NULL;
+    INT16S temp = 60;
+    long i;
+    int j;
+
+    memset(m_BenchSensor, 0, sizeof(FSCTempSensor) * BENCH_SENSOR_NUM);
+
+    for (i = 0; i < BENCH_SENSOR_NUM; i++)
+    {
+        pSensor = &m_BenchSensor[i];
+        pSensor->Present = 1;
+        pSensor->MinPWM = 20;
+        pSensor->MaxPWM = 100;
+        pSensor->Algorithm = algorithm;
+        pSensor->LastTemp = 60;
+        pSensor->LastLastTemp = 60;
+        pSensor->LastPWM = 40;
+        snprintf(pSensor->Label, sizeof(pSensor->Label), "bench %ld", i);
+
+        if (algorithm == FSC_CTL_PID)
+        {
+            pSensor->fscparam.pidparam.Pvalue = 2.5f;
+            pSensor->fscparam.pidparam.Ivalue = 0.15f;
+            pSensor->fscparam.pidparam.Dvalue = 0.2f;
+            pSensor->fscparam.pidparam.SetPoint = 85;
+            continue;
+        }
+
+        pCurve = &pSensor->fscparam.ambientbaseparam;
+        pCurve->CurveType = curve_type;
+        pCurve->CoeffCount = MAX_POLYNOMIAL_COEFFS;
+        pCurve->Coefficients[0] = 10;
+        pCurve->Coefficients[1] = 0.8f;
+        pCurve->Coefficients[2] = 0.02f;
+        pCurve->Coefficients[3] = 0.0002f;
+        pCurve->PointCount = MAX_PIECEWISE_POINTS;
+        for (j = 0; j < MAX_PIECEWISE_POINTS; j++)
+        {
+            pCurve->PiecewisePoints[j].temp = (INT8U)(15 + j * 4);
+            pCurve->PiecewisePoints[j].pwm = (INT8U)(25 + j * 8);
+        }
+        pCurve->FallingHyst = 2;
+        pCurve->MaxRisingRate = 10;
+        pCurve->MaxFallingRate = 5;
+    }
+
+    for (i = 0; i < BENCH_INPUT_NUM; i++)
+    {
+        temp += (INT16S)(BenchRandom() % 7) - 3;
+        if (temp < 15)
+            temp = 15;
+        if (temp > 110)
+            temp = 110;
+        m_BenchInput[i] = temp;
+        m_BenchPWM[i] = (INT8U)(BenchRandom() % 101);
+    }
+}
+
+/**
+ * @fn BenchSetupCalibration
+ * @brief Sets a four coefficient or ten point ambient calibration.
+ */
+static void BenchSetupCalibration(INT8U cal_type)
+{
+    int j;
+
+    memset(&g_AmbientCalibration, 0, sizeof(g_AmbientCalibration));
+    g_AmbientCalibration.CalType = cal_type;
+    g_AmbientCalibration.CoeffCount = MAX_POLYNOMIAL_COEFFS;
+    g_AmbientCalibration.Coefficients[0] = 1.5f;
+    g_AmbientCalibration.Coefficients[1] = 0.05f;
+    g_AmbientCalibration.Coefficients[2] = -0.0003f;
+    g_AmbientCalibration.Coefficients[3] = 0.000001f;
+    g_AmbientCalibration.PointCount = MAX_PIECEWISE_POINTS;
+    for (j = 0; j < MAX_PIECEWISE_POINTS; j++)
+    {
+        g_AmbientCalibration.PiecewisePoints[j].pwm = (INT8U)(j * 11);
+        g_AmbientCalibration.PiecewisePoints[j].delta_temp = 6.0f - j * 0.5f;
+    }
+}
+
+static void BenchSetupPID(void)
+{
+    BenchSetupCalibration(FSC_AMBIENT_CAL_POLYNOMIAL);
+    BenchSetupSensors(FSC_CTL_PID, 0);
+}
+
+static void BenchSetupPolynomial(void)
+{
+    BenchSetupCalibration(FSC_AMBIENT_CAL_POLYNOMIAL);
+    BenchSetupSensors(FSC_CTL_POLYNOMIAL, FSC_AMBIENT_CAL_POLYNOMIAL);
+}
+
+static void BenchSetupPiecewise(void)
+{
+    BenchSetupCalibration(FSC_AMBIENT_CAL_PIECEWISE);
+    BenchSetupSensors(FSC_CTL_POLYNOMIAL, FSC_AMBIENT_CAL_PIECEWISE);
+}
+
+static void BenchSetupCalPolynomial(void)
+{
+    BenchSetupPolynomial();
+}
+
+static void BenchSetupCalPiecewise(void)
+{
+    BenchSetupPiecewise();
+}
+
+static void BenchRunGetPWMValue(long calls)
+{
+    FSCTempSensor *pSensor = NULL;
+    INT8U pwm = 0;
+    INT32U sink = 0;
+    long i;
+
+    for (i = 0; i < calls; i++)
+    {
+        pSensor = &m_BenchSensor[i & (BENCH_SENSOR_NUM - 1)];
+        pSensor->CurrentTemp = m_BenchInput[i & (BENCH_INPUT_NUM - 1)];
+        FSCGetPWMValue(&pwm, pSensor, 0, 0);
+        sink += pwm;
+    }
+    m_BenchSink = sink;
+}
+
+static void BenchRunAmbient(long calls)
+{
+    float sink = 0;
+    long i;
+
+    for (i = 0; i < calls; i++)
+    {
+        sink += FSCGetAmbientTemperature(m_BenchInput[i & (BENCH_INPUT_NUM - 1)],
+                                         m_BenchPWM[i & (BENCH_INPUT_NUM - 1)], 0);
+    }
+    m_BenchSink = (INT32U)sink;
+}
+
+/**
+ * @fn BenchSetupCycle
+ * @brief Gives every profile sensor of the config a plant node, so the
+ *        control cycle reads a reading for each of them.
+ */
+static void BenchSetupCycle(void)
+{
+    SimPlant *pPlant = &g_SimPlant;
+    int i;
+
+    SimPlantDefaults(pPlant);
+
+    // The first cycle loads the config
+    FanControlLoop(0);
+
+    for (i = 0; i < g_FscProfileInfo.TotalProfileNum && i < SIM_NODE_MAX; i++)
+    {
+        pPlant->Node[i].SensorNum = g_FscProfileInfo.ProfileInfo[i].SensorNum;
+        pPlant->Node[i].FanMask = (1 << SYS_FAN_NUM_MAX) - 1;
+    }
+    pPlant->NodeNum = (INT8U)i;
+    SimPlantStart(pPlant);
+}
+
+static void BenchRunCycle(long calls)
+{
+    SimPlant *pPlant = &g_SimPlant;
+    long i;
+    int j;
+
+    for (i = 0; i < calls; i++)
+    {
+        for (j = 0; j < pPlant->NodeNum; j++)
+        {
+            pPlant->Node[j].Temp = m_BenchInput[(i * 8 + j) & (BENCH_INPUT_NUM - 1)];
+        }
+        FanControlLoop(0);
+    }
+    m_BenchSink = pPlant->Fan[0].PWM;
+}
+
+static const FSCBench m_Bench[] =
+{
+    { "pid",                    BenchSetupPID,           BenchRunGetPWMValue, 0 },
+    { "polynomial",             BenchSetupPolynomial,    BenchRunGetPWMValue, 0 },
+    { "piecewise",              BenchSetupPiecewise,     BenchRunGetPWMValue, 0 },
+    { "ambient_cal_polynomial", BenchSetupCalPolynomial, BenchRunAmbient,     0 },
+    { "ambient_cal_piecewise",  BenchSetupCalPiecewise,  BenchRunAmbient,     0 },
+    { "control_cycle",          BenchSetupCycle,         BenchRunCycle,       1 },
+};
+
+static int BenchCompare(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+
+    return (da > db) - (da < db);
+}
+
+/**
+ * @fn BenchRun
+ * @brief Runs one benchmark and writes its result line.
+ */
+static void BenchRun(const FSCBench *pBench, long calls, int reps, FILE *out)
+{
+    BenchCounters counters;
+    INT64U count[BENCH_COUNTER_NUM];
+    INT64U best[BENCH_COUNTER_NUM];
+    double ns[BENCH_REP_MAX];
+    INT64U start;
+    int counted = 1;
+    int r;
+
+    pBench->Setup();
+
+    // Warm up caches and branch predictors
+    pBench->Run(calls / 10 + 1);
+
+    BenchCountersOpen(&counters);
+    for (r = 0; r < reps; r++)
+    {
+        BenchCountersStart(&counters);
+        start = BenchNow();
+        pBench->Run(calls);
+        ns[r] = (double)(BenchNow() - start) / calls;
+
+        if (BenchCountersStop(&counters, count) != 0)
+        {
+            counted = 0;
+        }
+        else if (r == 0 || count[0] < best[0])
+        {
+            memcpy(best, count, sizeof(best));
+        }
+    }
+    BenchCountersClose(&counters);
+
+    qsort(ns, reps, sizeof(double), BenchCompare);
+
+    fprintf(out, "{\"bench\":\"%s\",\"calls\":%ld,\"reps\":%d,\"ns_per_call\":%.2f,\"ns_per_call_min\":%.2f",
+            pBench->Name, calls, reps, ns[reps / 2], ns[0]);
+    if (counted)
+    {
+        fprintf(out, ",\"instructions_per_call\":%.1f,\"cache_misses_per_call\":%.4f}\n",
+                (double)best[0] / calls, (double)best[1] / calls);
+    }
+    else
+    {
+        fprintf(out, ",\"instructions_per_call\":null,\"cache_misses_per_call\":null}\n");
+    }
+    fflush(out);
+}
+
+static void BenchUsage(const char *name)
+{
+    printf("Usage: %s [-c <fsc config>] [-n <calls>] [-r <repetitions>] [-b <benchmark>] [-o <output>]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filter = NULL;
+    FILE *out = NULL;
+    long calls = 1000000;
+    int reps = 7;
+    size_t i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:n:r:b:o:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c': SimBmcSetConfigFile(optarg); break;
+            case 'n': calls = strtol(optarg, NULL, 0); break;
+            case 'r': reps = (int)strtol(optarg, NULL, 0); break;
+            case 'b': filter = optarg; break;
+            case 'o':
+                out = fopen(optarg, "w");
+                if (out == NULL)
+                {
+                    fprintf(stderr, "fsc_bench: cannot write %s: %s\n", optarg, strerror(errno));
+                    return 1;
+                }
+                break;
+            default: BenchUsage(argv[0]); return 1;
+        }
+    }
+
+    if (calls <= 0 || reps <= 0 || reps > BENCH_REP_MAX)
+    {
+        BenchUsage(argv[0]);
+        return 1;
+    }
+
+    // Keep stdout for the results, whatever the FSC prints goes to stderr
+    if (out == NULL)
+    {
+        out = fdopen(dup(STDOUT_FILENO), "w");
+        if (out == NULL)
+        {
+            return 1;
+        }
+    }
+    fflush(stdout);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    m_BenchSensor = calloc(BENCH_SENSOR_NUM, sizeof(FSCTempSensor));
+    m_BenchInput = calloc(BENCH_INPUT_NUM, sizeof(INT16S));
+    m_BenchPWM = calloc(BENCH_INPUT_NUM, sizeof(INT8U));
+    if (m_BenchSensor == NULL || m_BenchInput == NULL || m_BenchPWM == NULL)
+    {
+        return 1;
+    }
+
+    for (i = 0; i < sizeof(m_Bench) / sizeof(m_Bench[0]); i++)
+    {
+        if (filter != NULL && strcmp(filter, m_Bench[i].Name) != 0)
+        {
+            continue;
+        }
+        if (m_Bench[i].NeedConfig && SimConfigFile()[0] == '\0')
+        {
+            continue;
+        }
+        BenchRun(&m_Bench[i], calls, reps, out);
+    }
+
+    fclose(out);
+    free(m_BenchSensor);
+    free(m_BenchInput);
+    free(m_BenchPWM);
+    return 0;
+}
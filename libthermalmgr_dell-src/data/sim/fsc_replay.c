@@ -0,0 +1,158 @@
+/*************************************************************************
+ *
+ * fsc_replay.c
+ * Replays a recording of the FSC on a host and checks its outputs
+ *
+ * Every recorded cycle is fed through FanControlLoop, with the sensor
+ * readings, fan presence and PWM write results of the recording, and the
+ * global, profile and fan tray PWMs are compared with the recorded ones.
+ * A build that behaves the same replays without a difference; a changed
+ * build shows where and by how much it would have driven the fans
+ * differently on the recorded data.
+ *
+ *   fsc_replay -c <fsc config> -r <recording> [-o <csv>] [-m <max shown>] [-v]
+ *
+ * The exit status is 0 if every cycle matched, 1 otherwise. -o writes the
+ * recorded and replayed PWMs of every cycle.
+ *
+ * Outputs are bit exact when the build runs the floating point code the
+ * same way as the BMC; across compilers or architectures they may be off
+ * by one PWM step where a result is rounded.
+ *
+ ************************************************************************/
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "OEMDBG.h"
+#include "fsc.h"
+#include "fsc_record.h"
+#include "sim_bmc.h"
+
+static void ReplayUsage(const char *name)
+{
+    printf("Usage: %s -c <fsc config> -r <recording> [-o <csv>] [-m <max shown>] [-v]\n", name);
+}
+
+static void ReplayPrint(const FSCReplayResult *pResult)
+{
+    int i;
+
+    printf("cycle %u: %d outputs differ, PWM %d -> %d, trays",
+           pResult->Seq, pResult->Mismatch, pResult->RecordedPWM, pResult->ReplayedPWM);
+    for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+    {
+        printf(" %d->%d", pResult->RecordedTrayPWM[i], pResult->ReplayedTrayPWM[i]);
+    }
+    if (pResult->Missing || pResult->Unused)
+    {
+        printf(", %d inputs not recorded, %d not read", pResult->Missing, pResult->Unused);
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    FSCReplayResult result;
+    const char *record_path = NULL;
+    const char *csv_path = NULL;
+    FILE *csv = NULL;
+    long cycles = 0, diverged = 0;
+    long first = -1;
+    long max_shown = 10;
+    int ret;
+    int i, opt;
+
+    while ((opt = getopt(argc, argv, "c:r:o:m:vh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c': SimBmcSetConfigFile(optarg); break;
+            case 'r': record_path = optarg; break;
+            case 'o': csv_path = optarg; break;
+            case 'm': max_shown = strtol(optarg, NULL, 0); break;
+            case 'v': g_OEMDebugArray[OEM_DEBUG_Item_FSC] = 1; break;
+            default: ReplayUsage(argv[0]); return 1;
+        }
+    }
+
+    if (SimConfigFile()[0] == '\0' || record_path == NULL)
+    {
+        ReplayUsage(argv[0]);
+        return 1;
+    }
+
+    if (FSCReplayOpen(record_path) != 0)
+    {
+        return 1;
+    }
+
+    if (csv_path != NULL)
+    {
+        csv = fopen(csv_path, "w");
+        if (csv == NULL)
+        {
+            printf("fsc_replay: cannot write %s\n", csv_path);
+            return 1;
+        }
+        fprintf(csv, "cycle,mismatch,pwm,replayed_pwm");
+        for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+        {
+            fprintf(csv, ",fan%d_pwm,fan%d_replayed_pwm", i + 1, i + 1);
+        }
+        fprintf(csv, "\n");
+    }
+
+    while ((ret = FSCReplayNextCycle()) > 0)
+    {
+        FanControlLoop(0);
+        FSCReplayGetResult(&result);
+        cycles++;
+
+        if (result.Mismatch || result.Missing)
+        {
+            if (diverged++ < max_shown)
+            {
+                ReplayPrint(&result);
+            }
+            if (first < 0)
+            {
+                first = result.Seq;
+            }
+        }
+
+        if (csv != NULL)
+        {
+            fprintf(csv, "%u,%d,%d,%d", result.Seq, result.Mismatch, result.RecordedPWM, result.ReplayedPWM);
+            for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+            {
+                fprintf(csv, ",%d,%d", result.RecordedTrayPWM[i], result.ReplayedTrayPWM[i]);
+            }
+            fprintf(csv, "\n");
+        }
+    }
+
+    FSCReplayClose();
+    if (csv != NULL)
+    {
+        fclose(csv);
+    }
+
+    if (ret < 0)
+    {
+        printf("fsc_replay: %s is corrupt after %ld cycles\n", record_path, cycles);
+        return 1;
+    }
+
+    if (diverged == 0)
+    {
+        printf("fsc_replay: %ld cycles replayed, outputs identical\n", cycles);
+        return 0;
+    }
+
+    printf("fsc_replay: %ld of %ld cycles differ, first at cycle %ld\n", diverged, cycles, first);
+    return 1;
+}
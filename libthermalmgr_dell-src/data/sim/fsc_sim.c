@@ -0,0 +1,741 @@
+/*************************************************************************
+ *
+ * fsc_sim.c
+ * Host simulator for the fan speed control loop
+ *
+ * Runs FanControlLoop unchanged against a simulated chassis, so an
+ * algorithm or configuration change can be evaluated before flashing.
+ * Node temperatures come either from the RC plant in sim_plant.c,
+ * driven by a scenario of ambient, load and fan failure events, or from
+ * a recorded trace replayed open loop.
+ *
+ *   fsc_sim -c <fsc config> [-s <scenario>] [-t <trace>] [-o <csv>]
+ *           [-r <recording>] [-d <duration s>] [-a] [-v]
+ *
+ * A trace is a CSV file with a 'time' column in seconds followed by one
+ * column per temperature sensor, headed by its sensor number. An empty
+ * cell or 'na' reads as unavailable. Scenario nodes give the sensors of
+ * a trace their labels and setpoints.
+ *
+ * The run is summarized as settling time after each event, overshoot and
+ * time over setpoint for every node with a setpoint, and PWM energy,
+ * the fan power integrated with the cubic fan law. The first warmup_s
+ * seconds of a scenario, where the loop pulls the plant away from its
+ * arbitrary start, are left out of all but the settling times.
+ *
+ * -r records the run as the BMC would with the 'recorder' configured, for
+ * fsc_replay.
+ *
+ * -a runs the loop at the adaptive period of the FSC thread, see
+ * fsc_period.c. The plant then steps at the minimum period of the 'loop'
+ * configuration instead of the scenario period.
+ *
+ ************************************************************************/
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Types.h"
+#include "cJSON.h"
+#include "OEMFAN.h"
+#include "OEMDBG.h"
+#include "fsc.h"
+#include "fsc_parser.h"
+#include "fsc_record.h"
+#include "fsc_period.h"
+#include "sim_plant.h"
+#include "sim_bmc.h"
+
+// A segment has settled once the highest tray PWM stays within this many
+// percent, and every tracked node within this many C, of where it ends
+#define SIM_SETTLE_PWM_BAND     2
+#define SIM_SETTLE_TEMP_BAND    0.5f
+
+#define SIM_TRACE_LINE_MAX      1024
+
+typedef struct
+{
+    float  Duration;                    // s
+    float  Period;                      // s between FanControlLoop calls
+    float  Warmup;                      // s left out of the energy and node metrics
+    INT8U  InitialPWM;                  // PWM of the fans at the start
+} SimScenario;
+
+typedef struct
+{
+    int    ColumnNum;
+    INT8U  SensorNum[SIM_NODE_MAX];
+    int    RowNum;
+    float *pTime;                       // RowNum
+    float *pTemp;                       // RowNum x ColumnNum, NAN = unavailable
+} SimTrace;
+
+typedef struct
+{
+    int    StepNum;
+    float *pPWM;                        // StepNum x SYS_FAN_NUM_MAX
+    float *pTemp;                       // StepNum x SIM_NODE_MAX
+} SimHistory;
+
+/**
+ * @fn SimReadFile
+ * @return Content of a file, to be freed by the caller, NULL on failure.
+ */
+static char *SimReadFile(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    char *content = NULL;
+    long length;
+
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        content = malloc((size_t)length + 1);
+        if (content != NULL)
+        {
+            content[fread(content, 1, (size_t)length, file)] = '\0';
+        }
+    }
+
+    fclose(file);
+    return content;
+}
+
+/**
+ * @fn SimJsonNumber
+ * @return Number under a key, or the default if the key is missing.
+ */
+static double SimJsonNumber(const cJSON *pObject, const char *key, double def)
+{
+    const cJSON *pItem = cJSON_GetObjectItem(pObject, key);
+
+    return (pItem != NULL && cJSON_IsNumber(pItem)) ? cJSON_GetNumberValue(pItem) : def;
+}
+
+/**
+ * @fn SimJsonFanMask
+ * @return Trays listed by a 1 based array under a key, every tray if missing.
+ */
+static INT8U SimJsonFanMask(const cJSON *pObject, const char *key)
+{
+    const cJSON *pList = cJSON_GetObjectItem(pObject, key);
+    INT8U mask = 0;
+    int i, fan;
+
+    if (pList == NULL)
+    {
+        return (1 << SYS_FAN_NUM_MAX) - 1;
+    }
+
+    for (i = 0; i < cJSON_GetArraySize(pList); i++)
+    {
+        fan = (int)cJSON_GetNumberValue(cJSON_GetArrayItem(pList, i));
+        if (fan >= 1 && fan <= SYS_FAN_NUM_MAX)
+        {
+            mask |= 1 << (fan - 1);
+        }
+    }
+    return mask;
+}
+
+static int SimEventCompare(const void *a, const void *b)
+{
+    float ta = ((const SimEvent *)a)->Time;
+    float tb = ((const SimEvent *)b)->Time;
+
+    return (ta > tb) - (ta < tb);
+}
+
+/**
+ * @fn SimLoadScenario
+ * @brief Reads the plant, nodes and events of a scenario file.
+ * @return 0 on success, -1 on failure.
+ */
+static int SimLoadScenario(const char *path, SimScenario *pScenario, SimPlant *pPlant)
+{
+    char *file = SimReadFile(path);
+    cJSON *cjson_input = NULL;
+    const cJSON *pFan = NULL;
+    const cJSON *pList = NULL;
+    const cJSON *pItem = NULL;
+    const cJSON *pGain = NULL;
+    SimNode *pNode = NULL;
+    SimEvent *pEvent = NULL;
+    const char *type = NULL;
+    int i, t, num;
+    int ret = -1;
+
+    cjson_input = cJSON_Parse(file);
+    if (cjson_input == NULL)
+    {
+        printf("fsc_sim: cannot parse scenario %s\n", path);
+        goto END;
+    }
+
+    pScenario->Duration = (float)SimJsonNumber(cjson_input, "duration_s", pScenario->Duration);
+    pScenario->Period = (float)SimJsonNumber(cjson_input, "period_s", pScenario->Period);
+    pScenario->Warmup = (float)SimJsonNumber(cjson_input, "warmup_s", pScenario->Warmup);
+    pPlant->Ambient = (float)SimJsonNumber(cjson_input, "ambient", pPlant->Ambient);
+
+    pFan = cJSON_GetObjectItem(cjson_input, "fan");
+    if (pFan != NULL)
+    {
+        pPlant->FanNum = (INT8U)SimJsonNumber(pFan, "num", pPlant->FanNum);
+        if (pPlant->FanNum > SYS_FAN_NUM_MAX)
+        {
+            pPlant->FanNum = SYS_FAN_NUM_MAX;
+        }
+        pPlant->FanMaxRPM = (float)SimJsonNumber(pFan, "max_rpm", pPlant->FanMaxRPM);
+        pPlant->FanTau = (float)SimJsonNumber(pFan, "tau_s", pPlant->FanTau);
+        pPlant->RearRatio = (float)SimJsonNumber(pFan, "rear_ratio", pPlant->RearRatio);
+        pScenario->InitialPWM = (INT8U)SimJsonNumber(pFan, "initial_pwm", pScenario->InitialPWM);
+
+        pGain = cJSON_GetObjectItem(pFan, "gain");
+        for (i = 0; pGain != NULL && i < cJSON_GetArraySize(pGain) && i < SYS_FAN_NUM_MAX; i++)
+        {
+            pPlant->Fan[i].Gain = (float)cJSON_GetNumberValue(cJSON_GetArrayItem(pGain, i));
+        }
+    }
+
+    pList = cJSON_GetObjectItem(cjson_input, "nodes");
+    num = (pList != NULL) ? cJSON_GetArraySize(pList) : 0;
+    if (num > SIM_NODE_MAX)
+    {
+        printf("fsc_sim: too many nodes\n");
+        goto END;
+    }
+
+    for (i = 0; i < num; i++)
+    {
+        pItem = cJSON_GetArrayItem(pList, i);
+        pNode = &pPlant->Node[i];
+
+        pNode->SensorNum = (INT8U)SimJsonNumber(pItem, "sensor_num", 0);
+        snprintf(pNode->Label, sizeof(pNode->Label), "%s",
+                 cJSON_IsString(cJSON_GetObjectItem(pItem, "label")) ?
+                 cJSON_GetObjectItem(pItem, "label")->valuestring : "");
+        pNode->Capacitance = (float)SimJsonNumber(pItem, "capacitance", 0);
+        pNode->GMin = (float)SimJsonNumber(pItem, "g_min", 0);
+        pNode->GMax = (float)SimJsonNumber(pItem, "g_max", 0);
+        pNode->Power = (float)SimJsonNumber(pItem, "power", 0);
+        pNode->Preheat = (float)SimJsonNumber(pItem, "preheat", 0);
+        pNode->SetPoint = (float)SimJsonNumber(pItem, "setpoint", 0);
+        pNode->FanMask = SimJsonFanMask(pItem, "fans");
+    }
+    pPlant->NodeNum = (INT8U)num;
+
+    pList = cJSON_GetObjectItem(cjson_input, "events");
+    num = (pList != NULL) ? cJSON_GetArraySize(pList) : 0;
+    if (num > SIM_EVENT_MAX)
+    {
+        printf("fsc_sim: too many events\n");
+        goto END;
+    }
+
+    for (i = 0; i < num; i++)
+    {
+        pItem = cJSON_GetArrayItem(pList, i);
+        pEvent = &pPlant->Event[i];
+
+        pEvent->Time = (float)SimJsonNumber(pItem, "time", 0);
+        pEvent->Value = (float)SimJsonNumber(pItem, "value", 0);
+
+        type = cJSON_IsString(cJSON_GetObjectItem(pItem, "type")) ?
+               cJSON_GetObjectItem(pItem, "type")->valuestring : "";
+        for (t = 0; SimEventName(t) != NULL && strcmp(SimEventName(t), type) != 0; t++);
+        if (SimEventName(t) == NULL)
+        {
+            printf("fsc_sim: event[%d]: unknown type '%s'\n", i, type);
+            goto END;
+        }
+        pEvent->Type = (INT8U)t;
+
+        if (cJSON_GetObjectItem(pItem, "sensor_num") != NULL)
+        {
+            pNode = SimPlantNode(pPlant, (INT8U)SimJsonNumber(pItem, "sensor_num", 0));
+            if (pNode == NULL)
+            {
+                printf("fsc_sim: event[%d]: no node for sensor %d\n", i, (int)SimJsonNumber(pItem, "sensor_num", 0));
+                goto END;
+            }
+            pEvent->Target = (INT8U)(pNode - pPlant->Node);
+        }
+        else
+        {
+            pEvent->Target = (INT8U)(SimJsonNumber(pItem, "fan", 1) - 1);
+        }
+    }
+    pPlant->EventNum = (INT8U)num;
+    qsort(pPlant->Event, pPlant->EventNum, sizeof(SimEvent), SimEventCompare);
+
+    ret = 0;
+
+END:
+    cJSON_Delete(cjson_input);
+    free(file);
+    return ret;
+}
+
+/**
+ * @fn SimLoadTrace
+ * @brief Reads a recorded trace and adds a node for every sensor in it
+ *        that the scenario does not already have.
+ * @return 0 on success, -1 on failure.
+ */
+static int SimLoadTrace(const char *path, SimTrace *pTrace, SimPlant *pPlant)
+{
+    FILE *file = fopen(path, "r");
+    char line[SIM_TRACE_LINE_MAX];
+    char *token = NULL;
+    char *save = NULL;
+    SimNode *pNode = NULL;
+    int capacity = 0;
+    int col;
+
+    if (file == NULL)
+    {
+        printf("fsc_sim: cannot open trace %s\n", path);
+        return -1;
+    }
+
+    memset(pTrace, 0, sizeof(SimTrace));
+
+    if (fgets(line, sizeof(line), file) == NULL || strncmp(line, "time", 4) != 0)
+    {
+        printf("fsc_sim: trace %s has no 'time' header\n", path);
+        fclose(file);
+        return -1;
+    }
+
+    strtok_r(line, ",\r\n", &save);
+    while ((token = strtok_r(NULL, ",\r\n", &save)) != NULL && pTrace->ColumnNum < SIM_NODE_MAX)
+    {
+        pTrace->SensorNum[pTrace->ColumnNum] = (INT8U)strtol(token, NULL, 0);
+        if (SimPlantNode(pPlant, pTrace->SensorNum[pTrace->ColumnNum]) == NULL && pPlant->NodeNum < SIM_NODE_MAX)
+        {
+            pNode = &pPlant->Node[pPlant->NodeNum++];
+            memset(pNode, 0, sizeof(SimNode));
+            pNode->SensorNum = pTrace->SensorNum[pTrace->ColumnNum];
+            snprintf(pNode->Label, sizeof(pNode->Label), "sensor %d", pNode->SensorNum);
+            pNode->FanMask = (1 << SYS_FAN_NUM_MAX) - 1;
+        }
+        pTrace->ColumnNum++;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (pTrace->RowNum == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 256;
+            pTrace->pTime = realloc(pTrace->pTime, capacity * sizeof(float));
+            pTrace->pTemp = realloc(pTrace->pTemp, (size_t)capacity * pTrace->ColumnNum * sizeof(float));
+            if (pTrace->pTime == NULL || pTrace->pTemp == NULL)
+            {
+                fclose(file);
+                return -1;
+            }
+        }
+
+        // Empty cells are kept, so split by hand instead of with strtok
+        token = line;
+        pTrace->pTime[pTrace->RowNum] = strtof(token, &token);
+        for (col = 0; col < pTrace->ColumnNum; col++)
+        {
+            float *pValue = &pTrace->pTemp[pTrace->RowNum * pTrace->ColumnNum + col];
+            char *end = NULL;
+
+            *pValue = NAN;
+            token = (token != NULL) ? strchr(token, ',') : NULL;
+            if (token == NULL)
+            {
+                continue;
+            }
+            token++;
+            *pValue = strtof(token, &end);
+            if (end == token)
+            {
+                *pValue = NAN;
+            }
+        }
+        pTrace->RowNum++;
+    }
+
+    fclose(file);
+    return (pTrace->RowNum > 0) ? 0 : -1;
+}
+
+/**
+ * @fn SimApplyTrace
+ * @brief Sets the node temperatures from the last trace row at or before t.
+ */
+static void SimApplyTrace(const SimTrace *pTrace, SimPlant *pPlant, float t, int *pRow)
+{
+    SimNode *pNode = NULL;
+    float value;
+    int col;
+
+    while (*pRow + 1 < pTrace->RowNum && pTrace->pTime[*pRow + 1] <= t)
+    {
+        (*pRow)++;
+    }
+
+    for (col = 0; col < pTrace->ColumnNum; col++)
+    {
+        pNode = SimPlantNode(pPlant, pTrace->SensorNum[col]);
+        value = pTrace->pTemp[*pRow * pTrace->ColumnNum + col];
+        pNode->Unreadable = isnan(value) ? 1 : 0;
+        if (!pNode->Unreadable)
+        {
+            pNode->Temp = value;
+        }
+    }
+}
+
+/**
+ * @fn SimSettleTime
+ * @brief Time from the start of a segment until the PWM and the tracked
+ *        temperatures stay within band of their values at its end.
+ * @return Settling time in s, -1 if the segment ends before settling.
+ */
+static float SimSettleTime(const SimHistory *pHistory, const SimPlant *pPlant, float period, int first, int last)
+{
+    float final_pwm = 0, pwm;
+    int unsettled = first - 1;
+    int step, i;
+
+    if (last <= first)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < pPlant->FanNum; i++)
+    {
+        if (pHistory->pPWM[last * SYS_FAN_NUM_MAX + i] > final_pwm)
+        {
+            final_pwm = pHistory->pPWM[last * SYS_FAN_NUM_MAX + i];
+        }
+    }
+
+    for (step = first; step <= last; step++)
+    {
+        pwm = 0;
+        for (i = 0; i < pPlant->FanNum; i++)
+        {
+            if (pHistory->pPWM[step * SYS_FAN_NUM_MAX + i] > pwm)
+            {
+                pwm = pHistory->pPWM[step * SYS_FAN_NUM_MAX + i];
+            }
+        }
+        if (fabsf(pwm - final_pwm) > SIM_SETTLE_PWM_BAND)
+        {
+            unsettled = step;
+            continue;
+        }
+
+        for (i = 0; i < pPlant->NodeNum; i++)
+        {
+            if (pPlant->Node[i].SetPoint > 0 &&
+                fabsf(pHistory->pTemp[step * SIM_NODE_MAX + i] - pHistory->pTemp[last * SIM_NODE_MAX + i]) > SIM_SETTLE_TEMP_BAND)
+            {
+                unsettled = step;
+                break;
+            }
+        }
+    }
+
+    if (unsettled == last)
+    {
+        return -1;
+    }
+    return (unsettled - first + 1) * period;
+}
+
+/**
+ * @fn SimReport
+ * @brief Prints the metrics of a finished run.
+ */
+static void SimReport(const SimHistory *pHistory, const SimPlant *pPlant, const SimScenario *pScenario)
+{
+    const SimNode *pNode = NULL;
+    const SimEvent *pEvent = NULL;
+    float period = pScenario->Period;
+    float energy = 0, pwm_sum = 0;
+    float max_temp, over, pwm, temp, settle;
+    int start = (int)ceilf(pScenario->Warmup / period);
+    int step, i, ev, first, last;
+
+    if (start >= pHistory->StepNum)
+    {
+        start = 0;
+    }
+
+    for (step = start; step < pHistory->StepNum; step++)
+    {
+        for (i = 0; i < pPlant->FanNum; i++)
+        {
+            pwm = pHistory->pPWM[step * SYS_FAN_NUM_MAX + i] / 100;
+            energy += pwm * pwm * pwm * period;
+            pwm_sum += pwm * 100;
+        }
+    }
+
+    printf("steps              : %d x %.2f s, metrics from %.0f s\n", pHistory->StepNum, period, start * period);
+    printf("mean_pwm           : %.1f %%\n", pwm_sum / ((pHistory->StepNum - start) * pPlant->FanNum));
+    printf("pwm_energy         : %.1f tray-s at full speed (%.1f %% of full speed)\n",
+           energy, 100 * energy / ((pHistory->StepNum - start) * period * pPlant->FanNum));
+    printf("sel_events         : %d\n", SimBmcSELCount());
+
+    for (i = 0; i < pPlant->NodeNum; i++)
+    {
+        pNode = &pPlant->Node[i];
+        max_temp = -1000;
+        over = 0;
+        for (step = start; step < pHistory->StepNum; step++)
+        {
+            temp = pHistory->pTemp[step * SIM_NODE_MAX + i];
+            if (temp > max_temp)
+            {
+                max_temp = temp;
+            }
+            if (pNode->SetPoint > 0 && temp > pNode->SetPoint)
+            {
+                over += period;
+            }
+        }
+
+        if (pNode->SetPoint > 0)
+        {
+            printf("node %-14s: max %.1f C, setpoint %.0f C, overshoot %.1f C, over setpoint %.0f s\n",
+                   pNode->Label, max_temp, pNode->SetPoint,
+                   (max_temp > pNode->SetPoint) ? max_temp - pNode->SetPoint : 0, over);
+        }
+        else
+        {
+            printf("node %-14s: max %.1f C\n", pNode->Label, max_temp);
+        }
+    }
+
+    // Segment 0 is the start up, segment n follows event n
+    for (ev = 0; ev <= pPlant->EventNum; ev++)
+    {
+        pEvent = (ev > 0) ? &pPlant->Event[ev - 1] : NULL;
+        first = pEvent ? (int)ceilf(pEvent->Time / period) : 0;
+        last = (ev < pPlant->EventNum) ? (int)ceilf(pPlant->Event[ev].Time / period) - 1 : pHistory->StepNum - 1;
+        if (first >= pHistory->StepNum || last < first)
+        {
+            continue;
+        }
+
+        settle = SimSettleTime(pHistory, pPlant, period, first, last);
+        if (pEvent)
+        {
+            printf("event %-13d: %s @ %.0f s, ", ev, SimEventName(pEvent->Type), pEvent->Time);
+        }
+        else
+        {
+            printf("start              : ");
+        }
+
+        if (settle < 0)
+        {
+            printf("not settled within %.0f s\n", (last - first + 1) * period);
+        }
+        else
+        {
+            printf("settled after %.0f s\n", settle);
+        }
+    }
+}
+
+static void SimUsage(const char *name)
+{
+    printf("Usage: %s -c <fsc config> [-s <scenario>] [-t <trace>] [-o <csv>] [-r <recording>] [-d <duration s>] [-a] [-v]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    SimScenario scenario = { 600, 1, 0, 30 };
+    SimPlant *pPlant = &g_SimPlant;
+    SimTrace trace;
+    SimHistory history;
+    const char *scenario_path = NULL;
+    const char *trace_path = NULL;
+    const char *csv_path = NULL;
+    FILE *csv = NULL;
+    float duration = 0;
+    float next_cycle = 0;
+    float t;
+    int adaptive = 0;
+    int cycles = 0;
+    int ev = 0, row = 0;
+    int step, i, opt;
+
+    SimPlantDefaults(pPlant);
+    memset(&trace, 0, sizeof(trace));
+
+    while ((opt = getopt(argc, argv, "c:s:t:o:r:d:avh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c': SimBmcSetConfigFile(optarg); break;
+            case 's': scenario_path = optarg; break;
+            case 't': trace_path = optarg; break;
+            case 'o': csv_path = optarg; break;
+            case 'r': FSCRecordSetFile(optarg); break;
+            case 'd': duration = strtof(optarg, NULL); break;
+            case 'a': adaptive = 1; break;
+            case 'v': g_OEMDebugArray[OEM_DEBUG_Item_FSC] = 1; break;
+            default: SimUsage(argv[0]); return 1;
+        }
+    }
+
+    if (SimConfigFile()[0] == '\0' || (scenario_path == NULL && trace_path == NULL))
+    {
+        SimUsage(argv[0]);
+        return 1;
+    }
+
+    if (scenario_path != NULL && SimLoadScenario(scenario_path, &scenario, pPlant) != 0)
+    {
+        return 1;
+    }
+
+    if (trace_path != NULL)
+    {
+        if (SimLoadTrace(trace_path, &trace, pPlant) != 0)
+        {
+            return 1;
+        }
+        pPlant->Replay = 1;
+        scenario.Duration = trace.pTime[trace.RowNum - 1];
+    }
+
+    if (duration > 0)
+    {
+        scenario.Duration = duration;
+    }
+
+    if (adaptive)
+    {
+        if (0 != ParseLoopFromJson((char *)SimConfigFile(), &g_FscLoop, 0))
+        {
+            return 1;
+        }
+        scenario.Period = g_FscLoop.MinPeriodMs / 1000.0f;
+    }
+
+    if (scenario.Period <= 0 || scenario.Duration <= 0)
+    {
+        printf("fsc_sim: period and duration must be positive\n");
+        return 1;
+    }
+
+    history.StepNum = (int)(scenario.Duration / scenario.Period) + 1;
+    history.pPWM = calloc((size_t)history.StepNum * SYS_FAN_NUM_MAX, sizeof(float));
+    history.pTemp = calloc((size_t)history.StepNum * SIM_NODE_MAX, sizeof(float));
+    if (history.pPWM == NULL || history.pTemp == NULL)
+    {
+        return 1;
+    }
+
+    if (csv_path != NULL)
+    {
+        csv = fopen(csv_path, "w");
+        if (csv == NULL)
+        {
+            printf("fsc_sim: cannot write %s\n", csv_path);
+            return 1;
+        }
+        fprintf(csv, "time");
+        for (i = 0; i < pPlant->FanNum; i++)
+        {
+            fprintf(csv, ",fan%d_pwm,fan%d_rpm", i + 1, i + 1);
+        }
+        for (i = 0; i < pPlant->NodeNum; i++)
+        {
+            fprintf(csv, ",%d", pPlant->Node[i].SensorNum);
+        }
+        fprintf(csv, "\n");
+    }
+
+    for (i = 0; i < pPlant->FanNum; i++)
+    {
+        pPlant->Fan[i].PWM = scenario.InitialPWM;
+    }
+    if (pPlant->Replay)
+    {
+        SimApplyTrace(&trace, pPlant, 0, &row);
+    }
+    SimPlantStart(pPlant);
+
+    for (step = 0; step < history.StepNum; step++)
+    {
+        t = step * scenario.Period;
+
+        while (ev < pPlant->EventNum && pPlant->Event[ev].Time <= t)
+        {
+            SimPlantApplyEvent(pPlant, &pPlant->Event[ev++]);
+        }
+
+        if (pPlant->Replay)
+        {
+            SimApplyTrace(&trace, pPlant, t, &row);
+        }
+
+        // Half a step of slack for the float time
+        if (!adaptive || t + scenario.Period / 2 >= next_cycle)
+        {
+            FanControlLoop(0);
+            cycles++;
+            if (adaptive)
+            {
+                next_cycle = t + FSCPeriodNext(0) / 1000.0f;
+            }
+        }
+
+        for (i = 0; i < pPlant->FanNum; i++)
+        {
+            history.pPWM[step * SYS_FAN_NUM_MAX + i] = pPlant->Fan[i].Present ? pPlant->Fan[i].PWM : 0;
+        }
+        for (i = 0; i < pPlant->NodeNum; i++)
+        {
+            history.pTemp[step * SIM_NODE_MAX + i] = pPlant->Node[i].Temp;
+        }
+
+        if (csv != NULL)
+        {
+            fprintf(csv, "%.2f", t);
+            for (i = 0; i < pPlant->FanNum; i++)
+            {
+                fprintf(csv, ",%d,%.0f", pPlant->Fan[i].PWM, pPlant->Fan[i].RPM[0]);
+            }
+            for (i = 0; i < pPlant->NodeNum; i++)
+            {
+                fprintf(csv, ",%.2f", pPlant->Node[i].Temp);
+            }
+            fprintf(csv, "\n");
+        }
+
+        SimPlantStep(pPlant, scenario.Period);
+    }
+
+    if (csv != NULL)
+    {
+        fclose(csv);
+    }
+
+    SimReport(&history, pPlant, &scenario);
+    printf("fsc_cycles         : %d, mean period %.2f s\n", cycles, history.StepNum * scenario.Period / cycles);
+
+    free(history.pPWM);
+    free(history.pTemp);
+    free(trace.pTime);
+    free(trace.pTemp);
+    return 0;
+}
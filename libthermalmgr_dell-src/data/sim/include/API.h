@@ -0,0 +1,15 @@
+/*************************************************************************
+ *
+ * API.h
+ * Host stand-in for the SPX API.h, used by the FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_API_H
+#define SIM_API_H
+
+#include "Types.h"
+#include "IPMIDefs.h"
+
+extern int API_ExecuteCmd(MsgPkt_T *pMsgPkt, int BMCInst);
+
+#endif // SIM_API_H
@@ -0,0 +1,12 @@
+/*************************************************************************
+ *
+ * IPMIConf.h
+ * Host stand-in for the SPX IPMIConf.h, used by the FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_IPMICONF_H
+#define SIM_IPMICONF_H
+
+#include "Types.h"
+
+#endif // SIM_IPMICONF_H
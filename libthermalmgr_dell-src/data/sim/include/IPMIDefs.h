@@ -0,0 +1,26 @@
+/*************************************************************************
+ *
+ * IPMIDefs.h
+ * Host stand-in for the SPX IPMIDefs.h, used by the FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_IPMIDEFS_H
+#define SIM_IPMIDEFS_H
+
+#include "Types.h"
+
+#define NETFN_STORAGE           0x0A
+#define CC_SUCCESS              0x00
+#define CC_DEST_UNAVAILABLE     0xD3
+
+#define MSG_PAYLOAD_SIZE        256
+
+typedef struct
+{
+    INT8U   NetFnLUN;
+    INT8U   Cmd;
+    INT32U  Size;
+    INT8U   Data[MSG_PAYLOAD_SIZE];
+} MsgPkt_T;
+
+#endif // SIM_IPMIDEFS_H
@@ -0,0 +1,12 @@
+/*************************************************************************
+ *
+ * IPMI_SEL.h
+ * Host stand-in for the SPX IPMI_SEL.h, used by the FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_IPMI_SEL_H
+#define SIM_IPMI_SEL_H
+
+#define CMD_ADD_SEL_ENTRY       0x44
+
+#endif // SIM_IPMI_SEL_H
@@ -0,0 +1,20 @@
+/*************************************************************************
+ *
+ * OEMDBG.h
+ * Host stand-in for the OEM debug switches and log macros, used by the FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_OEMDBG_H
+#define SIM_OEMDBG_H
+
+#include <stdio.h>
+
+#define OEM_DEBUG_Item_FSC      0
+#define OEM_DEBUG_Item_MAX      8
+
+extern int g_OEMDebugArray[OEM_DEBUG_Item_MAX];
+
+#define TINFO(fmt, ...)         fprintf(stderr, fmt "\n", ##__VA_ARGS__)
+#define TCRIT(fmt, ...)         fprintf(stderr, fmt, ##__VA_ARGS__)
+
+#endif // SIM_OEMDBG_H
@@ -0,0 +1,39 @@
+/*************************************************************************
+ *
+ * OEMFAN.h
+ * Host stand-in for the OEM fan interface, used by the FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_OEMFAN_H
+#define SIM_OEMFAN_H
+
+#include "Types.h"
+
+#define SYS_FAN1                0
+#define SYS_FAN2                1
+#define SYS_FAN3                2
+#define SYS_FAN4                3
+#define SYS_FAN5                4
+#define SYS_FAN_NUM_MAX         5
+
+#define FAN_ROTOR_FRONT         0
+#define FAN_ROTOR_REAR          1
+
+#define FAN_ABSENT              0
+#define FAN_PRESENT             1
+
+#define FAN_RPM_MULTIPLIER      150
+
+#define AIRFLOW_F2B             0
+#define AIRFLOW_B2F             1
+
+#define FAN_CTL_MODE_AUTO       0
+#define FAN_CTL_MODE_MANUAL     1
+
+extern int OEM_GetFanTrayPresent(INT8U fan_id);
+extern int OEM_GetFanTrayRPM(INT8U fan_id, INT8U fan_rotor, INT16U *rpm);
+extern int OEM_SetFanTrayPWM(INT8U fan_id, INT8U pwm);
+extern int OEM_SetAllFanTraysPWM(INT8U pwm);
+extern int OEM_GetSystemAirflow(void);
+
+#endif // SIM_OEMFAN_H
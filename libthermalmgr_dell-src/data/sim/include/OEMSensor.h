@@ -0,0 +1,22 @@
+/*************************************************************************
+ *
+ * OEMSensor.h
+ * Host stand-in for the OEM sensor numbers, used by the FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_OEMSENSOR_H
+#define SIM_OEMSENSOR_H
+
+// Fan RPM sensors, outside the range the FSC configs use for temperatures
+#define FAN1_FRONT_RPM_SENSOR   0xE0
+#define FAN1_REAR_RPM_SENSOR    0xE1
+#define FAN2_FRONT_RPM_SENSOR   0xE2
+#define FAN2_REAR_RPM_SENSOR    0xE3
+#define FAN3_FRONT_RPM_SENSOR   0xE4
+#define FAN3_REAR_RPM_SENSOR    0xE5
+#define FAN4_FRONT_RPM_SENSOR   0xE6
+#define FAN4_REAR_RPM_SENSOR    0xE7
+#define FAN5_FRONT_RPM_SENSOR   0xE8
+#define FAN5_REAR_RPM_SENSOR    0xE9
+
+#endif // SIM_OEMSENSOR_H
@@ -0,0 +1,12 @@
+/*************************************************************************
+ *
+ * OemDefs.h
+ * Host stand-in for the SPX OemDefs.h, used by the FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_OEMDEFS_H
+#define SIM_OEMDEFS_H
+
+#include "Types.h"
+
+#endif // SIM_OEMDEFS_H
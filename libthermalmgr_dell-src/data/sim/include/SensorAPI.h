@@ -0,0 +1,25 @@
+/*************************************************************************
+ *
+ * SensorAPI.h
+ * Host stand-in for the SPX SensorAPI.h, used by the FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_SENSORAPI_H
+#define SIM_SENSORAPI_H
+
+#include "Types.h"
+#include "IPMIDefs.h"
+
+// Only the fields the FSC reads
+typedef struct
+{
+    INT8U   SensorNumber;
+    INT16U  SensorReading;
+    INT8U   EventFlags;                     // Bit 5 - unable to read
+    INT8U   IsSensorPresent;
+    INT8U   Err;
+} SensorInfo_T;
+
+extern SensorInfo_T *API_GetSensorInfo(INT8U SensorNum, INT8U OwnerLUN, int BMCInst);
+
+#endif // SIM_SENSORAPI_H
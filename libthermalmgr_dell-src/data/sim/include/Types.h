@@ -0,0 +1,26 @@
+/*************************************************************************
+ *
+ * Types.h
+ * Host stand-in for the SPX Types.h, used by the FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_TYPES_H
+#define SIM_TYPES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint8_t     INT8U;
+typedef int8_t      INT8S;
+typedef uint16_t    INT16U;
+typedef int16_t     INT16S;
+typedef uint32_t    INT32U;
+typedef int32_t     INT32S;
+typedef uint64_t    INT64U;
+
+#define PACKED      __attribute__((packed))
+#define TRUE        1
+#define FALSE       0
+#define UN_USED(x)  (void)(x)
+
+#endif // SIM_TYPES_H
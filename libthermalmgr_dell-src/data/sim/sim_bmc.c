@@ -0,0 +1,170 @@
+/*************************************************************************
+ *
+ * sim_bmc.c
+ * BMC services stood in for by the host FSC simulator
+ *
+ * Sensor readings and fan tray I/O go to the simulated plant, SEL
+ * entries are counted and printed.
+ *
+ ************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Types.h"
+#include "API.h"
+#include "IPMIDefs.h"
+#include "IPMI_SEL.h"
+#include "SensorAPI.h"
+#include "OEMFAN.h"
+#include "OEMSensor.h"
+#include "OEMDBG.h"
+#include "sim_plant.h"
+#include "sim_bmc.h"
+
+int g_OEMDebugArray[OEM_DEBUG_Item_MAX];
+
+static const char *m_SimConfigFile = "";
+static int m_SimSELCount = 0;
+static SensorInfo_T m_SimSensorInfo;
+
+const char *SimConfigFile(void)
+{
+    return m_SimConfigFile;
+}
+
+void SimBmcSetConfigFile(const char *path)
+{
+    m_SimConfigFile = path;
+}
+
+int SimBmcSELCount(void)
+{
+    return m_SimSELCount;
+}
+
+/**
+ * @fn SimBmcFanSensor
+ * @brief Maps a fan RPM sensor number to its tray and rotor.
+ * @return 0 if the sensor is a fan RPM sensor, -1 otherwise.
+ */
+static int SimBmcFanSensor(INT8U sensor_num, INT8U *fan_id, INT8U *rotor)
+{
+    if (sensor_num < FAN1_FRONT_RPM_SENSOR || sensor_num > FAN5_REAR_RPM_SENSOR)
+    {
+        return -1;
+    }
+
+    *fan_id = (sensor_num - FAN1_FRONT_RPM_SENSOR) / 2;
+    *rotor = (sensor_num - FAN1_FRONT_RPM_SENSOR) % 2;
+    return 0;
+}
+
+SensorInfo_T *API_GetSensorInfo(INT8U SensorNum, INT8U OwnerLUN, int BMCInst)
+{
+    SensorInfo_T *pInfo = &m_SimSensorInfo;
+    SimNode *pNode = NULL;
+    INT8U fan_id, rotor;
+
+    UN_USED(OwnerLUN);
+    UN_USED(BMCInst);
+
+    memset(pInfo, 0, sizeof(SensorInfo_T));
+    pInfo->SensorNumber = SensorNum;
+
+    if (SimBmcFanSensor(SensorNum, &fan_id, &rotor) == 0)
+    {
+        if (fan_id >= g_SimPlant.FanNum || !g_SimPlant.Fan[fan_id].Present)
+        {
+            pInfo->Err = CC_DEST_UNAVAILABLE;
+            return pInfo;
+        }
+        pInfo->IsSensorPresent = 1;
+        pInfo->SensorReading = (INT16U)(g_SimPlant.Fan[fan_id].RPM[rotor] / FAN_RPM_MULTIPLIER);
+        return pInfo;
+    }
+
+    pNode = SimPlantNode(&g_SimPlant, SensorNum);
+    if (pNode == NULL)
+    {
+        return NULL;
+    }
+
+    pInfo->IsSensorPresent = 1;
+    if (pNode->Unreadable)
+    {
+        pInfo->EventFlags = 0x20;
+    }
+    else
+    {
+        pInfo->SensorReading = (INT16U)lroundf(pNode->Temp < 0 ? 0 : pNode->Temp);
+    }
+
+    return pInfo;
+}
+
+int API_ExecuteCmd(MsgPkt_T *pMsgPkt, int BMCInst)
+{
+    UN_USED(BMCInst);
+
+    if (pMsgPkt->NetFnLUN >> 2 == NETFN_STORAGE && pMsgPkt->Cmd == CMD_ADD_SEL_ENTRY)
+    {
+        m_SimSELCount++;
+        printf("# SEL: sensor 0x%02x type 0x%02x %s, data 0x%02x 0x%02x 0x%02x\n",
+               pMsgPkt->Data[11], pMsgPkt->Data[10], (pMsgPkt->Data[12] & 0x80) ? "deassert" : "assert",
+               pMsgPkt->Data[13], pMsgPkt->Data[14], pMsgPkt->Data[15]);
+    }
+
+    pMsgPkt->Data[0] = CC_SUCCESS;
+    pMsgPkt->Size = 1;
+    return 0;
+}
+
+int OEM_GetFanTrayPresent(INT8U fan_id)
+{
+    if (fan_id >= g_SimPlant.FanNum)
+    {
+        return -1;
+    }
+    return g_SimPlant.Fan[fan_id].Present ? FAN_PRESENT : FAN_ABSENT;
+}
+
+int OEM_GetFanTrayRPM(INT8U fan_id, INT8U fan_rotor, INT16U *rpm)
+{
+    if (fan_id >= g_SimPlant.FanNum || fan_rotor >= SIM_ROTOR_MAX || !g_SimPlant.Fan[fan_id].Present)
+    {
+        return -1;
+    }
+    *rpm = (INT16U)g_SimPlant.Fan[fan_id].RPM[fan_rotor];
+    return 0;
+}
+
+int OEM_SetFanTrayPWM(INT8U fan_id, INT8U pwm)
+{
+    if (fan_id >= g_SimPlant.FanNum || !g_SimPlant.Fan[fan_id].Present)
+    {
+        return -1;
+    }
+    g_SimPlant.Fan[fan_id].PWM = (pwm > 100) ? 100 : pwm;
+    return 0;
+}
+
+int OEM_SetAllFanTraysPWM(INT8U pwm)
+{
+    int ret = 0;
+    int i;
+
+    for (i = 0; i < g_SimPlant.FanNum; i++)
+    {
+        if (OEM_SetFanTrayPWM(i, pwm) != 0)
+        {
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+int OEM_GetSystemAirflow(void)
+{
+    return AIRFLOW_B2F;
+}
@@ -0,0 +1,19 @@
+/*************************************************************************
+ *
+ * sim_bmc.h
+ * BMC services stood in for by the host FSC simulator
+ *
+ * Force included into the FSC sources by Makefile.test, which points
+ * FSC_CONF_B2F_FILE and FSC_CONF_F2B_FILE at SimConfigFile().
+ *
+ ************************************************************************/
+#ifndef SIM_BMC_H
+#define SIM_BMC_H
+
+#include "Types.h"
+
+extern const char *SimConfigFile(void);
+extern void SimBmcSetConfigFile(const char *path);
+extern int SimBmcSELCount(void);
+
+#endif // SIM_BMC_H
@@ -0,0 +1,258 @@
+/*************************************************************************
+ *
+ * sim_plant.c
+ * RC thermal plant and fan model driving the host FSC simulator
+ *
+ * Each node is a single thermal capacitance heated by its power and
+ * cooled by the air of the trays in its fan mask:
+ *
+ *   C dT/dt = P - (GMin + GMax * a^0.8) * (T - Tair)
+ *
+ * where a is the mean front rotor RPM of those trays over fan_max_rpm
+ * and Tair is the ambient plus a preheat that shrinks as the airflow
+ * grows. Rotors follow their PWM with a first order lag.
+ *
+ ************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "sim_plant.h"
+
+SimPlant g_SimPlant;
+
+/**
+ * @fn SimPlantDefaults
+ * @brief Sets the plant parameters not given by the scenario.
+ */
+void SimPlantDefaults(SimPlant *pPlant)
+{
+    int i;
+
+    memset(pPlant, 0, sizeof(SimPlant));
+    pPlant->Ambient = 25;
+    pPlant->FanMaxRPM = 24000;
+    pPlant->FanTau = 2;
+    pPlant->RearRatio = 0.85f;
+    pPlant->FanNum = SYS_FAN_NUM_MAX;
+
+    for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+    {
+        pPlant->Fan[i].Present = 1;
+        pPlant->Fan[i].Gain = 1;
+    }
+}
+
+/**
+ * @fn SimPlantAirflow
+ * @return Airflow reaching a node, 0 to 1.
+ */
+static float SimPlantAirflow(const SimPlant *pPlant, const SimNode *pNode)
+{
+    float sum = 0;
+    int num = 0;
+    int i;
+
+    for (i = 0; i < pPlant->FanNum; i++)
+    {
+        if (!(pNode->FanMask & (1 << i)))
+        {
+            continue;
+        }
+
+        num++;
+        if (pPlant->Fan[i].Present)
+        {
+            sum += (pPlant->Fan[i].RPM[0] + pPlant->Fan[i].RPM[1] / pPlant->RearRatio) / 2;
+        }
+    }
+
+    if (num == 0 || pPlant->FanMaxRPM <= 0)
+    {
+        return 0;
+    }
+
+    sum /= num * pPlant->FanMaxRPM;
+    return (sum > 1) ? 1 : sum;
+}
+
+/**
+ * @fn SimPlantSteadyTemp
+ * @return Temperature a node settles at with the current airflow.
+ */
+static float SimPlantSteadyTemp(const SimPlant *pPlant, const SimNode *pNode)
+{
+    float a = SimPlantAirflow(pPlant, pNode);
+    float g = pNode->GMin + pNode->GMax * powf(a, 0.8f);
+    float air = pPlant->Ambient + pNode->Preheat * (1 - 0.5f * a);
+
+    return air + ((g > 0) ? pNode->Power / g : 0);
+}
+
+/**
+ * @fn SimPlantStart
+ * @brief Spins the fans up to their PWM and settles every node, so a run
+ *        starts from equilibrium at the initial PWM.
+ */
+void SimPlantStart(SimPlant *pPlant)
+{
+    SimFan *pFan = NULL;
+    int i;
+
+    for (i = 0; i < pPlant->FanNum; i++)
+    {
+        pFan = &pPlant->Fan[i];
+        pFan->RPM[0] = pFan->Present ? pPlant->FanMaxRPM * pFan->Gain * pFan->PWM / 100 : 0;
+        pFan->RPM[1] = pFan->RPM[0] * pPlant->RearRatio;
+    }
+
+    for (i = 0; i < pPlant->NodeNum; i++)
+    {
+        if (!pPlant->Replay)
+        {
+            pPlant->Node[i].Temp = SimPlantSteadyTemp(pPlant, &pPlant->Node[i]);
+        }
+    }
+}
+
+/**
+ * @fn SimPlantApplyEvent
+ * @brief Applies one scenario event to the plant.
+ */
+void SimPlantApplyEvent(SimPlant *pPlant, const SimEvent *pEvent)
+{
+    SimFan *pFan = &pPlant->Fan[pEvent->Target % SYS_FAN_NUM_MAX];
+    SimNode *pNode = &pPlant->Node[pEvent->Target % SIM_NODE_MAX];
+
+    switch (pEvent->Type)
+    {
+        case SIM_EV_AMBIENT:
+            pPlant->Ambient = pEvent->Value;
+            break;
+
+        case SIM_EV_POWER:
+            pNode->Power = pEvent->Value;
+            break;
+
+        case SIM_EV_FAN_FAIL:
+            pFan->FailedMask |= (pEvent->Value > 0) ? (INT8U)pEvent->Value : 0x03;
+            break;
+
+        case SIM_EV_FAN_REPAIR:
+            pFan->FailedMask = 0;
+            break;
+
+        case SIM_EV_FAN_REMOVE:
+            pFan->Present = 0;
+            break;
+
+        case SIM_EV_FAN_INSERT:
+            pFan->Present = 1;
+            break;
+
+        case SIM_EV_SENSOR_FAIL:
+            pNode->Unreadable = 1;
+            break;
+
+        case SIM_EV_SENSOR_RESTORE:
+            pNode->Unreadable = 0;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @fn SimPlantStep
+ * @brief Advances the fans and, unless replaying a trace, the node
+ *        temperatures by the given time.
+ */
+void SimPlantStep(SimPlant *pPlant, float seconds)
+{
+    SimFan *pFan = NULL;
+    SimNode *pNode = NULL;
+    float dt, target, k;
+    int i, j;
+
+    while (seconds > 0)
+    {
+        dt = (seconds > SIM_PLANT_STEP) ? SIM_PLANT_STEP : seconds;
+        seconds -= dt;
+
+        k = (pPlant->FanTau > 0) ? 1 - expf(-dt / pPlant->FanTau) : 1;
+        for (i = 0; i < pPlant->FanNum; i++)
+        {
+            pFan = &pPlant->Fan[i];
+            for (j = 0; j < SIM_ROTOR_MAX; j++)
+            {
+                target = pPlant->FanMaxRPM * pFan->Gain * pFan->PWM / 100;
+                if (j == 1)
+                {
+                    target *= pPlant->RearRatio;
+                }
+                if (!pFan->Present || (pFan->FailedMask & (1 << j)))
+                {
+                    target = 0;
+                }
+                pFan->RPM[j] += (target - pFan->RPM[j]) * k;
+            }
+        }
+
+        if (pPlant->Replay)
+        {
+            continue;
+        }
+
+        for (i = 0; i < pPlant->NodeNum; i++)
+        {
+            pNode = &pPlant->Node[i];
+            if (pNode->Capacitance <= 0)
+            {
+                pNode->Temp = SimPlantSteadyTemp(pPlant, pNode);
+                continue;
+            }
+
+            // Exact step of the linear ODE with the airflow held over dt
+            target = SimPlantSteadyTemp(pPlant, pNode);
+            k = pNode->GMin + pNode->GMax * powf(SimPlantAirflow(pPlant, pNode), 0.8f);
+            pNode->Temp = target + (pNode->Temp - target) * expf(-k * dt / pNode->Capacitance);
+        }
+    }
+}
+
+/**
+ * @fn SimPlantNode
+ * @return Node read by a sensor number, NULL if the plant has none.
+ */
+SimNode *SimPlantNode(SimPlant *pPlant, INT8U sensor_num)
+{
+    int i;
+
+    for (i = 0; i < pPlant->NodeNum; i++)
+    {
+        if (pPlant->Node[i].SensorNum == sensor_num)
+        {
+            return &pPlant->Node[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @fn SimEventName
+ * @return Scenario name of an event type.
+ */
+const char *SimEventName(INT8U type)
+{
+    static const char *names[] =
+    {
+        "ambient", "power", "fan_fail", "fan_repair",
+        "fan_remove", "fan_insert", "sensor_fail", "sensor_restore",
+    };
+
+    return (type < sizeof(names) / sizeof(names[0])) ? names[type] : NULL;
+}
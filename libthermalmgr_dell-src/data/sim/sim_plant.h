@@ -0,0 +1,86 @@
+/*************************************************************************
+ *
+ * sim_plant.h
+ * RC thermal plant and fan model driving the host FSC simulator
+ *
+ ************************************************************************/
+#ifndef SIM_PLANT_H
+#define SIM_PLANT_H
+
+#include "Types.h"
+#include "OEMFAN.h"
+
+#define SIM_NODE_MAX            20
+#define SIM_EVENT_MAX           64
+#define SIM_ROTOR_MAX           2
+
+// Plant integration step, the FSC period is split into steps of at most this
+#define SIM_PLANT_STEP          0.1f
+
+// Events
+#define SIM_EV_AMBIENT          0       // Value = ambient in C
+#define SIM_EV_POWER            1       // Value = node power in W
+#define SIM_EV_FAN_FAIL         2       // Value = rotor mask, 1 front, 2 rear
+#define SIM_EV_FAN_REPAIR       3
+#define SIM_EV_FAN_REMOVE       4
+#define SIM_EV_FAN_INSERT       5
+#define SIM_EV_SENSOR_FAIL      6       // Sensor reads as unavailable
+#define SIM_EV_SENSOR_RESTORE   7
+
+typedef struct
+{
+    INT8U  SensorNum;
+    char   Label[32];
+    float  Capacitance;                 // J/C
+    float  GMin;                        // W/C to the air with the fans stopped
+    float  GMax;                        // W/C added at full airflow
+    float  Power;                       // W dissipated
+    float  Preheat;                     // C the air is heated before reaching the node, at full power
+    float  SetPoint;                    // C, 0 = not tracked
+    INT8U  FanMask;                     // Trays whose air cools the node
+    INT8U  Unreadable;
+    float  Temp;                        // State
+} SimNode;
+
+typedef struct
+{
+    INT8U  Present;
+    INT8U  FailedMask;                  // Bit per rotor
+    INT8U  PWM;                         // Last PWM written by the FSC
+    float  Gain;                        // RPM at a PWM relative to a nominal tray
+    float  RPM[SIM_ROTOR_MAX];          // State
+} SimFan;
+
+typedef struct
+{
+    float  Time;
+    INT8U  Type;                        // SIM_EV_*
+    INT8U  Target;                      // Node index or fan tray
+    float  Value;
+} SimEvent;
+
+typedef struct
+{
+    float  Ambient;                     // C
+    float  FanMaxRPM;                   // Front rotor RPM of a nominal tray at 100%
+    float  FanTau;                      // Rotor time constant in s
+    float  RearRatio;                   // Rear / front rotor RPM
+    INT8U  FanNum;
+    SimFan Fan[SYS_FAN_NUM_MAX];
+    INT8U  NodeNum;
+    SimNode Node[SIM_NODE_MAX];
+    INT8U  EventNum;
+    SimEvent Event[SIM_EVENT_MAX];
+    INT8U  Replay;                      // 1 = node temperatures come from a trace
+} SimPlant;
+
+extern SimPlant g_SimPlant;
+
+extern void SimPlantDefaults(SimPlant *pPlant);
+extern void SimPlantStart(SimPlant *pPlant);
+extern void SimPlantApplyEvent(SimPlant *pPlant, const SimEvent *pEvent);
+extern void SimPlantStep(SimPlant *pPlant, float seconds);
+extern SimNode *SimPlantNode(SimPlant *pPlant, INT8U sensor_num);
+extern const char *SimEventName(INT8U type);
+
+#endif // SIM_PLANT_H
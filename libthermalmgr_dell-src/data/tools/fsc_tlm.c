@@ -0,0 +1,265 @@
+/*************************************************************************
+ *
+ * fsc_tlm.c
+ * Reader of the FSC telemetry ring
+ *
+ * Formats the records the fan control loop writes to shared memory, see
+ * fsc_telemetry.h. It runs next to the loop without slowing it down, so
+ * it can be used on a production BMC.
+ *
+ *   fsc_tlm [-n <records>] [-f] [-p <profile>] [-c] [-s <shm name>]
+ *   fsc_tlm -t [-s <shm name>]
+ *
+ * Prints the last -n records (64 by default) and exits, or keeps
+ * printing new ones with -f. -p keeps the records of one profile and
+ * the cycle records, -c prints CSV. -t prints the loop timing stats
+ * instead, see fsc_timing.h.
+ *
+ * Built with the SPX toolchain from this directory with
+ *   $(CC) -I. tools/fsc_tlm.c fsc_telemetry.c fsc_timing.c -o fsc_tlm -lrt
+ *
+ ************************************************************************/
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Types.h"
+#include "OEMFAN.h"
+#include "fsc_telemetry.h"
+#include "fsc_timing.h"
+
+// Poll period when following, ms
+#define TLM_FOLLOW_PERIOD       200
+
+static const struct
+{
+    INT8U Flag;
+    const char *Name;
+} m_TlmProfileFlag[] =
+{
+    { FSC_TLM_PRESENT,      "present" },
+    { FSC_TLM_VALID,        "valid" },
+    { FSC_TLM_FILTERED,     "filtered" },
+    { FSC_TLM_HYSTERESIS,   "hysteresis" },
+    { FSC_TLM_RATE_LIMITED, "rate_limited" },
+    { FSC_TLM_CLAMP_MAX,    "clamp_max" },
+    { FSC_TLM_CLAMP_MIN,    "clamp_min" },
+    { FSC_TLM_REUSED,       "reused" },
+};
+
+static const struct
+{
+    INT8U Flag;
+    const char *Name;
+} m_TlmCycleFlag[] =
+{
+    { FSC_TLM_BOOSTED,      "boosted" },
+    { FSC_TLM_RPM_CONTROL,  "rpm_control" },
+};
+
+/**
+ * @fn TlmFlags
+ * @brief Formats the flags of a record as a '|' separated list.
+ */
+static const char *TlmFlags(const FSCTelemetryRecord *pRecord)
+{
+    static char buf[128];
+    size_t len = 0;
+    size_t num, i;
+    INT8U flag;
+    const char *name;
+
+    buf[0] = '\0';
+    num = (pRecord->Type == FSC_TLM_CYCLE) ? sizeof(m_TlmCycleFlag) / sizeof(m_TlmCycleFlag[0])
+                                           : sizeof(m_TlmProfileFlag) / sizeof(m_TlmProfileFlag[0]);
+
+    for (i = 0; i < num; i++)
+    {
+        flag = (pRecord->Type == FSC_TLM_CYCLE) ? m_TlmCycleFlag[i].Flag : m_TlmProfileFlag[i].Flag;
+        name = (pRecord->Type == FSC_TLM_CYCLE) ? m_TlmCycleFlag[i].Name : m_TlmProfileFlag[i].Name;
+
+        if ((pRecord->Flags & flag) && len < sizeof(buf))
+        {
+            len += snprintf(&buf[len], sizeof(buf) - len, "%s%s", len ? "|" : "", name);
+        }
+    }
+
+    return buf;
+}
+
+static void TlmPrint(const FSCTelemetryRecord *pRecord, int csv)
+{
+    int i;
+
+    if (pRecord->Type == FSC_TLM_CYCLE)
+    {
+        if (csv)
+        {
+            printf("%u,%u.%03u,cycle,,,,,,,%d,%s", pRecord->Seq, pRecord->Time / 1000, pRecord->Time % 1000,
+                   pRecord->PWM, TlmFlags(pRecord));
+            for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+            {
+                printf(",%d", pRecord->TrayPWM[i]);
+            }
+            printf("\n");
+            return;
+        }
+
+        printf("%8u %8u.%03u cycle  pwm %3d trays", pRecord->Seq, pRecord->Time / 1000, pRecord->Time % 1000, pRecord->PWM);
+        for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+        {
+            printf(" %3d", pRecord->TrayPWM[i]);
+        }
+        printf(" %s\n", TlmFlags(pRecord));
+        return;
+    }
+
+    if (csv)
+    {
+        printf("%u,%u.%03u,profile,%d,%d,%d,%d,%.2f,%.2f,%d,%s", pRecord->Seq, pRecord->Time / 1000, pRecord->Time % 1000,
+               pRecord->Profile, pRecord->SensorNum, pRecord->Temp, pRecord->LastTemp, pRecord->Ambient,
+               pRecord->RawPWM, pRecord->PWM, TlmFlags(pRecord));
+        for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+        {
+            printf(",");
+        }
+        printf("\n");
+        return;
+    }
+
+    printf("%8u %8u.%03u profile %2d sensor %3d temp %4d (%4d) ambient %6.2f raw %7.2f pwm %3d %s\n",
+           pRecord->Seq, pRecord->Time / 1000, pRecord->Time % 1000, pRecord->Profile, pRecord->SensorNum,
+           pRecord->Temp, pRecord->LastTemp, pRecord->Ambient, pRecord->RawPWM, pRecord->PWM, TlmFlags(pRecord));
+}
+
+static void TlmUsage(const char *name)
+{
+    printf("Usage: %s [-n <records>] [-f] [-p <profile>] [-c] [-s <shm name>]\n", name);
+    printf("       %s -t [-s <shm name>]\n", name);
+}
+
+static int TlmDumpTiming(const char *name)
+{
+    const FSCTimingStats *pStats = NULL;
+    FSCTimingStats stats;
+
+    pStats = FSCTimingAttach(name);
+    if (pStats == NULL)
+    {
+        printf("fsc_tlm: no version %d timing stats at %s\n", FSC_TIMING_VERSION, name);
+        return 1;
+    }
+
+    if (FSCTimingCopy(pStats, &stats) != 0)
+    {
+        printf("fsc_tlm: timing stats at %s keep changing\n", name);
+        return 1;
+    }
+
+    FSCTimingDump(&stats, stdout);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    FSCTelemetryRing *pRing = NULL;
+    FSCTelemetryRecord record;
+    const char *name = NULL;
+    INT32U index, head;
+    INT32U lost;
+    long count = 64;
+    int follow = 0;
+    int csv = 0;
+    int profile = -1;
+    int timing = 0;
+    int i, opt;
+
+    while ((opt = getopt(argc, argv, "n:fp:cs:th")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': count = strtol(optarg, NULL, 0); break;
+            case 'f': follow = 1; break;
+            case 'p': profile = (int)strtol(optarg, NULL, 0); break;
+            case 'c': csv = 1; break;
+            case 's': name = optarg; break;
+            case 't': timing = 1; break;
+            default: TlmUsage(argv[0]); return 1;
+        }
+    }
+
+    if (timing)
+    {
+        return TlmDumpTiming(name ? name : FSC_TIMING_SHM_NAME);
+    }
+
+    if (name == NULL)
+    {
+        name = FSC_TLM_SHM_NAME;
+    }
+
+    pRing = FSCTelemetryAttach(name);
+    if (pRing == NULL)
+    {
+        printf("fsc_tlm: no version %d telemetry ring at %s\n", FSC_TLM_VERSION, name);
+        return 1;
+    }
+
+    if (csv)
+    {
+        printf("cycle,time,type,profile,sensor,temp,last_temp,ambient,raw_pwm,pwm,flags");
+        for (i = 0; i < SYS_FAN_NUM_MAX; i++)
+        {
+            printf(",fan%d_pwm", i + 1);
+        }
+        printf("\n");
+    }
+
+    head = FSCTelemetryHead(pRing);
+    if (count < 0 || (INT32U)count > pRing->Capacity)
+    {
+        count = pRing->Capacity;
+    }
+    index = (head > (INT32U)count) ? head - (INT32U)count : 0;
+
+    for (;;)
+    {
+        lost = 0;
+        for (; index != head; index++)
+        {
+            if (FSCTelemetryRead(pRing, index, &record) != 0)
+            {
+                lost++;
+                continue;
+            }
+
+            if (profile >= 0 && record.Type == FSC_TLM_PROFILE && record.Profile != profile)
+            {
+                continue;
+            }
+            TlmPrint(&record, csv);
+        }
+
+        if (lost && !csv)
+        {
+            printf("# %u records overwritten before they were read\n", lost);
+        }
+
+        if (!follow)
+        {
+            break;
+        }
+
+        fflush(stdout);
+        usleep(TLM_FOLLOW_PERIOD * 1000);
+        head = FSCTelemetryHead(pRing);
+        if (head - index > pRing->Capacity)
+        {
+            index = head - pRing->Capacity;
+        }
+    }
+
+    return 0;
+}